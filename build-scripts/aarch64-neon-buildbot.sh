@@ -0,0 +1,63 @@
+#!/bin/bash
+
+# This script cross-compiles SDL2 from x86 Linux to 64-bit ARM Linux and
+#  runs testyuv under QEMU user mode emulation, so the NEON YUV
+#  conversions get built and checked against the C ones without ARM
+#  hardware.
+
+# On Debian or Ubuntu, install gcc-aarch64-linux-gnu and qemu-user.
+#  Set CROSS_PREFIX to use a different toolchain, and QEMU to use a
+#  different emulator, or to an empty string when running on ARM itself.
+
+if [ "x$CROSS_PREFIX" == "x" ]; then
+    CROSS_PREFIX=aarch64-linux-gnu-
+fi
+
+if [ -z "${QEMU+set}" ]; then
+    QEMU="qemu-aarch64 -L /usr/aarch64-linux-gnu"
+fi
+
+OSTYPE=`uname -s`
+if [ "$OSTYPE" != "Linux" ]; then
+    echo "This only works on Linux at the moment." 1>&2
+    exit 1
+fi
+
+if [ "x$MAKE" == "x" ]; then
+    NCPU=`cat /proc/cpuinfo |grep processor |wc -l`
+    let NCPU=$NCPU+1
+    MAKE="make -j$NCPU"
+fi
+
+BUILDBOTDIR="aarch64-neon-buildbot"
+PARENTDIR="$PWD"
+
+set -e
+set -x
+rm -rf $BUILDBOTDIR
+mkdir -p $BUILDBOTDIR
+pushd $BUILDBOTDIR
+
+# Only the dummy drivers are needed to run the tests, so nothing has to
+#  be installed for the target beyond the C library.
+cmake "$PARENTDIR" \
+    -DCMAKE_SYSTEM_NAME=Linux \
+    -DCMAKE_SYSTEM_PROCESSOR=aarch64 \
+    -DCMAKE_C_COMPILER=${CROSS_PREFIX}gcc \
+    -DCMAKE_BUILD_TYPE=Release \
+    -DSDL_SHARED=OFF -DSDL_TEST=ON \
+    -DVIDEO_X11=OFF -DVIDEO_WAYLAND=OFF -DVIDEO_KMSDRM=OFF \
+    -DVIDEO_OPENGL=OFF -DVIDEO_OPENGLES=OFF -DVIDEO_VULKAN=OFF \
+    -DALSA=OFF -DJACK=OFF -DESD=OFF -DPULSEAUDIO=OFF -DARTS=OFF \
+    -DNAS=OFF -DSNDIO=OFF -DLIBSAMPLERATE=OFF -DHIDAPI=OFF
+$MAKE testyuv
+
+# testyuv compares the NEON conversions against the C ones, then times them
+SDL_VIDEODRIVER=dummy $QEMU ./test/testyuv --automated
+SDL_VIDEODRIVER=dummy $QEMU ./test/testyuv --benchmark
+
+popd
+rm -rf $BUILDBOTDIR
+
+set +x
+echo "All done.";
@@ -489,6 +489,84 @@ extern DECLSPEC SDL_AudioSpec *SDLCALL SDL_LoadWAV_RW(SDL_RWops * src,
  */
 extern DECLSPEC void SDLCALL SDL_FreeWAV(Uint8 * audio_buf);
 
+/**
+ *  \name WAVE streaming
+ *
+ *  A WAVE stream decodes the data of a WAVE file in small pieces as it is
+ *  read, instead of loading all of it into memory like SDL_LoadWAV_RW(). It
+ *  supports the same formats and hints. PCM data is decoded in chunks of 4096
+ *  sample frames and ADPCM data one block at a time, so the memory use does
+ *  not depend on the length of the file.
+ */
+/* @{ */
+struct _SDL_WAVStream;
+typedef struct _SDL_WAVStream SDL_WAVStream;
+
+/**
+ *  Open a WAVE file for streaming
+ *
+ *  The headers of the file are read and checked right away and \c spec is
+ *  filled in the same way as by SDL_LoadWAV_RW(). The data source must
+ *  support seeking and stays in use until the stream is closed.
+ *
+ *  \param src The data source with the WAVE data
+ *  \param freesrc A integer value that makes SDL_CloseWAVStream() close the data source if non-zero
+ *  \param spec A pointer filled with the audio format of the decoded audio data
+ *  \return NULL on error, or the new stream on success. If \c freesrc is
+ *          non-zero, the data source is closed on error.
+ *
+ *  \sa SDL_ReadWAVStream
+ *  \sa SDL_SeekWAVStream
+ *  \sa SDL_CloseWAVStream
+ */
+extern DECLSPEC SDL_WAVStream *SDLCALL SDL_OpenWAVStream_RW(SDL_RWops * src,
+                                                            int freesrc,
+                                                            SDL_AudioSpec * spec);
+
+/**
+ *  Opens a WAVE file for streaming.
+ *  Convenience function.
+ */
+#define SDL_OpenWAVStream(file, spec) \
+    SDL_OpenWAVStream_RW(SDL_RWFromFile(file, "rb"), 1, spec)
+
+/**
+ *  Read and decode audio data from a WAVE stream
+ *
+ *  \param stream The stream to read from
+ *  \param buf A buffer to fill with decoded audio data
+ *  \param len The maximum number of bytes to fill. Only whole sample frames
+ *             are read.
+ *  \return The number of bytes read, 0 at the end of the data, or -1 on error.
+ */
+extern DECLSPEC int SDLCALL SDL_ReadWAVStream(SDL_WAVStream *stream, void *buf, int len);
+
+/**
+ *  Move the read position of a WAVE stream to a sample frame
+ *
+ *  \param stream The stream to seek
+ *  \param frame The sample frame returned by the next read, up to the value
+ *               of SDL_WAVStreamLength()
+ *  \return 0 on success, or -1 on error.
+ */
+extern DECLSPEC int SDLCALL SDL_SeekWAVStream(SDL_WAVStream *stream, Uint32 frame);
+
+/**
+ *  Get the sample frame returned by the next read from a WAVE stream
+ */
+extern DECLSPEC Uint32 SDLCALL SDL_WAVStreamTell(SDL_WAVStream *stream);
+
+/**
+ *  Get the number of sample frames in a WAVE stream
+ */
+extern DECLSPEC Uint32 SDLCALL SDL_WAVStreamLength(SDL_WAVStream *stream);
+
+/**
+ *  Close a WAVE stream and free its memory
+ */
+extern DECLSPEC void SDLCALL SDL_CloseWAVStream(SDL_WAVStream *stream);
+/* @} *//* WAVE streaming */
+
 /**
  *  This function takes a source format and rate and a destination format
  *  and rate, and initializes the \c cvt structure with information needed
@@ -516,6 +594,9 @@ extern DECLSPEC int SDLCALL SDL_BuildAudioCVT(SDL_AudioCVT * cvt,
  *  \c cvt->buf should be allocated after the \c cvt structure is initialized by
  *  SDL_BuildAudioCVT(), and should be \c cvt->len*cvt->len_mult bytes long.
  *
+ *  Large buffers can be converted on several threads at once, see
+ *  SDL_HINT_AUDIO_CONVERT_THREADS. The result is the same either way.
+ *
  *  \return 0 on success or -1 if \c cvt->buf is NULL.
  */
 extern DECLSPEC int SDLCALL SDL_ConvertAudio(SDL_AudioCVT * cvt);
@@ -667,6 +748,107 @@ extern DECLSPEC void SDLCALL SDL_MixAudioFormat(Uint8 * dst,
                                                 SDL_AudioFormat format,
                                                 Uint32 len, int volume);
 
+/**
+ *  A mixer plays any number of voices at once. Each voice is fed through its
+ *  own audio stream, so it can use any format and rate. The voices are
+ *  summed as floats and clipped only once, when the mix is converted to the
+ *  mixer's output format.
+ *
+ *  The mixer is thread safe: voices can be fed from any thread while the
+ *  audio device callback is rendering.
+ *
+ *  \sa SDL_CreateAudioMixer
+ *  \sa SDL_AudioMixerCallback
+ */
+struct _SDL_AudioMixer;
+typedef struct _SDL_AudioMixer SDL_AudioMixer;
+
+/**
+ *  Create a mixer that renders audio in the given format.
+ *
+ *  \param format The format of the mixed output
+ *  \param channels The number of channels of the mixed output
+ *  \param rate The sampling rate of the mixed output
+ *  \return A new mixer, or NULL on error.
+ *
+ *  \sa SDL_AudioMixerAddVoice
+ *  \sa SDL_AudioMixerRender
+ *  \sa SDL_FreeAudioMixer
+ */
+extern DECLSPEC SDL_AudioMixer * SDLCALL SDL_CreateAudioMixer(SDL_AudioFormat format,
+                                                              Uint8 channels,
+                                                              int rate);
+
+/**
+ *  Add a voice to the mixer. Audio queued on the voice is converted from
+ *  the given format to the mixer's format.
+ *
+ *  \return A voice ID >= 0 on success, or -1 on error.
+ *
+ *  \sa SDL_AudioMixerPutVoice
+ *  \sa SDL_AudioMixerSetVoiceGain
+ *  \sa SDL_AudioMixerRemoveVoice
+ */
+extern DECLSPEC int SDLCALL SDL_AudioMixerAddVoice(SDL_AudioMixer *mixer,
+                                                   SDL_AudioFormat format,
+                                                   Uint8 channels,
+                                                   int rate);
+
+/**
+ *  Queue audio to be played on a voice. A voice that runs out of audio
+ *  contributes silence until more is queued.
+ *
+ *  \return 0 on success, or -1 on error.
+ */
+extern DECLSPEC int SDLCALL SDL_AudioMixerPutVoice(SDL_AudioMixer *mixer, int voice,
+                                                   const void *buf, int len);
+
+/**
+ *  Set the gain and stereo position of a voice.
+ *
+ *  \param gain The linear gain, 1.0f plays the voice unchanged
+ *  \param pan The balance between -1.0f (left) and 1.0f (right), 0.0f is centered
+ *  \return 0 on success, or -1 on error.
+ */
+extern DECLSPEC int SDLCALL SDL_AudioMixerSetVoiceGain(SDL_AudioMixer *mixer, int voice,
+                                                       float gain, float pan);
+
+/**
+ *  Get the number of bytes of converted audio queued on a voice, or -1 on
+ *  error.
+ */
+extern DECLSPEC int SDLCALL SDL_AudioMixerVoiceQueued(SDL_AudioMixer *mixer, int voice);
+
+/**
+ *  Remove a voice from the mixer, discarding any audio queued on it.
+ */
+extern DECLSPEC void SDLCALL SDL_AudioMixerRemoveVoice(SDL_AudioMixer *mixer, int voice);
+
+/**
+ *  Mix all voices into \c stream, replacing its contents.
+ *
+ *  Bytes after the last whole sample frame are filled with silence. If
+ *  \c mixer is NULL, \c stream is zeroed and an error is set.
+ *
+ *  \param stream The buffer to fill, in the mixer's output format
+ *  \param len The size of \c stream, in bytes
+ */
+extern DECLSPEC void SDLCALL SDL_AudioMixerRender(SDL_AudioMixer *mixer, Uint8 *stream, int len);
+
+/**
+ *  An audio callback that renders the mixer passed as its userdata.
+ *
+ *  Open the audio device with this as SDL_AudioSpec::callback and the mixer
+ *  as SDL_AudioSpec::userdata, using the mixer's format, channels and rate,
+ *  and the voices are mixed straight into the device buffer.
+ */
+extern DECLSPEC void SDLCALL SDL_AudioMixerCallback(void *userdata, Uint8 *stream, int len);
+
+/**
+ *  Free a mixer and all of its voices.
+ */
+extern DECLSPEC void SDLCALL SDL_FreeAudioMixer(SDL_AudioMixer *mixer);
+
 /**
  *  Queue more audio on non-callback devices.
  *
@@ -686,6 +868,11 @@ extern DECLSPEC void SDLCALL SDL_MixAudioFormat(Uint8 * dst,
  *  the difference. This means you will have skips in your audio playback
  *  if you aren't routinely queueing sufficient data.
  *
+ *  If SDL_HINT_AUDIO_QUEUE_RING_SIZE was set when the device was opened,
+ *  data goes into a fixed size ring instead, without locking the device.
+ *  Only one thread may queue to such a device, and queueing more than fits
+ *  in the ring returns an error without queueing anything.
+ *
  *  This function copies the supplied data, so you are safe to free it when
  *  the function returns. This function is thread-safe, but queueing to the
  *  same device from two threads at once does not promise which buffer will
@@ -826,6 +1013,76 @@ extern DECLSPEC Uint32 SDLCALL SDL_GetQueuedAudioSize(SDL_AudioDeviceID dev);
  */
 extern DECLSPEC void SDLCALL SDL_ClearQueuedAudio(SDL_AudioDeviceID dev);
 
+/**
+ *  Get the number of times a queueing device ran out of audio or room.
+ *
+ *  For playback devices, this counts how often the device ran out of queued
+ *  audio and had to play silence. A device that stays empty counts once,
+ *  not once per callback.
+ *
+ *  For capture devices, this counts how often captured audio had to be
+ *  dropped, because SDL_HINT_AUDIO_QUEUE_RING_SIZE's ring was full or the
+ *  queue couldn't grow.
+ *
+ *  \param dev The device ID to query.
+ *  \return The number of underruns or overruns since the device was opened.
+ *
+ *  \sa SDL_QueueAudio
+ *  \sa SDL_DequeueAudio
+ */
+extern DECLSPEC Uint32 SDLCALL SDL_GetQueuedAudioXruns(SDL_AudioDeviceID dev);
+
+/**
+ *  The number of buckets in SDL_AudioDeviceStats::callback_histogram.
+ */
+#define SDL_AUDIO_STATS_HISTOGRAM_SIZE 16
+
+/**
+ *  Timing statistics of an audio device's thread, all times in microseconds.
+ *
+ *  A "period" is one device buffer, SDL_AudioSpec::samples frames of the
+ *  audio the device was actually opened with.
+ *
+ *  \sa SDL_GetAudioDeviceStats
+ */
+typedef struct SDL_AudioDeviceStats
+{
+    Uint32 period_us;           /**< How long one period of audio lasts */
+    Uint32 periods;             /**< Number of times the audio thread woke up for a period */
+    Uint32 jitter_avg_us;       /**< Average distance of the wake-ups from one period apart */
+    Uint32 jitter_max_us;       /**< Largest distance of the wake-ups from one period apart */
+    Uint32 late_periods;        /**< Wake-ups that came a whole period or more late */
+    Uint32 callbacks;           /**< Number of times the callback ran for a period */
+    Uint32 callback_avg_us;     /**< Average time spent in the callback per period */
+    Uint32 callback_max_us;     /**< Longest time spent in the callback for a period */
+    Uint32 callback_histogram[SDL_AUDIO_STATS_HISTOGRAM_SIZE]; /**< Callback times in eighths of a period, the last bucket counts everything longer */
+    Uint32 xruns;               /**< Same as SDL_GetQueuedAudioXruns() */
+    Uint32 stream_fill;         /**< Bytes waiting to be converted or resized between the callback and the device */
+} SDL_AudioDeviceStats;
+
+/**
+ *  Get timing statistics of an open audio device's thread.
+ *
+ *  The statistics are collected with the performance counter since the
+ *  device was opened, or since the last call to SDL_ResetAudioDeviceStats().
+ *  They help tell a callback that is too slow from a device that wakes up
+ *  irregularly.
+ *
+ *  \param dev The device ID to query.
+ *  \param stats A structure to fill in.
+ *  \return 0 on success, or -1 on error.
+ *
+ *  \sa SDL_ResetAudioDeviceStats
+ */
+extern DECLSPEC int SDLCALL SDL_GetAudioDeviceStats(SDL_AudioDeviceID dev, SDL_AudioDeviceStats *stats);
+
+/**
+ *  Start collecting an audio device's timing statistics over.
+ *
+ *  \sa SDL_GetAudioDeviceStats
+ */
+extern DECLSPEC void SDLCALL SDL_ResetAudioDeviceStats(SDL_AudioDeviceID dev);
+
 
 /**
  *  \name Audio lock functions
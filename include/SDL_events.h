@@ -656,6 +656,18 @@ extern DECLSPEC SDL_bool SDLCALL SDL_HasEvents(Uint32 minType, Uint32 maxType);
 extern DECLSPEC void SDLCALL SDL_FlushEvent(Uint32 type);
 extern DECLSPEC void SDLCALL SDL_FlushEvents(Uint32 minType, Uint32 maxType);
 
+/**
+ *  \brief Get the number of events merged into earlier queued events.
+ *
+ *  \param type ::SDL_MOUSEMOTION or ::SDL_FINGERMOTION
+ *
+ *  \return The number of events of that type that were coalesced since the
+ *          event subsystem was initialized, or 0 for other types.
+ *
+ *  \sa SDL_HINT_EVENT_COALESCE_MOTION
+ */
+extern DECLSPEC int SDLCALL SDL_GetCoalescedEventCount(Uint32 type);
+
 /**
  *  \brief Polls for currently pending events.
  *
@@ -666,6 +678,25 @@ extern DECLSPEC void SDLCALL SDL_FlushEvents(Uint32 minType, Uint32 maxType);
  */
 extern DECLSPEC int SDLCALL SDL_PollEvent(SDL_Event * event);
 
+/**
+ *  \brief Polls for all currently pending events within a type range.
+ *
+ *  This pumps the event loop once and then removes up to \c numevents
+ *  events within the specified minimum and maximum type from the queue,
+ *  which is much cheaper than calling SDL_PollEvent() for each of them
+ *  when many events arrive in a frame.
+ *
+ *  \return The number of events stored in \c events, or -1 if there was an
+ *          error.
+ *
+ *  \param events An array with room for at least \c numevents events.
+ *  \param numevents The maximum number of events to return.
+ *  \param minType The minimum event type to return, e.g. ::SDL_FIRSTEVENT.
+ *  \param maxType The maximum event type to return, e.g. ::SDL_LASTEVENT.
+ */
+extern DECLSPEC int SDLCALL SDL_PollEvents(SDL_Event * events, int numevents,
+                                           Uint32 minType, Uint32 maxType);
+
 /**
  *  \brief Waits indefinitely for the next available event.
  *
@@ -1157,6 +1157,92 @@ extern "C" {
  */
 #define SDL_HINT_AUDIO_CATEGORY   "SDL_AUDIO_CATEGORY"
 
+/**
+ *  \brief  A variable setting the size of a fixed ring buffer for queued audio.
+ *
+ *  By default, SDL_QueueAudio() and SDL_DequeueAudio() use a queue that grows
+ *  as needed and is protected by the device lock. If this is set to a number
+ *  of bytes, devices opened without a callback use a ring buffer of at least
+ *  that size instead (rounded up to a power of two, and to two callbacks'
+ *  worth of audio). The ring never allocates and the app thread and the
+ *  audio thread don't lock each other out, but it must only be fed from one
+ *  thread, and SDL_QueueAudio() fails if the data doesn't fit.
+ *
+ *  SDL_GetQueuedAudioXruns() counts how often queued playback ran dry, or
+ *  queued capture had to drop audio because the ring was full.
+ *
+ *  This hint is checked when the audio device is opened.
+ */
+#define SDL_HINT_AUDIO_QUEUE_RING_SIZE   "SDL_AUDIO_QUEUE_RING_SIZE"
+
+/**
+ *  \brief  A variable controlling how fast the "disk" and "dummy" audio drivers run.
+ *
+ *  These drivers don't have real hardware to keep time, so they wait as long
+ *  as each buffer would take to play. This variable is a multiple of real
+ *  time to run them at instead, for rendering audio offline or in tests.
+ *
+ *  This variable can be set to the following values:
+ *    "1"     - Run in real time (default)
+ *    "4"     - Run four times faster than real time, any positive number works
+ *    "0"     - Don't wait at all, run the audio callback as fast as it can go
+ *
+ *  The disk driver's SDL_DISKAUDIODELAY environment variable overrides this.
+ *
+ *  This hint is checked when the audio device is opened.
+ */
+#define SDL_HINT_AUDIO_SIMULATED_SPEED   "SDL_AUDIO_SIMULATED_SPEED"
+
+/**
+ *  \brief  A variable controlling how many threads SDL_ConvertAudio() uses.
+ *
+ *  Converting large buffers, like a sample library at load time, can be
+ *  split up between worker threads. Small buffers are always converted on
+ *  the calling thread, since they aren't worth waking threads for.
+ *
+ *  This variable can be set to the following values:
+ *    "1"     - Convert on the calling thread only (default)
+ *    "4"     - Use up to four threads for large buffers, up to 16 works
+ *    "0"     - Use a thread for each CPU core
+ *
+ *  This hint is checked each time a large buffer is converted.
+ */
+#define SDL_HINT_AUDIO_CONVERT_THREADS   "SDL_AUDIO_CONVERT_THREADS"
+
+/**
+ *  \brief  A variable controlling how many threads software surface blits use.
+ *
+ *  Large blits, like converting or compositing full screen surfaces with
+ *  SDL_BlitSurface() or SDL_ConvertSurface(), can be split into bands of
+ *  rows that run on a pool of worker threads. Blits of less than 512x512
+ *  pixels and scaled blits always run on the calling thread.
+ *
+ *  This variable can be set to the following values:
+ *    "1"     - Blit on the calling thread only (default)
+ *    "4"     - Use up to four threads for large blits, up to 16 works
+ *    "0"     - Use a thread for each CPU core
+ *
+ *  This hint is checked each time a large surface is blitted.
+ */
+#define SDL_HINT_BLIT_THREADS   "SDL_BLIT_THREADS"
+
+/**
+ *  \brief  A variable controlling whether audio streams dither integer output.
+ *
+ *  SDL_AudioStream keeps audio in float until the very end when it has to
+ *  convert it anyway, and then adds a little triangular noise before
+ *  rounding to 8 or 16 bits, so quiet sounds fade into hiss instead of
+ *  distortion. This also applies to audio devices that need a conversion.
+ *  Samples that are exactly zero are never dithered, so silence stays silent.
+ *
+ *  This variable can be set to the following values:
+ *    "0"     - Round to the nearest value, without dither (default)
+ *    "1"     - Dither 8 and 16-bit output
+ *
+ *  This hint is checked when the audio stream is created.
+ */
+#define SDL_HINT_AUDIO_DITHER   "SDL_AUDIO_DITHER"
+
 /**
  *  \brief  A variable controlling whether the 2D render API is compatible or efficient.
  *
@@ -1178,9 +1264,28 @@ extern "C" {
  *  if you do, you will call SDL_RenderFlush() before you do so any current
  *  batch goes to the GPU before your work begins. Not following this contract
  *  will result in undefined behavior.
+ *
+ *  Renderers created with SDL_CreateSoftwareRenderer() only batch if this
+ *  is set to "1", since the app owns the target surface.
  */
 #define SDL_HINT_RENDER_BATCHING  "SDL_RENDER_BATCHING"
 
+/**
+ *  \brief  A variable controlling how many threads the software renderer uses to draw.
+ *
+ *  This variable can be set to the following values:
+ *
+ *    "0"     - Draw everything on the calling thread (default).
+ *    "N"     - Split the render target into N horizontal tiles and draw them in parallel.
+ *
+ *  When enabled, each flushed command queue is replayed once per tile with
+ *  the tile as an extra clip rectangle, so draws still land in submission
+ *  order for every pixel. Commands that can't be split exactly (lines,
+ *  scaled or rotated copies) are run on the calling thread between parallel
+ *  runs. The value is checked when the software renderer is created.
+ */
+#define SDL_HINT_RENDER_SOFTWARE_THREADS  "SDL_RENDER_SOFTWARE_THREADS"
+
 
 /**
  *  \brief  A variable controlling whether SDL logs all events pushed onto its internal queue.
@@ -1203,6 +1308,25 @@ extern "C" {
  */
 #define SDL_HINT_EVENT_LOGGING   "SDL_EVENT_LOGGING"
 
+/**
+ *  \brief  A variable controlling whether mouse and finger motion events are coalesced in the event queue.
+ *
+ *  This variable can be set to the following values:
+ *    "0"     - Every motion event is queued separately (default)
+ *    "1"     - A motion event is merged into the last queued event if that is
+ *              motion for the same window and mouse (with the same button
+ *              state) or finger. The merged event has the latest position and
+ *              the sum of the relative motion.
+ *
+ *  This keeps high rate mice and touchscreens from filling the event queue
+ *  when the app only needs the latest position each frame. Event filters and
+ *  watchers still see every event. SDL_GetCoalescedEventCount() reports how
+ *  many events were merged.
+ *
+ *  This hint can be toggled on and off at runtime.
+ */
+#define SDL_HINT_EVENT_COALESCE_MOTION   "SDL_EVENT_COALESCE_MOTION"
+
 
 
 /**
@@ -125,6 +125,17 @@ typedef enum
     SDL_FLIP_VERTICAL = 0x00000002     /**< flip vertically */
 } SDL_RendererFlip;
 
+/**
+ *  \brief A sprite drawn by SDL_RenderCopySprites()
+ */
+typedef struct SDL_RenderSprite
+{
+    SDL_Rect srcrect;       /**< The area of the texture to draw */
+    SDL_FRect dstrect;      /**< Where to draw it, before rotation */
+    SDL_Color color;        /**< Multiplied with the texture color and alpha modulation */
+    double angle;           /**< Degrees of clockwise rotation around the center of dstrect */
+} SDL_RenderSprite;
+
 /**
  *  \brief A structure representing rendering state
  */
@@ -137,6 +148,12 @@ typedef struct SDL_Renderer SDL_Renderer;
 struct SDL_Texture;
 typedef struct SDL_Texture SDL_Texture;
 
+/**
+ *  \brief A set of texture pages that small surfaces are packed into
+ */
+struct SDL_TextureAtlas;
+typedef struct SDL_TextureAtlas SDL_TextureAtlas;
+
 
 /* Function prototypes */
 
@@ -269,6 +286,64 @@ extern DECLSPEC SDL_Texture * SDLCALL SDL_CreateTexture(SDL_Renderer * renderer,
  */
 extern DECLSPEC SDL_Texture * SDLCALL SDL_CreateTextureFromSurface(SDL_Renderer * renderer, SDL_Surface * surface);
 
+/**
+ *  \brief Create an atlas for packing many small surfaces into a few textures.
+ *
+ *  Textures added to an atlas share the backend texture of their page, so
+ *  drawing several of them in a row doesn't break up the render batch.
+ *
+ *  \param renderer The renderer.
+ *  \param page_width The width of each page, or 0 for a default.
+ *  \param page_height The height of each page, or 0 for a default.
+ *
+ *  \return The created atlas, or NULL on error.
+ *
+ *  \sa SDL_AtlasAddSurface()
+ *  \sa SDL_DestroyTextureAtlas()
+ */
+extern DECLSPEC SDL_TextureAtlas * SDLCALL SDL_CreateTextureAtlas(SDL_Renderer * renderer, int page_width, int page_height);
+
+/**
+ *  \brief Pack a surface into an atlas and get a texture for it.
+ *
+ *  The returned texture can be used with SDL_RenderCopy() and friends, and
+ *  has its own color, alpha and blend mode. It can be updated with
+ *  SDL_UpdateTexture(), but can't be locked, used as a render target or
+ *  have its scale mode changed. Destroying it doesn't free its space in
+ *  the atlas, that happens when the atlas is destroyed.
+ *
+ *  \param atlas The atlas.
+ *  \param surface The surface containing pixel data used to fill the texture,
+ *                 it must fit on one page.
+ *
+ *  \return The created texture is returned, or NULL on error.
+ *
+ *  \note The surface is not modified or freed by this function.
+ */
+extern DECLSPEC SDL_Texture * SDLCALL SDL_AtlasAddSurface(SDL_TextureAtlas * atlas, SDL_Surface * surface);
+
+/**
+ *  \brief Get how well an atlas is packed.
+ *
+ *  \param atlas The atlas.
+ *  \param pages A pointer filled in with the number of pages, or NULL.
+ *  \param textures A pointer filled in with the number of textures packed
+ *                  into the atlas and not destroyed yet, or NULL.
+ *  \param efficiency A pointer filled in with the fraction of the page area
+ *                    covered by those textures (0.0 to 1.0), or NULL.
+ *
+ *  \return 0 on success, or -1 on error.
+ */
+extern DECLSPEC int SDLCALL SDL_GetTextureAtlasInfo(SDL_TextureAtlas * atlas, int *pages, int *textures, float *efficiency);
+
+/**
+ *  \brief Destroy an atlas, its pages and all the textures packed into it.
+ *
+ *  Atlases that are still around when their renderer is destroyed are
+ *  destroyed with it.
+ */
+extern DECLSPEC void SDLCALL SDL_DestroyTextureAtlas(SDL_TextureAtlas * atlas);
+
 /**
  *  \brief Query the attributes of a texture
  *
@@ -1037,6 +1112,26 @@ extern DECLSPEC int SDLCALL SDL_RenderCopyExF(SDL_Renderer * renderer,
                                             const SDL_FPoint *center,
                                             const SDL_RendererFlip flip);
 
+/**
+ *  \brief Copy many portions of a texture to the current rendering target in one call.
+ *
+ *  This draws the same as calling SDL_RenderCopyExF() for each sprite, with
+ *  the sprite color multiplied into the texture color and alpha modulation,
+ *  but the whole array is queued at once. Renderers that support it draw
+ *  the sprites as a single command.
+ *
+ *  \param renderer The renderer which should copy parts of a texture.
+ *  \param texture The source texture.
+ *  \param sprites An array of sprites to draw, in order.
+ *  \param count The number of sprites.
+ *
+ *  \return 0 on success, or -1 on error
+ */
+extern DECLSPEC int SDLCALL SDL_RenderCopySprites(SDL_Renderer * renderer,
+                                                  SDL_Texture * texture,
+                                                  const SDL_RenderSprite * sprites,
+                                                  int count);
+
 /**
  *  \brief Read pixels from the current rendering target.
  *
@@ -1103,6 +1198,24 @@ extern DECLSPEC void SDLCALL SDL_DestroyRenderer(SDL_Renderer * renderer);
  */
 extern DECLSPEC int SDLCALL SDL_RenderFlush(SDL_Renderer * renderer);
 
+/**
+ *  \brief Get the number of render commands handled during the last frame.
+ *
+ *  Before queued commands are sent to the backend, state changes that have
+ *  no effect are dropped and adjacent compatible draws (same texture, color
+ *  and blend mode) are merged into one. This reports how well that worked
+ *  for the frame finished by the last call to SDL_RenderPresent().
+ *
+ *  \param renderer The renderer to query.
+ *  \param commands_in A pointer filled in with the number of commands queued, or NULL.
+ *  \param commands_out A pointer filled in with the number of commands sent to the backend, or NULL.
+ *
+ *  \return 0 on success, or -1 if the renderer is invalid.
+ *
+ *  \sa SDL_RenderPresent()
+ */
+extern DECLSPEC int SDLCALL SDL_RenderGetCommandStats(SDL_Renderer * renderer, int *commands_in, int *commands_out);
+
 
 /**
  *  \brief Bind the texture to the current OpenGL/ES/ES2 context for use with
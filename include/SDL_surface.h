@@ -503,13 +503,28 @@ extern DECLSPEC int SDLCALL SDL_LowerBlit
  *  \brief Perform a fast, low quality, stretch blit between two surfaces of the
  *         same pixel format.
  *
- *  \note This function uses a static buffer, and is not thread-safe.
+ *  \note This function uses nearest neighbour sampling.
  */
 extern DECLSPEC int SDLCALL SDL_SoftStretch(SDL_Surface * src,
                                             const SDL_Rect * srcrect,
                                             SDL_Surface * dst,
                                             const SDL_Rect * dstrect);
 
+/**
+ *  \brief Perform a filtered stretch blit between two surfaces of the same
+ *         32-bit pixel format with 8-bit channels.
+ *
+ *  Enlarged pixels are interpolated bilinearly, and shrunk pixels are the
+ *  average of the source pixels they cover, so large reductions don't alias.
+ *  Each direction is filtered separately.
+ *
+ *  \return 0 on success, or -1 if the formats differ or aren't supported.
+ */
+extern DECLSPEC int SDLCALL SDL_SoftStretchLinear(SDL_Surface * src,
+                                                  const SDL_Rect * srcrect,
+                                                  SDL_Surface * dst,
+                                                  const SDL_Rect * dstrect);
+
 #define SDL_BlitScaled SDL_UpperBlitScaled
 
 /**
@@ -94,6 +94,22 @@ extern DECLSPEC SDL_TimerID SDLCALL SDL_AddTimer(Uint32 interval,
                                                  SDL_TimerCallback callback,
                                                  void *param);
 
+/**
+ * \brief Add a new timer with an interval in microseconds.
+ *
+ * This works like SDL_AddTimer(), except that the interval passed to and
+ * returned from the callback is in microseconds instead of milliseconds.
+ *
+ * \note The timer thread polls for the last millisecond before one of these
+ *       timers is due, so short intervals cost CPU time in exchange for
+ *       precision.
+ *
+ * \return A timer ID, or 0 when an error occurs.
+ */
+extern DECLSPEC SDL_TimerID SDLCALL SDL_AddTimerMicroseconds(Uint32 interval,
+                                                             SDL_TimerCallback callback,
+                                                             void *param);
+
 /**
  * \brief Remove a timer knowing its ID.
  *
@@ -558,8 +558,92 @@ SDL_RemoveAudioDevice(const int iscapture, void *handle)
 
 
 
+/* pacing for simulated devices... */
+
+void
+SDL_InitAudioPacer(SDL_AudioPacer *pacer, const SDL_AudioSpec *spec)
+{
+    const char *hint = SDL_GetHint(SDL_HINT_AUDIO_SIMULATED_SPEED);
+    const double speed = hint ? SDL_atof(hint) : 1.0;
+
+    pacer->next = 0;
+    if (speed <= 0.0) {
+        pacer->period = 0;  /* as fast as the app can keep up. */
+    } else {
+        pacer->period = (Uint64) (((double) spec->samples * SDL_GetPerformanceFrequency()) / (spec->freq * speed));
+    }
+}
+
+void
+SDL_WaitAudioPacer(SDL_AudioPacer *pacer)
+{
+    const Uint64 frequency = SDL_GetPerformanceFrequency();
+    Uint64 now;
+
+    if (!pacer->period) {
+        return;
+    }
+
+    /* Buffers are due at fixed intervals from the first one, so sleeping
+       in whole milliseconds doesn't make the device drift. */
+    now = SDL_GetPerformanceCounter();
+    if (!pacer->next || (now > pacer->next + pacer->period)) {
+        pacer->next = now;  /* first buffer, or we fell behind; start over. */
+    }
+    pacer->next += pacer->period;
+
+    while (now < pacer->next) {
+        const Uint32 ms = (Uint32) (((pacer->next - now) * 1000) / frequency);
+        SDL_Delay(ms ? ms : 1);
+        now = SDL_GetPerformanceCounter();
+    }
+}
+
+
 /* buffer queueing support... */
 
+/* The ring is single producer, single consumer: for playback the app writes
+   and the audio thread reads, for capture it's the other way around. Each
+   side only stores its own end, after copying, so the other side never sees
+   a half written or half read span. */
+static Uint32
+SDL_CountAudioRing(SDL_AudioDevice *device)
+{
+    return (Uint32) SDL_AtomicGet(&device->ring_head) - (Uint32) SDL_AtomicGet(&device->ring_tail);
+}
+
+static Uint32
+SDL_WriteToAudioRing(SDL_AudioDevice *device, const Uint8 *data, Uint32 len)
+{
+    const Uint32 head = (Uint32) SDL_AtomicGet(&device->ring_head);
+    const Uint32 tail = (Uint32) SDL_AtomicGet(&device->ring_tail);
+    const Uint32 offset = head & (device->ring_size - 1);
+    Uint32 first;
+
+    len = SDL_min(len, device->ring_size - (head - tail));
+    first = SDL_min(len, device->ring_size - offset);
+    SDL_memcpy(device->ring + offset, data, first);
+    SDL_memcpy(device->ring, data + first, len - first);
+    SDL_AtomicSet(&device->ring_head, (int) (head + len));
+    return len;
+}
+
+static Uint32
+SDL_ReadFromAudioRing(SDL_AudioDevice *device, Uint8 *data, Uint32 len)
+{
+    const Uint32 head = (Uint32) SDL_AtomicGet(&device->ring_head);
+    const Uint32 tail = (Uint32) SDL_AtomicGet(&device->ring_tail);
+    const Uint32 offset = tail & (device->ring_size - 1);
+    Uint32 first;
+
+    len = SDL_min(len, head - tail);
+    first = SDL_min(len, device->ring_size - offset);
+    SDL_memcpy(data, device->ring + offset, first);
+    SDL_memcpy(data + first, device->ring, len - first);
+    SDL_AtomicSet(&device->ring_tail, (int) (tail + len));
+    return len;
+}
+
 static void SDLCALL
 SDL_BufferQueueDrainCallback(void *userdata, Uint8 *stream, int len)
 {
@@ -571,13 +655,25 @@ SDL_BufferQueueDrainCallback(void *userdata, Uint8 *stream, int len)
     SDL_assert(!device->iscapture);  /* this shouldn't ever happen, right?! */
     SDL_assert(len >= 0);  /* this shouldn't ever happen, right?! */
 
-    dequeued = SDL_ReadFromDataQueue(device->buffer_queue, stream, len);
+    if (device->ring) {
+        dequeued = SDL_ReadFromAudioRing(device, stream, (Uint32) len);
+    } else {
+        dequeued = SDL_ReadFromDataQueue(device->buffer_queue, stream, len);
+    }
     stream += dequeued;
     len -= (int) dequeued;
 
     if (len > 0) {  /* fill any remaining space in the stream with silence. */
-        SDL_assert(SDL_CountDataQueue(device->buffer_queue) == 0);
+        SDL_assert(device->ring || SDL_CountDataQueue(device->buffer_queue) == 0);
         SDL_memset(stream, device->spec.silence, len);
+
+        /* count running dry once, not every callback while nothing is queued */
+        if (!device->starved) {
+            SDL_AtomicIncRef(&device->xruns);
+            device->starved = SDL_TRUE;
+        }
+    } else {
+        device->starved = SDL_FALSE;
     }
 }
 
@@ -591,10 +687,20 @@ SDL_BufferQueueFillCallback(void *userdata, Uint8 *stream, int len)
     SDL_assert(device->iscapture);  /* this shouldn't ever happen, right?! */
     SDL_assert(len >= 0);  /* this shouldn't ever happen, right?! */
 
+    if (device->ring) {
+        /* the app isn't keeping up, drop what doesn't fit. */
+        if (SDL_WriteToAudioRing(device, stream, (Uint32) len) < (Uint32) len) {
+            SDL_AtomicIncRef(&device->xruns);
+        }
+        return;
+    }
+
     /* note that if this needs to allocate more space and run out of memory,
        we have no choice but to quietly drop the data and hope it works out
        later, but you probably have bigger problems in this case anyhow. */
-    SDL_WriteToDataQueue(device->buffer_queue, stream, len);
+    if (SDL_WriteToDataQueue(device->buffer_queue, stream, len) < 0) {
+        SDL_AtomicIncRef(&device->xruns);
+    }
 }
 
 int
@@ -612,6 +718,14 @@ SDL_QueueAudio(SDL_AudioDeviceID devid, const void *data, Uint32 len)
     }
 
     if (len > 0) {
+        if (device->ring) {
+            /* No lock: the audio thread only ever moves the other end. */
+            if (len > device->ring_size - SDL_CountAudioRing(device)) {
+                return SDL_SetError("Audio queue is full");
+            }
+            SDL_WriteToAudioRing(device, (const Uint8 *) data, len);
+            return 0;
+        }
         current_audio.impl.LockDevice(device);
         rc = SDL_WriteToDataQueue(device->buffer_queue, data, len);
         current_audio.impl.UnlockDevice(device);
@@ -633,6 +747,10 @@ SDL_DequeueAudio(SDL_AudioDeviceID devid, void *data, Uint32 len)
         return 0;  /* just report zero bytes dequeued. */
     }
 
+    if (device->ring) {
+        return SDL_ReadFromAudioRing(device, (Uint8 *) data, len);
+    }
+
     current_audio.impl.LockDevice(device);
     rc = (Uint32) SDL_ReadFromDataQueue(device->buffer_queue, data, len);
     current_audio.impl.UnlockDevice(device);
@@ -653,6 +771,9 @@ SDL_GetQueuedAudioSize(SDL_AudioDeviceID devid)
     if (device->callbackspec.callback == SDL_BufferQueueDrainCallback ||
         device->callbackspec.callback == SDL_BufferQueueFillCallback)
     {
+        if (device->ring) {
+            return SDL_CountAudioRing(device);
+        }
         current_audio.impl.LockDevice(device);
         retval = (Uint32) SDL_CountDataQueue(device->buffer_queue);
         current_audio.impl.UnlockDevice(device);
@@ -673,12 +794,195 @@ SDL_ClearQueuedAudio(SDL_AudioDeviceID devid)
     /* Blank out the device and release the mutex. Free it afterwards. */
     current_audio.impl.LockDevice(device);
 
-    /* Keep up to two packets in the pool to reduce future malloc pressure. */
-    SDL_ClearDataQueue(device->buffer_queue, SDL_AUDIOBUFFERQUEUE_PACKETLEN * 2);
+    if (device->ring) {
+        /* The callback can't run while we hold the lock, so it's safe to
+           move the reading end here even for playback. */
+        SDL_AtomicSet(&device->ring_tail, SDL_AtomicGet(&device->ring_head));
+    } else {
+        /* Keep up to two packets in the pool to reduce future malloc pressure. */
+        SDL_ClearDataQueue(device->buffer_queue, SDL_AUDIOBUFFERQUEUE_PACKETLEN * 2);
+    }
 
     current_audio.impl.UnlockDevice(device);
 }
 
+Uint32
+SDL_GetQueuedAudioXruns(SDL_AudioDeviceID devid)
+{
+    SDL_AudioDevice *device = get_audio_device(devid);
+
+    if (!device) {
+        return 0;
+    }
+    return (Uint32) SDL_AtomicGet(&device->xruns);
+}
+
+
+/* Audio thread timing statistics. The spinlock is only ever held for a few
+   additions, and only contended while someone reads the statistics. */
+static Uint64
+SDL_AudioPeriodTicks(SDL_AudioDevice *device)
+{
+    return ((Uint64) device->spec.samples * SDL_GetPerformanceFrequency()) / device->spec.freq;
+}
+
+/* Call when the audio thread wakes up for the next period. */
+static void
+SDL_AudioStatsWake(SDL_AudioDevice *device)
+{
+    const Uint64 now = SDL_GetPerformanceCounter();
+    const Uint64 period = SDL_AudioPeriodTicks(device);
+    SDL_AudioDeviceTimes *stats = &device->stats;
+    Uint32 stream_fill = 0;
+
+    if (device->stream) {
+        stream_fill = (Uint32) SDL_AudioStreamAvailable(device->stream);
+    } else if (device->rebuffer) {
+        stream_fill = device->rebuffer_len;
+    }
+
+    SDL_AtomicLock(&device->stats_lock);
+    if (stats->last_wake) {
+        const Uint64 interval = now - stats->last_wake;
+        const Uint64 jitter = (interval > period) ? (interval - period) : (period - interval);
+        stats->jitter_total += jitter;
+        if (jitter > stats->jitter_max) {
+            stats->jitter_max = jitter;
+        }
+        if (interval >= period * 2) {
+            ++stats->late_periods;
+        }
+        ++stats->periods;
+    }
+    stats->last_wake = now;
+    stats->stream_fill = stream_fill;
+    SDL_AtomicUnlock(&device->stats_lock);
+}
+
+/* Call after running the callback for a period, with the time it started. */
+static void
+SDL_AudioStatsCallback(SDL_AudioDevice *device, Uint64 start)
+{
+    const Uint64 elapsed = SDL_GetPerformanceCounter() - start;
+    const Uint64 period = SDL_AudioPeriodTicks(device);
+    SDL_AudioDeviceTimes *stats = &device->stats;
+    Uint64 bucket = period ? ((elapsed * 8) / period) : 0;
+
+    if (bucket >= SDL_AUDIO_STATS_HISTOGRAM_SIZE) {
+        bucket = SDL_AUDIO_STATS_HISTOGRAM_SIZE - 1;
+    }
+
+    SDL_AtomicLock(&device->stats_lock);
+    stats->callback_total += elapsed;
+    if (elapsed > stats->callback_max) {
+        stats->callback_max = elapsed;
+    }
+    ++stats->callback_histogram[bucket];
+    ++stats->callbacks;
+    SDL_AtomicUnlock(&device->stats_lock);
+}
+
+int
+SDL_GetAudioDeviceStats(SDL_AudioDeviceID devid, SDL_AudioDeviceStats *stats)
+{
+    SDL_AudioDevice *device = get_audio_device(devid);
+    SDL_AudioDeviceTimes times;
+    Uint64 frequency;
+    int i;
+
+    if (!device) {
+        return -1;  /* get_audio_device() will have set the error state */
+    } else if (!stats) {
+        return SDL_InvalidParamError("stats");
+    }
+
+    SDL_AtomicLock(&device->stats_lock);
+    times = device->stats;
+    SDL_AtomicUnlock(&device->stats_lock);
+
+    frequency = SDL_GetPerformanceFrequency();
+#define TICKS_TO_US(ticks) ((Uint32) (((ticks) * 1000000) / frequency))
+    SDL_zerop(stats);
+    stats->period_us = TICKS_TO_US(SDL_AudioPeriodTicks(device));
+    stats->periods = times.periods;
+    stats->jitter_avg_us = times.periods ? TICKS_TO_US(times.jitter_total / times.periods) : 0;
+    stats->jitter_max_us = TICKS_TO_US(times.jitter_max);
+    stats->late_periods = times.late_periods;
+    stats->callbacks = times.callbacks;
+    stats->callback_avg_us = times.callbacks ? TICKS_TO_US(times.callback_total / times.callbacks) : 0;
+    stats->callback_max_us = TICKS_TO_US(times.callback_max);
+    for (i = 0; i < SDL_AUDIO_STATS_HISTOGRAM_SIZE; ++i) {
+        stats->callback_histogram[i] = times.callback_histogram[i];
+    }
+    stats->xruns = (Uint32) SDL_AtomicGet(&device->xruns);
+    stats->stream_fill = times.stream_fill;
+#undef TICKS_TO_US
+
+    return 0;
+}
+
+void
+SDL_ResetAudioDeviceStats(SDL_AudioDeviceID devid)
+{
+    SDL_AudioDevice *device = get_audio_device(devid);
+
+    if (!device) {
+        return;
+    }
+
+    SDL_AtomicLock(&device->stats_lock);
+    {
+        /* keep the last wake-up, so the next period is still measured. */
+        const Uint64 last_wake = device->stats.last_wake;
+        SDL_zero(device->stats);
+        device->stats.last_wake = last_wake;
+    }
+    SDL_AtomicUnlock(&device->stats_lock);
+}
+
+/* Fill one device buffer from a callback that uses a different buffer size
+   but the same format. Whole callback buffers are rendered straight into the
+   device buffer. The one that straddles the end is rendered into
+   device->rebuffer, and what's left of it starts the next device buffer. */
+static void
+SDL_FillRebufferedAudio(SDL_AudioDevice *device, Uint8 *data)
+{
+    const Uint32 data_len = device->spec.size;
+    const Uint32 callback_len = device->callbackspec.size;
+    SDL_AudioCallback callback = device->callbackspec.callback;
+    void *udata = device->callbackspec.userdata;
+    Uint64 start;
+    Uint32 filled;
+
+    /* !!! FIXME: this should be LockDevice. */
+    SDL_LockMutex(device->mixer_lock);
+    if (SDL_AtomicGet(&device->paused)) {
+        SDL_memset(data, device->spec.silence, data_len);
+        SDL_UnlockMutex(device->mixer_lock);
+        return;
+    }
+
+    start = SDL_GetPerformanceCounter();
+    filled = SDL_min(device->rebuffer_len, data_len);
+    SDL_memcpy(data, device->rebuffer + device->rebuffer_pos, filled);
+    device->rebuffer_pos += filled;
+    device->rebuffer_len -= filled;
+
+    while (data_len - filled >= callback_len) {
+        callback(udata, data + filled, (int) callback_len);
+        filled += callback_len;
+    }
+
+    if (filled < data_len) {
+        callback(udata, device->rebuffer, (int) callback_len);
+        device->rebuffer_pos = data_len - filled;
+        device->rebuffer_len = callback_len - device->rebuffer_pos;
+        SDL_memcpy(data + filled, device->rebuffer, device->rebuffer_pos);
+    }
+    SDL_UnlockMutex(device->mixer_lock);
+
+    SDL_AudioStatsCallback(device, start);
+}
 
 /* The general mixing thread function */
 static int SDLCALL
@@ -710,6 +1014,23 @@ SDL_RunAudio(void *devicep)
     /* Loop, filling the audio buffers */
     while (!SDL_AtomicGet(&device->shutdown)) {
         current_audio.impl.BeginLoopIteration(device);
+
+        if (device->rebuffer) {
+            data = SDL_AtomicGet(&device->enabled) ? current_audio.impl.GetDeviceBuf(device) : NULL;
+            SDL_FillRebufferedAudio(device, data ? data : device->work_buffer);
+            if (data == NULL) {
+                /* pause like we queued a buffer to play. */
+                const Uint32 delay = ((device->spec.samples * 1000) / device->spec.freq);
+                SDL_Delay(delay);
+                SDL_AudioStatsWake(device);
+            } else {
+                current_audio.impl.PlayDevice(device);
+                current_audio.impl.WaitDevice(device);
+                SDL_AudioStatsWake(device);
+            }
+            continue;
+        }
+
     #ifndef __OHOS__
         data_len = device->callbackspec.size;
     #endif
@@ -740,7 +1061,9 @@ SDL_RunAudio(void *devicep)
         if (SDL_AtomicGet(&device->paused)) {
             SDL_memset(data, device->spec.silence, data_len);
         } else {
+            const Uint64 start = SDL_GetPerformanceCounter();
             callback(udata, data, data_len);
+            SDL_AudioStatsCallback(device, start);
         }
         SDL_UnlockMutex(device->mixer_lock);
 
@@ -758,22 +1081,26 @@ SDL_RunAudio(void *devicep)
                 if (data == NULL) {  /* device is having issues... */
                     const Uint32 delay = ((device->spec.samples * 1000) / device->spec.freq);
                     SDL_Delay(delay);  /* wait for as long as this buffer would have played. Maybe device recovers later? */
+                    SDL_AudioStatsWake(device);
                 } else {
                     if (got != device->spec.size) {
                         SDL_memset(data, device->spec.silence, device->spec.size);
                     }
                     current_audio.impl.PlayDevice(device);
                     current_audio.impl.WaitDevice(device);
+                    SDL_AudioStatsWake(device);
                 }
             }
         } else if (data == device->work_buffer) {
             /* nothing to do; pause like we queued a buffer to play. */
             const Uint32 delay = ((device->spec.samples * 1000) / device->spec.freq);
             SDL_Delay(delay);
+            SDL_AudioStatsWake(device);
         } else {  /* writing directly to the device. */
             /* queue this buffer and wait for it to finish playing. */
             current_audio.impl.PlayDevice(device);
             current_audio.impl.WaitDevice(device);
+            SDL_AudioStatsWake(device);
         }
     }
 
@@ -866,6 +1193,7 @@ SDL_CaptureAudio(void *devicep)
             /* Keep any data we already read, silence the rest. */
             SDL_memset(ptr, silence, still_need);
         }
+        SDL_AudioStatsWake(device);
 
         if (device->stream) {
             /* if this fails...oh well. */
@@ -881,7 +1209,9 @@ SDL_CaptureAudio(void *devicep)
                 /* !!! FIXME: this should be LockDevice. */
                 SDL_LockMutex(device->mixer_lock);
                 if (!SDL_AtomicGet(&device->paused)) {
+                    const Uint64 start = SDL_GetPerformanceCounter();
                     callback(udata, device->work_buffer, device->callbackspec.size);
+                    SDL_AudioStatsCallback(device, start);
                 }
                 SDL_UnlockMutex(device->mixer_lock);
             }
@@ -889,7 +1219,9 @@ SDL_CaptureAudio(void *devicep)
             /* !!! FIXME: this should be LockDevice. */
             SDL_LockMutex(device->mixer_lock);
             if (!SDL_AtomicGet(&device->paused)) {
+                const Uint64 start = SDL_GetPerformanceCounter();
                 callback(udata, data, device->callbackspec.size);
+                SDL_AudioStatsCallback(device, start);
             }
             SDL_UnlockMutex(device->mixer_lock);
         }
@@ -1143,6 +1475,8 @@ close_audio_device(SDL_AudioDevice * device)
     }
 
     SDL_free(device->work_buffer);
+    SDL_free(device->ring);
+    SDL_free(device->rebuffer);
     SDL_FreeAudioStream(device->stream);
 
     if (device->id > 0) {
@@ -1404,6 +1738,22 @@ open_audio_device(const char *devname, int iscapture,
 
     device->callbackspec = *obtained;
 
+#ifndef __OHOS__  /* the OHOS backend resizes both buffers in GetDeviceBuf */
+    if (build_stream && !iscapture &&
+        obtained->freq == device->spec.freq &&
+        obtained->format == device->spec.format &&
+        obtained->channels == device->spec.channels) {
+        /* Only the buffer size differs, so there's nothing to convert. The
+           callback renders straight into the device buffer, and only the
+           piece that doesn't fit goes through this buffer. */
+        device->rebuffer = (Uint8 *) SDL_malloc(obtained->size);
+        if (!device->rebuffer) {
+            close_audio_device(device);
+            SDL_OutOfMemory();
+            return 0;
+        }
+    } else
+#endif
     if (build_stream) {
         if (iscapture) {
             device->stream = SDL_NewAudioStream(device->spec.format,
@@ -1422,12 +1772,29 @@ open_audio_device(const char *devname, int iscapture,
     }
 
     if (device->spec.callback == NULL) {  /* use buffer queueing? */
-        /* pool a few packets to start. Enough for two callbacks. */
-        device->buffer_queue = SDL_NewDataQueue(SDL_AUDIOBUFFERQUEUE_PACKETLEN, obtained->size * 2);
-        if (!device->buffer_queue) {
-            close_audio_device(device);
-            SDL_SetError("Couldn't create audio buffer queue");
-            return 0;
+        const char *hint = SDL_GetHint(SDL_HINT_AUDIO_QUEUE_RING_SIZE);
+        const int ringsize = hint ? SDL_atoi(hint) : 0;
+        if (ringsize > 0) {
+            /* at least two callbacks' worth, rounded up to a power of two. */
+            Uint32 size = 1;
+            while ((size < (Uint32) ringsize || size < obtained->size * 2) && size < (1u << 30)) {
+                size <<= 1;
+            }
+            device->ring = (Uint8 *) SDL_malloc(size);
+            if (!device->ring) {
+                close_audio_device(device);
+                SDL_OutOfMemory();
+                return 0;
+            }
+            device->ring_size = size;
+        } else {
+            /* pool a few packets to start. Enough for two callbacks. */
+            device->buffer_queue = SDL_NewDataQueue(SDL_AUDIOBUFFERQUEUE_PACKETLEN, obtained->size * 2);
+            if (!device->buffer_queue) {
+                close_audio_device(device);
+                SDL_SetError("Couldn't create audio buffer queue");
+                return 0;
+            }
         }
         device->callbackspec.callback = iscapture ? SDL_BufferQueueFillCallback : SDL_BufferQueueDrainCallback;
         device->callbackspec.userdata = device;
@@ -55,6 +55,17 @@ extern SDL_AudioFormat SDL_NextAudioFormat(void);
 extern Uint8 SDL_SilenceValueForFormat(const SDL_AudioFormat format);
 extern void SDL_CalculateAudioSpec(SDL_AudioSpec * spec);
 
+/* Paces drivers that only pretend to play or capture in real time, like the
+   disk and dummy drivers, honoring SDL_HINT_AUDIO_SIMULATED_SPEED. */
+typedef struct SDL_AudioPacer
+{
+    Uint64 period;  /* performance counter ticks per buffer, 0 to never wait */
+    Uint64 next;    /* when the next buffer is due */
+} SDL_AudioPacer;
+
+extern void SDL_InitAudioPacer(SDL_AudioPacer *pacer, const SDL_AudioSpec *spec);
+extern void SDL_WaitAudioPacer(SDL_AudioPacer *pacer);
+
 /* Choose the audio filter functions below */
 extern void SDL_ChooseAudioConverters(void);
 
@@ -70,6 +81,23 @@ extern SDL_AudioFilter SDL_Convert_F32_to_S16;
 extern SDL_AudioFilter SDL_Convert_F32_to_U16;
 extern SDL_AudioFilter SDL_Convert_F32_to_S32;
 
+/* Final conversion out of native float, with dithering, clamping, the
+   integer conversion and any byteswap all done in one pass. */
+typedef struct SDL_AudioDither SDL_AudioDither;
+typedef void (*SDL_AudioDitherFunc)(SDL_AudioDither *dither, const float *src, void *dst, int samples);
+
+struct SDL_AudioDither
+{
+    SDL_AudioFormat format;
+    float amplitude;  /* noise in LSBs of the output format, 0 for none. */
+    Uint32 state[8];  /* two random number generators per SIMD lane. */
+    SDL_AudioDitherFunc func;
+};
+
+/* (dst) may be the same as (src); returns the number of bytes written. */
+extern void SDL_InitAudioDither(SDL_AudioDither *dither, SDL_AudioFormat format, SDL_bool enabled);
+extern int SDL_DitherAudio(SDL_AudioDither *dither, const float *src, void *dst, int samples);
+
 /* You need to call SDL_PrepareResampleFilter() before using the internal resampler.
    SDL_AudioQuit() calls SDL_FreeResamplerFilter(), you should never call it yourself. */
 extern int SDL_PrepareResampleFilter(void);
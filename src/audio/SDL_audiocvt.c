@@ -32,6 +32,7 @@
 #include "SDL_loadso.h"
 #include "SDL_assert.h"
 #include "../SDL_dataqueue.h"
+#include "../thread/SDL_systhread.h"
 #include "SDL_cpuinfo.h"
 
 #define DEBUG_AUDIOSTREAM 0
@@ -40,6 +41,18 @@
 #define HAVE_SSE3_INTRINSICS 1
 #endif
 
+#ifdef __SSE2__
+#define HAVE_SSE2_INTRINSICS 1
+#endif
+
+#if defined(__AVX2__) && defined(HAVE_IMMINTRIN_H)
+#define HAVE_AVX2_INTRINSICS 1
+#endif
+
+#ifdef __ARM_NEON
+#define HAVE_NEON_INTRINSICS 1
+#endif
+
 #if HAVE_SSE3_INTRINSICS
 /* Convert from stereo to mono. Average left and right. */
 static void SDLCALL
@@ -382,6 +395,17 @@ SDL_Convert51To71(SDL_AudioCVT * cvt, SDL_AudioFormat format)
 #define RESAMPLER_SAMPLES_PER_ZERO_CROSSING  (1 << ((RESAMPLER_BITS_PER_SAMPLE / 2) + 1))
 #define RESAMPLER_FILTER_SIZE ((RESAMPLER_SAMPLES_PER_ZERO_CROSSING * RESAMPLER_ZERO_CROSSINGS) + 1)
 
+/* Each output frame is made from the input frame at or before it, the five
+   before that (the left wing) and the six after it (the right wing). */
+#define RESAMPLER_LEFT_TAPS (RESAMPLER_ZERO_CROSSINGS + 1)
+#define RESAMPLER_TAPS (RESAMPLER_LEFT_TAPS * 2)
+#define RESAMPLER_MAX_CHANNELS 8
+
+/* The filter is sampled once per output phase into a bank of coefficients,
+   as long as the rates have a small enough common divisor. */
+#define RESAMPLER_MAX_PHASES 1024
+#define RESAMPLER_MAX_BANKS 16
+
 /* This is a "modified" bessel function, so you can't use POSIX j0() */
 static double
 bessel(const double x)
@@ -420,16 +444,398 @@ kaiser_and_sinc(float *table, float *diffs, const int tablelen, const double bet
 
     for (i = 1; i < tablelen; i++) {
         const float x = (((float) i) / ((float) RESAMPLER_SAMPLES_PER_ZERO_CROSSING)) * ((float) M_PI);
-        table[i] *= SDL_sinf(x) / x;
+        if ((i % RESAMPLER_SAMPLES_PER_ZERO_CROSSING) == 0) {
+            table[i] = 0.0f;  /* exactly, so input frames that line up with the output pass straight through */
+        } else {
+            table[i] *= SDL_sinf(x) / x;
+        }
         diffs[i - 1] = table[i] - table[i - 1];
     }
     diffs[lenm1] = 0.0f;
 }
 
+typedef struct SDL_ResamplerBank
+{
+    int phases;
+    float *coefficients;  /* phases * RESAMPLER_TAPS */
+    struct SDL_ResamplerBank *next;
+} SDL_ResamplerBank;
+
+/* Resample frames, starting with the output frame at (phase / phases) of the
+   way between the input frame at src[(RESAMPLER_LEFT_TAPS - 1) * chans] and the
+   one after it. The phase advances by step for each output frame. */
+typedef void (*SDL_ResamplerFunc)(const int chans, const float *bank, const int phases, const int step, int phase,
+                                  const float *src, float *dst, const int dststride, int frames);
 
 static SDL_SpinLock ResampleFilterSpinlock = 0;
 static float *ResamplerFilter = NULL;
 static float *ResamplerFilterDifference = NULL;
+static SDL_ResamplerBank *ResamplerBanks = NULL;
+static int ResamplerNumBanks = 0;
+static SDL_ResamplerFunc ResamplerFrames = NULL;
+
+static void
+ResamplerCoefficients(const int phase, const int phases, float *coefficients)
+{
+    const double interpolation1 = ((double) phase) / ((double) phases);
+    const double interpolation2 = 1.0 - interpolation1;
+    const double position1 = interpolation1 * RESAMPLER_SAMPLES_PER_ZERO_CROSSING;
+    const double position2 = interpolation2 * RESAMPLER_SAMPLES_PER_ZERO_CROSSING;
+    const int filterindex1 = (int) position1;
+    const int filterindex2 = (int) position2;
+    const double fraction1 = position1 - filterindex1;
+    const double fraction2 = position2 - filterindex2;
+    int j;
+
+    /* the left wing goes back in time from the input frame at or before the output time... */
+    for (j = 0; j < RESAMPLER_LEFT_TAPS; j++) {
+        const int index = filterindex1 + (j * RESAMPLER_SAMPLES_PER_ZERO_CROSSING);
+        coefficients[RESAMPLER_LEFT_TAPS - 1 - j] = (index < RESAMPLER_FILTER_SIZE) ?
+            (float) (ResamplerFilter[index] + (fraction1 * ResamplerFilterDifference[index])) : 0.0f;
+    }
+
+    /* ...and the right wing goes forward from the one after it. */
+    for (j = 0; j < RESAMPLER_TAPS - RESAMPLER_LEFT_TAPS; j++) {
+        const int index = filterindex2 + (j * RESAMPLER_SAMPLES_PER_ZERO_CROSSING);
+        coefficients[RESAMPLER_LEFT_TAPS + j] = (index < RESAMPLER_FILTER_SIZE) ?
+            (float) (ResamplerFilter[index] + (fraction2 * ResamplerFilterDifference[index])) : 0.0f;
+    }
+}
+
+static void
+SDL_ResampleFrames_Scalar(const int chans, const float *bank, const int phases, const int step, int phase,
+                          const float *src, float *dst, const int dststride, int frames)
+{
+    int chan, i;
+
+    while (frames--) {
+        const float *coefficients = bank + (phase * RESAMPLER_TAPS);
+
+        for (chan = 0; chan < chans; chan++) {
+            const float *sample = src + chan;
+            float outsample = 0.0f;
+            for (i = 0; i < RESAMPLER_TAPS; i++, sample += chans) {
+                outsample += coefficients[i] * *sample;
+            }
+            dst[chan] = outsample;
+        }
+        dst += dststride;
+
+        phase += step;
+        while (phase >= phases) {
+            phase -= phases;
+            src += chans;
+        }
+    }
+}
+
+#if HAVE_SSE2_INTRINSICS
+static void
+SDL_ResampleFrames_SSE2(const int chans, const float *bank, const int phases, const int step, int phase,
+                        const float *src, float *dst, const int dststride, int frames)
+{
+    int i;
+
+    switch (chans) {
+    case 1:
+        while (frames--) {
+            const float *coefficients = bank + (phase * RESAMPLER_TAPS);
+            __m128 sum = _mm_mul_ps(_mm_loadu_ps(coefficients), _mm_loadu_ps(src));
+            sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(coefficients + 4), _mm_loadu_ps(src + 4)));
+            sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(coefficients + 8), _mm_loadu_ps(src + 8)));
+            sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+            sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, _MM_SHUFFLE(1, 1, 1, 1)));
+            _mm_store_ss(dst, sum);
+            dst += dststride;
+
+            phase += step;
+            while (phase >= phases) {
+                phase -= phases;
+                src += 1;
+            }
+        }
+        break;
+
+    case 2:
+        while (frames--) {
+            const float *coefficients = bank + (phase * RESAMPLER_TAPS);
+            __m128 sum = _mm_setzero_ps();
+            for (i = 0; i < RESAMPLER_TAPS; i += 4) {
+                /* each coefficient applies to both channels of a frame */
+                const __m128 c = _mm_loadu_ps(coefficients + i);
+                sum = _mm_add_ps(sum, _mm_mul_ps(_mm_unpacklo_ps(c, c), _mm_loadu_ps(src + (i * 2))));
+                sum = _mm_add_ps(sum, _mm_mul_ps(_mm_unpackhi_ps(c, c), _mm_loadu_ps(src + (i * 2) + 4)));
+            }
+            sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+            _mm_storel_pi((__m64 *) dst, sum);
+            dst += dststride;
+
+            phase += step;
+            while (phase >= phases) {
+                phase -= phases;
+                src += 2;
+            }
+        }
+        break;
+
+    case 4:
+        while (frames--) {
+            const float *coefficients = bank + (phase * RESAMPLER_TAPS);
+            __m128 sum = _mm_setzero_ps();
+            for (i = 0; i < RESAMPLER_TAPS; i++) {
+                sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(coefficients[i]), _mm_loadu_ps(src + (i * 4))));
+            }
+            _mm_storeu_ps(dst, sum);
+            dst += dststride;
+
+            phase += step;
+            while (phase >= phases) {
+                phase -= phases;
+                src += 4;
+            }
+        }
+        break;
+
+    case 6:
+        while (frames--) {
+            const float *coefficients = bank + (phase * RESAMPLER_TAPS);
+            __m128 sum1 = _mm_setzero_ps();
+            __m128 sum2 = _mm_setzero_ps();
+            for (i = 0; i < RESAMPLER_TAPS; i++) {
+                const __m128 c = _mm_set1_ps(coefficients[i]);
+                sum1 = _mm_add_ps(sum1, _mm_mul_ps(c, _mm_loadu_ps(src + (i * 6))));
+                sum2 = _mm_add_ps(sum2, _mm_mul_ps(c, _mm_loadl_pi(_mm_setzero_ps(), (const __m64 *) (src + (i * 6) + 4))));
+            }
+            _mm_storeu_ps(dst, sum1);
+            _mm_storel_pi((__m64 *) (dst + 4), sum2);
+            dst += dststride;
+
+            phase += step;
+            while (phase >= phases) {
+                phase -= phases;
+                src += 6;
+            }
+        }
+        break;
+
+    case 8:
+        while (frames--) {
+            const float *coefficients = bank + (phase * RESAMPLER_TAPS);
+            __m128 sum1 = _mm_setzero_ps();
+            __m128 sum2 = _mm_setzero_ps();
+            for (i = 0; i < RESAMPLER_TAPS; i++) {
+                const __m128 c = _mm_set1_ps(coefficients[i]);
+                sum1 = _mm_add_ps(sum1, _mm_mul_ps(c, _mm_loadu_ps(src + (i * 8))));
+                sum2 = _mm_add_ps(sum2, _mm_mul_ps(c, _mm_loadu_ps(src + (i * 8) + 4)));
+            }
+            _mm_storeu_ps(dst, sum1);
+            _mm_storeu_ps(dst + 4, sum2);
+            dst += dststride;
+
+            phase += step;
+            while (phase >= phases) {
+                phase -= phases;
+                src += 8;
+            }
+        }
+        break;
+
+    default:
+        SDL_ResampleFrames_Scalar(chans, bank, phases, step, phase, src, dst, dststride, frames);
+        break;
+    }
+}
+#endif
+
+#if HAVE_AVX2_INTRINSICS
+static void
+SDL_ResampleFrames_AVX2(const int chans, const float *bank, const int phases, const int step, int phase,
+                        const float *src, float *dst, const int dststride, int frames)
+{
+    int i;
+
+    switch (chans) {
+    case 1:
+        while (frames--) {
+            const float *coefficients = bank + (phase * RESAMPLER_TAPS);
+            const __m256 sum8 = _mm256_mul_ps(_mm256_loadu_ps(coefficients), _mm256_loadu_ps(src));
+            __m128 sum = _mm_mul_ps(_mm_loadu_ps(coefficients + 8), _mm_loadu_ps(src + 8));
+            sum = _mm_add_ps(sum, _mm_add_ps(_mm256_castps256_ps128(sum8), _mm256_extractf128_ps(sum8, 1)));
+            sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+            sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, _MM_SHUFFLE(1, 1, 1, 1)));
+            _mm_store_ss(dst, sum);
+            dst += dststride;
+
+            phase += step;
+            while (phase >= phases) {
+                phase -= phases;
+                src += 1;
+            }
+        }
+        break;
+
+    case 2:
+        while (frames--) {
+            const float *coefficients = bank + (phase * RESAMPLER_TAPS);
+            __m256 sum8 = _mm256_setzero_ps();
+            __m128 sum;
+            for (i = 0; i < RESAMPLER_TAPS; i += 4) {
+                /* each coefficient applies to both channels of a frame */
+                const __m128 c = _mm_loadu_ps(coefficients + i);
+                const __m256 c2 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_unpacklo_ps(c, c)), _mm_unpackhi_ps(c, c), 1);
+                sum8 = _mm256_add_ps(sum8, _mm256_mul_ps(c2, _mm256_loadu_ps(src + (i * 2))));
+            }
+            sum = _mm_add_ps(_mm256_castps256_ps128(sum8), _mm256_extractf128_ps(sum8, 1));
+            sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+            _mm_storel_pi((__m64 *) dst, sum);
+            dst += dststride;
+
+            phase += step;
+            while (phase >= phases) {
+                phase -= phases;
+                src += 2;
+            }
+        }
+        break;
+
+    case 4:
+        while (frames--) {
+            const float *coefficients = bank + (phase * RESAMPLER_TAPS);
+            __m256 sum8 = _mm256_setzero_ps();
+            for (i = 0; i < RESAMPLER_TAPS; i += 2) {
+                const __m256 c2 = _mm256_insertf128_ps(_mm256_set1_ps(coefficients[i]), _mm_set1_ps(coefficients[i + 1]), 1);
+                sum8 = _mm256_add_ps(sum8, _mm256_mul_ps(c2, _mm256_loadu_ps(src + (i * 4))));
+            }
+            _mm_storeu_ps(dst, _mm_add_ps(_mm256_castps256_ps128(sum8), _mm256_extractf128_ps(sum8, 1)));
+            dst += dststride;
+
+            phase += step;
+            while (phase >= phases) {
+                phase -= phases;
+                src += 4;
+            }
+        }
+        break;
+
+    case 8:
+        while (frames--) {
+            const float *coefficients = bank + (phase * RESAMPLER_TAPS);
+            __m256 sum8 = _mm256_setzero_ps();
+            for (i = 0; i < RESAMPLER_TAPS; i++) {
+                sum8 = _mm256_add_ps(sum8, _mm256_mul_ps(_mm256_set1_ps(coefficients[i]), _mm256_loadu_ps(src + (i * 8))));
+            }
+            _mm256_storeu_ps(dst, sum8);
+            dst += dststride;
+
+            phase += step;
+            while (phase >= phases) {
+                phase -= phases;
+                src += 8;
+            }
+        }
+        break;
+
+    default:
+        SDL_ResampleFrames_SSE2(chans, bank, phases, step, phase, src, dst, dststride, frames);
+        break;
+    }
+}
+#endif
+
+#if HAVE_NEON_INTRINSICS
+static void
+SDL_ResampleFrames_NEON(const int chans, const float *bank, const int phases, const int step, int phase,
+                        const float *src, float *dst, const int dststride, int frames)
+{
+    int i;
+
+    switch (chans) {
+    case 1:
+        while (frames--) {
+            const float *coefficients = bank + (phase * RESAMPLER_TAPS);
+            float32x4_t sum = vmulq_f32(vld1q_f32(coefficients), vld1q_f32(src));
+            float32x2_t sum2;
+            sum = vmlaq_f32(sum, vld1q_f32(coefficients + 4), vld1q_f32(src + 4));
+            sum = vmlaq_f32(sum, vld1q_f32(coefficients + 8), vld1q_f32(src + 8));
+            sum2 = vadd_f32(vget_low_f32(sum), vget_high_f32(sum));
+            sum2 = vpadd_f32(sum2, sum2);
+            vst1_lane_f32(dst, sum2, 0);
+            dst += dststride;
+
+            phase += step;
+            while (phase >= phases) {
+                phase -= phases;
+                src += 1;
+            }
+        }
+        break;
+
+    case 2:
+        while (frames--) {
+            const float *coefficients = bank + (phase * RESAMPLER_TAPS);
+            float32x4_t sum = vdupq_n_f32(0.0f);
+            for (i = 0; i < RESAMPLER_TAPS; i += 4) {
+                /* each coefficient applies to both channels of a frame */
+                const float32x4x2_t c = vzipq_f32(vld1q_f32(coefficients + i), vld1q_f32(coefficients + i));
+                sum = vmlaq_f32(sum, c.val[0], vld1q_f32(src + (i * 2)));
+                sum = vmlaq_f32(sum, c.val[1], vld1q_f32(src + (i * 2) + 4));
+            }
+            vst1_f32(dst, vadd_f32(vget_low_f32(sum), vget_high_f32(sum)));
+            dst += dststride;
+
+            phase += step;
+            while (phase >= phases) {
+                phase -= phases;
+                src += 2;
+            }
+        }
+        break;
+
+    case 4:
+        while (frames--) {
+            const float *coefficients = bank + (phase * RESAMPLER_TAPS);
+            float32x4_t sum = vdupq_n_f32(0.0f);
+            for (i = 0; i < RESAMPLER_TAPS; i++) {
+                sum = vmlaq_n_f32(sum, vld1q_f32(src + (i * 4)), coefficients[i]);
+            }
+            vst1q_f32(dst, sum);
+            dst += dststride;
+
+            phase += step;
+            while (phase >= phases) {
+                phase -= phases;
+                src += 4;
+            }
+        }
+        break;
+
+    case 8:
+        while (frames--) {
+            const float *coefficients = bank + (phase * RESAMPLER_TAPS);
+            float32x4_t sum1 = vdupq_n_f32(0.0f);
+            float32x4_t sum2 = vdupq_n_f32(0.0f);
+            for (i = 0; i < RESAMPLER_TAPS; i++) {
+                sum1 = vmlaq_n_f32(sum1, vld1q_f32(src + (i * 8)), coefficients[i]);
+                sum2 = vmlaq_n_f32(sum2, vld1q_f32(src + (i * 8) + 4), coefficients[i]);
+            }
+            vst1q_f32(dst, sum1);
+            vst1q_f32(dst + 4, sum2);
+            dst += dststride;
+
+            phase += step;
+            while (phase >= phases) {
+                phase -= phases;
+                src += 8;
+            }
+        }
+        break;
+
+    default:
+        SDL_ResampleFrames_Scalar(chans, bank, phases, step, phase, src, dst, dststride, frames);
+        break;
+    }
+}
+#endif
 
 int
 SDL_PrepareResampleFilter(void)
@@ -455,6 +861,23 @@ SDL_PrepareResampleFilter(void)
             return SDL_OutOfMemory();
         }
         kaiser_and_sinc(ResamplerFilter, ResamplerFilterDifference, RESAMPLER_FILTER_SIZE, beta);
+
+        ResamplerFrames = SDL_ResampleFrames_Scalar;
+#if HAVE_SSE2_INTRINSICS
+        if (SDL_HasSSE2()) {
+            ResamplerFrames = SDL_ResampleFrames_SSE2;
+        }
+#endif
+#if HAVE_AVX2_INTRINSICS
+        if (SDL_HasAVX2()) {
+            ResamplerFrames = SDL_ResampleFrames_AVX2;
+        }
+#endif
+#if HAVE_NEON_INTRINSICS
+        if (SDL_HasNEON()) {
+            ResamplerFrames = SDL_ResampleFrames_NEON;
+        }
+#endif
     }
     SDL_AtomicUnlock(&ResampleFilterSpinlock);
     return 0;
@@ -463,12 +886,58 @@ SDL_PrepareResampleFilter(void)
 void
 SDL_FreeResampleFilter(void)
 {
+    while (ResamplerBanks) {
+        SDL_ResamplerBank *next = ResamplerBanks->next;
+        SDL_free(ResamplerBanks);
+        ResamplerBanks = next;
+    }
+    ResamplerNumBanks = 0;
+
     SDL_free(ResamplerFilter);
     SDL_free(ResamplerFilterDifference);
     ResamplerFilter = NULL;
     ResamplerFilterDifference = NULL;
 }
 
+/* Get the coefficients for every phase, or NULL if there are too many phases to keep around.
+   Banks are never freed before SDL_FreeResampleFilter(), so this can be used without the lock held. */
+static const float *
+GetResamplerBank(const int phases)
+{
+    SDL_ResamplerBank *bank;
+    const float *retval = NULL;
+    int phase;
+
+    if (phases > RESAMPLER_MAX_PHASES) {
+        return NULL;
+    }
+
+    SDL_AtomicLock(&ResampleFilterSpinlock);
+    for (bank = ResamplerBanks; bank; bank = bank->next) {
+        if (bank->phases == phases) {
+            retval = bank->coefficients;
+            break;
+        }
+    }
+    if (!retval && ResamplerNumBanks < RESAMPLER_MAX_BANKS) {
+        bank = (SDL_ResamplerBank *) SDL_malloc(sizeof (*bank) + (phases * RESAMPLER_TAPS * sizeof (float)));
+        if (bank) {
+            bank->phases = phases;
+            bank->coefficients = (float *) (bank + 1);
+            for (phase = 0; phase < phases; phase++) {
+                ResamplerCoefficients(phase, phases, bank->coefficients + (phase * RESAMPLER_TAPS));
+            }
+            bank->next = ResamplerBanks;
+            ResamplerBanks = bank;
+            ++ResamplerNumBanks;
+            retval = bank->coefficients;
+        }
+    }
+    SDL_AtomicUnlock(&ResampleFilterSpinlock);
+
+    return retval;
+}
+
 static int
 ResamplerPadding(const int inrate, const int outrate)
 {
@@ -480,62 +949,152 @@ ResamplerPadding(const int inrate, const int outrate)
     return RESAMPLER_SAMPLES_PER_ZERO_CROSSING;
 }
 
-/* lpadding and rpadding are expected to be buffers of (ResamplePadding(inrate, outrate) * chans * sizeof (float)) bytes. */
 static int
-SDL_ResampleAudio(const int chans, const int inrate, const int outrate,
-                        const float *lpadding, const float *rpadding,
-                        const float *inbuf, const int inbuflen,
-                        float *outbuf, const int outbuflen)
+ResamplerGCD(int a, int b)
+{
+    while (b) {
+        const int t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+/* Resample one output frame, near enough to the ends of inbuf that it needs some of the padding */
+static void
+ResamplerEdgeFrame(const int chans, const int srcindex, const float *coefficients, const int paddinglen,
+                   const float *lpadding, const float *rpadding,
+                   const float *inbuf, const int inframes, float *dst)
+{
+    float window[RESAMPLER_TAPS * RESAMPLER_MAX_CHANNELS];
+    int i;
+
+    for (i = 0; i < RESAMPLER_TAPS; i++) {
+        const int srcframe = srcindex - (RESAMPLER_LEFT_TAPS - 1) + i;
+        const float *src;
+        if (srcframe < 0) {
+            src = lpadding + ((paddinglen + srcframe) * chans);
+        } else if (srcframe >= inframes) {
+            src = rpadding + ((srcframe - inframes) * chans);
+        } else {
+            src = inbuf + (srcframe * chans);
+        }
+        SDL_memcpy(window + (i * chans), src, chans * sizeof (float));
+    }
+
+    ResamplerFrames(chans, coefficients, 1, 0, 0, window, dst, chans, 1);
+}
+
+/* How many frames SDL_ResampleAudio() makes from (inframes), with room for (maxoutframes) */
+static int
+ResamplerOutputFrames(const int inrate, const int outrate, const int inframes, const int maxoutframes)
 {
-    const double finrate = (double) inrate;
-    const double outtimeincr = 1.0 / ((float) outrate);
     const double  ratio = ((float) outrate) / ((float) inrate);
+    const int wantedoutframes = (int) (inframes * ratio);  /* maxoutframes isn't total to write, it's total available. */
+    return SDL_min(wantedoutframes, maxoutframes);
+}
+
+/* Resample output frames [startframe, endframe) into the same place in outbuf.
+   Every frame only depends on its position, so any range comes out the same as it would as part of the whole. */
+static void
+SDL_ResampleAudioFrames(const int chans, const int inrate, const int outrate,
+                        const float *lpadding, const float *rpadding,
+                        const float *inbuf, const int inframes,
+                        float *outbuf, const int startframe, const int endframe)
+{
     const int paddinglen = ResamplerPadding(inrate, outrate);
     const int framelen = chans * (int)sizeof (float);
-    const int inframes = inbuflen / framelen;
-    const int wantedoutframes = (int) ((inbuflen / framelen) * ratio);  /* outbuflen isn't total to write, it's total available. */
-    const int maxoutframes = outbuflen / framelen;
-    const int outframes = SDL_min(wantedoutframes, maxoutframes);
-    float *dst = outbuf;
-    double outtime = 0.0;
-    int i, j, chan;
-
-    for (i = 0; i < outframes; i++) {
-        const int srcindex = (int) (outtime * inrate);
-        const double intime = ((double) srcindex) / finrate;
-        const double innexttime = ((double) (srcindex + 1)) / finrate;
-        const double interpolation1 = 1.0 - ((innexttime - outtime) / (innexttime - intime));
-        const int filterindex1 = (int) (interpolation1 * RESAMPLER_SAMPLES_PER_ZERO_CROSSING);
-        const double interpolation2 = 1.0 - interpolation1;
-        const int filterindex2 = (int) (interpolation2 * RESAMPLER_SAMPLES_PER_ZERO_CROSSING);
+    const int divisor = ResamplerGCD(inrate, outrate);
+    const int phases = outrate / divisor;  /* output frame i is at input frame (i * step / phases) */
+    const int step = inrate / divisor;
+    const float *bank = GetResamplerBank(phases);
+    float coefficients[RESAMPLER_TAPS];
+    Sint64 first, last;
+    int i;
 
-        for (chan = 0; chan < chans; chan++) {
-            float outsample = 0.0f;
+    SDL_assert(chans <= RESAMPLER_MAX_CHANNELS);
 
-            /* do this twice to calculate the sample, once for the "left wing" and then same for the right. */
-            /* !!! FIXME: do both wings in one loop */
-            for (j = 0; (filterindex1 + (j * RESAMPLER_SAMPLES_PER_ZERO_CROSSING)) < RESAMPLER_FILTER_SIZE; j++) {
-                const int srcframe = srcindex - j;
-                /* !!! FIXME: we can bubble this conditional out of here by doing a pre loop. */
-                const float insample = (srcframe < 0) ? lpadding[((paddinglen + srcframe) * chans) + chan] : inbuf[(srcframe * chans) + chan];
-                outsample += (float)(insample * (ResamplerFilter[filterindex1 + (j * RESAMPLER_SAMPLES_PER_ZERO_CROSSING)] + (interpolation1 * ResamplerFilterDifference[filterindex1 + (j * RESAMPLER_SAMPLES_PER_ZERO_CROSSING)])));
+    /* Output frames in [first, last) only need input from inbuf, so they run
+       straight off of it, without checking for the padding every time. */
+    first = (((Sint64) (RESAMPLER_LEFT_TAPS - 1) * phases) + step - 1) / step;
+    if (inframes > RESAMPLER_TAPS - RESAMPLER_LEFT_TAPS) {
+        last = (((Sint64) (inframes - (RESAMPLER_TAPS - RESAMPLER_LEFT_TAPS)) * phases) - 1) / step + 1;
+    } else {
+        last = 0;
+    }
+    last = SDL_min(last, endframe);
+    first = SDL_max(first, startframe);
+    first = SDL_min(first, last);
+
+    for (i = startframe; i < endframe; i++) {
+        const Sint64 position = (Sint64) i * step;
+        const int srcindex = (int) (position / phases);
+        const int phase = (int) (position % phases);
+        const float *frame_coefficients;
+
+        if (i == first && i < last && bank) {
+            if (phases == 2 && step == 1) {
+                /* Upsampling 2x: even output frames are input frames, odd ones are all the same phase */
+                const int odd = (int) (first | 1);
+                int j;
+                for (j = (int) (first + (first & 1)); j < last; j += 2) {
+                    SDL_memcpy(outbuf + (j * chans), inbuf + ((j / 2) * chans), framelen);
+                }
+                if (odd < last) {
+                    ResamplerFrames(chans, bank + RESAMPLER_TAPS, 1, 1, 0,
+                                    inbuf + (((odd / 2) - (RESAMPLER_LEFT_TAPS - 1)) * chans),
+                                    outbuf + (odd * chans), chans * 2, (int) ((last - odd + 1) / 2));
+                }
+            } else if (phases == 1 && step == 2) {
+                /* Downsampling 2x: every output frame is an input frame */
+                int j;
+                for (j = (int) first; j < last; j++) {
+                    SDL_memcpy(outbuf + (j * chans), inbuf + ((j * 2) * chans), framelen);
+                }
+            } else {
+                ResamplerFrames(chans, bank, phases, step, phase,
+                                inbuf + ((srcindex - (RESAMPLER_LEFT_TAPS - 1)) * chans),
+                                outbuf + (i * chans), chans, (int) (last - first));
             }
+            i = (int) last - 1;
+            continue;
+        }
 
-            for (j = 0; (filterindex2 + (j * RESAMPLER_SAMPLES_PER_ZERO_CROSSING)) < RESAMPLER_FILTER_SIZE; j++) {
-                const int srcframe = srcindex + 1 + j;
-                /* !!! FIXME: we can bubble this conditional out of here by doing a post loop. */
-                const float insample = (srcframe >= inframes) ? rpadding[((srcframe - inframes) * chans) + chan] : inbuf[(srcframe * chans) + chan];
-                outsample += (float)(insample * (ResamplerFilter[filterindex2 + (j * RESAMPLER_SAMPLES_PER_ZERO_CROSSING)] + (interpolation2 * ResamplerFilterDifference[filterindex2 + (j * RESAMPLER_SAMPLES_PER_ZERO_CROSSING)])));
-            }
-            *(dst++) = outsample;
+        if (bank) {
+            frame_coefficients = bank + (phase * RESAMPLER_TAPS);
+        } else {
+            ResamplerCoefficients(phase, phases, coefficients);
+            frame_coefficients = coefficients;
         }
 
-        outtime += outtimeincr;
+        if (i >= first && i < last) {
+            ResamplerFrames(chans, frame_coefficients, 1, 0, 0,
+                            inbuf + ((srcindex - (RESAMPLER_LEFT_TAPS - 1)) * chans),
+                            outbuf + (i * chans), chans, 1);
+        } else {
+            ResamplerEdgeFrame(chans, srcindex, frame_coefficients, paddinglen, lpadding, rpadding,
+                               inbuf, inframes, outbuf + (i * chans));
+        }
     }
+}
 
+/* lpadding and rpadding are expected to be buffers of (ResamplePadding(inrate, outrate) * chans * sizeof (float)) bytes. */
+static int
+SDL_ResampleAudio(const int chans, const int inrate, const int outrate,
+                        const float *lpadding, const float *rpadding,
+                        const float *inbuf, const int inbuflen,
+                        float *outbuf, const int outbuflen)
+{
+    const int framelen = chans * (int)sizeof (float);
+    const int inframes = inbuflen / framelen;
+    const int outframes = ResamplerOutputFrames(inrate, outrate, inframes, outbuflen / framelen);
+
+    SDL_ResampleAudioFrames(chans, inrate, outrate, lpadding, rpadding, inbuf, inframes, outbuf, 0, outframes);
     return outframes * chans * sizeof (float);
 }
 
+static SDL_bool SDL_ConvertAudioThreaded(SDL_AudioCVT *cvt);
+
 int
 SDL_ConvertAudio(SDL_AudioCVT * cvt)
 {
@@ -553,6 +1112,11 @@ SDL_ConvertAudio(SDL_AudioCVT * cvt)
         return 0;
     }
 
+    /* Big buffers can be split up between threads, if the app wants that. */
+    if (SDL_ConvertAudioThreaded(cvt)) {
+        return 0;
+    }
+
     /* Set up the conversion and go! */
     cvt->filter_index = 0;
     cvt->filters[0] (cvt, cvt->src_format);
@@ -778,6 +1342,250 @@ ChooseCVTResampler(const int dst_channels)
     return NULL;
 }
 
+static int
+CVTResamplerChannels(const SDL_AudioFilter filter)
+{
+    if (filter == SDL_ResampleCVT_c1) {
+        return 1;
+    } else if (filter == SDL_ResampleCVT_c2) {
+        return 2;
+    } else if (filter == SDL_ResampleCVT_c4) {
+        return 4;
+    } else if (filter == SDL_ResampleCVT_c6) {
+        return 6;
+    } else if (filter == SDL_ResampleCVT_c8) {
+        return 8;
+    }
+    return 0;  /* not a resampler. */
+}
+
+
+/* Converting big buffers on several threads...
+
+   Everything in the filter chain except the resampler works on each frame
+   by itself, so the buffer is cut into frame-aligned pieces that are
+   converted in their own scratch space and then put back together. The
+   resampler needs its neighbours, so it runs as a separate step in the
+   middle, where each thread makes a range of output frames straight from
+   the whole input buffer. Either way the result is the same as converting
+   it all on one thread. */
+
+#define CONVERT_MAX_THREADS 16
+#define CONVERT_THREADED_MIN_LEN (512 * 1024)  /* smaller buffers aren't worth waking threads for. */
+#define CONVERT_THREADED_MIN_CHUNK (256 * 1024)
+#define CONVERT_CHUNK_ALIGN 3360  /* a multiple of every frame size: 1, 2 or 4 bytes times 1 to 8 channels. */
+
+typedef struct
+{
+    /* Filter chain pieces: a copy of the cvt, with just the filters to run. */
+    SDL_AudioCVT cvt;
+    SDL_AudioFormat format;
+    const Uint8 *src;
+
+    /* Resampler pieces. */
+    int chans;
+    int inrate;
+    int outrate;
+    const float *padding;
+    const float *inbuf;
+    int inframes;
+    float *outbuf;
+    int startframe;
+    int endframe;
+} SDL_ConvertJob;
+
+static int SDLCALL
+SDL_ConvertJobThread(void *data)
+{
+    SDL_ConvertJob *job = (SDL_ConvertJob *) data;
+
+    if (job->chans) {
+        SDL_ResampleAudioFrames(job->chans, job->inrate, job->outrate, job->padding, job->padding,
+                                job->inbuf, job->inframes, job->outbuf, job->startframe, job->endframe);
+    } else {
+        if (job->src != job->cvt.buf) {
+            SDL_memcpy(job->cvt.buf, job->src, job->cvt.len_cvt);
+        }
+        job->cvt.filter_index = 0;
+        job->cvt.filters[0](&job->cvt, job->format);
+    }
+    return 0;
+}
+
+static void
+SDL_RunConvertJobs(SDL_ConvertJob *jobs, const int numjobs)
+{
+    SDL_Thread *threads[CONVERT_MAX_THREADS];
+    int i;
+
+    for (i = 1; i < numjobs; i++) {
+        threads[i] = SDL_CreateThreadInternal(SDL_ConvertJobThread, "SDLAudioConv", 0, &jobs[i]);
+        if (!threads[i]) {
+            SDL_ConvertJobThread(&jobs[i]);  /* no thread? Do it here, then. */
+        }
+    }
+
+    SDL_ConvertJobThread(&jobs[0]);  /* this thread takes the first piece. */
+
+    for (i = 1; i < numjobs; i++) {
+        if (threads[i]) {
+            SDL_WaitThread(threads[i], NULL);
+        }
+    }
+}
+
+/* Run filters [first, last) over the buffer, in (mult) times as much scratch space as there is data. */
+static void
+SDL_ConvertAudioChunks(SDL_AudioCVT *cvt, const int first, const int last, const SDL_AudioFormat format,
+                       const int mult, Uint8 *scratch, const int threads)
+{
+    SDL_ConvertJob jobs[CONVERT_MAX_THREADS];
+    const int len = cvt->len_cvt;
+    int numjobs = SDL_min(threads, len / CONVERT_THREADED_MIN_CHUNK);
+    int chunk, offset, i, j;
+
+    if (first == last) {
+        return;
+    }
+
+    numjobs = SDL_max(numjobs, 1);
+    chunk = ((len / numjobs) / CONVERT_CHUNK_ALIGN) * CONVERT_CHUNK_ALIGN;
+
+    for (i = 0; i < numjobs; i++) {
+        SDL_ConvertJob *job = &jobs[i];
+        SDL_zerop(job);
+        job->cvt = *cvt;
+        for (j = first; j < last; j++) {
+            job->cvt.filters[j - first] = cvt->filters[j];
+        }
+        job->cvt.filters[last - first] = NULL;
+        job->format = format;
+        job->src = cvt->buf + (i * chunk);
+        job->cvt.len_cvt = (i == numjobs - 1) ? (len - (i * chunk)) : chunk;
+        job->cvt.buf = (numjobs == 1) ? cvt->buf : (scratch + (i * chunk * mult));
+    }
+
+    SDL_RunConvertJobs(jobs, numjobs);
+
+    if (numjobs == 1) {
+        cvt->len_cvt = jobs[0].cvt.len_cvt;
+        return;
+    }
+
+    /* Every piece has read its input by now, so the results can go anywhere. */
+    offset = 0;
+    for (i = 0; i < numjobs; i++) {
+        SDL_memcpy(cvt->buf + offset, jobs[i].cvt.buf, jobs[i].cvt.len_cvt);
+        offset += jobs[i].cvt.len_cvt;
+    }
+    cvt->len_cvt = offset;
+}
+
+/* Threaded version of SDL_ResampleCVT(): same buffer layout, same result. */
+static void
+SDL_ResampleAudioChunks(SDL_AudioCVT *cvt, const int chans, const float *padding, const int threads)
+{
+    SDL_ConvertJob jobs[CONVERT_MAX_THREADS];
+    const int inrate = (int) (size_t) cvt->filters[SDL_AUDIOCVT_MAX_FILTERS-1];
+    const int outrate = (int) (size_t) cvt->filters[SDL_AUDIOCVT_MAX_FILTERS];
+    const int framelen = chans * (int) sizeof (float);
+    const int srclen = cvt->len_cvt;
+    float *dst = (float *) (cvt->buf + srclen);
+    const int dstlen = (cvt->len * cvt->len_mult) - srclen;
+    const int inframes = srclen / framelen;
+    const int outframes = ResamplerOutputFrames(inrate, outrate, inframes, dstlen / framelen);
+    int numjobs = SDL_min(threads, (outframes * framelen) / CONVERT_THREADED_MIN_CHUNK);
+    int i;
+
+    numjobs = SDL_max(numjobs, 1);
+    for (i = 0; i < numjobs; i++) {
+        SDL_ConvertJob *job = &jobs[i];
+        SDL_zerop(job);
+        job->chans = chans;
+        job->inrate = inrate;
+        job->outrate = outrate;
+        job->padding = padding;
+        job->inbuf = (const float *) cvt->buf;
+        job->inframes = inframes;
+        job->outbuf = dst;
+        job->startframe = (int) (((Sint64) outframes * i) / numjobs);
+        job->endframe = (int) (((Sint64) outframes * (i + 1)) / numjobs);
+    }
+
+    SDL_RunConvertJobs(jobs, numjobs);
+
+    cvt->len_cvt = outframes * framelen;
+    SDL_memmove(cvt->buf, dst, cvt->len_cvt);
+}
+
+/* Returns SDL_TRUE if it converted the buffer, or SDL_FALSE to leave it to the single threaded path. */
+static SDL_bool
+SDL_ConvertAudioThreaded(SDL_AudioCVT *cvt)
+{
+    const char *hint;
+    int threads, resampler, last, chans = 0;
+    float *padding = NULL;
+    Uint8 *scratch;
+
+    if (cvt->len < CONVERT_THREADED_MIN_LEN) {
+        return SDL_FALSE;
+    }
+
+    hint = SDL_GetHint(SDL_HINT_AUDIO_CONVERT_THREADS);
+    threads = hint ? SDL_atoi(hint) : 1;
+    if (threads <= 0) {
+        threads = SDL_GetCPUCount();
+    }
+    threads = SDL_min(threads, CONVERT_MAX_THREADS);
+    if (threads <= 1) {
+        return SDL_FALSE;
+    }
+
+    for (resampler = 0; cvt->filters[resampler]; resampler++) {
+        chans = CVTResamplerChannels(cvt->filters[resampler]);
+        if (chans) {
+            break;
+        }
+    }
+    for (last = resampler; cvt->filters[last]; last++) {
+        /* find the end of the chain. */
+    }
+
+    /* Get all the memory up front, so a failure leaves the buffer alone. */
+    if (chans) {
+        const int inrate = (int) (size_t) cvt->filters[SDL_AUDIOCVT_MAX_FILTERS-1];
+        const int outrate = (int) (size_t) cvt->filters[SDL_AUDIOCVT_MAX_FILTERS];
+        const int paddinglen = ResamplerPadding(inrate, outrate);
+        if (paddinglen >= SDL_MAX_SINT32 / chans) {
+            return SDL_FALSE;
+        }
+        padding = (float *) SDL_calloc((paddinglen * chans) + 1, sizeof (float));
+        if (!padding) {
+            return SDL_FALSE;
+        }
+    }
+
+    /* Each step's scratch space fits in as much as the app had to allocate:
+       before the resampler the data is at most len_mult times bigger, and
+       after it the data only shrinks but starts out at most half of that. */
+    scratch = (Uint8 *) SDL_SIMDAlloc(cvt->len * cvt->len_mult);
+    if (!scratch) {
+        SDL_free(padding);
+        return SDL_FALSE;
+    }
+
+    cvt->len_cvt = cvt->len;
+    SDL_ConvertAudioChunks(cvt, 0, resampler, cvt->src_format, cvt->len_mult, scratch, threads);
+    if (chans) {
+        SDL_ResampleAudioChunks(cvt, chans, padding, threads);
+        SDL_ConvertAudioChunks(cvt, resampler + 1, last, AUDIO_F32SYS, 1, scratch, threads);
+    }
+
+    SDL_SIMDFree(scratch);
+    SDL_free(padding);
+    return SDL_TRUE;
+}
+
 static int
 SDL_BuildAudioResampleCVT(SDL_AudioCVT * cvt, const int dst_channels,
                           const int src_rate, const int dst_rate)
@@ -1118,6 +1926,8 @@ struct _SDL_AudioStream
     SDL_ResampleAudioStreamFunc resampler_func;
     SDL_ResetAudioStreamResamplerFunc reset_resampler_func;
     SDL_CleanupAudioStreamResamplerFunc cleanup_resampler_func;
+    SDL_bool dither_needed;  /* the pipeline ends in float, convert to dst_format at the very end. */
+    SDL_AudioDither dither;
 };
 
 static Uint8 *
@@ -1275,6 +2085,7 @@ SDL_NewAudioStream(const SDL_AudioFormat src_format,
 {
     const int packetlen = 4096;  /* !!! FIXME: good enough for now. */
     Uint8 pre_resample_channels;
+    SDL_AudioFormat final_format = dst_format;
     SDL_AudioStream *retval;
 
     retval = (SDL_AudioStream *) SDL_calloc(1, sizeof (SDL_AudioStream));
@@ -1309,6 +2120,17 @@ SDL_NewAudioStream(const SDL_AudioFormat src_format,
         return NULL;
     }
 
+    /* If the data goes through float anyhow, keep it there until the very
+       end, and then dither, convert and byteswap to the integer format all
+       at once. Only plain byteswaps are left to SDL_BuildAudioCVT. */
+    if (!SDL_AUDIO_ISFLOAT(dst_format) &&
+        ((src_rate != dst_rate) || (src_channels != dst_channels) ||
+         ((src_format & ~SDL_AUDIO_MASK_ENDIAN) != (dst_format & ~SDL_AUDIO_MASK_ENDIAN)))) {
+        final_format = AUDIO_F32SYS;
+        retval->dither_needed = SDL_TRUE;
+        SDL_InitAudioDither(&retval->dither, dst_format, SDL_GetHintBoolean(SDL_HINT_AUDIO_DITHER, SDL_FALSE));
+    }
+
     retval->staging_buffer_size = ((retval->resampler_padding_samples / retval->pre_resample_channels) * retval->src_sample_frame_size);
     if (retval->staging_buffer_size > 0) {
         retval->staging_buffer = (Uint8 *) SDL_malloc(retval->staging_buffer_size);
@@ -1322,7 +2144,7 @@ SDL_NewAudioStream(const SDL_AudioFormat src_format,
     /* Not resampling? It's an easy conversion (and maybe not even that!) */
     if (src_rate == dst_rate) {
         retval->cvt_before_resampling.needed = SDL_FALSE;
-        if (SDL_BuildAudioCVT(&retval->cvt_after_resampling, src_format, src_channels, dst_rate, dst_format, dst_channels, dst_rate) < 0) {
+        if (SDL_BuildAudioCVT(&retval->cvt_after_resampling, src_format, src_channels, dst_rate, final_format, dst_channels, dst_rate) < 0) {
             SDL_FreeAudioStream(retval);
             return NULL;  /* SDL_BuildAudioCVT should have called SDL_SetError. */
         }
@@ -1359,7 +2181,7 @@ SDL_NewAudioStream(const SDL_AudioFormat src_format,
         }
 
         /* Convert us to the final format after resampling. */
-        if (SDL_BuildAudioCVT(&retval->cvt_after_resampling, AUDIO_F32SYS, pre_resample_channels, dst_rate, dst_format, dst_channels, dst_rate) < 0) {
+        if (SDL_BuildAudioCVT(&retval->cvt_after_resampling, AUDIO_F32SYS, pre_resample_channels, dst_rate, final_format, dst_channels, dst_rate) < 0) {
             SDL_FreeAudioStream(retval);
             return NULL;  /* SDL_BuildAudioCVT should have called SDL_SetError. */
         }
@@ -1488,6 +2310,14 @@ SDL_AudioStreamPutInternal(SDL_AudioStream *stream, const void *buf, int len, in
         #endif
     }
 
+    if (stream->dither_needed && (buflen > 0)) {
+        buflen = SDL_DitherAudio(&stream->dither, (const float *) resamplebuf, resamplebuf, buflen / sizeof (float));
+
+        #if DEBUG_AUDIOSTREAM
+        printf("AUDIOSTREAM: After dithering we have %d bytes\n", buflen);
+        #endif
+    }
+
     #if DEBUG_AUDIOSTREAM
     printf("AUDIOSTREAM: Final output is %d bytes\n", buflen);
     #endif
@@ -1530,7 +2360,8 @@ SDL_AudioStreamPut(SDL_AudioStream *stream, const void *buf, int len)
 
     if (!stream->cvt_before_resampling.needed &&
         (stream->dst_rate == stream->src_rate) &&
-        !stream->cvt_after_resampling.needed) {
+        !stream->cvt_after_resampling.needed &&
+        !stream->dither_needed) {
         #if DEBUG_AUDIOSTREAM
         printf("AUDIOSTREAM: no conversion needed at all, queueing %d bytes.\n", len);
         #endif
@@ -1383,6 +1383,297 @@ SDL_Convert_F32_to_S32_NEON(SDL_AudioCVT *cvt, SDL_AudioFormat format)
 
 
 
+/* Dithered conversion out of float...
+
+   Audio streams keep everything in float until the very end, then do the
+   dither, clamp, integer conversion and byteswap in one pass. The dither is
+   triangular (TPDF) noise of +/- 1 LSB, the difference of two uniform random
+   numbers, which turns quantization error into a constant, quiet hiss
+   instead of distortion that follows the signal. Samples that are exactly
+   zero get no noise, so silence stays digital silence. */
+
+static SDL_INLINE Uint32
+DitherRandom(Uint32 *state)
+{
+    Uint32 x = *state;  /* xorshift32 */
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+static void
+SDL_DitherAudio_Scalar(SDL_AudioDither *dither, const float *src, void *_dst, int samples)
+{
+    const SDL_AudioFormat format = dither->format;
+    const int bits = SDL_AUDIO_BITSIZE(format);
+    const SDL_bool swap = (bits > 8) && ((SDL_AUDIO_ISBIGENDIAN(format) != 0) == (SDL_BYTEORDER == SDL_LIL_ENDIAN));
+    const Uint32 bias = (Uint32) 1 << (bits - 1);
+    const Uint32 flip = SDL_AUDIO_ISSIGNED(format) ? bias : 0;
+    const float scale = (float) (bias - 1);
+    const float offset = ((float) bias) + 0.5f;  /* keep it positive, so truncating rounds to nearest. */
+    const float maxval = (float) ((bias * 2) - 1);
+    const float amplitude = dither->amplitude * (1.0f / 65536.0f);
+    Uint8 *dst = (Uint8 *) _dst;
+    int i;
+
+    for (i = 0; i < samples; i++) {
+        float sample = src[i];
+        Uint32 value;
+
+        if (!(sample >= -1.0f)) {  /* catches NaN, too. */
+            sample = -1.0f;
+        } else if (sample > 1.0f) {
+            sample = 1.0f;
+        }
+
+        if (bits == 32) {
+            value = ((Uint32) (Sint32) (sample * 8388607.0f)) << 8;
+            *((Uint32 *) dst) = swap ? SDL_Swap32(value) : value;
+            dst += 4;
+            continue;
+        }
+
+        if ((amplitude != 0.0f) && (sample != 0.0f)) {
+            const Uint32 x = DitherRandom(&dither->state[0]);
+            sample = (sample * scale) + offset + (((float) (Sint32) ((x >> 16) - (x & 0xFFFF))) * amplitude);
+            sample = (sample < 0.0f) ? 0.0f : ((sample > maxval) ? maxval : sample);
+        } else {
+            sample = (sample * scale) + offset;
+        }
+        value = ((Uint32) sample) ^ flip;
+
+        if (bits == 16) {
+            *((Uint16 *) dst) = swap ? SDL_Swap16((Uint16) value) : (Uint16) value;
+            dst += 2;
+        } else {
+            *(dst++) = (Uint8) value;
+        }
+    }
+}
+
+#if HAVE_SSE2_INTRINSICS
+static SDL_INLINE __m128
+DitherNoise_SSE2(__m128i *state, const __m128 amplitude)
+{
+    __m128i x = *state;
+    x = _mm_xor_si128(x, _mm_slli_epi32(x, 13));
+    x = _mm_xor_si128(x, _mm_srli_epi32(x, 17));
+    x = _mm_xor_si128(x, _mm_slli_epi32(x, 5));
+    *state = x;
+    return _mm_mul_ps(_mm_cvtepi32_ps(_mm_sub_epi32(_mm_srli_epi32(x, 16), _mm_and_si128(x, _mm_set1_epi32(0xFFFF)))), amplitude);
+}
+
+/* Four samples, dithered and rounded into the output range, then made signed again for packing. */
+static SDL_INLINE __m128i
+DitherFour_SSE2(const float *src, __m128i *state, const SDL_bool noisy, const __m128 amplitude,
+                const __m128 scale, const __m128 offset, const __m128 maxval, const __m128i bias)
+{
+    const __m128 clamped = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(src), _mm_set1_ps(-1.0f)), _mm_set1_ps(1.0f));
+    __m128 x = _mm_add_ps(_mm_mul_ps(clamped, scale), offset);
+    if (noisy) {  /* the noise can push it out of range again. */
+        const __m128 audible = _mm_cmpneq_ps(clamped, _mm_setzero_ps());
+        x = _mm_add_ps(x, _mm_and_ps(DitherNoise_SSE2(state, amplitude), audible));
+        x = _mm_min_ps(_mm_max_ps(x, _mm_setzero_ps()), maxval);
+    }
+    return _mm_sub_epi32(_mm_cvttps_epi32(x), bias);
+}
+
+static void
+SDL_DitherAudio_SSE2(SDL_AudioDither *dither, const float *src, void *_dst, int samples)
+{
+    const SDL_AudioFormat format = dither->format;
+    const int bits = SDL_AUDIO_BITSIZE(format);
+    const SDL_bool swap = (bits > 8) && ((SDL_AUDIO_ISBIGENDIAN(format) != 0) == (SDL_BYTEORDER == SDL_LIL_ENDIAN));
+    const int bias = 1 << (bits - 1);
+    const __m128 scale = _mm_set1_ps((float) (bias - 1));
+    const __m128 offset = _mm_set1_ps(((float) bias) + 0.5f);
+    const __m128 maxval = _mm_set1_ps((float) ((bias * 2) - 1));
+    const __m128 amplitude = _mm_set1_ps(dither->amplitude * (1.0f / 65536.0f));
+    const __m128i mmbias = _mm_set1_epi32(bias);
+    const SDL_bool noisy = (dither->amplitude != 0.0f);
+    __m128i state1 = _mm_loadu_si128((const __m128i *) dither->state);
+    __m128i state2 = _mm_loadu_si128((const __m128i *) (dither->state + 4));
+    Uint8 *dst = (Uint8 *) _dst;
+
+    /* Every block reads its input before writing output no bigger than it, so this works in place. */
+    if (bits == 8) {
+        const __m128i flip = _mm_set1_epi8(SDL_AUDIO_ISSIGNED(format) ? 0 : (char) 0x80);
+        while (samples >= 16) {
+            const __m128i a = DitherFour_SSE2(src, &state1, noisy, amplitude, scale, offset, maxval, mmbias);
+            const __m128i b = DitherFour_SSE2(src + 4, &state2, noisy, amplitude, scale, offset, maxval, mmbias);
+            const __m128i c = DitherFour_SSE2(src + 8, &state1, noisy, amplitude, scale, offset, maxval, mmbias);
+            const __m128i d = DitherFour_SSE2(src + 12, &state2, noisy, amplitude, scale, offset, maxval, mmbias);
+            const __m128i packed = _mm_packs_epi16(_mm_packs_epi32(a, b), _mm_packs_epi32(c, d));
+            _mm_storeu_si128((__m128i *) dst, _mm_xor_si128(packed, flip));
+            samples -= 16; src += 16; dst += 16;
+        }
+    } else if (bits == 16) {
+        const __m128i flip = _mm_set1_epi16(SDL_AUDIO_ISSIGNED(format) ? 0 : (short) 0x8000);
+        while (samples >= 8) {
+            const __m128i a = DitherFour_SSE2(src, &state1, noisy, amplitude, scale, offset, maxval, mmbias);
+            const __m128i b = DitherFour_SSE2(src + 4, &state2, noisy, amplitude, scale, offset, maxval, mmbias);
+            __m128i packed = _mm_xor_si128(_mm_packs_epi32(a, b), flip);
+            if (swap) {
+                packed = _mm_or_si128(_mm_slli_epi16(packed, 8), _mm_srli_epi16(packed, 8));
+            }
+            _mm_storeu_si128((__m128i *) dst, packed);
+            samples -= 8; src += 8; dst += 16;
+        }
+    } else {
+        /* Floats don't have the precision for dither to matter in 32 bits. */
+        const __m128 one = _mm_set1_ps(1.0f);
+        const __m128 negone = _mm_set1_ps(-1.0f);
+        const __m128 mulby8388607 = _mm_set1_ps(8388607.0f);
+        while (samples >= 4) {
+            __m128i ints = _mm_slli_epi32(_mm_cvttps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(src), negone), one), mulby8388607)), 8);
+            if (swap) {
+                const __m128i mask = _mm_set1_epi32(0x0000FF00);
+                ints = _mm_or_si128(_mm_or_si128(_mm_slli_epi32(ints, 24), _mm_srli_epi32(ints, 24)),
+                                    _mm_or_si128(_mm_and_si128(_mm_srli_epi32(ints, 8), mask),
+                                                 _mm_slli_epi32(_mm_and_si128(ints, mask), 8)));
+            }
+            _mm_storeu_si128((__m128i *) dst, ints);
+            samples -= 4; src += 4; dst += 16;
+        }
+    }
+
+    _mm_storeu_si128((__m128i *) dither->state, state1);
+    _mm_storeu_si128((__m128i *) (dither->state + 4), state2);
+
+    SDL_DitherAudio_Scalar(dither, src, dst, samples);  /* leftovers. */
+}
+#endif
+
+#if HAVE_NEON_INTRINSICS
+static SDL_INLINE float32x4_t
+DitherNoise_NEON(uint32x4_t *state, const float32x4_t amplitude)
+{
+    uint32x4_t x = *state;
+    x = veorq_u32(x, vshlq_n_u32(x, 13));
+    x = veorq_u32(x, vshrq_n_u32(x, 17));
+    x = veorq_u32(x, vshlq_n_u32(x, 5));
+    *state = x;
+    return vmulq_f32(vcvtq_f32_s32(vreinterpretq_s32_u32(vsubq_u32(vshrq_n_u32(x, 16), vandq_u32(x, vdupq_n_u32(0xFFFF))))), amplitude);
+}
+
+/* Four samples, dithered and rounded into the output range, then made signed again for narrowing. */
+static SDL_INLINE int32x4_t
+DitherFour_NEON(const float *src, uint32x4_t *state, const SDL_bool noisy, const float32x4_t amplitude,
+                const float32x4_t scale, const float32x4_t offset, const float32x4_t maxval, const int32x4_t bias)
+{
+    const float32x4_t clamped = vminq_f32(vmaxq_f32(vld1q_f32(src), vdupq_n_f32(-1.0f)), vdupq_n_f32(1.0f));
+    float32x4_t x = vaddq_f32(vmulq_f32(clamped, scale), offset);
+    if (noisy) {  /* the noise can push it out of range again. */
+        const uint32x4_t silent = vceqq_f32(clamped, vdupq_n_f32(0.0f));
+        const float32x4_t noise = DitherNoise_NEON(state, amplitude);
+        x = vaddq_f32(x, vreinterpretq_f32_u32(vbicq_u32(vreinterpretq_u32_f32(noise), silent)));
+        x = vminq_f32(vmaxq_f32(x, vdupq_n_f32(0.0f)), maxval);
+    }
+    return vsubq_s32(vreinterpretq_s32_u32(vcvtq_u32_f32(x)), bias);
+}
+
+static void
+SDL_DitherAudio_NEON(SDL_AudioDither *dither, const float *src, void *_dst, int samples)
+{
+    const SDL_AudioFormat format = dither->format;
+    const int bits = SDL_AUDIO_BITSIZE(format);
+    const SDL_bool swap = (bits > 8) && ((SDL_AUDIO_ISBIGENDIAN(format) != 0) == (SDL_BYTEORDER == SDL_LIL_ENDIAN));
+    const int bias = 1 << (bits - 1);
+    const float32x4_t scale = vdupq_n_f32((float) (bias - 1));
+    const float32x4_t offset = vdupq_n_f32(((float) bias) + 0.5f);
+    const float32x4_t maxval = vdupq_n_f32((float) ((bias * 2) - 1));
+    const float32x4_t amplitude = vdupq_n_f32(dither->amplitude * (1.0f / 65536.0f));
+    const int32x4_t mmbias = vdupq_n_s32(bias);
+    const SDL_bool noisy = (dither->amplitude != 0.0f);
+    uint32x4_t state1 = vld1q_u32(dither->state);
+    uint32x4_t state2 = vld1q_u32(dither->state + 4);
+    Uint8 *dst = (Uint8 *) _dst;
+
+    /* Every block reads its input before writing output no bigger than it, so this works in place. */
+    if (bits == 8) {
+        const uint8x16_t flip = vdupq_n_u8(SDL_AUDIO_ISSIGNED(format) ? 0 : 0x80);
+        while (samples >= 16) {
+            const int32x4_t a = DitherFour_NEON(src, &state1, noisy, amplitude, scale, offset, maxval, mmbias);
+            const int32x4_t b = DitherFour_NEON(src + 4, &state2, noisy, amplitude, scale, offset, maxval, mmbias);
+            const int32x4_t c = DitherFour_NEON(src + 8, &state1, noisy, amplitude, scale, offset, maxval, mmbias);
+            const int32x4_t d = DitherFour_NEON(src + 12, &state2, noisy, amplitude, scale, offset, maxval, mmbias);
+            const int8x16_t packed = vcombine_s8(vmovn_s16(vcombine_s16(vmovn_s32(a), vmovn_s32(b))),
+                                                 vmovn_s16(vcombine_s16(vmovn_s32(c), vmovn_s32(d))));
+            vst1q_u8(dst, veorq_u8(vreinterpretq_u8_s8(packed), flip));
+            samples -= 16; src += 16; dst += 16;
+        }
+    } else if (bits == 16) {
+        const uint16x8_t flip = vdupq_n_u16(SDL_AUDIO_ISSIGNED(format) ? 0 : 0x8000);
+        while (samples >= 8) {
+            const int32x4_t a = DitherFour_NEON(src, &state1, noisy, amplitude, scale, offset, maxval, mmbias);
+            const int32x4_t b = DitherFour_NEON(src + 4, &state2, noisy, amplitude, scale, offset, maxval, mmbias);
+            uint8x16_t packed = vreinterpretq_u8_u16(veorq_u16(vreinterpretq_u16_s16(vcombine_s16(vmovn_s32(a), vmovn_s32(b))), flip));
+            if (swap) {
+                packed = vrev16q_u8(packed);
+            }
+            vst1q_u8(dst, packed);
+            samples -= 8; src += 8; dst += 16;
+        }
+    } else {
+        /* Floats don't have the precision for dither to matter in 32 bits. */
+        const float32x4_t one = vdupq_n_f32(1.0f);
+        const float32x4_t negone = vdupq_n_f32(-1.0f);
+        const float32x4_t mulby8388607 = vdupq_n_f32(8388607.0f);
+        while (samples >= 4) {
+            uint8x16_t ints = vreinterpretq_u8_s32(vshlq_n_s32(vcvtq_s32_f32(vmulq_f32(vminq_f32(vmaxq_f32(vld1q_f32(src), negone), one), mulby8388607)), 8));
+            if (swap) {
+                ints = vrev32q_u8(ints);
+            }
+            vst1q_u8(dst, ints);
+            samples -= 4; src += 4; dst += 16;
+        }
+    }
+
+    vst1q_u32(dither->state, state1);
+    vst1q_u32(dither->state + 4, state2);
+
+    SDL_DitherAudio_Scalar(dither, src, dst, samples);  /* leftovers. */
+}
+#endif
+
+void
+SDL_InitAudioDither(SDL_AudioDither *dither, SDL_AudioFormat format, SDL_bool enabled)
+{
+    int i;
+
+    SDL_assert(!SDL_AUDIO_ISFLOAT(format));
+
+    dither->format = format;
+    /* floats only have 24 bits of precision, so 32-bit output gains nothing from dither. */
+    dither->amplitude = (enabled && (SDL_AUDIO_BITSIZE(format) <= 16)) ? 1.0f : 0.0f;
+    /* any nonzero seeds work, fixed ones keep the output repeatable. */
+    for (i = 0; i < SDL_arraysize(dither->state); i++) {
+        dither->state[i] = 0x9E3779B9 * (Uint32) (i + 1);
+    }
+
+    dither->func = SDL_DitherAudio_Scalar;
+#if HAVE_SSE2_INTRINSICS
+    if (SDL_HasSSE2()) {
+        dither->func = SDL_DitherAudio_SSE2;
+    }
+#endif
+#if HAVE_NEON_INTRINSICS
+    if (SDL_HasNEON()) {
+        dither->func = SDL_DitherAudio_NEON;
+    }
+#endif
+}
+
+int
+SDL_DitherAudio(SDL_AudioDither *dither, const float *src, void *dst, int samples)
+{
+    dither->func(dither, src, dst, samples);
+    return samples * (SDL_AUDIO_BITSIZE(dither->format) / 8);
+}
+
+
 void SDL_ChooseAudioConverters(void)
 {
     static SDL_bool converters_chosen = SDL_FALSE;
@@ -26,6 +26,15 @@
 #include "SDL_timer.h"
 #include "SDL_audio.h"
 #include "SDL_sysaudio.h"
+#include "SDL_audio_c.h"
+
+#ifdef __SSE2__
+#define HAVE_SSE2_INTRINSICS 1
+#endif
+
+#ifdef __ARM_NEON
+#define HAVE_NEON_INTRINSICS 1
+#endif
 
 /* This table is used to add two sound values together and pin
  * the value to avoid overflow.  (used with permission from ARDI)
@@ -366,4 +375,441 @@ SDL_MixAudioFormat(Uint8 * dst, const Uint8 * src, SDL_AudioFormat format,
     }
 }
 
+
+/* The multi-voice mixer.  Every voice is converted to float at the mixer's
+ * channels and rate by its own audio stream, scaled by a per-channel gain and
+ * summed into a float bus.  The bus is clipped only once, when it's converted
+ * to the output format, so loud voices don't clip each other.
+ */
+#define MIXER_MAX_CHANNELS 8
+
+typedef struct
+{
+    SDL_AudioStream *stream;    /* NULL if this voice isn't in use */
+    float gain;
+    float pan;
+} SDL_MixerVoice;
+
+struct _SDL_AudioMixer
+{
+    SDL_mutex *lock;
+    SDL_AudioFormat format;
+    int channels;
+    int rate;
+    int framesize;
+    SDL_AudioCVT cvt;           /* converts the bus to the output format */
+    SDL_MixerVoice *voices;
+    int num_voices;
+    float *bus;
+    float *work;
+    int buslen;                 /* size of bus and work in bytes */
+
+    /* The gains of a voice repeated for four frames, so a SIMD register
+       always holds the gains for the same channels. */
+    float gains[MIXER_MAX_CHANNELS * 4];
+};
+
+typedef void (*SDL_MixerAddFunc)(float *bus, const float *src, const float *gains, int rowlen, int num_samples);
+typedef void (*SDL_MixerClampFunc)(float *dst, const float *src, int num_samples);
+
+static void
+SDL_MixerAdd_Scalar(float *bus, const float *src, const float *gains, int rowlen, int num_samples)
+{
+    int i, j;
+    for (i = 0; i < num_samples; i += rowlen) {
+        const int count = SDL_min(rowlen, num_samples - i);
+        for (j = 0; j < count; ++j) {
+            bus[i + j] += src[i + j] * gains[j];
+        }
+    }
+}
+
+static void
+SDL_MixerClamp_Scalar(float *dst, const float *src, int num_samples)
+{
+    int i;
+    for (i = 0; i < num_samples; ++i) {
+        const float sample = src[i];
+        dst[i] = (sample > 1.0f) ? 1.0f : (sample < -1.0f) ? -1.0f : sample;
+    }
+}
+
+#if HAVE_SSE2_INTRINSICS
+static void
+SDL_MixerAdd_SSE2(float *bus, const float *src, const float *gains, int rowlen, int num_samples)
+{
+    int i = 0, j;
+
+    /* rowlen is always a multiple of four */
+    for (; i + rowlen <= num_samples; i += rowlen) {
+        for (j = 0; j < rowlen; j += 4) {
+            const __m128 sum = _mm_add_ps(_mm_loadu_ps(&bus[i + j]), _mm_mul_ps(_mm_loadu_ps(&src[i + j]), _mm_loadu_ps(&gains[j])));
+            _mm_storeu_ps(&bus[i + j], sum);
+        }
+    }
+    SDL_MixerAdd_Scalar(bus + i, src + i, gains, rowlen, num_samples - i);
+}
+
+static void
+SDL_MixerClamp_SSE2(float *dst, const float *src, int num_samples)
+{
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 negone = _mm_set1_ps(-1.0f);
+    int i = 0;
+
+    for (; i + 4 <= num_samples; i += 4) {
+        _mm_storeu_ps(&dst[i], _mm_max_ps(negone, _mm_min_ps(one, _mm_loadu_ps(&src[i]))));
+    }
+    SDL_MixerClamp_Scalar(dst + i, src + i, num_samples - i);
+}
+#endif
+
+#if HAVE_NEON_INTRINSICS
+static void
+SDL_MixerAdd_NEON(float *bus, const float *src, const float *gains, int rowlen, int num_samples)
+{
+    int i = 0, j;
+
+    for (; i + rowlen <= num_samples; i += rowlen) {
+        for (j = 0; j < rowlen; j += 4) {
+            vst1q_f32(&bus[i + j], vmlaq_f32(vld1q_f32(&bus[i + j]), vld1q_f32(&src[i + j]), vld1q_f32(&gains[j])));
+        }
+    }
+    SDL_MixerAdd_Scalar(bus + i, src + i, gains, rowlen, num_samples - i);
+}
+
+static void
+SDL_MixerClamp_NEON(float *dst, const float *src, int num_samples)
+{
+    const float32x4_t one = vdupq_n_f32(1.0f);
+    const float32x4_t negone = vdupq_n_f32(-1.0f);
+    int i = 0;
+
+    for (; i + 4 <= num_samples; i += 4) {
+        vst1q_f32(&dst[i], vmaxq_f32(negone, vminq_f32(one, vld1q_f32(&src[i]))));
+    }
+    SDL_MixerClamp_Scalar(dst + i, src + i, num_samples - i);
+}
+#endif
+
+static SDL_MixerAddFunc SDL_MixerAdd = NULL;
+static SDL_MixerClampFunc SDL_MixerClamp = NULL;
+
+static void
+SDL_ChooseMixerFuncs(void)
+{
+    if (SDL_MixerAdd) {
+        return;
+    }
+#if HAVE_SSE2_INTRINSICS
+    if (SDL_HasSSE2()) {
+        SDL_MixerClamp = SDL_MixerClamp_SSE2;
+        SDL_MixerAdd = SDL_MixerAdd_SSE2;
+        return;
+    }
+#endif
+#if HAVE_NEON_INTRINSICS
+    if (SDL_HasNEON()) {
+        SDL_MixerClamp = SDL_MixerClamp_NEON;
+        SDL_MixerAdd = SDL_MixerAdd_NEON;
+        return;
+    }
+#endif
+    SDL_MixerClamp = SDL_MixerClamp_Scalar;
+    SDL_MixerAdd = SDL_MixerAdd_Scalar;
+}
+
+/* Which side of the listener each channel is on: -1 left, 1 right, 0 neither.
+   This follows the channel layouts documented with SDL_AudioSpec. */
+static const Sint8 mixer_channel_sides[MIXER_MAX_CHANNELS][MIXER_MAX_CHANNELS] = {
+    { 0 },                                  /* mono */
+    { -1, 1 },                              /* FL FR */
+    { -1, 1, 0 },                           /* FL FR LFE */
+    { -1, 1, -1, 1 },                       /* FL FR BL BR */
+    { -1, 1, 0, -1, 1 },                    /* FL FR FC BL BR */
+    { -1, 1, 0, 0, -1, 1 },                 /* FL FR FC LFE SL SR */
+    { -1, 1, 0, 0, 0, -1, 1 },              /* FL FR FC LFE BC SL SR */
+    { -1, 1, 0, 0, -1, 1, -1, 1 }           /* FL FR FC LFE BL BR SL SR */
+};
+
+static void
+SDL_MixerFillGains(SDL_AudioMixer *mixer, const SDL_MixerVoice *voice)
+{
+    const int channels = mixer->channels;
+    int chan, i;
+
+    for (chan = 0; chan < channels; ++chan) {
+        const int side = mixer_channel_sides[channels - 1][chan];
+        float gain = voice->gain;
+        if (side < 0 && voice->pan > 0.0f) {
+            gain *= 1.0f - voice->pan;
+        } else if (side > 0 && voice->pan < 0.0f) {
+            gain *= 1.0f + voice->pan;
+        }
+        for (i = 0; i < 4; ++i) {
+            mixer->gains[i * channels + chan] = gain;
+        }
+    }
+}
+
+static SDL_MixerVoice *
+SDL_GetMixerVoice(SDL_AudioMixer *mixer, int voice)
+{
+    if (!mixer) {
+        SDL_InvalidParamError("mixer");
+        return NULL;
+    }
+    if (voice < 0 || voice >= mixer->num_voices || !mixer->voices[voice].stream) {
+        SDL_SetError("Invalid mixer voice");
+        return NULL;
+    }
+    return &mixer->voices[voice];
+}
+
+SDL_AudioMixer *
+SDL_CreateAudioMixer(SDL_AudioFormat format, Uint8 channels, int rate)
+{
+    SDL_AudioMixer *mixer;
+
+    if (channels < 1 || channels > MIXER_MAX_CHANNELS) {
+        SDL_SetError("Unsupported number of mixer channels");
+        return NULL;
+    }
+    if (rate <= 0) {
+        SDL_InvalidParamError("rate");
+        return NULL;
+    }
+
+    mixer = (SDL_AudioMixer *) SDL_calloc(1, sizeof (*mixer));
+    if (!mixer) {
+        SDL_OutOfMemory();
+        return NULL;
+    }
+    mixer->format = format;
+    mixer->channels = channels;
+    mixer->rate = rate;
+    mixer->framesize = (SDL_AUDIO_BITSIZE(format) / 8) * channels;
+
+    if (SDL_BuildAudioCVT(&mixer->cvt, AUDIO_F32SYS, channels, rate, format, channels, rate) < 0) {
+        SDL_free(mixer);
+        return NULL;
+    }
+
+    mixer->lock = SDL_CreateMutex();
+    if (!mixer->lock) {
+        SDL_free(mixer);
+        return NULL;
+    }
+
+    SDL_ChooseMixerFuncs();
+    return mixer;
+}
+
+int
+SDL_AudioMixerAddVoice(SDL_AudioMixer *mixer, SDL_AudioFormat format, Uint8 channels, int rate)
+{
+    SDL_AudioStream *stream;
+    int i;
+
+    if (!mixer) {
+        return SDL_InvalidParamError("mixer");
+    }
+
+    stream = SDL_NewAudioStream(format, channels, rate, AUDIO_F32SYS, (Uint8) mixer->channels, mixer->rate);
+    if (!stream) {
+        return -1;
+    }
+
+    SDL_LockMutex(mixer->lock);
+    for (i = 0; i < mixer->num_voices; ++i) {
+        if (!mixer->voices[i].stream) {
+            break;
+        }
+    }
+    if (i == mixer->num_voices) {
+        const int num_voices = mixer->num_voices ? (mixer->num_voices * 2) : 16;
+        SDL_MixerVoice *voices = (SDL_MixerVoice *) SDL_realloc(mixer->voices, num_voices * sizeof (*voices));
+        if (!voices) {
+            SDL_UnlockMutex(mixer->lock);
+            SDL_FreeAudioStream(stream);
+            return SDL_OutOfMemory();
+        }
+        SDL_memset(&voices[mixer->num_voices], 0, (num_voices - mixer->num_voices) * sizeof (*voices));
+        mixer->voices = voices;
+        mixer->num_voices = num_voices;
+    }
+    mixer->voices[i].stream = stream;
+    mixer->voices[i].gain = 1.0f;
+    mixer->voices[i].pan = 0.0f;
+    SDL_UnlockMutex(mixer->lock);
+
+    return i;
+}
+
+int
+SDL_AudioMixerPutVoice(SDL_AudioMixer *mixer, int voice, const void *buf, int len)
+{
+    SDL_MixerVoice *v;
+    int retval;
+
+    if (!mixer) {
+        return SDL_InvalidParamError("mixer");
+    }
+
+    SDL_LockMutex(mixer->lock);
+    v = SDL_GetMixerVoice(mixer, voice);
+    retval = v ? SDL_AudioStreamPut(v->stream, buf, len) : -1;
+    SDL_UnlockMutex(mixer->lock);
+    return retval;
+}
+
+int
+SDL_AudioMixerSetVoiceGain(SDL_AudioMixer *mixer, int voice, float gain, float pan)
+{
+    SDL_MixerVoice *v;
+
+    if (!mixer) {
+        return SDL_InvalidParamError("mixer");
+    }
+
+    SDL_LockMutex(mixer->lock);
+    v = SDL_GetMixerVoice(mixer, voice);
+    if (v) {
+        v->gain = gain;
+        v->pan = SDL_max(-1.0f, SDL_min(pan, 1.0f));
+    }
+    SDL_UnlockMutex(mixer->lock);
+    return v ? 0 : -1;
+}
+
+int
+SDL_AudioMixerVoiceQueued(SDL_AudioMixer *mixer, int voice)
+{
+    SDL_MixerVoice *v;
+    int retval;
+
+    if (!mixer) {
+        return SDL_InvalidParamError("mixer");
+    }
+
+    SDL_LockMutex(mixer->lock);
+    v = SDL_GetMixerVoice(mixer, voice);
+    retval = v ? SDL_AudioStreamAvailable(v->stream) : -1;
+    SDL_UnlockMutex(mixer->lock);
+    return retval;
+}
+
+void
+SDL_AudioMixerRemoveVoice(SDL_AudioMixer *mixer, int voice)
+{
+    SDL_MixerVoice *v;
+
+    if (!mixer) {
+        return;
+    }
+
+    SDL_LockMutex(mixer->lock);
+    v = SDL_GetMixerVoice(mixer, voice);
+    if (v) {
+        SDL_FreeAudioStream(v->stream);
+        v->stream = NULL;
+    }
+    SDL_UnlockMutex(mixer->lock);
+}
+
+void
+SDL_AudioMixerRender(SDL_AudioMixer *mixer, Uint8 *stream, int len)
+{
+    int rowlen, rendered, num_samples, buslen, i;
+
+    if (!mixer) {
+        /* Without a mixer there is no format to take the silence value from */
+        SDL_memset(stream, 0, len);
+        SDL_InvalidParamError("mixer");
+        return;
+    }
+
+    rowlen = mixer->channels * 4;
+    rendered = (len / mixer->framesize) * mixer->framesize;
+    num_samples = (len / mixer->framesize) * mixer->channels;
+    buslen = num_samples * (int) sizeof (float);
+
+    SDL_LockMutex(mixer->lock);
+
+    if (buslen > mixer->buslen) {
+        float *bus = (float *) SDL_realloc(mixer->bus, buslen);
+        float *work = bus ? (float *) SDL_realloc(mixer->work, buslen) : NULL;
+        if (bus) {
+            mixer->bus = bus;
+        }
+        if (!work) {
+            SDL_UnlockMutex(mixer->lock);
+            SDL_memset(stream, SDL_SilenceValueForFormat(mixer->format), len);
+            return;
+        }
+        mixer->work = work;
+        mixer->buslen = buslen;
+    }
+
+    SDL_memset(mixer->bus, 0, buslen);
+    for (i = 0; i < mixer->num_voices; ++i) {
+        SDL_MixerVoice *voice = &mixer->voices[i];
+        int got;
+
+        if (!voice->stream || voice->gain == 0.0f) {
+            continue;
+        }
+        got = SDL_AudioStreamGet(voice->stream, mixer->work, buslen);
+        if (got <= 0) {
+            continue;
+        }
+        SDL_MixerFillGains(mixer, voice);
+        SDL_MixerAdd(mixer->bus, mixer->work, mixer->gains, rowlen, got / (int) sizeof (float));
+    }
+
+    /* Clip once, on the way out */
+    if (!mixer->cvt.needed) {
+        SDL_MixerClamp((float *) stream, mixer->bus, num_samples);
+    } else {
+        SDL_MixerClamp(mixer->bus, mixer->bus, num_samples);
+        mixer->cvt.buf = (Uint8 *) mixer->bus;
+        mixer->cvt.len = buslen;
+        SDL_ConvertAudio(&mixer->cvt);
+        SDL_memcpy(stream, mixer->bus, mixer->cvt.len_cvt);
+    }
+
+    /* A partial frame at the end can't be mixed, so it stays silent */
+    if (rendered < len) {
+        SDL_memset(stream + rendered, SDL_SilenceValueForFormat(mixer->format), len - rendered);
+    }
+
+    SDL_UnlockMutex(mixer->lock);
+}
+
+void SDLCALL
+SDL_AudioMixerCallback(void *userdata, Uint8 *stream, int len)
+{
+    SDL_AudioMixerRender((SDL_AudioMixer *) userdata, stream, len);
+}
+
+void
+SDL_FreeAudioMixer(SDL_AudioMixer *mixer)
+{
+    int i;
+
+    if (!mixer) {
+        return;
+    }
+    for (i = 0; i < mixer->num_voices; ++i) {
+        if (mixer->voices[i].stream) {
+            SDL_FreeAudioStream(mixer->voices[i].stream);
+        }
+    }
+    SDL_DestroyMutex(mixer->lock);
+    SDL_free(mixer->voices);
+    SDL_free(mixer->bus);
+    SDL_free(mixer->work);
+    SDL_free(mixer);
+}
+
 /* vi: set ts=4 sw=4 expandtab: */
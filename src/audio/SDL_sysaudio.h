@@ -127,6 +127,21 @@ typedef struct SDL_AudioDriver
 } SDL_AudioDriver;
 
 
+/* Timing statistics in performance counter ticks, see SDL_GetAudioDeviceStats() */
+typedef struct SDL_AudioDeviceTimes
+{
+    Uint64 last_wake;
+    Uint64 jitter_total;
+    Uint64 jitter_max;
+    Uint64 callback_total;
+    Uint64 callback_max;
+    Uint32 periods;
+    Uint32 late_periods;
+    Uint32 callbacks;
+    Uint32 callback_histogram[SDL_AUDIO_STATS_HISTOGRAM_SIZE];
+    Uint32 stream_fill;
+} SDL_AudioDeviceTimes;
+
 /* Define the SDL audio driver structure */
 struct SDL_AudioDevice
 {
@@ -149,6 +164,13 @@ struct SDL_AudioDevice
     SDL_atomic_t paused;
     SDL_bool iscapture;
 
+    /* Holds the callback output that didn't fit in the last device buffer,
+       when the callback only differs from the device in buffer size.
+       NULL if not needed. */
+    Uint8 *rebuffer;
+    Uint32 rebuffer_pos;    /* offset of the pending bytes */
+    Uint32 rebuffer_len;    /* number of pending bytes */
+
     /* Scratch buffer used in the bridge between SDL and the user callback. */
     Uint8 *work_buffer;
 
@@ -165,6 +187,22 @@ struct SDL_AudioDevice
     /* Queued buffers (if app not using callback). */
     SDL_DataQueue *buffer_queue;
 
+    /* Fixed size ring used for queued audio instead of buffer_queue when
+       SDL_HINT_AUDIO_QUEUE_RING_SIZE is set. The app thread and the audio
+       thread each move only one end, so neither needs the mixer lock. */
+    Uint8 *ring;
+    Uint32 ring_size;       /* always a power of two */
+    SDL_atomic_t ring_head; /* total bytes written, wrapping */
+    SDL_atomic_t ring_tail; /* total bytes read, wrapping */
+
+    /* Times queued playback ran dry or queued capture had to drop data. */
+    SDL_atomic_t xruns;
+    SDL_bool starved;
+
+    /* Written by the audio thread, read by SDL_GetAudioDeviceStats(). */
+    SDL_SpinLock stats_lock;
+    SDL_AudioDeviceTimes stats;
+
     /* * * */
     /* Data private to this driver */
     struct SDL_PrivateAudioData *hidden;
@@ -36,10 +36,19 @@
 
 #include "SDL_log.h"
 #include "SDL_hints.h"
+#include "SDL_cpuinfo.h"
 #include "SDL_audio.h"
 #include "SDL_wave.h"
 #include "SDL_audio_c.h"
 
+#ifdef __SSE2__
+#define HAVE_SSE2_INTRINSICS 1
+#endif
+
+#ifdef __ARM_NEON
+#define HAVE_NEON_INTRINSICS 1
+#endif
+
 /* Reads the value stored at the location of the f1 pointer, multiplies it
  * with the second argument and then stores the result to f1.
  * Returns 0 on success, or -1 if the multiplication overflows, in which case f1
@@ -103,6 +112,16 @@ typedef struct MS_ADPCM_ChannelState
     Sint16 coeff2;
 } MS_ADPCM_ChannelState;
 
+/* The IMA ADPCM step calculation and index update for every combination of
+ * step index and nibble, so the decoder only has to look them up. The channel
+ * state is the step index, which is always kept in the valid range.
+ */
+typedef struct IMA_ADPCM_DecoderData
+{
+    Sint32 delta[89 * 16];
+    Uint8 nextindex[89 * 16];
+} IMA_ADPCM_DecoderData;
+
 #ifdef SDL_WAVE_DEBUG_LOG_FORMAT
 static void
 WaveDebugLogFormat(WaveFile *file)
@@ -508,7 +527,7 @@ MS_ADPCM_ProcessNibble(MS_ADPCM_ChannelState *cstate, Sint32 sample1, Sint32 sam
 
     new_sample = (sample1 * cstate->coeff1 + sample2 * cstate->coeff2) / 256;
     /* The nibble is a signed 4-bit error delta. */
-    errordelta = (Sint32)nybble - (nybble >= 0x08 ? 0x10 : 0);
+    errordelta = ((Sint32)nybble ^ 0x08) - 0x08;
     new_sample += (Sint32)delta * errordelta;
     if (new_sample < min_audioval) {
         new_sample = min_audioval;
@@ -593,49 +612,79 @@ MS_ADPCM_DecodeBlockHeader(ADPCM_DecoderState *state)
 static int
 MS_ADPCM_DecodeBlockData(ADPCM_DecoderState *state)
 {
-    Uint16 nybble = 0;
-    Sint16 sample1, sample2;
     const Uint32 channels = state->channels;
-    Uint32 c;
     MS_ADPCM_ChannelState *cstate = (MS_ADPCM_ChannelState *)state->cstate;
+    Sint16 *output = state->output.data;
 
     size_t blockpos = state->block.pos;
     size_t blocksize = state->block.size;
 
     size_t outpos = state->output.pos;
 
+    /* Each sample depends on the two before it. Keeping them and the channel
+     * states in locals instead of reloading them from the output lets the
+     * channels of a stereo stream decode in parallel.
+     */
+    MS_ADPCM_ChannelState left = cstate[0];
+    MS_ADPCM_ChannelState right = cstate[channels - 1];
+    Sint16 left1 = output[outpos - channels];
+    Sint16 left2 = output[outpos - channels * 2];
+    Sint16 right1 = output[outpos - 1];
+    Sint16 right2 = output[outpos - 1 - channels];
+    int result = 0;
+
     Sint64 blockframesleft = state->samplesperblock - 2;
     if (blockframesleft > state->framesleft) {
         blockframesleft = state->framesleft;
     }
 
     while (blockframesleft > 0) {
-        for (c = 0; c < channels; c++) {
-            if (nybble & 0x4000) {
-                nybble <<= 4;
-            } else if (blockpos < blocksize) {
-                nybble = state->block.data[blockpos++] | 0x4000;
-            } else {
-                /* Out of input data. Drop the incomplete frame and return. */
-                state->output.pos = outpos - c;
-                return -1;
-            }
-
-            /* Load previous samples which may come from the block header. */
-            sample1 = state->output.data[outpos - channels];
-            sample2 = state->output.data[outpos - channels * 2];
+        Uint8 nybbles;
+        Sint16 sample;
+
+        if (blockpos < blocksize) {
+            nybbles = state->block.data[blockpos++];
+        } else {
+            /* Out of input data. Return. */
+            result = -1;
+            break;
+        }
 
-            sample1 = MS_ADPCM_ProcessNibble(cstate + c, sample1, sample2, (nybble >> 4) & 0x0f);
-            state->output.data[outpos++] = sample1;
+        /* The high nibble comes first. */
+        sample = MS_ADPCM_ProcessNibble(&left, left1, left2, nybbles >> 4);
+        left2 = left1;
+        left1 = sample;
+
+        if (channels == 2) {
+            output[outpos++] = sample;
+            sample = MS_ADPCM_ProcessNibble(&right, right1, right2, nybbles & 0x0f);
+            right2 = right1;
+            right1 = sample;
+            output[outpos++] = sample;
+        } else {
+            output[outpos++] = sample;
+            state->framesleft--;
+            if (--blockframesleft == 0) {
+                break;
+            }
+            sample = MS_ADPCM_ProcessNibble(&left, left1, left2, nybbles & 0x0f);
+            left2 = left1;
+            left1 = sample;
+            output[outpos++] = sample;
         }
 
         state->framesleft--;
         blockframesleft--;
     }
 
+    cstate[0] = left;
+    if (channels == 2) {
+        cstate[1] = right;
+    }
+    state->block.pos = blockpos;
     state->output.pos = outpos;
 
-    return 0;
+    return result;
 }
 
 static int
@@ -792,6 +841,64 @@ IMA_ADPCM_CalculateSampleFrames(WaveFile *file, size_t datalength)
     return 0;
 }
 
+static void
+IMA_ADPCM_InitTables(IMA_ADPCM_DecoderData *ddata)
+{
+    const Sint8 index_table_4b[16] = {
+        -1, -1, -1, -1,
+        2, 4, 6, 8,
+        -1, -1, -1, -1,
+        2, 4, 6, 8
+    };
+    const Uint16 step_table[89] = {
+        7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31,
+        34, 37, 41, 45, 50, 55, 60, 66, 73, 80, 88, 97, 107, 118, 130,
+        143, 157, 173, 190, 209, 230, 253, 279, 307, 337, 371, 408,
+        449, 494, 544, 598, 658, 724, 796, 876, 963, 1060, 1166, 1282,
+        1411, 1552, 1707, 1878, 2066, 2272, 2499, 2749, 3024, 3327,
+        3660, 4026, 4428, 4871, 5358, 5894, 6484, 7132, 7845, 8630,
+        9493, 10442, 11487, 12635, 13899, 15289, 16818, 18500, 20350,
+        22385, 24623, 27086, 29794, 32767
+    };
+    size_t index;
+    Uint8 nybble;
+
+    for (index = 0; index < 89; index++) {
+        const Uint32 step = step_table[index];
+
+        for (nybble = 0; nybble < 16; nybble++) {
+            const size_t entry = index * 16 + nybble;
+            Sint32 delta, nextindex;
+
+            /* This calculation uses shifts and additions because multiplications were
+             * much slower back then. Sadly, this can't just be replaced with an actual
+             * multiplication now as the old algorithm drops some bits. The closest
+             * approximation I could find is something like this:
+             * (nybble & 0x8 ? -1 : 1) * ((nybble & 0x7) * step / 4 + step / 8)
+             */
+            delta = step >> 3;
+            if (nybble & 0x04)
+                delta += step;
+            if (nybble & 0x02)
+                delta += step >> 1;
+            if (nybble & 0x01)
+                delta += step >> 2;
+            if (nybble & 0x08)
+                delta = -delta;
+            ddata->delta[entry] = delta;
+
+            /* Clamp index into valid range. */
+            nextindex = (Sint32)index + index_table_4b[nybble];
+            if (nextindex > 88) {
+                nextindex = 88;
+            } else if (nextindex < 0) {
+                nextindex = 0;
+            }
+            ddata->nextindex[entry] = (Uint8)nextindex;
+        }
+    }
+}
+
 static int
 IMA_ADPCM_Init(WaveFile *file, size_t datalength)
 {
@@ -851,6 +958,12 @@ IMA_ADPCM_Init(WaveFile *file, size_t datalength)
         return SDL_SetError("Invalid number of samples per IMA ADPCM block (wSamplesPerBlock)");
     }
 
+    file->decoderdata = SDL_malloc(sizeof(IMA_ADPCM_DecoderData)); /* Freed in cleanup. */
+    if (file->decoderdata == NULL) {
+        return SDL_OutOfMemory();
+    }
+    IMA_ADPCM_InitTables((IMA_ADPCM_DecoderData *)file->decoderdata);
+
     if (IMA_ADPCM_CalculateSampleFrames(file, datalength) < 0) {
         return -1;
     }
@@ -859,60 +972,15 @@ IMA_ADPCM_Init(WaveFile *file, size_t datalength)
 }
 
 static Sint16
-IMA_ADPCM_ProcessNibble(Sint8 *cindex, Sint16 lastsample, Uint8 nybble)
+IMA_ADPCM_ProcessNibble(const IMA_ADPCM_DecoderData *ddata, Uint8 *cindex, Sint16 lastsample, Uint8 nybble)
 {
     const Sint32 max_audioval = 32767;
     const Sint32 min_audioval = -32768;
-    const Sint8 index_table_4b[16] = {
-        -1, -1, -1, -1,
-        2, 4, 6, 8,
-        -1, -1, -1, -1,
-        2, 4, 6, 8
-    };
-    const Uint16 step_table[89] = {
-        7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31,
-        34, 37, 41, 45, 50, 55, 60, 66, 73, 80, 88, 97, 107, 118, 130,
-        143, 157, 173, 190, 209, 230, 253, 279, 307, 337, 371, 408,
-        449, 494, 544, 598, 658, 724, 796, 876, 963, 1060, 1166, 1282,
-        1411, 1552, 1707, 1878, 2066, 2272, 2499, 2749, 3024, 3327,
-        3660, 4026, 4428, 4871, 5358, 5894, 6484, 7132, 7845, 8630,
-        9493, 10442, 11487, 12635, 13899, 15289, 16818, 18500, 20350,
-        22385, 24623, 27086, 29794, 32767
-    };
-    Uint32 step;
-    Sint32 sample, delta;
-    Sint8 index = *cindex;
-
-    /* Clamp index into valid range. */
-    if (index > 88) {
-        index = 88;
-    } else if (index < 0) {
-        index = 0;
-    }
-
-    /* explicit cast to avoid gcc warning about using 'char' as array index */
-    step = step_table[(size_t)index];
+    const size_t entry = (size_t)*cindex * 16 + nybble;
+    Sint32 sample = lastsample + ddata->delta[entry];
 
     /* Update index value */
-    *cindex = index + index_table_4b[nybble];
-
-    /* This calculation uses shifts and additions because multiplications were
-     * much slower back then. Sadly, this can't just be replaced with an actual
-     * multiplication now as the old algorithm drops some bits. The closest
-     * approximation I could find is something like this:
-     * (nybble & 0x8 ? -1 : 1) * ((nybble & 0x7) * step / 4 + step / 8)
-     */
-    delta = step >> 3;
-    if (nybble & 0x04)
-        delta += step;
-    if (nybble & 0x02)
-        delta += step >> 1;
-    if (nybble & 0x01)
-        delta += step >> 2;
-    if (nybble & 0x08)
-        delta = -delta;
-
-    sample = lastsample + delta;
+    *cindex = ddata->nextindex[entry];
 
     /* Clamp output sample */
     if (sample > max_audioval) {
@@ -928,6 +996,7 @@ static int
 IMA_ADPCM_DecodeBlockHeader(ADPCM_DecoderState *state)
 {
     Sint16 step;
+    Sint8 index;
     Uint32 c;
     Uint8 *cstate = state->cstate;
 
@@ -941,9 +1010,10 @@ IMA_ADPCM_DecodeBlockHeader(ADPCM_DecoderState *state)
         }
         state->output.data[state->output.pos++] = (Sint16)sample;
 
-        /* Channel step index. */
+        /* Channel step index, clamped into the valid range. */
         step = (Sint16)state->block.data[o + 2];
-        cstate[c] = (Sint8)(step > 0x80 ? step - 0x100 : step);
+        index = (Sint8)(step > 0x80 ? step - 0x100 : step);
+        cstate[c] = index > 88 ? 88 : (index < 0 ? 0 : index);
 
         /* Reserved byte in block header, should be 0. */
         if (state->block.data[o + 3] != 0) {
@@ -971,6 +1041,8 @@ IMA_ADPCM_DecodeBlockData(ADPCM_DecoderState *state)
     int retval = 0;
     const Uint32 channels = state->channels;
     const size_t subblockframesize = channels * 4;
+    const IMA_ADPCM_DecoderData *ddata = (const IMA_ADPCM_DecoderData *)state->ddata;
+    Uint8 *cstate = (Uint8 *)state->cstate;
     Uint64 bytesrequired;
     Uint32 c;
 
@@ -1018,7 +1090,7 @@ IMA_ADPCM_DecodeBlockData(ADPCM_DecoderState *state)
                     nybble = state->block.data[blockpos++];
                 }
 
-                sample = IMA_ADPCM_ProcessNibble((Sint8 *)state->cstate + c, sample, nybble & 0x0f);
+                sample = IMA_ADPCM_ProcessNibble(ddata, cstate + c, sample, nybble & 0x0f);
                 state->output.data[outpos + c + i * channels] = sample;
             }
         }
@@ -1063,6 +1135,7 @@ IMA_ADPCM_Decode(WaveFile *file, Uint8 **audio_buf, Uint32 *audio_len)
     state.blockheadersize = (size_t)state.channels * 4;
     state.samplesperblock = file->format.samplesperblock;
     state.framesize = state.channels * sizeof(Sint16);
+    state.ddata = file->decoderdata;
     state.framestotal = file->sampleframes;
     state.framesleft = state.framestotal;
 
@@ -1167,8 +1240,128 @@ LAW_Init(WaveFile *file, size_t datalength)
     return 0;
 }
 
+#if HAVE_SSE2_INTRINSICS
+/* Shifts each lane of v left by the number of bits in the same lane of amount (0 to 7). */
+static __m128i
+LAW_ShiftLeft_SSE2(__m128i v, __m128i amount)
+{
+    const __m128i one = _mm_set1_epi16(1);
+    const __m128i two = _mm_set1_epi16(2);
+    const __m128i four = _mm_set1_epi16(4);
+    __m128i mask;
+
+    mask = _mm_cmpeq_epi16(_mm_and_si128(amount, one), one);
+    v = _mm_or_si128(_mm_andnot_si128(mask, v), _mm_and_si128(mask, _mm_slli_epi16(v, 1)));
+    mask = _mm_cmpeq_epi16(_mm_and_si128(amount, two), two);
+    v = _mm_or_si128(_mm_andnot_si128(mask, v), _mm_and_si128(mask, _mm_slli_epi16(v, 2)));
+    mask = _mm_cmpeq_epi16(_mm_and_si128(amount, four), four);
+    return _mm_or_si128(_mm_andnot_si128(mask, v), _mm_and_si128(mask, _mm_slli_epi16(v, 4)));
+}
+
+/* Expands eight companded samples that were zero-extended to 16 bits. */
+static __m128i
+LAW_Expand_SSE2(Uint16 encoding, __m128i x)
+{
+    const __m128i mask4 = _mm_set1_epi16(0x0f);
+    const __m128i mask3 = _mm_set1_epi16(0x07);
+    const __m128i signbit = _mm_set1_epi16(0x80);
+    __m128i mantissa, exponent, negate;
+
+    if (encoding == ALAW_CODE) {
+        const __m128i e = _mm_xor_si128(_mm_and_si128(x, _mm_set1_epi16(0x7f)), _mm_set1_epi16(0x55));
+        exponent = _mm_srli_epi16(e, 4);
+        mantissa = _mm_or_si128(_mm_slli_epi16(_mm_and_si128(e, mask4), 4), _mm_set1_epi16(0x08));
+        /* The implicit leading one, except for the lowest segment. */
+        mantissa = _mm_or_si128(mantissa, _mm_and_si128(_mm_cmpgt_epi16(exponent, _mm_setzero_si128()), _mm_set1_epi16(0x100)));
+        mantissa = LAW_ShiftLeft_SSE2(mantissa, _mm_subs_epu16(exponent, _mm_set1_epi16(1)));
+        negate = _mm_cmpeq_epi16(_mm_and_si128(x, signbit), _mm_setzero_si128());
+    } else {
+        const __m128i bias = _mm_set1_epi16(0x84);
+        const __m128i n = _mm_xor_si128(x, _mm_set1_epi16(0xff));
+        exponent = _mm_and_si128(_mm_srli_epi16(n, 4), mask3);
+        mantissa = _mm_add_epi16(_mm_slli_epi16(_mm_and_si128(n, mask4), 3), bias);
+        mantissa = _mm_sub_epi16(LAW_ShiftLeft_SSE2(mantissa, exponent), bias);
+        negate = _mm_cmpeq_epi16(_mm_and_si128(n, signbit), signbit);
+    }
+
+    /* Two's complement negation where the mask is set. */
+    return _mm_sub_epi16(_mm_xor_si128(mantissa, negate), negate);
+}
+
+/* Expands the last 16-byte chunks of src. Returns the number of samples left at the start. */
+static size_t
+LAW_DecodeSamples_SSE2(Uint16 encoding, const Uint8 *src, Sint16 *dst, size_t sample_count)
+{
+    const __m128i zero = _mm_setzero_si128();
+    size_t i = sample_count;
+
+    /* Going backwards, a store never overwrites source bytes that weren't loaded yet. */
+    while (i >= 16) {
+        __m128i x;
+        i -= 16;
+        x = _mm_loadu_si128((const __m128i *)(src + i));
+        _mm_storeu_si128((__m128i *)(dst + i + 8), LAW_Expand_SSE2(encoding, _mm_unpackhi_epi8(x, zero)));
+        _mm_storeu_si128((__m128i *)(dst + i), LAW_Expand_SSE2(encoding, _mm_unpacklo_epi8(x, zero)));
+    }
+
+    return i;
+}
+#endif
+
+#if HAVE_NEON_INTRINSICS
+/* Expands eight companded samples that were zero-extended to 16 bits. */
+static int16x8_t
+LAW_Expand_NEON(Uint16 encoding, uint16x8_t x)
+{
+    const uint16x8_t mask4 = vdupq_n_u16(0x0f);
+    const uint16x8_t signbit = vdupq_n_u16(0x80);
+    uint16x8_t mantissa, exponent, negate;
+
+    if (encoding == ALAW_CODE) {
+        const uint16x8_t e = veorq_u16(vandq_u16(x, vdupq_n_u16(0x7f)), vdupq_n_u16(0x55));
+        exponent = vshrq_n_u16(e, 4);
+        mantissa = vorrq_u16(vshlq_n_u16(vandq_u16(e, mask4), 4), vdupq_n_u16(0x08));
+        /* The implicit leading one, except for the lowest segment. */
+        mantissa = vorrq_u16(mantissa, vandq_u16(vcgtq_u16(exponent, vdupq_n_u16(0)), vdupq_n_u16(0x100)));
+        mantissa = vshlq_u16(mantissa, vreinterpretq_s16_u16(vqsubq_u16(exponent, vdupq_n_u16(1))));
+        negate = vceqq_u16(vandq_u16(x, signbit), vdupq_n_u16(0));
+    } else {
+        const uint16x8_t bias = vdupq_n_u16(0x84);
+        const uint16x8_t n = veorq_u16(x, vdupq_n_u16(0xff));
+        exponent = vandq_u16(vshrq_n_u16(n, 4), vdupq_n_u16(0x07));
+        mantissa = vaddq_u16(vshlq_n_u16(vandq_u16(n, mask4), 3), bias);
+        mantissa = vsubq_u16(vshlq_u16(mantissa, vreinterpretq_s16_u16(exponent)), bias);
+        negate = vceqq_u16(vandq_u16(n, signbit), signbit);
+    }
+
+    /* Two's complement negation where the mask is set. */
+    return vreinterpretq_s16_u16(vsubq_u16(veorq_u16(mantissa, negate), negate));
+}
+
+/* Expands the last 16-byte chunks of src. Returns the number of samples left at the start. */
+static size_t
+LAW_DecodeSamples_NEON(Uint16 encoding, const Uint8 *src, Sint16 *dst, size_t sample_count)
+{
+    size_t i = sample_count;
+
+    /* Going backwards, a store never overwrites source bytes that weren't loaded yet. */
+    while (i >= 16) {
+        uint8x16_t x;
+        i -= 16;
+        x = vld1q_u8(src + i);
+        vst1q_s16(dst + i + 8, LAW_Expand_NEON(encoding, vmovl_u8(vget_high_u8(x))));
+        vst1q_s16(dst + i, LAW_Expand_NEON(encoding, vmovl_u8(vget_low_u8(x))));
+    }
+
+    return i;
+}
+#endif
+
+/* Expands sample_count companded samples from src to 16-bit samples in dst.
+ * Works backwards, so dst can point to the same memory as src.
+ */
 static int
-LAW_Decode(WaveFile *file, Uint8 **audio_buf, Uint32 *audio_len)
+LAW_DecodeSamples(Uint16 encoding, const Uint8 *src, Sint16 *dst, size_t sample_count)
 {
 #ifdef SDL_WAVE_LAW_LUT
     const Sint16 alaw_lut[256] = {
@@ -1208,54 +1401,24 @@ LAW_Decode(WaveFile *file, Uint8 **audio_buf, Uint32 *audio_len)
         112, 104, 96, 88, 80, 72, 64, 56, 48, 40, 32, 24, 16, 8, 0
     };
 #endif
+    size_t i = sample_count;
 
-    WaveFormat *format = &file->format;
-    WaveChunk *chunk = &file->chunk;
-    size_t i, sample_count, expanded_len;
-    Uint8 *src;
-    Sint16 *dst;
-
-    if (chunk->length != chunk->size) {
-        file->sampleframes = WaveAdjustToFactValue(file, chunk->size / format->blockalign);
-        if (file->sampleframes < 0) {
-            return -1;
-        }
-    }
-
-    /* Nothing to decode, nothing to return. */
-    if (file->sampleframes == 0) {
-        *audio_buf = NULL;
-        *audio_len = 0;
-        return 0;
-    }
-
-    sample_count = (size_t)file->sampleframes;
-    if (SafeMult(&sample_count, format->channels)) {
-        return SDL_OutOfMemory();
+    if (encoding != ALAW_CODE && encoding != MULAW_CODE) {
+        return SDL_SetError("Unknown companded encoding");
     }
 
-    expanded_len = sample_count;
-    if (SafeMult(&expanded_len, sizeof(Sint16))) {
-        return SDL_OutOfMemory();
-    } else if (expanded_len > SDL_MAX_UINT32 || file->sampleframes > SIZE_MAX) {
-        return SDL_SetError("WAVE file too big");
+#if HAVE_SSE2_INTRINSICS
+    if (SDL_HasSSE2()) {
+        i = LAW_DecodeSamples_SSE2(encoding, src, dst, sample_count);
     }
-
-    /* 1 to avoid allocating zero bytes, to keep static analysis happy. */
-    src = (Uint8 *)SDL_realloc(chunk->data, expanded_len ? expanded_len : 1);
-    if (src == NULL) {
-        return SDL_OutOfMemory();
+#elif HAVE_NEON_INTRINSICS
+    if (SDL_HasNEON()) {
+        i = LAW_DecodeSamples_NEON(encoding, src, dst, sample_count);
     }
-    chunk->data = NULL;
-    chunk->size = 0;
-
-    dst = (Sint16 *)src;
+#endif
 
-    /* Work backwards, since we're expanding in-place. SDL_AudioSpec.format will
-     * inform the caller about the byte order.
-     */
-    i = sample_count;
-    switch (file->format.encoding) {
+    /* The rest, or everything without SIMD. */
+    switch (encoding) {
 #ifdef SDL_WAVE_LAW_LUT
     case ALAW_CODE:
         while (i--) {
@@ -1300,10 +1463,62 @@ LAW_Decode(WaveFile *file, Uint8 **audio_buf, Uint32 *audio_len)
         break;
 #endif
     default:
-        SDL_free(src);
         return SDL_SetError("Unknown companded encoding");
     }
 
+    return 0;
+}
+
+static int
+LAW_Decode(WaveFile *file, Uint8 **audio_buf, Uint32 *audio_len)
+{
+    WaveFormat *format = &file->format;
+    WaveChunk *chunk = &file->chunk;
+    size_t sample_count, expanded_len;
+    Uint8 *src;
+
+    if (chunk->length != chunk->size) {
+        file->sampleframes = WaveAdjustToFactValue(file, chunk->size / format->blockalign);
+        if (file->sampleframes < 0) {
+            return -1;
+        }
+    }
+
+    /* Nothing to decode, nothing to return. */
+    if (file->sampleframes == 0) {
+        *audio_buf = NULL;
+        *audio_len = 0;
+        return 0;
+    }
+
+    sample_count = (size_t)file->sampleframes;
+    if (SafeMult(&sample_count, format->channels)) {
+        return SDL_OutOfMemory();
+    }
+
+    expanded_len = sample_count;
+    if (SafeMult(&expanded_len, sizeof(Sint16))) {
+        return SDL_OutOfMemory();
+    } else if (expanded_len > SDL_MAX_UINT32 || file->sampleframes > SIZE_MAX) {
+        return SDL_SetError("WAVE file too big");
+    }
+
+    /* 1 to avoid allocating zero bytes, to keep static analysis happy. */
+    src = (Uint8 *)SDL_realloc(chunk->data, expanded_len ? expanded_len : 1);
+    if (src == NULL) {
+        return SDL_OutOfMemory();
+    }
+    chunk->data = NULL;
+    chunk->size = 0;
+
+    /* Expanding in-place. SDL_AudioSpec.format will inform the caller about
+     * the byte order.
+     */
+    if (LAW_DecodeSamples(format->encoding, src, (Sint16 *)src, sample_count) < 0) {
+        SDL_free(src);
+        return -1;
+    }
+
     *audio_buf = src;
     *audio_len = (Uint32)expanded_len;
 
@@ -1353,12 +1568,37 @@ PCM_Init(WaveFile *file, size_t datalength)
     return 0;
 }
 
+/* Shifts sample_count 24-bit samples at the start of ptr to 32 bits. The buffer
+ * must have room for the expanded samples.
+ */
+static void
+PCM_ExpandSint24ToSint32(Uint8 *ptr, size_t sample_count)
+{
+    size_t i;
+
+    /* work from end to start, since we're expanding in-place. */
+    for (i = sample_count; i > 0; i--) {
+        const size_t o = i - 1;
+        uint8_t b[4];
+
+        b[0] = 0;
+        b[1] = ptr[o * 3];
+        b[2] = ptr[o * 3 + 1];
+        b[3] = ptr[o * 3 + 2];
+
+        ptr[o * 4 + 0] = b[0];
+        ptr[o * 4 + 1] = b[1];
+        ptr[o * 4 + 2] = b[2];
+        ptr[o * 4 + 3] = b[3];
+    }
+}
+
 static int
 PCM_ConvertSint24ToSint32(WaveFile *file, Uint8 **audio_buf, Uint32 *audio_len)
 {
     WaveFormat *format = &file->format;
     WaveChunk *chunk = &file->chunk;
-    size_t i, expanded_len, sample_count;
+    size_t expanded_len, sample_count;
     Uint8 *ptr;
 
     sample_count = (size_t)file->sampleframes;
@@ -1386,21 +1626,7 @@ PCM_ConvertSint24ToSint32(WaveFile *file, Uint8 **audio_buf, Uint32 *audio_len)
     *audio_buf = ptr;
     *audio_len = (Uint32)expanded_len;
 
-    /* work from end to start, since we're expanding in-place. */
-    for (i = sample_count; i > 0; i--) {
-        const size_t o = i - 1;
-        uint8_t b[4];
-
-        b[0] = 0;
-        b[1] = ptr[o * 3];
-        b[2] = ptr[o * 3 + 1];
-        b[3] = ptr[o * 3 + 2];
-
-        ptr[o * 4 + 0] = b[0];
-        ptr[o * 4 + 1] = b[1];
-        ptr[o * 4 + 2] = b[2];
-        ptr[o * 4 + 3] = b[3];
-    }
+    PCM_ExpandSint24ToSint32(ptr, sample_count);
 
     return 0;
 }
@@ -1784,10 +2010,17 @@ WaveCheckFormat(WaveFile *file, size_t datalength)
     return 0;
 }
 
+/* Finds the fmt and data chunks, checks the format, and initializes the decoder.
+ * On success, file->chunk describes the data chunk and endposition is set to
+ * the position after the WAVE file. If streaming is set, the data chunk is not
+ * going to be read in full and the decoder gets initialized with the number of
+ * bytes in the data chunk that are actually present in src.
+ */
 static int
-WaveLoad(SDL_RWops *src, WaveFile *file, SDL_AudioSpec *spec, Uint8 **audio_buf, Uint32 *audio_len)
+WaveReadHeaders(SDL_RWops *src, WaveFile *file, SDL_AudioSpec *spec, Sint64 *endposition, SDL_bool streaming)
 {
     int result;
+    size_t datalength;
     Uint32 chunkcount = 0;
     Uint32 chunkcountlimit = 10000;
     char *envchunkcountlimit;
@@ -1985,7 +2218,22 @@ WaveLoad(SDL_RWops *src, WaveFile *file, SDL_AudioSpec *spec, Uint8 **audio_buf,
         return SDL_SetError("Could not read data of WAVE fmt chunk");
     } else if (WaveReadFormat(file) < 0) {
         return -1;
-    } else if (WaveCheckFormat(file, (size_t)datachunk.length) < 0) {
+    }
+
+    datalength = (size_t)datachunk.length;
+    if (streaming) {
+        /* The data will be read later, so check now if it's all there. */
+        Sint64 srcsize = SDL_RWsize(src);
+        if (srcsize >= 0 && (Uint64)srcsize < (Uint64)datachunk.position + datachunk.length) {
+            if (file->trunchint == TruncVeryStrict || file->trunchint == TruncStrict) {
+                return SDL_SetError("Could not read data of WAVE data chunk");
+            }
+            datalength = srcsize > datachunk.position ? (size_t)(srcsize - datachunk.position) : 0;
+        }
+        datachunk.size = datalength;
+    }
+
+    if (WaveCheckFormat(file, datalength) < 0) {
         return -1;
     }
 
@@ -1998,9 +2246,71 @@ WaveLoad(SDL_RWops *src, WaveFile *file, SDL_AudioSpec *spec, Uint8 **audio_buf,
 
     WaveFreeChunkData(chunk);
 
-    /* Process data chunk. */
     *chunk = datachunk;
 
+    /* Setting up the SDL_AudioSpec. All unsupported formats were filtered out
+     * by checks earlier in this function.
+     */
+    SDL_zerop(spec);
+    spec->freq = format->frequency;
+    spec->channels = (Uint8)format->channels;
+    spec->samples = 4096;       /* Good default buffer size */
+
+    switch (format->encoding) {
+    case MS_ADPCM_CODE:
+    case IMA_ADPCM_CODE:
+    case ALAW_CODE:
+    case MULAW_CODE:
+        /* These can be easily stored in the byte order of the system. */
+        spec->format = AUDIO_S16SYS;
+        break;
+    case IEEE_FLOAT_CODE:
+        spec->format = AUDIO_F32LSB;
+        break;
+    case PCM_CODE:
+        switch (format->bitspersample) {
+        case 8:
+            spec->format = AUDIO_U8;
+            break;
+        case 16:
+            spec->format = AUDIO_S16LSB;
+            break;
+        case 24: /* Gets shifted to 32 bits. */
+        case 32:
+            spec->format = AUDIO_S32LSB;
+            break;
+        default:
+            /* Just in case something unexpected happened in the checks. */
+            return SDL_SetError("Unexpected %u-bit PCM data format", (unsigned int)format->bitspersample);
+        }
+        break;
+    }
+
+    spec->silence = SDL_SilenceValueForFormat(spec->format);
+
+    if (RIFFlengthknown) {
+        *endposition = RIFFend;
+    } else {
+        *endposition = lastchunkpos;
+    }
+
+    return 0;
+}
+
+static int
+WaveLoad(SDL_RWops *src, WaveFile *file, SDL_AudioSpec *spec, Uint8 **audio_buf, Uint32 *audio_len)
+{
+    int result;
+    Sint64 endposition;
+    SDL_AudioSpec wavespec;
+    WaveFormat *format = &file->format;
+    WaveChunk *chunk = &file->chunk;
+
+    if (WaveReadHeaders(src, file, &wavespec, &endposition, SDL_FALSE) < 0) {
+        return -1;
+    }
+
+    /* Process data chunk. */
     if (chunk->length > 0) {
         result = WaveReadChunkData(src, chunk);
         if (result == -1) {
@@ -2044,52 +2354,10 @@ WaveLoad(SDL_RWops *src, WaveFile *file, SDL_AudioSpec *spec, Uint8 **audio_buf,
         break;
     }
 
-    /* Setting up the SDL_AudioSpec. All unsupported formats were filtered out
-     * by checks earlier in this function.
-     */
-    SDL_zerop(spec);
-    spec->freq = format->frequency;
-    spec->channels = (Uint8)format->channels;
-    spec->samples = 4096;       /* Good default buffer size */
-
-    switch (format->encoding) {
-    case MS_ADPCM_CODE:
-    case IMA_ADPCM_CODE:
-    case ALAW_CODE:
-    case MULAW_CODE:
-        /* These can be easily stored in the byte order of the system. */
-        spec->format = AUDIO_S16SYS;
-        break;
-    case IEEE_FLOAT_CODE:
-        spec->format = AUDIO_F32LSB;
-        break;
-    case PCM_CODE:
-        switch (format->bitspersample) {
-        case 8:
-            spec->format = AUDIO_U8;
-            break;
-        case 16:
-            spec->format = AUDIO_S16LSB;
-            break;
-        case 24: /* Has been shifted to 32 bits. */
-        case 32:
-            spec->format = AUDIO_S32LSB;
-            break;
-        default:
-            /* Just in case something unexpected happened in the checks. */
-            return SDL_SetError("Unexpected %u-bit PCM data format", (unsigned int)format->bitspersample);
-        }
-        break;
-    }
-
-    spec->silence = SDL_SilenceValueForFormat(spec->format);
+    *spec = wavespec;
 
     /* Report the end position back to the cleanup code. */
-    if (RIFFlengthknown) {
-        chunk->position = RIFFend;
-    } else {
-        chunk->position = lastchunkpos;
-    }
+    chunk->position = endposition;
 
     return 0;
 }
@@ -2153,4 +2421,349 @@ SDL_FreeWAV(Uint8 *audio_buf)
     SDL_free(audio_buf);
 }
 
+/* Number of sample frames the stream decodes at once for the formats without
+ * blocks. ADPCM always gets decoded one block at a time.
+ */
+#define WAVE_STREAM_PCM_FRAMES 4096
+
+struct _SDL_WAVStream
+{
+    SDL_RWops *src;
+    int freesrc;
+    WaveFile file;
+    Sint64 endposition;     /* Where src is left when the stream is closed. */
+    Sint64 datastart;       /* Position of the data chunk data in src. */
+    size_t datasize;        /* Number of bytes in the data chunk present in src. */
+    size_t blocksize;       /* Number of bytes decoded at once. */
+    Uint32 blockframes;     /* Number of sample frames in a full block. */
+    Uint32 framesize;       /* Size of a decoded sample frame in bytes. */
+    Sint64 block;           /* Index of the next block in src. */
+    Sint64 position;        /* Sample frame returned by the next read. */
+    Uint8 *blockbuf;        /* Encoded block. The same as outputbuf if decoded in-place. */
+    Uint8 *outputbuf;       /* Decoded block. */
+    size_t outputpos;       /* Read position in outputbuf in bytes. */
+    size_t outputlen;       /* Number of decoded bytes in outputbuf. */
+    ADPCM_DecoderState state;
+};
+
+/* Reads the next block from src and decodes it into the output buffer. An
+ * empty output buffer after a successful call marks the end of the data.
+ */
+static int
+WaveStreamDecodeBlock(SDL_WAVStream *stream)
+{
+    WaveFile *file = &stream->file;
+    WaveFormat *format = &file->format;
+    ADPCM_DecoderState *state = &stream->state;
+    const Uint64 offset = (Uint64)stream->block * stream->blocksize;
+    Sint64 frames = file->sampleframes - stream->block * stream->blockframes;
+    size_t length, got;
+    int result;
+
+    stream->outputpos = 0;
+    stream->outputlen = 0;
+
+    if (frames <= 0 || offset >= stream->datasize) {
+        return 0;
+    } else if (frames > stream->blockframes) {
+        frames = stream->blockframes;
+    }
+
+    length = stream->datasize - (size_t)offset;
+    if (length > stream->blocksize) {
+        length = stream->blocksize;
+    }
+
+    got = SDL_RWread(stream->src, stream->blockbuf, 1, length);
+    stream->block++;
+    if (got != length) {
+        /* I/O issues or the file got shorter since it was opened. */
+        if (file->trunchint == TruncVeryStrict || file->trunchint == TruncStrict) {
+            return SDL_SetError("Could not read data of WAVE data chunk");
+        }
+    }
+
+    switch (format->encoding) {
+    case PCM_CODE:
+    case IEEE_FLOAT_CODE:
+        if (frames > (Sint64)(got / format->blockalign)) {
+            frames = got / format->blockalign;
+        }
+        if (format->encoding == PCM_CODE && format->bitspersample == 24) {
+            PCM_ExpandSint24ToSint32(stream->outputbuf, (size_t)frames * format->channels);
+        }
+        break;
+    case ALAW_CODE:
+    case MULAW_CODE:
+        if (frames > (Sint64)(got / format->blockalign)) {
+            frames = got / format->blockalign;
+        }
+        if (LAW_DecodeSamples(format->encoding, stream->blockbuf, (Sint16 *)stream->outputbuf, (size_t)frames * format->channels) < 0) {
+            return -1;
+        }
+        break;
+    case MS_ADPCM_CODE:
+    case IMA_ADPCM_CODE:
+        if (got < state->blockheadersize) {
+            frames = 0;
+            break;
+        }
+
+        state->block.data = stream->blockbuf;
+        state->block.size = got;
+        state->block.pos = 0;
+        state->output.data = (Sint16 *)stream->outputbuf;
+        state->output.pos = 0;
+        state->framesleft = frames;
+
+        /* Same as the loop in the decode functions, but for just one block. */
+        if (format->encoding == MS_ADPCM_CODE) {
+            if (MS_ADPCM_DecodeBlockHeader(state) < 0) {
+                return -1;
+            }
+            result = MS_ADPCM_DecodeBlockData(state);
+        } else {
+            result = IMA_ADPCM_DecodeBlockHeader(state);
+            if (result == 0) {
+                result = IMA_ADPCM_DecodeBlockData(state);
+            }
+        }
+
+        if (result == -1) {
+            /* Unexpected end. Return partial data if necessary. */
+            if (file->trunchint == TruncVeryStrict || file->trunchint == TruncStrict) {
+                return SDL_SetError("Truncated data chunk");
+            } else if (file->trunchint != TruncDropFrame) {
+                frames = 0;
+            }
+        }
+        if (frames > (Sint64)(state->output.pos / state->channels)) {
+            frames = state->output.pos / state->channels;
+        }
+        break;
+    }
+
+    stream->outputlen = (size_t)frames * stream->framesize;
+
+    return 0;
+}
+
+SDL_WAVStream *
+SDL_OpenWAVStream_RW(SDL_RWops *src, int freesrc, SDL_AudioSpec *spec)
+{
+    SDL_WAVStream *stream;
+    WaveFile *file;
+    WaveFormat *format;
+    size_t outputsize;
+
+    /* Make sure we are passed a valid data source */
+    if (src == NULL) {
+        /* Error may come from RWops. */
+        return NULL;
+    } else if (spec == NULL) {
+        SDL_InvalidParamError("spec");
+        if (freesrc) {
+            SDL_RWclose(src);
+        }
+        return NULL;
+    }
+
+    stream = (SDL_WAVStream *)SDL_calloc(1, sizeof(*stream));
+    if (stream == NULL) {
+        SDL_OutOfMemory();
+        if (freesrc) {
+            SDL_RWclose(src);
+        }
+        return NULL;
+    }
+
+    stream->src = src;
+    stream->freesrc = freesrc;
+    file = &stream->file;
+    format = &file->format;
+
+    file->riffhint = WaveGetRiffSizeHint();
+    file->trunchint = WaveGetTruncationHint();
+    file->facthint = WaveGetFactChunkHint();
+
+    if (WaveReadHeaders(src, file, spec, &stream->endposition, SDL_TRUE) < 0) {
+        SDL_CloseWAVStream(stream);
+        return NULL;
+    }
+
+    stream->datastart = file->chunk.position;
+    stream->datasize = file->chunk.size;
+
+    switch (format->encoding) {
+    case PCM_CODE:
+    case IEEE_FLOAT_CODE:
+    case ALAW_CODE:
+    case MULAW_CODE:
+        stream->blockframes = WAVE_STREAM_PCM_FRAMES;
+        stream->blocksize = (size_t)format->blockalign * stream->blockframes;
+        break;
+    case MS_ADPCM_CODE:
+    case IMA_ADPCM_CODE:
+        stream->blockframes = format->samplesperblock;
+        stream->blocksize = format->blockalign;
+        break;
+    }
+    stream->framesize = (Uint32)SDL_AUDIO_BITSIZE(spec->format) / 8 * format->channels;
+
+    outputsize = (size_t)stream->framesize * stream->blockframes;
+    stream->outputbuf = (Uint8 *)SDL_malloc(outputsize);
+    if (stream->outputbuf == NULL) {
+        SDL_OutOfMemory();
+        SDL_CloseWAVStream(stream);
+        return NULL;
+    }
+
+    if (format->encoding == MS_ADPCM_CODE || format->encoding == IMA_ADPCM_CODE) {
+        ADPCM_DecoderState *state = &stream->state;
+        const size_t cstatesize = format->encoding == MS_ADPCM_CODE ? sizeof(MS_ADPCM_ChannelState) : sizeof(Sint8);
+
+        state->channels = format->channels;
+        state->blocksize = format->blockalign;
+        state->blockheadersize = (size_t)state->channels * (format->encoding == MS_ADPCM_CODE ? 7 : 4);
+        state->samplesperblock = format->samplesperblock;
+        state->framesize = state->channels * sizeof(Sint16);
+        state->framestotal = file->sampleframes;
+        state->ddata = file->decoderdata;
+        state->output.size = outputsize / sizeof(Sint16);
+
+        stream->blockbuf = (Uint8 *)SDL_malloc(stream->blocksize);
+        state->cstate = SDL_calloc(state->channels, cstatesize);
+        if (stream->blockbuf == NULL || state->cstate == NULL) {
+            SDL_OutOfMemory();
+            SDL_CloseWAVStream(stream);
+            return NULL;
+        }
+    } else {
+        /* These get expanded in-place, the output buffer is big enough. */
+        stream->blockbuf = stream->outputbuf;
+    }
+
+    if (SDL_RWseek(src, stream->datastart, RW_SEEK_SET) != stream->datastart) {
+        SDL_SetError("Could not seek data of WAVE data chunk");
+        SDL_CloseWAVStream(stream);
+        return NULL;
+    }
+
+    return stream;
+}
+
+int
+SDL_ReadWAVStream(SDL_WAVStream *stream, void *buf, int len)
+{
+    Uint8 *dst = (Uint8 *)buf;
+    int total = 0;
+
+    if (!stream) {
+        return SDL_InvalidParamError("stream");
+    } else if (!buf) {
+        return SDL_InvalidParamError("buf");
+    } else if (len < 0) {
+        return SDL_InvalidParamError("len");
+    }
+
+    /* Only whole sample frames. */
+    len -= len % stream->framesize;
+
+    while (len > 0) {
+        size_t cpy;
+
+        if (stream->outputpos == stream->outputlen) {
+            if (WaveStreamDecodeBlock(stream) < 0) {
+                return -1;
+            } else if (stream->outputlen == 0) {
+                break;  /* End of the data. */
+            }
+        }
+
+        cpy = stream->outputlen - stream->outputpos;
+        if (cpy > (size_t)len) {
+            cpy = (size_t)len;
+        }
+        SDL_memcpy(dst, stream->outputbuf + stream->outputpos, cpy);
+        stream->outputpos += cpy;
+        dst += cpy;
+        len -= (int)cpy;
+        total += (int)cpy;
+    }
+
+    stream->position += total / stream->framesize;
+
+    return total;
+}
+
+int
+SDL_SeekWAVStream(SDL_WAVStream *stream, Uint32 frame)
+{
+    Sint64 block, position;
+    size_t skip;
+
+    if (!stream) {
+        return SDL_InvalidParamError("stream");
+    } else if (frame > stream->file.sampleframes) {
+        return SDL_SetError("Seek position past the end of the WAVE data");
+    }
+
+    block = frame / stream->blockframes;
+    position = stream->datastart + block * (Sint64)stream->blocksize;
+    if (SDL_RWseek(stream->src, position, RW_SEEK_SET) != position) {
+        return SDL_SetError("Could not seek data of WAVE data chunk");
+    }
+
+    /* Decode the block with the frame and skip the frames before it. */
+    stream->block = block;
+    if (WaveStreamDecodeBlock(stream) < 0) {
+        return -1;
+    }
+    skip = (size_t)(frame % stream->blockframes) * stream->framesize;
+    stream->outputpos = skip < stream->outputlen ? skip : stream->outputlen;
+    stream->position = frame;
+
+    return 0;
+}
+
+Uint32
+SDL_WAVStreamTell(SDL_WAVStream *stream)
+{
+    if (!stream) {
+        SDL_InvalidParamError("stream");
+        return 0;
+    }
+    return (Uint32)stream->position;
+}
+
+Uint32
+SDL_WAVStreamLength(SDL_WAVStream *stream)
+{
+    if (!stream) {
+        SDL_InvalidParamError("stream");
+        return 0;
+    }
+    return (Uint32)stream->file.sampleframes;
+}
+
+void
+SDL_CloseWAVStream(SDL_WAVStream *stream)
+{
+    if (stream) {
+        if (stream->freesrc) {
+            SDL_RWclose(stream->src);
+        } else {
+            SDL_RWseek(stream->src, stream->endposition ? stream->endposition : stream->file.chunk.position, RW_SEEK_SET);
+        }
+        if (stream->blockbuf != stream->outputbuf) {
+            SDL_free(stream->blockbuf);
+        }
+        SDL_free(stream->outputbuf);
+        SDL_free(stream->state.cstate);
+        WaveFreeChunkData(&stream->file.chunk);
+        SDL_free(stream->file.decoderdata);
+        SDL_free(stream);
+    }
+}
+
 /* vi: set ts=4 sw=4 expandtab: */
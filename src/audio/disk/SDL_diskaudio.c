@@ -47,7 +47,7 @@
 static void
 DISKAUDIO_WaitDevice(_THIS)
 {
-    SDL_Delay(this->hidden->io_delay);
+    SDL_WaitAudioPacer(&this->hidden->pacer);
 }
 
 static void
@@ -78,7 +78,7 @@ DISKAUDIO_CaptureFromDevice(_THIS, void *buffer, int buflen)
     struct SDL_PrivateAudioData *h = this->hidden;
     const int origbuflen = buflen;
 
-    SDL_Delay(h->io_delay);
+    SDL_WaitAudioPacer(&h->pacer);
 
     if (h->io) {
         const size_t br = SDL_RWread(h->io, buffer, 1, buflen);
@@ -140,10 +140,9 @@ DISKAUDIO_OpenDevice(_THIS, void *handle, const char *devname, int iscapture)
     }
     SDL_zerop(this->hidden);
 
+    SDL_InitAudioPacer(&this->hidden->pacer, &this->spec);
     if (envr != NULL) {
-        this->hidden->io_delay = SDL_atoi(envr);
-    } else {
-        this->hidden->io_delay = ((this->spec.samples * 1000) / this->spec.freq);
+        this->hidden->pacer.period = (SDL_atoi(envr) * SDL_GetPerformanceFrequency()) / 1000;
     }
 
     /* Open the audio device */
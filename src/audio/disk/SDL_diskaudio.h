@@ -33,7 +33,7 @@ struct SDL_PrivateAudioData
 {
     /* The file descriptor for the audio device */
     SDL_RWops *io;
-    Uint32 io_delay;
+    SDL_AudioPacer pacer;
     Uint8 *mixbuf;
 };
 
@@ -30,26 +30,62 @@
 static int
 DUMMYAUDIO_OpenDevice(_THIS, void *handle, const char *devname, int iscapture)
 {
-    return 0;                   /* always succeeds. */
+    this->hidden = (struct SDL_PrivateAudioData *) SDL_calloc(1, sizeof (*this->hidden));
+    if (this->hidden == NULL) {
+        return SDL_OutOfMemory();
+    }
+
+    if (!iscapture) {
+        this->hidden->mixbuf = (Uint8 *) SDL_malloc(this->spec.size);
+        if (this->hidden->mixbuf == NULL) {
+            return SDL_OutOfMemory();
+        }
+    }
+
+    SDL_InitAudioPacer(&this->hidden->pacer, &this->spec);
+    return 0;
+}
+
+static void
+DUMMYAUDIO_WaitDevice(_THIS)
+{
+    /* Wait as long as the buffer would have taken to play. */
+    SDL_WaitAudioPacer(&this->hidden->pacer);
+}
+
+static Uint8 *
+DUMMYAUDIO_GetDeviceBuf(_THIS)
+{
+    return this->hidden->mixbuf;
 }
 
 static int
 DUMMYAUDIO_CaptureFromDevice(_THIS, void *buffer, int buflen)
 {
     /* Delay to make this sort of simulate real audio input. */
-    SDL_Delay((this->spec.samples * 1000) / this->spec.freq);
+    SDL_WaitAudioPacer(&this->hidden->pacer);
 
     /* always return a full buffer of silence. */
     SDL_memset(buffer, this->spec.silence, buflen);
     return buflen;
 }
 
+static void
+DUMMYAUDIO_CloseDevice(_THIS)
+{
+    SDL_free(this->hidden->mixbuf);
+    SDL_free(this->hidden);
+}
+
 static int
 DUMMYAUDIO_Init(SDL_AudioDriverImpl * impl)
 {
     /* Set the function pointers */
     impl->OpenDevice = DUMMYAUDIO_OpenDevice;
+    impl->WaitDevice = DUMMYAUDIO_WaitDevice;
+    impl->GetDeviceBuf = DUMMYAUDIO_GetDeviceBuf;
     impl->CaptureFromDevice = DUMMYAUDIO_CaptureFromDevice;
+    impl->CloseDevice = DUMMYAUDIO_CloseDevice;
 
     impl->OnlyHasDefaultOutputDevice = 1;
     impl->OnlyHasDefaultCaptureDevice = 1;
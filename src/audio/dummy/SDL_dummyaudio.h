@@ -30,11 +30,9 @@
 
 struct SDL_PrivateAudioData
 {
-    /* The file descriptor for the audio device */
+    /* The buffer the audio is mixed into and thrown away */
     Uint8 *mixbuf;
-    Uint32 mixlen;
-    Uint32 write_delay;
-    Uint32 initial_calls;
+    SDL_AudioPacer pacer;
 };
 
 #endif /* SDL_dummyaudio_h_ */
@@ -233,6 +233,32 @@ static void SDL_EVDEV_udev_callback(SDL_UDEV_deviceevent udev_event, int udev_cl
 }
 #endif /* SDL_USE_LIBUDEV */
 
+/* Fills in the fds SDL_EVDEV_Poll() reads from, so callers can wait on them */
+int
+SDL_EVDEV_GetFDs(int *fds, int max_fds)
+{
+    SDL_evdevlist_item *item;
+    int numfds = 0;
+
+    if (!_this) {
+        return 0;
+    }
+
+#if SDL_USE_LIBUDEV
+    if (numfds < max_fds) {
+        const int fd = SDL_UDEV_GetMonitorFD();
+        if (fd >= 0) {
+            fds[numfds++] = fd;
+        }
+    }
+#endif
+
+    for (item = _this->first; item != NULL && numfds < max_fds; item = item->next) {
+        fds[numfds++] = item->fd;
+    }
+    return numfds;
+}
+
 void 
 SDL_EVDEV_Poll(void)
 {
@@ -477,6 +477,16 @@ device_event(SDL_UDEV_deviceevent type, struct udev_device *dev)
     }
 }
 
+/* The fd that becomes readable when there's hotplug news for SDL_UDEV_Poll(), or -1 */
+int
+SDL_UDEV_GetMonitorFD(void)
+{
+    if (_this == NULL || _this->udev_mon == NULL) {
+        return -1;
+    }
+    return _this->syms.udev_monitor_get_fd(_this->udev_mon);
+}
+
 void 
 SDL_UDEV_Poll(void)
 {
@@ -22,6 +22,7 @@
 #include "../../SDL_internal.h"
 
 #include "SDL_assert.h"
+#include "SDL_error.h"
 #include "SDL_poll.h"
 
 #ifdef HAVE_POLL
@@ -29,9 +30,14 @@
 #else
 #include <sys/time.h>
 #include <sys/types.h>
-#include <unistd.h>
 #endif
 #include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+#ifdef __LINUX__
+#include <sys/eventfd.h>
+#endif
 
 
 int
@@ -84,4 +90,148 @@ SDL_IOReady(int fd, SDL_bool forWrite, int timeoutMS)
     return result;
 }
 
+
+/* On Linux both of these are the same eventfd, elsewhere they're a pipe */
+static int wakeup_read_fd = -1;
+static int wakeup_write_fd = -1;
+static int wakeup_refcount = 0;
+
+int
+SDL_IOWakeupInit(void)
+{
+    if (wakeup_refcount++ > 0) {
+        return 0;
+    }
+
+#ifdef __LINUX__
+    wakeup_read_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (wakeup_read_fd < 0) {
+        --wakeup_refcount;
+        return SDL_SetError("Couldn't create wakeup eventfd: %s", strerror(errno));
+    }
+    wakeup_write_fd = wakeup_read_fd;
+#else
+    {
+        int fds[2];
+        int i;
+
+        if (pipe(fds) < 0) {
+            --wakeup_refcount;
+            return SDL_SetError("Couldn't create wakeup pipe: %s", strerror(errno));
+        }
+        for (i = 0; i < 2; ++i) {
+            fcntl(fds[i], F_SETFD, FD_CLOEXEC);
+            fcntl(fds[i], F_SETFL, fcntl(fds[i], F_GETFL) | O_NONBLOCK);
+        }
+        wakeup_read_fd = fds[0];
+        wakeup_write_fd = fds[1];
+    }
+#endif
+    return 0;
+}
+
+void
+SDL_IOWakeupQuit(void)
+{
+    if (wakeup_refcount == 0 || --wakeup_refcount > 0) {
+        return;
+    }
+
+    if (wakeup_write_fd != wakeup_read_fd) {
+        close(wakeup_write_fd);
+    }
+    close(wakeup_read_fd);
+    wakeup_read_fd = -1;
+    wakeup_write_fd = -1;
+}
+
+void
+SDL_IOSendWakeup(void)
+{
+    if (wakeup_write_fd >= 0) {
+        const int saved_errno = errno;
+#ifdef __LINUX__
+        const Uint64 value = 1;
+#else
+        const Uint8 value = 1;
+#endif
+        /* If this fails, the pipe is full and a wakeup is already pending */
+        if (write(wakeup_write_fd, &value, sizeof(value)) < 0) {
+            /* nothing to do */
+        }
+        errno = saved_errno;
+    }
+}
+
+/* Returns > 0 if one of the fds is readable, or we were woken up or
+   interrupted by a signal, and 0 if the timeout expired. */
+int
+SDL_IOReadyOrWoken(const int *fds, int numfds, int timeoutMS)
+{
+    int result;
+    int i;
+
+    SDL_assert(numfds <= SDL_IOREADY_MAX_FDS);
+    numfds = SDL_min(numfds, SDL_IOREADY_MAX_FDS);
+
+    {
+#ifdef HAVE_POLL
+        struct pollfd info[SDL_IOREADY_MAX_FDS + 1];
+        int count = 0;
+
+        for (i = 0; i < numfds; ++i) {
+            info[count].fd = fds[i];
+            info[count].events = POLLIN | POLLPRI;
+            info[count].revents = 0;
+            ++count;
+        }
+        if (wakeup_read_fd >= 0) {
+            info[count].fd = wakeup_read_fd;
+            info[count].events = POLLIN;
+            info[count].revents = 0;
+            ++count;
+        }
+        result = poll(info, count, timeoutMS);
+#else
+        fd_set rfdset;
+        struct timeval tv, *tvp = NULL;
+        int maxfd = -1;
+
+        FD_ZERO(&rfdset);
+        for (i = 0; i < numfds; ++i) {
+            /* If this assert triggers we'll corrupt memory here */
+            SDL_assert(fds[i] >= 0 && fds[i] < FD_SETSIZE);
+            FD_SET(fds[i], &rfdset);
+            maxfd = SDL_max(maxfd, fds[i]);
+        }
+        if (wakeup_read_fd >= 0) {
+            FD_SET(wakeup_read_fd, &rfdset);
+            maxfd = SDL_max(maxfd, wakeup_read_fd);
+        }
+
+        if (timeoutMS >= 0) {
+            tv.tv_sec = timeoutMS / 1000;
+            tv.tv_usec = (timeoutMS % 1000) * 1000;
+            tvp = &tv;
+        }
+
+        result = select(maxfd + 1, &rfdset, NULL, NULL, tvp);
+#endif /* HAVE_POLL */
+    }
+
+    if (result < 0 && errno == EINTR) {
+        /* A signal may have queued an event, let the caller look */
+        return 1;
+    }
+
+    /* Clear any pending wakeups, the caller is about to look for events */
+    if (result > 0 && wakeup_read_fd >= 0) {
+        Uint64 value;
+        while (read(wakeup_read_fd, &value, sizeof(value)) > 0) {
+            continue;
+        }
+    }
+    return result;
+}
+
 /* vi: set ts=4 sw=4 expandtab: */
@@ -29,6 +29,16 @@
 
 extern int SDL_IOReady(int fd, SDL_bool forWrite, int timeoutMS);
 
+/* A process wide wakeup, so other threads can interrupt a video backend that
+   is blocked waiting for input in SDL_IOReadyOrWoken(). SDL_IOSendWakeup()
+   is safe to call from a signal handler. */
+#define SDL_IOREADY_MAX_FDS 32
+
+extern int SDL_IOWakeupInit(void);
+extern void SDL_IOWakeupQuit(void);
+extern void SDL_IOSendWakeup(void);
+extern int SDL_IOReadyOrWoken(const int *fds, int numfds, int timeoutMS);
+
 #endif /* SDL_poll_h_ */
 
 /* vi: set ts=4 sw=4 expandtab: */
@@ -749,3 +749,31 @@
 #define SDL_GetAndroidSDKVersion SDL_GetAndroidSDKVersion_REAL
 #define SDL_isupper SDL_isupper_REAL
 #define SDL_islower SDL_islower_REAL
+#define SDL_RenderGetCommandStats SDL_RenderGetCommandStats_REAL
+#define SDL_RenderCopySprites SDL_RenderCopySprites_REAL
+#define SDL_CreateTextureAtlas SDL_CreateTextureAtlas_REAL
+#define SDL_AtlasAddSurface SDL_AtlasAddSurface_REAL
+#define SDL_GetTextureAtlasInfo SDL_GetTextureAtlasInfo_REAL
+#define SDL_DestroyTextureAtlas SDL_DestroyTextureAtlas_REAL
+#define SDL_AddTimerMicroseconds SDL_AddTimerMicroseconds_REAL
+#define SDL_PollEvents SDL_PollEvents_REAL
+#define SDL_GetCoalescedEventCount SDL_GetCoalescedEventCount_REAL
+#define SDL_CreateAudioMixer SDL_CreateAudioMixer_REAL
+#define SDL_AudioMixerAddVoice SDL_AudioMixerAddVoice_REAL
+#define SDL_AudioMixerPutVoice SDL_AudioMixerPutVoice_REAL
+#define SDL_AudioMixerSetVoiceGain SDL_AudioMixerSetVoiceGain_REAL
+#define SDL_AudioMixerVoiceQueued SDL_AudioMixerVoiceQueued_REAL
+#define SDL_AudioMixerRemoveVoice SDL_AudioMixerRemoveVoice_REAL
+#define SDL_AudioMixerRender SDL_AudioMixerRender_REAL
+#define SDL_AudioMixerCallback SDL_AudioMixerCallback_REAL
+#define SDL_FreeAudioMixer SDL_FreeAudioMixer_REAL
+#define SDL_GetQueuedAudioXruns SDL_GetQueuedAudioXruns_REAL
+#define SDL_GetAudioDeviceStats SDL_GetAudioDeviceStats_REAL
+#define SDL_ResetAudioDeviceStats SDL_ResetAudioDeviceStats_REAL
+#define SDL_OpenWAVStream_RW SDL_OpenWAVStream_RW_REAL
+#define SDL_ReadWAVStream SDL_ReadWAVStream_REAL
+#define SDL_SeekWAVStream SDL_SeekWAVStream_REAL
+#define SDL_WAVStreamTell SDL_WAVStreamTell_REAL
+#define SDL_WAVStreamLength SDL_WAVStreamLength_REAL
+#define SDL_CloseWAVStream SDL_CloseWAVStream_REAL
+#define SDL_SoftStretchLinear SDL_SoftStretchLinear_REAL
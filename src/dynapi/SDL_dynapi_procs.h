@@ -809,3 +809,31 @@ SDL_DYNAPI_PROC(int,SDL_GetAndroidSDKVersion,(void),(),return)
 #endif
 SDL_DYNAPI_PROC(int,SDL_isupper,(int a),(a),return)
 SDL_DYNAPI_PROC(int,SDL_islower,(int a),(a),return)
+SDL_DYNAPI_PROC(int,SDL_RenderGetCommandStats,(SDL_Renderer *a, int *b, int *c),(a,b,c),return)
+SDL_DYNAPI_PROC(int,SDL_RenderCopySprites,(SDL_Renderer *a, SDL_Texture *b, const SDL_RenderSprite *c, int d),(a,b,c,d),return)
+SDL_DYNAPI_PROC(SDL_TextureAtlas*,SDL_CreateTextureAtlas,(SDL_Renderer *a, int b, int c),(a,b,c),return)
+SDL_DYNAPI_PROC(SDL_Texture*,SDL_AtlasAddSurface,(SDL_TextureAtlas *a, SDL_Surface *b),(a,b),return)
+SDL_DYNAPI_PROC(int,SDL_GetTextureAtlasInfo,(SDL_TextureAtlas *a, int *b, int *c, float *d),(a,b,c,d),return)
+SDL_DYNAPI_PROC(void,SDL_DestroyTextureAtlas,(SDL_TextureAtlas *a),(a),)
+SDL_DYNAPI_PROC(SDL_TimerID,SDL_AddTimerMicroseconds,(Uint32 a, SDL_TimerCallback b, void *c),(a,b,c),return)
+SDL_DYNAPI_PROC(int,SDL_PollEvents,(SDL_Event *a, int b, Uint32 c, Uint32 d),(a,b,c,d),return)
+SDL_DYNAPI_PROC(int,SDL_GetCoalescedEventCount,(Uint32 a),(a),return)
+SDL_DYNAPI_PROC(SDL_AudioMixer*,SDL_CreateAudioMixer,(SDL_AudioFormat a, Uint8 b, int c),(a,b,c),return)
+SDL_DYNAPI_PROC(int,SDL_AudioMixerAddVoice,(SDL_AudioMixer *a, SDL_AudioFormat b, Uint8 c, int d),(a,b,c,d),return)
+SDL_DYNAPI_PROC(int,SDL_AudioMixerPutVoice,(SDL_AudioMixer *a, int b, const void *c, int d),(a,b,c,d),return)
+SDL_DYNAPI_PROC(int,SDL_AudioMixerSetVoiceGain,(SDL_AudioMixer *a, int b, float c, float d),(a,b,c,d),return)
+SDL_DYNAPI_PROC(int,SDL_AudioMixerVoiceQueued,(SDL_AudioMixer *a, int b),(a,b),return)
+SDL_DYNAPI_PROC(void,SDL_AudioMixerRemoveVoice,(SDL_AudioMixer *a, int b),(a,b),)
+SDL_DYNAPI_PROC(void,SDL_AudioMixerRender,(SDL_AudioMixer *a, Uint8 *b, int c),(a,b,c),)
+SDL_DYNAPI_PROC(void,SDL_AudioMixerCallback,(void *a, Uint8 *b, int c),(a,b,c),)
+SDL_DYNAPI_PROC(void,SDL_FreeAudioMixer,(SDL_AudioMixer *a),(a),)
+SDL_DYNAPI_PROC(Uint32,SDL_GetQueuedAudioXruns,(SDL_AudioDeviceID a),(a),return)
+SDL_DYNAPI_PROC(int,SDL_GetAudioDeviceStats,(SDL_AudioDeviceID a, SDL_AudioDeviceStats *b),(a,b),return)
+SDL_DYNAPI_PROC(void,SDL_ResetAudioDeviceStats,(SDL_AudioDeviceID a),(a),)
+SDL_DYNAPI_PROC(SDL_WAVStream*,SDL_OpenWAVStream_RW,(SDL_RWops *a, int b, SDL_AudioSpec *c),(a,b,c),return)
+SDL_DYNAPI_PROC(int,SDL_ReadWAVStream,(SDL_WAVStream *a, void *b, int c),(a,b,c),return)
+SDL_DYNAPI_PROC(int,SDL_SeekWAVStream,(SDL_WAVStream *a, Uint32 b),(a,b),return)
+SDL_DYNAPI_PROC(Uint32,SDL_WAVStreamTell,(SDL_WAVStream *a),(a),return)
+SDL_DYNAPI_PROC(Uint32,SDL_WAVStreamLength,(SDL_WAVStream *a),(a),return)
+SDL_DYNAPI_PROC(void,SDL_CloseWAVStream,(SDL_WAVStream *a),(a),)
+SDL_DYNAPI_PROC(int,SDL_SoftStretchLinear,(SDL_Surface *a, const SDL_Rect *b, SDL_Surface *c, const SDL_Rect *d),(a,b,c,d),return)
@@ -27,6 +27,7 @@
 #include "SDL_thread.h"
 #include "SDL_events_c.h"
 #include "../timer/SDL_timer_c.h"
+#include "../SDL_hints_c.h"
 #if !SDL_JOYSTICK_DISABLED
 #include "../joystick/SDL_joystick_c.h"
 #endif
@@ -78,6 +79,36 @@ typedef struct _SDL_SysWMEntry
     struct _SDL_SysWMEntry *next;
 } SDL_SysWMEntry;
 
+/* Events are added to this bounded ring without taking the queue lock, and
+   whoever holds the lock next moves them onto the end of the list, so
+   threads pushing events only contend on the ring position.
+
+   This is the sequenced ring from test/testatomic.c: each entry's sequence
+   says whether it's free for the producer at that position, or filled in
+   for the consumer. There's only ever one consumer, the lock holder.
+ */
+#define SDL_EVENT_RING_SIZE 1024    /* must be a power of 2 */
+#define SDL_EVENT_RING_MASK (SDL_EVENT_RING_SIZE-1)
+
+typedef struct
+{
+    SDL_atomic_t sequence;
+    SDL_Event event;
+} SDL_EventRingEntry;
+
+typedef struct
+{
+    SDL_atomic_t enqueue_pos;
+
+    char cache_pad1[SDL_CACHELINE_SIZE-sizeof(SDL_atomic_t)];
+
+    unsigned dequeue_pos;   /* only used with the queue locked */
+
+    char cache_pad2[SDL_CACHELINE_SIZE-sizeof(unsigned)];
+
+    SDL_EventRingEntry entries[SDL_EVENT_RING_SIZE];
+} SDL_EventRing;
+
 static struct
 {
     SDL_mutex *lock;
@@ -89,7 +120,13 @@ static struct
     SDL_EventEntry *free;
     SDL_SysWMEntry *wmmsg_used;
     SDL_SysWMEntry *wmmsg_free;
-} SDL_EventQ = { NULL, { 1 }, { 0 }, 0, NULL, NULL, NULL, NULL, NULL };
+    SDL_EventRing *ring;
+    SDL_atomic_t pushers;   /* threads adding events, which the queue has to outlive */
+    SDL_atomic_t waiters;   /* threads blocked in SDL_WaitEventTimeout() */
+    SDL_sem *wakeup;        /* what they block on when there's no video backend to wait on */
+    SDL_atomic_t mouse_motion_folded;
+    SDL_atomic_t finger_motion_folded;
+} SDL_EventQ = { NULL, { 1 }, { 0 }, 0, NULL, NULL, NULL, NULL, NULL, NULL, { 0 }, { 0 }, NULL, { 0 }, { 0 } };
 
 
 /* 0 (default) means no logging, 1 means logging, 2 means logging with mouse and finger motion */
@@ -101,6 +138,15 @@ SDL_EventLoggingChanged(void *userdata, const char *name, const char *oldValue,
     SDL_DoEventLogging = (hint && *hint) ? SDL_max(SDL_min(SDL_atoi(hint), 2), 0) : 0;
 }
 
+/* Whether motion events are merged into the last queued event for the same device */
+static SDL_bool SDL_CoalesceMotion = SDL_FALSE;
+
+static void SDLCALL
+SDL_CoalesceMotionChanged(void *userdata, const char *name, const char *oldValue, const char *hint)
+{
+    SDL_CoalesceMotion = SDL_GetStringBoolean(hint, SDL_FALSE);
+}
+
 static void
 SDL_LogEvent(const SDL_Event *event)
 {
@@ -350,16 +396,31 @@ SDL_StopEventLoop(void)
     int i;
     SDL_EventEntry *entry;
     SDL_SysWMEntry *wmmsg;
+    SDL_EventRing *ring;
+
+    /* Threads adding events check this after counting themselves as pushers,
+       so this has to be a full barrier */
+    SDL_AtomicCAS(&SDL_EventQ.active, 1, 0);
+
+    /* The ones that got in before that may still be adding to the ring, the
+       list and the event count, and may need the lock to do it. Let them
+       finish before taking the lock and clearing everything. */
+    while (SDL_AtomicGet(&SDL_EventQ.pushers) > 0) {
+        SDL_Delay(0);
+    }
 
     if (SDL_EventQ.lock) {
         SDL_LockMutex(SDL_EventQ.lock);
     }
 
-    SDL_AtomicSet(&SDL_EventQ.active, 0);
-
     if (report && SDL_atoi(report)) {
         SDL_Log("SDL EVENT QUEUE: Maximum events in-flight: %d\n",
                 SDL_EventQ.max_events_seen);
+        if (SDL_CoalesceMotion) {
+            SDL_Log("SDL EVENT QUEUE: Motion events coalesced: %d mouse, %d finger\n",
+                    SDL_AtomicGet(&SDL_EventQ.mouse_motion_folded),
+                    SDL_AtomicGet(&SDL_EventQ.finger_motion_folded));
+        }
     }
 
     /* Clean out EventQ */
@@ -386,12 +447,24 @@ SDL_StopEventLoop(void)
 
     SDL_AtomicSet(&SDL_EventQ.count, 0);
     SDL_EventQ.max_events_seen = 0;
+    SDL_AtomicSet(&SDL_EventQ.mouse_motion_folded, 0);
+    SDL_AtomicSet(&SDL_EventQ.finger_motion_folded, 0);
     SDL_EventQ.head = NULL;
     SDL_EventQ.tail = NULL;
     SDL_EventQ.free = NULL;
     SDL_EventQ.wmmsg_used = NULL;
     SDL_EventQ.wmmsg_free = NULL;
 
+    /* Anything still in the ring is dropped along with the list */
+    ring = SDL_EventQ.ring;
+    SDL_EventQ.ring = NULL;
+    SDL_free(ring);
+
+    if (SDL_EventQ.wakeup) {
+        SDL_DestroySemaphore(SDL_EventQ.wakeup);
+        SDL_EventQ.wakeup = NULL;
+    }
+
     /* Clear disabled event state */
     for (i = 0; i < SDL_arraysize(SDL_disabled_events); ++i) {
         SDL_free(SDL_disabled_events[i]);
@@ -441,6 +514,26 @@ SDL_StartEventLoop(void)
             return -1;
         }
     }
+
+    if (!SDL_EventQ.ring) {
+        SDL_EventRing *ring = (SDL_EventRing *)SDL_calloc(1, sizeof(*ring));
+        int i;
+
+        if (ring == NULL) {
+            return SDL_OutOfMemory();
+        }
+        for (i = 0; i < SDL_EVENT_RING_SIZE; ++i) {
+            SDL_AtomicSet(&ring->entries[i].sequence, i);
+        }
+        SDL_EventQ.ring = ring;
+    }
+
+    if (!SDL_EventQ.wakeup) {
+        SDL_EventQ.wakeup = SDL_CreateSemaphore(0);
+        if (SDL_EventQ.wakeup == NULL) {
+            return -1;
+        }
+    }
 #endif /* !SDL_THREADS_DISABLED */
 
     /* Process most event types */
@@ -458,6 +551,24 @@ SDL_StartEventLoop(void)
 }
 
 
+/* Append an entry to the end of the list -- called with the queue locked */
+static void
+SDL_LinkEvent(SDL_EventEntry *entry)
+{
+    if (SDL_EventQ.tail) {
+        SDL_EventQ.tail->next = entry;
+        entry->prev = SDL_EventQ.tail;
+        SDL_EventQ.tail = entry;
+        entry->next = NULL;
+    } else {
+        SDL_assert(!SDL_EventQ.head);
+        SDL_EventQ.head = entry;
+        SDL_EventQ.tail = entry;
+        entry->prev = NULL;
+        entry->next = NULL;
+    }
+}
+
 /* Add an event to the event queue -- called with the queue locked */
 static int
 SDL_AddEvent(SDL_Event * event)
@@ -491,18 +602,7 @@ SDL_AddEvent(SDL_Event * event)
         entry->event.syswm.msg = &entry->msg;
     }
 
-    if (SDL_EventQ.tail) {
-        SDL_EventQ.tail->next = entry;
-        entry->prev = SDL_EventQ.tail;
-        SDL_EventQ.tail = entry;
-        entry->next = NULL;
-    } else {
-        SDL_assert(!SDL_EventQ.head);
-        SDL_EventQ.head = entry;
-        SDL_EventQ.tail = entry;
-        entry->prev = NULL;
-        entry->next = NULL;
-    }
+    SDL_LinkEvent(entry);
 
     final_count = SDL_AtomicAdd(&SDL_EventQ.count, 1) + 1;
     if (final_count > SDL_EventQ.max_events_seen) {
@@ -512,6 +612,156 @@ SDL_AddEvent(SDL_Event * event)
     return 1;
 }
 
+/* Fold a motion event into the last queued event, if that's motion for the
+   same mouse or finger -- called with the queue locked */
+static SDL_bool
+SDL_CoalesceEvent(SDL_Event * event)
+{
+    SDL_Event *last;
+
+    if (!SDL_EventQ.tail) {
+        return SDL_FALSE;
+    }
+    last = &SDL_EventQ.tail->event;
+    if (last->type != event->type) {
+        return SDL_FALSE;
+    }
+
+    if (event->type == SDL_MOUSEMOTION) {
+        if (last->motion.windowID != event->motion.windowID ||
+            last->motion.which != event->motion.which ||
+            last->motion.state != event->motion.state) {
+            return SDL_FALSE;
+        }
+        last->motion.timestamp = event->motion.timestamp;
+        last->motion.x = event->motion.x;
+        last->motion.y = event->motion.y;
+        last->motion.xrel += event->motion.xrel;
+        last->motion.yrel += event->motion.yrel;
+        SDL_AtomicAdd(&SDL_EventQ.mouse_motion_folded, 1);
+    } else if (event->type == SDL_FINGERMOTION) {
+        if (last->tfinger.windowID != event->tfinger.windowID ||
+            last->tfinger.touchId != event->tfinger.touchId ||
+            last->tfinger.fingerId != event->tfinger.fingerId) {
+            return SDL_FALSE;
+        }
+        last->tfinger.timestamp = event->tfinger.timestamp;
+        last->tfinger.x = event->tfinger.x;
+        last->tfinger.y = event->tfinger.y;
+        last->tfinger.dx += event->tfinger.dx;
+        last->tfinger.dy += event->tfinger.dy;
+        last->tfinger.pressure = event->tfinger.pressure;
+        SDL_AtomicAdd(&SDL_EventQ.finger_motion_folded, 1);
+    } else {
+        return SDL_FALSE;
+    }
+
+    if (SDL_DoEventLogging) {
+        SDL_LogEvent(event);
+    }
+    return SDL_TRUE;
+}
+
+/* Add an event to the ring, from any thread without the queue locked.
+   Returns -1 if the ring is full and the event should be added the slow way. */
+static int
+SDL_AddEventToRing(SDL_EventRing *ring, SDL_Event * event)
+{
+    SDL_EventRingEntry *entry;
+    unsigned queue_pos;
+    unsigned entry_seq;
+    int delta;
+
+    /* The ring counts towards the queue limit too */
+    if (SDL_AtomicAdd(&SDL_EventQ.count, 1) >= SDL_MAX_QUEUED_EVENTS) {
+        SDL_AtomicAdd(&SDL_EventQ.count, -1);
+        SDL_SetError("Event queue is full (%d events)", SDL_MAX_QUEUED_EVENTS);
+        return 0;
+    }
+
+    queue_pos = (unsigned)SDL_AtomicGet(&ring->enqueue_pos);
+    for ( ; ; ) {
+        entry = &ring->entries[queue_pos & SDL_EVENT_RING_MASK];
+        entry_seq = (unsigned)SDL_AtomicGet(&entry->sequence);
+
+        delta = (int)(entry_seq - queue_pos);
+        if (delta == 0) {
+            /* The entry and the ring position match, try to claim it */
+            if (SDL_AtomicCAS(&ring->enqueue_pos, (int)queue_pos, (int)(queue_pos + 1))) {
+                break;
+            }
+        } else if (delta < 0) {
+            /* The entry hasn't been moved to the list yet, the ring is full */
+            SDL_AtomicAdd(&SDL_EventQ.count, -1);
+            return -1;
+        } else {
+            /* Another thread claimed the entry, get the new ring position */
+            queue_pos = (unsigned)SDL_AtomicGet(&ring->enqueue_pos);
+        }
+    }
+
+    if (SDL_DoEventLogging) {
+        SDL_LogEvent(event);
+    }
+
+    entry->event = *event;
+    SDL_AtomicSet(&entry->sequence, (int)(queue_pos + 1));
+    return 1;
+}
+
+/* Move the events in the ring onto the list -- called with the queue locked.
+   Before adding to the list directly, we have to wait for the other threads
+   to finish filling in the entries they've claimed, since the entries after
+   them might hold older events from the thread that's adding. */
+static void
+SDL_DrainEventRing(SDL_bool wait_for_claimed)
+{
+    SDL_EventRing *ring = SDL_EventQ.ring;
+    int final_count;
+
+    if (!ring) {
+        return;
+    }
+
+    for ( ; ; ) {
+        const unsigned queue_pos = ring->dequeue_pos;
+        SDL_EventRingEntry *ring_entry = &ring->entries[queue_pos & SDL_EVENT_RING_MASK];
+        SDL_EventEntry *entry;
+
+        /* Stop at the first entry that isn't filled in, even if later ones
+           are, so events stay in the order they were added */
+        if ((int)((unsigned)SDL_AtomicGet(&ring_entry->sequence) - (queue_pos + 1)) < 0) {
+            if (wait_for_claimed && (unsigned)SDL_AtomicGet(&ring->enqueue_pos) != queue_pos) {
+                SDL_Delay(0);
+                continue;
+            }
+            break;
+        }
+
+        if (SDL_EventQ.free == NULL) {
+            entry = (SDL_EventEntry *)SDL_malloc(sizeof(*entry));
+        } else {
+            entry = SDL_EventQ.free;
+            SDL_EventQ.free = entry->next;
+        }
+        if (entry) {
+            entry->event = ring_entry->event;
+            SDL_LinkEvent(entry);
+        } else {
+            /* The event is lost, same as if SDL_AddEvent() had failed */
+            SDL_AtomicAdd(&SDL_EventQ.count, -1);
+        }
+
+        SDL_AtomicSet(&ring_entry->sequence, (int)(queue_pos + SDL_EVENT_RING_SIZE));
+        ring->dequeue_pos = queue_pos + 1;
+    }
+
+    final_count = SDL_AtomicGet(&SDL_EventQ.count);
+    if (final_count > SDL_EventQ.max_events_seen) {
+        SDL_EventQ.max_events_seen = final_count;
+    }
+}
+
 /* Remove an event from the queue -- called with the queue locked */
 static void
 SDL_CutEvent(SDL_EventEntry *entry)
@@ -539,9 +789,9 @@ SDL_CutEvent(SDL_EventEntry *entry)
 }
 
 /* Lock the event queue, take a peep at it, and unlock it */
-int
-SDL_PeepEvents(SDL_Event * events, int numevents, SDL_eventaction action,
-               Uint32 minType, Uint32 maxType)
+static int
+SDL_PeepEventsInternal(SDL_Event * events, int numevents, SDL_eventaction action,
+                       Uint32 minType, Uint32 maxType)
 {
     int i, used;
 
@@ -553,12 +803,50 @@ SDL_PeepEvents(SDL_Event * events, int numevents, SDL_eventaction action,
         }
         return (-1);
     }
-    /* Lock the event queue */
+
     used = 0;
+    i = 0;
+
+    /* Adding events doesn't need the lock unless the ring fills up */
+    if (action == SDL_ADDEVENT && SDL_EventQ.ring) {
+        SDL_EventRing *ring = SDL_EventQ.ring;
+
+        for ( ; i < numevents; ++i) {
+            int added;
+
+            if (events[i].type == SDL_SYSWMEVENT) {
+                break;  /* the list entries have room for the message */
+            }
+            if (SDL_CoalesceMotion &&
+                (events[i].type == SDL_MOUSEMOTION || events[i].type == SDL_FINGERMOTION)) {
+                break;  /* coalescing needs to see the end of the list */
+            }
+            added = SDL_AddEventToRing(ring, &events[i]);
+            if (added < 0) {
+                break;
+            }
+            used += added;
+        }
+        if (i == numevents) {
+            if (used > 0) {
+                SDL_WakeEventWaiters();
+            }
+            return (used);
+        }
+    }
+
+    /* Lock the event queue */
     if (!SDL_EventQ.lock || SDL_LockMutex(SDL_EventQ.lock) == 0) {
+        /* Everything in the ring was added before anything we do now */
+        SDL_DrainEventRing(action == SDL_ADDEVENT);
+
         if (action == SDL_ADDEVENT) {
-            for (i = 0; i < numevents; ++i) {
-                used += SDL_AddEvent(&events[i]);
+            for ( ; i < numevents; ++i) {
+                if (SDL_CoalesceMotion && SDL_CoalesceEvent(&events[i])) {
+                    ++used;
+                } else {
+                    used += SDL_AddEvent(&events[i]);
+                }
             }
         } else {
             SDL_EventEntry *entry, *next;
@@ -614,9 +902,30 @@ SDL_PeepEvents(SDL_Event * events, int numevents, SDL_eventaction action,
     } else {
         return SDL_SetError("Couldn't lock event queue");
     }
+    if (action == SDL_ADDEVENT && used > 0) {
+        SDL_WakeEventWaiters();
+    }
     return (used);
 }
 
+int
+SDL_PeepEvents(SDL_Event * events, int numevents, SDL_eventaction action,
+               Uint32 minType, Uint32 maxType)
+{
+    int retval;
+
+    if (action != SDL_ADDEVENT) {
+        return SDL_PeepEventsInternal(events, numevents, action, minType, maxType);
+    }
+
+    /* Events can be added from any thread, so SDL_StopEventLoop() waits for
+       everyone who got in before it deactivated the queue to leave again */
+    SDL_AtomicAdd(&SDL_EventQ.pushers, 1);
+    retval = SDL_PeepEventsInternal(events, numevents, action, minType, maxType);
+    SDL_AtomicAdd(&SDL_EventQ.pushers, -1);
+    return retval;
+}
+
 SDL_bool
 SDL_HasEvent(Uint32 type)
 {
@@ -629,6 +938,19 @@ SDL_HasEvents(Uint32 minType, Uint32 maxType)
     return (SDL_PeepEvents(NULL, 0, SDL_PEEKEVENT, minType, maxType) > 0);
 }
 
+int
+SDL_GetCoalescedEventCount(Uint32 type)
+{
+    switch (type) {
+    case SDL_MOUSEMOTION:
+        return SDL_AtomicGet(&SDL_EventQ.mouse_motion_folded);
+    case SDL_FINGERMOTION:
+        return SDL_AtomicGet(&SDL_EventQ.finger_motion_folded);
+    default:
+        return 0;
+    }
+}
+
 void
 SDL_FlushEvent(Uint32 type)
 {
@@ -659,6 +981,7 @@ SDL_FlushEvents(Uint32 minType, Uint32 maxType)
     if (!SDL_EventQ.lock || SDL_LockMutex(SDL_EventQ.lock) == 0) {
         SDL_EventEntry *entry, *next;
         Uint32 type;
+        SDL_DrainEventRing(SDL_FALSE);
         for (entry = SDL_EventQ.head; entry; entry = next) {
             next = entry->next;
             type = entry->event.type;
@@ -707,17 +1030,153 @@ SDL_PollEvent(SDL_Event * event)
     return SDL_WaitEventTimeout(event, 0);
 }
 
+int
+SDL_PollEvents(SDL_Event * events, int numevents, Uint32 minType, Uint32 maxType)
+{
+    if (!events) {
+        return SDL_InvalidParamError("events");
+    }
+    if (numevents <= 0) {
+        return 0;
+    }
+
+    /* Pump once and take everything in a single pass over the queue */
+    SDL_PumpEvents();
+    return SDL_PeepEvents(events, numevents, SDL_GETEVENT, minType, maxType);
+}
+
 int
 SDL_WaitEvent(SDL_Event * event)
 {
     return SDL_WaitEventTimeout(event, -1);
 }
 
+/* Called after adding events */
+void
+SDL_WakeEventWaiters(void)
+{
+    SDL_VideoDevice *_this;
+
+    if (SDL_AtomicGet(&SDL_EventQ.waiters) == 0) {
+        return;
+    }
+
+    _this = SDL_GetVideoDevice();
+    if (_this && _this->SendWakeupEvent) {
+        _this->SendWakeupEvent(_this);
+    } else if (SDL_EventQ.wakeup) {
+        SDL_SemPost(SDL_EventQ.wakeup);
+    }
+}
+
+/* Semaphores can't be posted from a signal handler, so without a video
+   backend to wake, waiters check for pending signals on their own. */
+void
+SDL_WakeEventWaitersFromSignal(void)
+{
+    SDL_VideoDevice *_this;
+
+    if (SDL_AtomicGet(&SDL_EventQ.waiters) == 0) {
+        return;
+    }
+
+    _this = SDL_GetVideoDevice();
+    if (_this && _this->SendWakeupEvent) {
+        _this->SendWakeupEvent(_this);
+    }
+}
+
+/* Joysticks and sensors are only read when pumping, so they have to be polled */
+static SDL_bool
+SDL_EventsNeedPolling(void)
+{
+#if !SDL_JOYSTICK_DISABLED
+    /* Even with nothing plugged in, hotplug is only detected when pumping */
+    if (SDL_WasInit(SDL_INIT_JOYSTICK)) {
+        return SDL_TRUE;
+    }
+#endif
+#if !SDL_SENSOR_DISABLED
+    if (SDL_WasInit(SDL_INIT_SENSOR)) {
+        return SDL_TRUE;
+    }
+#endif
+    return SDL_FALSE;
+}
+
+/* How often waiters without a video backend look for pending signals, in ms */
+#define SDL_SIGNAL_CHECK_INTERVAL   100
+
+/* Sleep until an event is added, the video backend has input, or the timeout
+   expires. Whoever adds an event checks SDL_EventQ.waiters after adding it,
+   and we check the queue after bumping it, so a wakeup can't be missed. */
+static int
+SDL_WaitEventTimeout_Blocking(SDL_VideoDevice *_this, SDL_Event * event, int timeout)
+{
+    const Uint32 expiration = SDL_GetTicks() + timeout;
+
+    for (;;) {
+        int status;
+        int remaining = -1;
+
+        SDL_PumpEvents();
+
+        SDL_AtomicAdd(&SDL_EventQ.waiters, 1);
+
+        /* In case a signal came in before there was anyone to wake up */
+        SDL_SendPendingSignalEvents();
+
+        status = SDL_PeepEvents(event, 1, SDL_GETEVENT, SDL_FIRSTEVENT, SDL_LASTEVENT);
+        if (status != 0) {
+            SDL_AtomicAdd(&SDL_EventQ.waiters, -1);
+            return (status > 0) ? 1 : 0;
+        }
+
+        if (timeout > 0) {
+            const Uint32 now = SDL_GetTicks();
+            if (SDL_TICKS_PASSED(now, expiration)) {
+                /* Timeout expired and no events */
+                SDL_AtomicAdd(&SDL_EventQ.waiters, -1);
+                return 0;
+            }
+            remaining = (int) (expiration - now);
+        }
+
+        if (_this) {
+            if (_this->WaitEventTimeout(_this, remaining) < 0) {
+                /* The backend can't wait anymore, report the error */
+                SDL_AtomicAdd(&SDL_EventQ.waiters, -1);
+                return 0;
+            }
+        } else {
+            /* A signal handler can't post the semaphore, so look for signals now and then */
+            if (remaining < 0 || remaining > SDL_SIGNAL_CHECK_INTERVAL) {
+                remaining = SDL_SIGNAL_CHECK_INTERVAL;
+            }
+            SDL_SemWaitTimeout(SDL_EventQ.wakeup, (Uint32) remaining);
+            /* One look at the queue covers every event added while we slept */
+            while (SDL_SemTryWait(SDL_EventQ.wakeup) == 0) {
+                continue;
+            }
+        }
+
+        SDL_AtomicAdd(&SDL_EventQ.waiters, -1);
+    }
+}
+
 int
 SDL_WaitEventTimeout(SDL_Event * event, int timeout)
 {
+    SDL_VideoDevice *_this = SDL_GetVideoDevice();
     Uint32 expiration = 0;
 
+    /* Block if whatever we'd be waiting for can wake us up */
+    if (timeout != 0 && !SDL_EventsNeedPolling()) {
+        if (_this ? (_this->WaitEventTimeout != NULL) : (SDL_EventQ.wakeup != NULL)) {
+            return SDL_WaitEventTimeout_Blocking(_this, event, timeout);
+        }
+    }
+
     if (timeout > 0)
         expiration = SDL_GetTicks() + timeout;
 
@@ -893,6 +1352,7 @@ SDL_FilterEvents(SDL_EventFilter filter, void *userdata)
 {
     if (!SDL_EventQ.lock || SDL_LockMutex(SDL_EventQ.lock) == 0) {
         SDL_EventEntry *entry, *next;
+        SDL_DrainEventRing(SDL_FALSE);
         for (entry = SDL_EventQ.head; entry; entry = next) {
             next = entry->next;
             if (!filter(userdata, &entry->event)) {
@@ -1009,8 +1469,10 @@ int
 SDL_EventsInit(void)
 {
     SDL_AddHintCallback(SDL_HINT_EVENT_LOGGING, SDL_EventLoggingChanged, NULL);
+    SDL_AddHintCallback(SDL_HINT_EVENT_COALESCE_MOTION, SDL_CoalesceMotionChanged, NULL);
     if (SDL_StartEventLoop() < 0) {
         SDL_DelHintCallback(SDL_HINT_EVENT_LOGGING, SDL_EventLoggingChanged, NULL);
+        SDL_DelHintCallback(SDL_HINT_EVENT_COALESCE_MOTION, SDL_CoalesceMotionChanged, NULL);
         return -1;
     }
 
@@ -1025,6 +1487,7 @@ SDL_EventsQuit(void)
     SDL_QuitQuit();
     SDL_StopEventLoop();
     SDL_DelHintCallback(SDL_HINT_EVENT_LOGGING, SDL_EventLoggingChanged, NULL);
+    SDL_DelHintCallback(SDL_HINT_EVENT_COALESCE_MOTION, SDL_CoalesceMotionChanged, NULL);
 }
 
 /* vi: set ts=4 sw=4 expandtab: */
@@ -53,6 +53,8 @@ extern int SDL_EventsInit(void);
 extern void SDL_EventsQuit(void);
 
 extern void SDL_SendPendingSignalEvents(void);
+extern void SDL_WakeEventWaiters(void);
+extern void SDL_WakeEventWaitersFromSignal(void);
 
 extern int SDL_QuitInit(void);
 extern void SDL_QuitQuit(void);
@@ -37,14 +37,14 @@
 
 #ifdef HAVE_SIGNAL_SUPPORT
 static SDL_bool disable_signals = SDL_FALSE;
-static SDL_bool send_quit_pending = SDL_FALSE;
+static volatile sig_atomic_t send_quit_pending = SDL_FALSE;
 
 #ifdef SDL_BACKGROUNDING_SIGNAL
-static SDL_bool send_backgrounding_pending = SDL_FALSE;
+static volatile sig_atomic_t send_backgrounding_pending = SDL_FALSE;
 #endif
 
 #ifdef SDL_FOREGROUNDING_SIGNAL
-static SDL_bool send_foregrounding_pending = SDL_FALSE;
+static volatile sig_atomic_t send_foregrounding_pending = SDL_FALSE;
 #endif
 
 static void
@@ -70,6 +70,9 @@ SDL_HandleSIG(int sig)
         send_foregrounding_pending = SDL_TRUE;
     }
     #endif
+
+    /* Get SDL_WaitEvent() to pump, so the events are sent */
+    SDL_WakeEventWaitersFromSignal();
 }
 
 static void
@@ -0,0 +1,519 @@
+/*
+  Simple DirectMedia Layer
+  Copyright (C) 1997-2020 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+#include "../SDL_internal.h"
+
+/* Packs small surfaces into a few large textures, so that drawing them
+   one after another stays on the same texture and can be batched.
+
+   Each page is packed with a skyline: the top edge of the used area,
+   stored as a list of horizontal segments from left to right. A new rect
+   goes wherever it ends up lowest (bottom-left), and then raises the
+   skyline over its width.
+*/
+
+#include "SDL_assert.h"
+#include "SDL_sysrender.h"
+
+#define ATLAS_DEFAULT_PAGE_SIZE 1024
+
+/* Keep a pixel between neighbors, so linear filtering doesn't bleed */
+#define ATLAS_PADDING   1
+
+typedef struct SDL_AtlasNode
+{
+    int x, y, w;
+} SDL_AtlasNode;
+
+typedef struct SDL_AtlasPage
+{
+    SDL_Texture *texture;
+    SDL_AtlasNode *nodes;
+    int num_nodes;
+    int max_nodes;
+} SDL_AtlasPage;
+
+struct SDL_TextureAtlas
+{
+    SDL_Renderer *renderer;
+    Uint32 format;
+    int page_w;
+    int page_h;
+    SDL_AtlasPage *pages;
+    int num_pages;
+    int num_textures;
+    Sint64 used_area;
+
+    SDL_TextureAtlas *prev;
+    SDL_TextureAtlas *next;
+};
+
+
+/* Returns the y a w wide rect would sit at if placed at node i, or -1 if it doesn't fit */
+static int
+SkylineFit(const SDL_TextureAtlas *atlas, const SDL_AtlasPage *page, int i, int w, int h)
+{
+    int x = page->nodes[i].x;
+    int y = 0;
+    int width_left = w;
+
+    if (x + w > atlas->page_w) {
+        return -1;
+    }
+    while (width_left > 0) {
+        if (i >= page->num_nodes) {
+            return -1;
+        }
+        y = SDL_max(y, page->nodes[i].y);
+        if (y + h > atlas->page_h) {
+            return -1;
+        }
+        width_left -= page->nodes[i].w;
+        ++i;
+    }
+    return y;
+}
+
+/* Finds the spot for a w x h rect on the page, without taking it yet */
+static SDL_bool
+SkylineFind(const SDL_TextureAtlas *atlas, const SDL_AtlasPage *page, int w, int h, int *index, SDL_Rect *rect)
+{
+    int best_index = -1;
+    int best_bottom = atlas->page_h + 1;
+    int best_width = atlas->page_w + 1;
+    int best_x = 0, best_y = 0;
+    int i;
+
+    for (i = 0; i < page->num_nodes; ++i) {
+        const int y = SkylineFit(atlas, page, i, w, h);
+        if (y >= 0) {
+            if (y + h < best_bottom ||
+                (y + h == best_bottom && page->nodes[i].w < best_width)) {
+                best_index = i;
+                best_bottom = y + h;
+                best_width = page->nodes[i].w;
+                best_x = page->nodes[i].x;
+                best_y = y;
+            }
+        }
+    }
+    if (best_index < 0) {
+        return SDL_FALSE;
+    }
+
+    *index = best_index;
+    rect->x = best_x;
+    rect->y = best_y;
+    rect->w = w;
+    rect->h = h;
+    return SDL_TRUE;
+}
+
+/* Makes room for the segment SkylineAdd() puts in, so that it can't fail */
+static int
+SkylineReserve(SDL_AtlasPage *page)
+{
+    if (page->num_nodes == page->max_nodes) {
+        const int max_nodes = page->max_nodes * 2;
+        SDL_AtlasNode *nodes = (SDL_AtlasNode *) SDL_realloc(page->nodes, max_nodes * sizeof (*nodes));
+        if (!nodes) {
+            return SDL_OutOfMemory();
+        }
+        page->nodes = nodes;
+        page->max_nodes = max_nodes;
+    }
+    return 0;
+}
+
+/* Raises the skyline over a rect found by SkylineFind() */
+static void
+SkylineAdd(SDL_AtlasPage *page, int index, const SDL_Rect *rect)
+{
+    int i;
+
+    SDL_assert(page->num_nodes < page->max_nodes);
+
+    /* Put the new segment in, and cut away whatever it covers to the right */
+    SDL_memmove(&page->nodes[index + 1], &page->nodes[index],
+                (page->num_nodes - index) * sizeof (*page->nodes));
+    page->nodes[index].x = rect->x;
+    page->nodes[index].y = rect->y + rect->h;
+    page->nodes[index].w = rect->w;
+    ++page->num_nodes;
+
+    for (i = index + 1; i < page->num_nodes; ++i) {
+        SDL_AtlasNode *node = &page->nodes[i];
+        const int covered = (page->nodes[i - 1].x + page->nodes[i - 1].w) - node->x;
+        if (covered <= 0) {
+            break;
+        }
+        if (covered < node->w) {
+            node->x += covered;
+            node->w -= covered;
+            break;
+        }
+        SDL_memmove(node, node + 1, (page->num_nodes - i - 1) * sizeof (*page->nodes));
+        --page->num_nodes;
+        --i;
+    }
+
+    /* Join up segments at the same height */
+    for (i = 0; i < page->num_nodes - 1; ++i) {
+        if (page->nodes[i].y == page->nodes[i + 1].y) {
+            page->nodes[i].w += page->nodes[i + 1].w;
+            SDL_memmove(&page->nodes[i + 1], &page->nodes[i + 2],
+                        (page->num_nodes - i - 2) * sizeof (*page->nodes));
+            --page->num_nodes;
+            --i;
+        }
+    }
+}
+
+static SDL_AtlasPage *
+AddAtlasPage(SDL_TextureAtlas *atlas)
+{
+    SDL_AtlasPage *pages;
+    SDL_AtlasPage *page;
+    void *pixels;
+    int pitch;
+
+    pages = (SDL_AtlasPage *) SDL_realloc(atlas->pages, (atlas->num_pages + 1) * sizeof (*pages));
+    if (!pages) {
+        SDL_OutOfMemory();
+        return NULL;
+    }
+    atlas->pages = pages;
+    page = &pages[atlas->num_pages];
+    SDL_zerop(page);
+
+    page->max_nodes = 16;
+    page->nodes = (SDL_AtlasNode *) SDL_malloc(page->max_nodes * sizeof (*page->nodes));
+    if (!page->nodes) {
+        SDL_OutOfMemory();
+        return NULL;
+    }
+    page->nodes[0].x = 0;
+    page->nodes[0].y = 0;
+    page->nodes[0].w = atlas->page_w;
+    page->num_nodes = 1;
+
+    page->texture = SDL_CreateTexture(atlas->renderer, atlas->format, SDL_TEXTUREACCESS_STATIC, atlas->page_w, atlas->page_h);
+    if (!page->texture) {
+        SDL_free(page->nodes);
+        return NULL;
+    }
+
+    /* Textures start out undefined, and the padding has to be transparent */
+    pitch = atlas->page_w * SDL_BYTESPERPIXEL(atlas->format);
+    pixels = SDL_calloc(atlas->page_h, pitch);
+    if (!pixels) {
+        SDL_DestroyTexture(page->texture);
+        SDL_free(page->nodes);
+        SDL_OutOfMemory();
+        return NULL;
+    }
+    if (SDL_UpdateTexture(page->texture, NULL, pixels, pitch) < 0) {
+        SDL_free(pixels);
+        SDL_DestroyTexture(page->texture);
+        SDL_free(page->nodes);
+        return NULL;
+    }
+    SDL_free(pixels);
+
+    SDL_SetTextureBlendMode(page->texture, SDL_BLENDMODE_BLEND);
+
+    ++atlas->num_pages;
+    return page;
+}
+
+/* Drops the page AddAtlasPage() just added, if nothing ended up on it */
+static void
+RemoveLastAtlasPage(SDL_TextureAtlas *atlas)
+{
+    SDL_AtlasPage *page = &atlas->pages[atlas->num_pages - 1];
+
+    SDL_DestroyTexture(page->texture);
+    SDL_free(page->nodes);
+    --atlas->num_pages;
+}
+
+SDL_TextureAtlas *
+SDL_CreateTextureAtlas(SDL_Renderer * renderer, int page_width, int page_height)
+{
+    SDL_RendererInfo info;
+    SDL_TextureAtlas *atlas;
+    Uint32 format = SDL_PIXELFORMAT_ARGB8888;
+    Uint32 i;
+
+    if (SDL_GetRendererInfo(renderer, &info) < 0) {
+        return NULL;
+    }
+    if (page_width < 0) {
+        SDL_InvalidParamError("page_width");
+        return NULL;
+    }
+    if (page_height < 0) {
+        SDL_InvalidParamError("page_height");
+        return NULL;
+    }
+
+    if (!page_width) {
+        page_width = ATLAS_DEFAULT_PAGE_SIZE;
+        if (info.max_texture_width) {
+            page_width = SDL_min(page_width, info.max_texture_width);
+        }
+    }
+    if (!page_height) {
+        page_height = ATLAS_DEFAULT_PAGE_SIZE;
+        if (info.max_texture_height) {
+            page_height = SDL_min(page_height, info.max_texture_height);
+        }
+    }
+    if ((info.max_texture_width && page_width > info.max_texture_width) ||
+        (info.max_texture_height && page_height > info.max_texture_height)) {
+        SDL_SetError("Texture dimensions are limited to %dx%d", info.max_texture_width, info.max_texture_height);
+        return NULL;
+    }
+
+    /* Pages hold anything, so they need alpha */
+    for (i = 0; i < info.num_texture_formats; ++i) {
+        if (!SDL_ISPIXELFORMAT_FOURCC(info.texture_formats[i]) &&
+            SDL_ISPIXELFORMAT_ALPHA(info.texture_formats[i])) {
+            format = info.texture_formats[i];
+            break;
+        }
+    }
+
+    atlas = (SDL_TextureAtlas *) SDL_calloc(1, sizeof (*atlas));
+    if (!atlas) {
+        SDL_OutOfMemory();
+        return NULL;
+    }
+    atlas->renderer = renderer;
+    atlas->format = format;
+    atlas->page_w = page_width;
+    atlas->page_h = page_height;
+
+    atlas->next = renderer->atlases;
+    if (renderer->atlases) {
+        renderer->atlases->prev = atlas;
+    }
+    renderer->atlases = atlas;
+
+    return atlas;
+}
+
+SDL_Texture *
+SDL_AtlasAddSurface(SDL_TextureAtlas * atlas, SDL_Surface * surface)
+{
+    SDL_Surface *converted = NULL;
+    SDL_Surface *source;
+    SDL_AtlasPage *page = NULL;
+    SDL_bool new_page = SDL_FALSE;
+    SDL_Texture *texture = NULL;
+    SDL_Rect rect;
+    int index = 0;
+    int w, h, i;
+
+    if (!atlas) {
+        SDL_InvalidParamError("atlas");
+        return NULL;
+    }
+    if (!surface) {
+        SDL_InvalidParamError("surface");
+        return NULL;
+    }
+    if (surface->w <= 0 || surface->h <= 0) {
+        SDL_SetError("Texture dimensions can't be 0");
+        return NULL;
+    }
+    if (surface->w > atlas->page_w || surface->h > atlas->page_h) {
+        SDL_SetError("Surface is larger than the %dx%d atlas pages", atlas->page_w, atlas->page_h);
+        return NULL;
+    }
+
+    /* Same conversion rules as SDL_CreateTextureFromSurface(), done before
+       taking any space, so that a failure leaves the atlas as it was */
+    if (surface->format->format != atlas->format || SDL_HasColorKey(surface)) {
+        converted = SDL_ConvertSurfaceFormat(surface, atlas->format, 0);
+        if (!converted) {
+            return NULL;
+        }
+        source = converted;
+    } else {
+        source = surface;
+        if (SDL_LockSurface(source) < 0) {
+            return NULL;
+        }
+    }
+
+    /* The padding only goes right and below, so it can be dropped at the page edge */
+    w = SDL_min(surface->w + ATLAS_PADDING, atlas->page_w);
+    h = SDL_min(surface->h + ATLAS_PADDING, atlas->page_h);
+    for (i = 0; i < atlas->num_pages; ++i) {
+        if (SkylineFind(atlas, &atlas->pages[i], w, h, &index, &rect)) {
+            page = &atlas->pages[i];
+            break;
+        }
+    }
+    if (!page) {
+        page = AddAtlasPage(atlas);
+        if (!page) {
+            goto failed;
+        }
+        new_page = SDL_TRUE;
+        if (!SkylineFind(atlas, page, w, h, &index, &rect)) {
+            SDL_SetError("Surface doesn't fit on an empty atlas page");
+            goto failed;
+        }
+    }
+    if (SkylineReserve(page) < 0) {
+        goto failed;
+    }
+
+    rect.w = surface->w;
+    rect.h = surface->h;
+    texture = SDL_CreatePackedTexture(atlas, page->texture, &rect);
+    if (!texture) {
+        goto failed;
+    }
+    ++atlas->num_textures;
+    atlas->used_area += (Sint64) rect.w * rect.h;
+
+    if (SDL_UpdateTexture(page->texture, &rect, source->pixels, source->pitch) < 0) {
+        SDL_DestroyTexture(texture);
+        texture = NULL;
+        goto failed;
+    }
+
+    /* Nothing can fail from here on, so the space is finally taken */
+    rect.w = w;
+    rect.h = h;
+    SkylineAdd(page, index, &rect);
+
+    if (converted) {
+        SDL_FreeSurface(converted);
+    } else {
+        SDL_UnlockSurface(source);
+    }
+
+    {
+        Uint8 r, g, b, a;
+        SDL_BlendMode blendMode;
+
+        SDL_GetSurfaceColorMod(surface, &r, &g, &b);
+        SDL_SetTextureColorMod(texture, r, g, b);
+
+        SDL_GetSurfaceAlphaMod(surface, &a);
+        SDL_SetTextureAlphaMod(texture, a);
+
+        if (SDL_HasColorKey(surface)) {
+            /* We converted to a texture with alpha format */
+            SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+        } else {
+            SDL_GetSurfaceBlendMode(surface, &blendMode);
+            SDL_SetTextureBlendMode(texture, blendMode);
+        }
+    }
+    return texture;
+
+failed:
+    if (new_page) {
+        RemoveLastAtlasPage(atlas);
+    }
+    if (converted) {
+        SDL_FreeSurface(converted);
+    } else {
+        SDL_UnlockSurface(source);
+    }
+    return NULL;
+}
+
+void
+SDL_ReleasePackedTexture(SDL_Texture *texture)
+{
+    SDL_TextureAtlas *atlas = texture->atlas;
+
+    --atlas->num_textures;
+    atlas->used_area -= (Sint64) texture->w * texture->h;
+}
+
+int
+SDL_GetTextureAtlasInfo(SDL_TextureAtlas * atlas, int *pages, int *textures, float *efficiency)
+{
+    if (!atlas) {
+        return SDL_InvalidParamError("atlas");
+    }
+
+    if (pages) {
+        *pages = atlas->num_pages;
+    }
+    if (textures) {
+        *textures = atlas->num_textures;
+    }
+    if (efficiency) {
+        if (atlas->num_pages > 0) {
+            *efficiency = (float) ((double) atlas->used_area / ((double) atlas->num_pages * atlas->page_w * atlas->page_h));
+        } else {
+            *efficiency = 0.0f;
+        }
+    }
+    return 0;
+}
+
+void
+SDL_DestroyTextureAtlas(SDL_TextureAtlas * atlas)
+{
+    SDL_Renderer *renderer;
+    SDL_Texture *texture;
+    int i;
+
+    if (!atlas) {
+        return;
+    }
+    renderer = atlas->renderer;
+
+    texture = renderer->textures;
+    while (texture) {
+        SDL_Texture *next = texture->next;
+        if (texture->atlas == atlas) {
+            SDL_DestroyTexture(texture);
+        }
+        texture = next;
+    }
+
+    for (i = 0; i < atlas->num_pages; ++i) {
+        SDL_DestroyTexture(atlas->pages[i].texture);
+        SDL_free(atlas->pages[i].nodes);
+    }
+    SDL_free(atlas->pages);
+
+    if (atlas->next) {
+        atlas->next->prev = atlas->prev;
+    }
+    if (atlas->prev) {
+        atlas->prev->next = atlas->next;
+    } else {
+        renderer->atlases = atlas->next;
+    }
+    SDL_free(atlas);
+}
+
+/* vi: set ts=4 sw=4 expandtab: */
@@ -199,35 +199,163 @@ DebugLogRenderCommands(const SDL_RenderCommand *cmd)
                         (int) cmd->data.draw.b, (int) cmd->data.draw.a,
                         (int) cmd->data.draw.blend, cmd->data.draw.texture);
                 break;
+
+            case SDL_RENDERCMD_COPY_SPRITES:
+                SDL_Log(" %u. copy sprites (first=%u, count=%u, r=%d, g=%d, b=%d, a=%d, blend=%d, tex=%p)", i++,
+                        (unsigned int) cmd->data.draw.first,
+                        (unsigned int) cmd->data.draw.count,
+                        (int) cmd->data.draw.r, (int) cmd->data.draw.g,
+                        (int) cmd->data.draw.b, (int) cmd->data.draw.a,
+                        (int) cmd->data.draw.blend, cmd->data.draw.texture);
+                break;
         }
         cmd = cmd->next;
     }
 #endif
 }
 
+static SDL_bool
+IsSameRenderState(const SDL_RenderCommand *a, const SDL_RenderCommand *b)
+{
+    switch (a->command) {
+        case SDL_RENDERCMD_SETVIEWPORT:
+            return (SDL_memcmp(&a->data.viewport.rect, &b->data.viewport.rect, sizeof (SDL_Rect)) == 0);
+
+        case SDL_RENDERCMD_SETCLIPRECT:
+            return (a->data.cliprect.enabled == b->data.cliprect.enabled) &&
+                   (SDL_memcmp(&a->data.cliprect.rect, &b->data.cliprect.rect, sizeof (SDL_Rect)) == 0);
+
+        case SDL_RENDERCMD_SETDRAWCOLOR:
+            return (a->data.color.r == b->data.color.r) && (a->data.color.g == b->data.color.g) &&
+                   (a->data.color.b == b->data.color.b) && (a->data.color.a == b->data.color.a);
+
+        default:
+            return SDL_FALSE;
+    }
+}
+
+static SDL_bool
+CanMergeRenderCommands(const SDL_Renderer *renderer, const SDL_RenderCommand *a, const SDL_RenderCommand *b)
+{
+    if (a->command != b->command) {
+        return SDL_FALSE;
+    } else if (a->command == SDL_RENDERCMD_FILL_RECTS) {
+        if (!renderer->merge_fill_rects) {
+            return SDL_FALSE;
+        }
+    } else if (a->command == SDL_RENDERCMD_COPY) {
+        if (!renderer->merge_copies) {
+            return SDL_FALSE;
+        }
+    } else {
+        return SDL_FALSE;
+    }
+
+    /* the vertex data has to follow on directly, without alignment padding. */
+    return (b->data.draw.first == a->data.draw.first + a->data.draw.size) &&
+           (a->data.draw.texture == b->data.draw.texture) &&
+           (a->data.draw.blend == b->data.draw.blend) &&
+           (a->data.draw.r == b->data.draw.r) && (a->data.draw.g == b->data.draw.g) &&
+           (a->data.draw.b == b->data.draw.b) && (a->data.draw.a == b->data.draw.a);
+}
+
+/* Drop state changes that are overridden before anything draws with them, or
+   that set what the previous draw already used, then fold adjacent draws the
+   backend can run as one. The vertex data isn't touched, only the commands. */
+static void
+OptimizeRenderCommands(SDL_Renderer *renderer)
+{
+    SDL_RenderCommand *cmds = renderer->render_commands;
+    const size_t total = renderer->render_commands_used;
+    SDL_RenderCommand *pending[3] = { NULL, NULL, NULL };  /* set since the last draw, by state type */
+    const SDL_RenderCommand *current[3] = { NULL, NULL, NULL };  /* what the last draw used */
+    SDL_RenderCommand *prev = NULL;
+    size_t i, used = 0;
+    int j;
+
+    for (i = 0; i < total; i++) {
+        SDL_RenderCommand *cmd = &cmds[i];
+        switch (cmd->command) {
+            case SDL_RENDERCMD_NO_OP:
+                break;
+
+            case SDL_RENDERCMD_SETVIEWPORT:
+            case SDL_RENDERCMD_SETCLIPRECT:
+            case SDL_RENDERCMD_SETDRAWCOLOR:
+                j = (int) (cmd->command - SDL_RENDERCMD_SETVIEWPORT);
+                if (pending[j]) {
+                    pending[j]->command = SDL_RENDERCMD_NO_OP;
+                }
+                pending[j] = cmd;
+                break;
+
+            default:  /* clears and draws use whatever state is pending. */
+                for (j = 0; j < (int) SDL_arraysize(pending); j++) {
+                    if (!pending[j]) {
+                        continue;
+                    }
+                    if (current[j] && IsSameRenderState(current[j], pending[j])) {
+                        pending[j]->command = SDL_RENDERCMD_NO_OP;
+                    } else {
+                        current[j] = pending[j];
+                    }
+                    pending[j] = NULL;
+                }
+                break;
+        }
+    }
+
+    for (i = 0; i < total; i++) {
+        SDL_RenderCommand *cmd = &cmds[i];
+        if (cmd->command == SDL_RENDERCMD_NO_OP) {
+            continue;
+        }
+        if (prev && CanMergeRenderCommands(renderer, prev, cmd)) {
+            prev->data.draw.count += cmd->data.draw.count;
+            prev->data.draw.size += cmd->data.draw.size;
+            continue;
+        }
+        prev = &cmds[used++];
+        if (prev != cmd) {
+            SDL_memcpy(prev, cmd, sizeof (*cmd));
+        }
+    }
+
+    renderer->render_commands_used = used;
+}
+
 static int
 FlushRenderCommands(SDL_Renderer *renderer)
 {
+    SDL_RenderCommand *cmd;
+    size_t i;
     int retval;
 
-    SDL_assert((renderer->render_commands == NULL) == (renderer->render_commands_tail == NULL));
-
-    if (renderer->render_commands == NULL) {  /* nothing to do! */
+    if (renderer->render_commands_used == 0) {  /* nothing to do! */
         SDL_assert(renderer->vertex_data_used == 0);
         return 0;
     }
 
-    DebugLogRenderCommands(renderer->render_commands);
+    renderer->frame_commands_in += (int) renderer->render_commands_used;
+    OptimizeRenderCommands(renderer);
+    renderer->frame_commands_out += (int) renderer->render_commands_used;
 
-    retval = renderer->RunCommandQueue(renderer, renderer->render_commands, renderer->vertex_data, renderer->vertex_data_used);
+    retval = 0;
+    if (renderer->render_commands_used > 0) {
+        /* The array can't move anymore, so chain the commands up for the backend. */
+        cmd = renderer->render_commands;
+        for (i = 1; i < renderer->render_commands_used; i++, cmd++) {
+            cmd->next = cmd + 1;
+        }
+        cmd->next = NULL;
 
-    /* Move the whole render command queue to the unused pool so we can reuse them next time. */
-    if (renderer->render_commands_tail != NULL) {
-        renderer->render_commands_tail->next = renderer->render_commands_pool;
-        renderer->render_commands_pool = renderer->render_commands;
-        renderer->render_commands_tail = NULL;
-        renderer->render_commands = NULL;
+        DebugLogRenderCommands(renderer->render_commands);
+
+        retval = renderer->RunCommandQueue(renderer, renderer->render_commands, renderer->vertex_data, renderer->vertex_data_used);
     }
+
+    /* Keep the command array around, so we can reuse it next time. */
+    renderer->render_commands_used = 0;
     renderer->vertex_data_used = 0;
     renderer->render_command_generation++;
     renderer->color_queued = SDL_FALSE;
@@ -259,6 +387,20 @@ SDL_RenderFlush(SDL_Renderer * renderer)
     return FlushRenderCommands(renderer);
 }
 
+int
+SDL_RenderGetCommandStats(SDL_Renderer * renderer, int *commands_in, int *commands_out)
+{
+    CHECK_RENDERER_MAGIC(renderer, -1);
+
+    if (commands_in) {
+        *commands_in = renderer->last_frame_commands_in;
+    }
+    if (commands_out) {
+        *commands_out = renderer->last_frame_commands_out;
+    }
+    return 0;
+}
+
 void *
 SDL_AllocateRenderVertices(SDL_Renderer *renderer, const size_t numbytes, const size_t alignment, size_t *offset)
 {
@@ -293,31 +435,28 @@ SDL_AllocateRenderVertices(SDL_Renderer *renderer, const size_t numbytes, const
     return ((Uint8 *) renderer->vertex_data) + aligned;
 }
 
+/* Commands live in one array that grows like the vertex data does. Pointers
+   returned here are only valid until the next call, because the array might
+   get realloc()'d. */
 static SDL_RenderCommand *
 AllocateRenderCommand(SDL_Renderer *renderer)
 {
     SDL_RenderCommand *retval = NULL;
 
     /* !!! FIXME: are there threading limitations in SDL's render API? If not, we need to mutex this. */
-    retval = renderer->render_commands_pool;
-    if (retval != NULL) {
-        renderer->render_commands_pool = retval->next;
-        retval->next = NULL;
-    } else {
-        retval = SDL_calloc(1, sizeof (*retval));
-        if (!retval) {
+    if (renderer->render_commands_used >= renderer->render_commands_allocation) {
+        const size_t newsize = renderer->render_commands_allocation ? (renderer->render_commands_allocation * 2) : 128;
+        void *ptr = SDL_realloc(renderer->render_commands, newsize * sizeof (SDL_RenderCommand));
+        if (ptr == NULL) {
             SDL_OutOfMemory();
             return NULL;
         }
+        renderer->render_commands = (SDL_RenderCommand *) ptr;
+        renderer->render_commands_allocation = newsize;
     }
 
-    SDL_assert((renderer->render_commands == NULL) == (renderer->render_commands_tail == NULL));
-    if (renderer->render_commands_tail != NULL) {
-        renderer->render_commands_tail->next = retval;
-    } else {
-        renderer->render_commands = retval;
-    }
-    renderer->render_commands_tail = retval;
+    retval = &renderer->render_commands[renderer->render_commands_used++];
+    retval->next = NULL;
 
     return retval;
 }
@@ -440,6 +579,7 @@ PrepQueueCmdDrawSolid(SDL_Renderer *renderer, const SDL_RenderCommandType cmdtyp
             cmd->command = cmdtype;
             cmd->data.draw.first = 0;  /* render backend will fill this in. */
             cmd->data.draw.count = 0;  /* render backend will fill this in. */
+            cmd->data.draw.size = 0;
             cmd->data.draw.r = renderer->r;
             cmd->data.draw.g = renderer->g;
             cmd->data.draw.b = renderer->b;
@@ -460,6 +600,8 @@ QueueCmdDrawPoints(SDL_Renderer *renderer, const SDL_FPoint * points, const int
         retval = renderer->QueueDrawPoints(renderer, cmd, points, count);
         if (retval < 0) {
             cmd->command = SDL_RENDERCMD_NO_OP;
+        } else {
+            cmd->data.draw.size = renderer->vertex_data_used - cmd->data.draw.first;
         }
     }
     return retval;
@@ -474,6 +616,8 @@ QueueCmdDrawLines(SDL_Renderer *renderer, const SDL_FPoint * points, const int c
         retval = renderer->QueueDrawLines(renderer, cmd, points, count);
         if (retval < 0) {
             cmd->command = SDL_RENDERCMD_NO_OP;
+        } else {
+            cmd->data.draw.size = renderer->vertex_data_used - cmd->data.draw.first;
         }
     }
     return retval;
@@ -488,26 +632,31 @@ QueueCmdFillRects(SDL_Renderer *renderer, const SDL_FRect * rects, const int cou
         retval = renderer->QueueFillRects(renderer, cmd, rects, count);
         if (retval < 0) {
             cmd->command = SDL_RENDERCMD_NO_OP;
+        } else {
+            cmd->data.draw.size = renderer->vertex_data_used - cmd->data.draw.first;
         }
     }
     return retval;
 }
 
 static SDL_RenderCommand *
-PrepQueueCmdDrawTexture(SDL_Renderer *renderer, SDL_Texture *texture, const SDL_RenderCommandType cmdtype)
+PrepQueueCmdDrawTexture(SDL_Renderer *renderer, SDL_Texture *texture,
+                        const Uint8 r, const Uint8 g, const Uint8 b, const Uint8 a,
+                        const SDL_RenderCommandType cmdtype)
 {
     /* !!! FIXME: drop this draw if viewport w or h is zero. */
     SDL_RenderCommand *cmd = NULL;
-    if (PrepQueueCmdDraw(renderer, texture->r, texture->g, texture->b, texture->a) == 0) {
+    if (PrepQueueCmdDraw(renderer, r, g, b, a) == 0) {
         cmd = AllocateRenderCommand(renderer);
         if (cmd != NULL) {
             cmd->command = cmdtype;
             cmd->data.draw.first = 0;  /* render backend will fill this in. */
             cmd->data.draw.count = 0;  /* render backend will fill this in. */
-            cmd->data.draw.r = texture->r;
-            cmd->data.draw.g = texture->g;
-            cmd->data.draw.b = texture->b;
-            cmd->data.draw.a = texture->a;
+            cmd->data.draw.size = 0;
+            cmd->data.draw.r = r;
+            cmd->data.draw.g = g;
+            cmd->data.draw.b = b;
+            cmd->data.draw.a = a;
             cmd->data.draw.blend = texture->blendMode;
             cmd->data.draw.texture = texture;
         }
@@ -518,12 +667,14 @@ PrepQueueCmdDrawTexture(SDL_Renderer *renderer, SDL_Texture *texture, const SDL_
 static int
 QueueCmdCopy(SDL_Renderer *renderer, SDL_Texture * texture, const SDL_Rect * srcrect, const SDL_FRect * dstrect)
 {
-    SDL_RenderCommand *cmd = PrepQueueCmdDrawTexture(renderer, texture, SDL_RENDERCMD_COPY);
+    SDL_RenderCommand *cmd = PrepQueueCmdDrawTexture(renderer, texture, texture->r, texture->g, texture->b, texture->a, SDL_RENDERCMD_COPY);
     int retval = -1;
     if (cmd != NULL) {
         retval = renderer->QueueCopy(renderer, cmd, texture, srcrect, dstrect);
         if (retval < 0) {
             cmd->command = SDL_RENDERCMD_NO_OP;
+        } else {
+            cmd->data.draw.size = renderer->vertex_data_used - cmd->data.draw.first;
         }
     }
     return retval;
@@ -534,13 +685,57 @@ QueueCmdCopyEx(SDL_Renderer *renderer, SDL_Texture * texture,
                const SDL_Rect * srcquad, const SDL_FRect * dstrect,
                const double angle, const SDL_FPoint *center, const SDL_RendererFlip flip)
 {
-    SDL_RenderCommand *cmd = PrepQueueCmdDrawTexture(renderer, texture, SDL_RENDERCMD_COPY_EX);
+    SDL_RenderCommand *cmd = PrepQueueCmdDrawTexture(renderer, texture, texture->r, texture->g, texture->b, texture->a, SDL_RENDERCMD_COPY_EX);
     int retval = -1;
     SDL_assert(renderer->QueueCopyEx != NULL);  /* should have caught at higher level. */
     if (cmd != NULL) {
         retval = renderer->QueueCopyEx(renderer, cmd, texture, srcquad, dstrect, angle, center, flip);
         if (retval < 0) {
             cmd->command = SDL_RENDERCMD_NO_OP;
+        } else {
+            cmd->data.draw.size = renderer->vertex_data_used - cmd->data.draw.first;
+        }
+    }
+    return retval;
+}
+
+static int
+QueueCmdCopySprites(SDL_Renderer *renderer, SDL_Texture * texture, const SDL_RenderSprite * sprites, const int count)
+{
+    SDL_RenderCommand *cmd = PrepQueueCmdDrawTexture(renderer, texture, texture->r, texture->g, texture->b, texture->a, SDL_RENDERCMD_COPY_SPRITES);
+    int retval = -1;
+    if (cmd != NULL) {
+        retval = renderer->QueueCopySprites(renderer, cmd, texture, sprites, count);
+        if (retval < 0) {
+            cmd->command = SDL_RENDERCMD_NO_OP;
+        } else {
+            cmd->data.draw.size = renderer->vertex_data_used - cmd->data.draw.first;
+        }
+    }
+    return retval;
+}
+
+/* For backends without QueueCopySprites: one copy per sprite, with the sprite
+   color in place of the texture color. */
+static int
+QueueCmdCopySprite(SDL_Renderer *renderer, SDL_Texture * texture, const SDL_RenderSprite * sprite)
+{
+    const SDL_RenderCommandType cmdtype = (sprite->angle != 0.0) ? SDL_RENDERCMD_COPY_EX : SDL_RENDERCMD_COPY;
+    SDL_RenderCommand *cmd = PrepQueueCmdDrawTexture(renderer, texture, sprite->color.r, sprite->color.g, sprite->color.b, sprite->color.a, cmdtype);
+    int retval = -1;
+    if (cmd != NULL) {
+        if (cmdtype == SDL_RENDERCMD_COPY) {
+            retval = renderer->QueueCopy(renderer, cmd, texture, &sprite->srcrect, &sprite->dstrect);
+        } else {
+            SDL_FPoint center;
+            center.x = sprite->dstrect.w / 2.0f;
+            center.y = sprite->dstrect.h / 2.0f;
+            retval = renderer->QueueCopyEx(renderer, cmd, texture, &sprite->srcrect, &sprite->dstrect, sprite->angle, &center, SDL_FLIP_NONE);
+        }
+        if (retval < 0) {
+            cmd->command = SDL_RENDERCMD_NO_OP;
+        } else {
+            cmd->data.draw.size = renderer->vertex_data_used - cmd->data.draw.first;
         }
     }
     return retval;
@@ -924,6 +1119,14 @@ SDL_CreateSoftwareRenderer(SDL_Surface * surface)
         /* new textures start at zero, so we start at 1 so first render doesn't flush by accident. */
         renderer->render_command_generation = 1;
 
+        /* The app might read or write the surface pixels directly, so keep
+           the old unbatched behavior unless it asks for batching. */
+        if (renderer->always_batch) {
+            renderer->batching = SDL_TRUE;
+        } else {
+            renderer->batching = SDL_GetHintBoolean(SDL_HINT_RENDER_BATCHING, SDL_FALSE);
+        }
+
         SDL_RenderSetViewport(renderer, NULL);
     }
     return renderer;
@@ -1138,6 +1341,63 @@ SDL_CreateTexture(SDL_Renderer * renderer, Uint32 format, int access, int w, int
     return texture;
 }
 
+SDL_Texture *
+SDL_CreatePackedTexture(SDL_TextureAtlas *atlas, SDL_Texture *page, const SDL_Rect *rect)
+{
+    SDL_Renderer *renderer = page->renderer;
+    SDL_Texture *texture;
+
+    texture = (SDL_Texture *) SDL_calloc(1, sizeof(*texture));
+    if (!texture) {
+        SDL_OutOfMemory();
+        return NULL;
+    }
+    texture->magic = &texture_magic;
+    texture->format = page->format;
+    texture->access = SDL_TEXTUREACCESS_STATIC;
+    texture->w = rect->w;
+    texture->h = rect->h;
+    texture->r = 255;
+    texture->g = 255;
+    texture->b = 255;
+    texture->a = 255;
+    texture->scaleMode = page->scaleMode;
+    texture->renderer = renderer;
+    texture->atlas = atlas;
+    texture->page = page;
+    texture->page_rect = *rect;
+    texture->next = renderer->textures;
+    if (renderer->textures) {
+        renderer->textures->prev = texture;
+    }
+    renderer->textures = texture;
+    return texture;
+}
+
+/* Packed textures are drawn as their rect of the page, with their own color and blend mode */
+static SDL_Texture *
+GetPackedTexturePage(SDL_Texture *texture, SDL_Rect *srcrect)
+{
+    SDL_Texture *page = texture->page;
+
+    srcrect->x += texture->page_rect.x;
+    srcrect->y += texture->page_rect.y;
+
+    page->r = texture->r;
+    page->g = texture->g;
+    page->b = texture->b;
+    page->a = texture->a;
+    page->blendMode = texture->blendMode;
+    if (page->native) {
+        page->native->r = texture->r;
+        page->native->g = texture->g;
+        page->native->b = texture->b;
+        page->native->a = texture->a;
+        page->native->blendMode = texture->blendMode;
+    }
+    return page;
+}
+
 SDL_Texture *
 SDL_CreateTextureFromSurface(SDL_Renderer * renderer, SDL_Surface * surface)
 {
@@ -1406,6 +1666,10 @@ SDL_SetTextureScaleMode(SDL_Texture * texture, SDL_ScaleMode scaleMode)
 
     CHECK_TEXTURE_MAGIC(texture, -1);
 
+    if (texture->page) {
+        return SDL_SetError("Can't change the scale mode of a texture in an atlas");
+    }
+
     renderer = texture->renderer;
     renderer->SetTextureScaleMode(renderer, texture, scaleMode);
     texture->scaleMode = scaleMode;
@@ -1540,6 +1804,16 @@ SDL_UpdateTexture(SDL_Texture * texture, const SDL_Rect * rect,
 
     if ((rect->w == 0) || (rect->h == 0)) {
         return 0;  /* nothing to do. */
+    } else if (texture->page) {
+        /* Don't let the update spill over into the neighbors on the page */
+        SDL_Rect page_rect = *rect;
+        if (rect->x < 0 || rect->y < 0 ||
+            rect->x + rect->w > texture->w || rect->y + rect->h > texture->h) {
+            return SDL_InvalidParamError("rect");
+        }
+        page_rect.x += texture->page_rect.x;
+        page_rect.y += texture->page_rect.y;
+        return SDL_UpdateTexture(texture->page, &page_rect, pixels, pitch);
 #if SDL_HAVE_YUV
     } else if (texture->yuv) {
         return SDL_UpdateTextureYUV(texture, rect, pixels, pitch);
@@ -2985,6 +3259,9 @@ SDL_RenderCopyF(SDL_Renderer * renderer, SDL_Texture * texture,
         real_dstrect = *dstrect;
     }
 
+    if (texture->page) {
+        texture = GetPackedTexturePage(texture, &real_srcrect);
+    }
     if (texture->native) {
         texture = texture->native;
     }
@@ -3079,6 +3356,9 @@ SDL_RenderCopyExF(SDL_Renderer * renderer, SDL_Texture * texture,
         real_dstrect.h = (float) r.h;
     }
 
+    if (texture->page) {
+        texture = GetPackedTexturePage(texture, &real_srcrect);
+    }
     if (texture->native) {
         texture = texture->native;
     }
@@ -3104,6 +3384,116 @@ SDL_RenderCopyExF(SDL_Renderer * renderer, SDL_Texture * texture,
     return retval < 0 ? retval : FlushRenderCommandsIfNotBatching(renderer);
 }
 
+int
+SDL_RenderCopySprites(SDL_Renderer * renderer, SDL_Texture * texture,
+                      const SDL_RenderSprite * sprites, int count)
+{
+    SDL_Rect texture_rect;
+    SDL_FRect viewport_rect;
+    SDL_Rect r;
+    SDL_RenderSprite *prepared;
+    int offset_x = 0, offset_y = 0;
+    int i, num_prepared = 0;
+    int retval = 0;
+
+    CHECK_RENDERER_MAGIC(renderer, -1);
+    CHECK_TEXTURE_MAGIC(texture, -1);
+
+    if (renderer != texture->renderer) {
+        return SDL_SetError("Texture was not created with this renderer");
+    }
+    if (!sprites) {
+        return SDL_SetError("SDL_RenderCopySprites(): Passed NULL sprites");
+    }
+    if (count < 1) {
+        return 0;
+    }
+
+    /* Don't draw while we're hidden */
+    if (renderer->hidden) {
+        return 0;
+    }
+
+    if (count > renderer->sprite_data_allocation) {
+        prepared = (SDL_RenderSprite *) SDL_realloc(renderer->sprite_data, count * sizeof (*prepared));
+        if (!prepared) {
+            return SDL_OutOfMemory();
+        }
+        renderer->sprite_data = prepared;
+        renderer->sprite_data_allocation = count;
+    }
+    prepared = renderer->sprite_data;
+
+    texture_rect.x = 0;
+    texture_rect.y = 0;
+    texture_rect.w = texture->w;
+    texture_rect.h = texture->h;
+
+    SDL_zero(r);
+    SDL_RenderGetViewport(renderer, &r);
+    viewport_rect.x = 0.0f;
+    viewport_rect.y = 0.0f;
+    viewport_rect.w = (float) r.w;
+    viewport_rect.h = (float) r.h;
+
+    if (texture->page) {
+        SDL_Rect origin;
+        SDL_zero(origin);
+        texture = GetPackedTexturePage(texture, &origin);
+        offset_x = origin.x;
+        offset_y = origin.y;
+    }
+    if (texture->native) {
+        texture = texture->native;
+    }
+
+    /* Same clipping and scaling as SDL_RenderCopyF() and SDL_RenderCopyExF() */
+    for (i = 0; i < count; ++i) {
+        const SDL_RenderSprite *sprite = &sprites[i];
+        SDL_RenderSprite *out = &prepared[num_prepared];
+        const SDL_bool rotated = ((int)(sprite->angle/360) != sprite->angle/360);
+
+        if (!SDL_IntersectRect(&sprite->srcrect, &texture_rect, &out->srcrect)) {
+            continue;
+        }
+        out->srcrect.x += offset_x;
+        out->srcrect.y += offset_y;
+        if (!rotated && !SDL_HasIntersectionF(&sprite->dstrect, &viewport_rect)) {
+            continue;
+        }
+
+        out->dstrect.x = sprite->dstrect.x * renderer->scale.x;
+        out->dstrect.y = sprite->dstrect.y * renderer->scale.y;
+        out->dstrect.w = sprite->dstrect.w * renderer->scale.x;
+        out->dstrect.h = sprite->dstrect.h * renderer->scale.y;
+        out->color.r = (Uint8) ((sprite->color.r * texture->r) / 255);
+        out->color.g = (Uint8) ((sprite->color.g * texture->g) / 255);
+        out->color.b = (Uint8) ((sprite->color.b * texture->b) / 255);
+        out->color.a = (Uint8) ((sprite->color.a * texture->a) / 255);
+        out->angle = rotated ? sprite->angle : 0.0;
+
+        if (rotated && !renderer->QueueCopySprites && !renderer->QueueCopyEx) {
+            return SDL_SetError("Renderer does not support RenderCopyEx");
+        }
+        ++num_prepared;
+    }
+
+    if (num_prepared == 0) {
+        return 0;
+    }
+
+    texture->last_command_generation = renderer->render_command_generation;
+
+    if (renderer->QueueCopySprites) {
+        retval = QueueCmdCopySprites(renderer, texture, prepared, num_prepared);
+    } else {
+        for (i = 0; i < num_prepared && retval == 0; ++i) {
+            retval = QueueCmdCopySprite(renderer, texture, &prepared[i]);
+        }
+    }
+    return retval < 0 ? retval : FlushRenderCommandsIfNotBatching(renderer);
+}
+
 int
 SDL_RenderReadPixels(SDL_Renderer * renderer, const SDL_Rect * rect,
                      Uint32 format, void * pixels, int pitch)
@@ -3150,6 +3540,11 @@ SDL_RenderPresent(SDL_Renderer * renderer)
 
     FlushRenderCommands(renderer);  /* time to send everything to the GPU! */
 
+    renderer->last_frame_commands_in = renderer->frame_commands_in;
+    renderer->last_frame_commands_out = renderer->frame_commands_out;
+    renderer->frame_commands_in = 0;
+    renderer->frame_commands_out = 0;
+
     /* Don't present while we're hidden */
     if (renderer->hidden) {
         return;
@@ -3182,6 +3577,13 @@ SDL_DestroyTexture(SDL_Texture * texture)
         renderer->textures = texture->next;
     }
 
+    if (texture->page) {
+        /* The pixels belong to the atlas page, there's no backend texture */
+        SDL_ReleasePackedTexture(texture);
+        SDL_free(texture);
+        return;
+    }
+
     if (texture->native) {
         SDL_DestroyTexture(texture->native);
     }
@@ -3203,30 +3605,22 @@ SDL_DestroyTexture(SDL_Texture * texture)
 void
 SDL_DestroyRenderer(SDL_Renderer * renderer)
 {
-    SDL_RenderCommand *cmd;
-
     CHECK_RENDERER_MAGIC(renderer, );
 
     SDL_DelEventWatch(SDL_RendererEventWatch, renderer);
 
-    if (renderer->render_commands_tail != NULL) {
-        renderer->render_commands_tail->next = renderer->render_commands_pool;
-        cmd = renderer->render_commands;
-    } else {
-        cmd = renderer->render_commands_pool;
-    }
-
-    renderer->render_commands_pool = NULL;
-    renderer->render_commands_tail = NULL;
+    SDL_free(renderer->render_commands);
     renderer->render_commands = NULL;
-
-    while (cmd != NULL) {
-        SDL_RenderCommand *next = cmd->next;
-        SDL_free(cmd);
-        cmd = next;
-    }
+    renderer->render_commands_used = 0;
+    renderer->render_commands_allocation = 0;
 
     SDL_free(renderer->vertex_data);
+    SDL_free(renderer->sprite_data);
+
+    /* Atlases take their pages and packed textures with them */
+    while (renderer->atlases) {
+        SDL_DestroyTextureAtlas(renderer->atlases);
+    }
 
     /* Free existing textures for this renderer */
     while (renderer->textures) {
@@ -3256,7 +3650,9 @@ int SDL_GL_BindTexture(SDL_Texture *texture, float *texw, float *texh)
 
     CHECK_TEXTURE_MAGIC(texture, -1);
     renderer = texture->renderer;
-    if (texture->native) {
+    if (texture->page) {
+        return SDL_SetError("Can't bind a texture in an atlas, it's only part of a page");
+    } else if (texture->native) {
         return SDL_GL_BindTexture(texture->native, texw, texh);
     } else if (renderer && renderer->GL_BindTexture) {
         FlushRenderCommandsIfTextureNeeded(texture);  /* in case the app is going to mess with it. */
@@ -3272,7 +3668,9 @@ int SDL_GL_UnbindTexture(SDL_Texture *texture)
 
     CHECK_TEXTURE_MAGIC(texture, -1);
     renderer = texture->renderer;
-    if (texture->native) {
+    if (texture->page) {
+        return SDL_SetError("Can't bind a texture in an atlas, it's only part of a page");
+    } else if (texture->native) {
         return SDL_GL_UnbindTexture(texture->native);
     } else if (renderer && renderer->GL_UnbindTexture) {
         FlushRenderCommandsIfTextureNeeded(texture);  /* in case the app messed with it. */
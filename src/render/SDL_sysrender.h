@@ -55,6 +55,11 @@ struct SDL_Texture
     SDL_Rect locked_rect;
     SDL_Surface *locked_surface;  /**< Locked region exposed as a SDL surface */
 
+    /* Textures packed into a SDL_TextureAtlas draw from part of a page */
+    SDL_TextureAtlas *atlas;
+    SDL_Texture *page;
+    SDL_Rect page_rect;
+
     Uint32 last_command_generation; /* last command queue generation this texture was in. */
 
     void *driverdata;           /**< Driver specific texture representation */
@@ -74,7 +79,8 @@ typedef enum
     SDL_RENDERCMD_DRAW_LINES,
     SDL_RENDERCMD_FILL_RECTS,
     SDL_RENDERCMD_COPY,
-    SDL_RENDERCMD_COPY_EX
+    SDL_RENDERCMD_COPY_EX,
+    SDL_RENDERCMD_COPY_SPRITES
 } SDL_RenderCommandType;
 
 typedef struct SDL_RenderCommand
@@ -92,6 +98,7 @@ typedef struct SDL_RenderCommand
         struct {
             size_t first;
             size_t count;
+            size_t size;  /* bytes of vertex data, filled in after the backend queued it. */
             Uint8 r, g, b, a;
             SDL_BlendMode blend;
             SDL_Texture *texture;
@@ -101,7 +108,7 @@ typedef struct SDL_RenderCommand
             Uint8 r, g, b, a;
         } color;
     } data;
-    struct SDL_RenderCommand *next;
+    struct SDL_RenderCommand *next;  /* set up when the queue is flushed, always the following array element. */
 } SDL_RenderCommand;
 
 
@@ -127,6 +134,8 @@ struct SDL_Renderer
     int (*QueueCopyEx) (SDL_Renderer * renderer, SDL_RenderCommand *cmd, SDL_Texture * texture,
                         const SDL_Rect * srcquad, const SDL_FRect * dstrect,
                         const double angle, const SDL_FPoint *center, const SDL_RendererFlip flip);
+    int (*QueueCopySprites) (SDL_Renderer * renderer, SDL_RenderCommand *cmd, SDL_Texture * texture,
+                             const SDL_RenderSprite * sprites, int count);
     int (*RunCommandQueue) (SDL_Renderer * renderer, SDL_RenderCommand *cmd, void *vertices, size_t vertsize);
     int (*UpdateTexture) (SDL_Renderer * renderer, SDL_Texture * texture,
                           const SDL_Rect * rect, const void *pixels,
@@ -200,8 +209,22 @@ struct SDL_Renderer
     SDL_bool always_batch;
     SDL_bool batching;
     SDL_RenderCommand *render_commands;
-    SDL_RenderCommand *render_commands_tail;
-    SDL_RenderCommand *render_commands_pool;
+    size_t render_commands_used;
+    size_t render_commands_allocation;
+
+    /* Set by backends that lay out vertices for these commands at a fixed
+       stride and draw all data.draw.count of them, so adjacent compatible
+       commands can be merged into one before RunCommandQueue(). */
+    SDL_bool merge_fill_rects;
+    SDL_bool merge_copies;
+
+    /* Commands queued vs. commands sent to the backend, for the frame being
+       built and the last presented one. */
+    int frame_commands_in;
+    int frame_commands_out;
+    int last_frame_commands_in;
+    int last_frame_commands_out;
+
     Uint32 render_command_generation;
     Uint32 last_queued_color;
     SDL_Rect last_queued_viewport;
@@ -215,6 +238,13 @@ struct SDL_Renderer
     size_t vertex_data_used;
     size_t vertex_data_allocation;
 
+    /* Atlases made with SDL_CreateTextureAtlas(), destroyed along with the renderer */
+    SDL_TextureAtlas *atlases;
+
+    /* SDL_RenderCopySprites() clips and scales into this before queueing. */
+    SDL_RenderSprite *sprite_data;
+    int sprite_data_allocation;
+
     void *driverdata;
 };
 
@@ -251,6 +281,11 @@ extern SDL_BlendOperation SDL_GetBlendModeAlphaOperation(SDL_BlendMode blendMode
    the next call, because it might be in an array that gets realloc()'d. */
 extern void *SDL_AllocateRenderVertices(SDL_Renderer *renderer, const size_t numbytes, const size_t alignment, size_t *offset);
 
+/* SDL_atlas.c packs surfaces onto page textures, and has SDL_render.c make the
+   texture objects that stand for each packed rect. */
+extern SDL_Texture *SDL_CreatePackedTexture(SDL_TextureAtlas *atlas, SDL_Texture *page, const SDL_Rect *rect);
+extern void SDL_ReleasePackedTexture(SDL_Texture *texture);
+
 #endif /* SDL_sysrender_h_ */
 
 /* vi: set ts=4 sw=4 expandtab: */
@@ -1432,6 +1432,7 @@ D3D_RunCommandQueue(SDL_Renderer * renderer, SDL_RenderCommand *cmd, void *verti
                 break;
             }
 
+            case SDL_RENDERCMD_COPY_SPRITES:  /* not queued, there is no QueueCopySprites */
             case SDL_RENDERCMD_NO_OP:
                 break;
         }
@@ -2310,6 +2310,7 @@ D3D11_RunCommandQueue(SDL_Renderer * renderer, SDL_RenderCommand *cmd, void *ver
                 break;
             }
 
+            case SDL_RENDERCMD_COPY_SPRITES:  /* not queued, there is no QueueCopySprites */
             case SDL_RENDERCMD_NO_OP:
                 break;
         }
@@ -1456,6 +1456,7 @@ METAL_RunCommandQueue(SDL_Renderer * renderer, SDL_RenderCommand *cmd, void *ver
                 break;
             }
 
+            case SDL_RENDERCMD_COPY_SPRITES:  /* not queued, there is no QueueCopySprites */
             case SDL_RENDERCMD_NO_OP:
                 break;
         }
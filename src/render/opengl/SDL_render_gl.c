@@ -928,6 +928,69 @@ GL_QueueCopy(SDL_Renderer * renderer, SDL_RenderCommand *cmd, SDL_Texture * text
     return 0;
 }
 
+static int
+GL_QueueCopySprites(SDL_Renderer * renderer, SDL_RenderCommand *cmd, SDL_Texture * texture,
+                    const SDL_RenderSprite * sprites, int count)
+{
+    GL_TextureData *texturedata = (GL_TextureData *) texture->driverdata;
+    GLfloat *verts = (GLfloat *) SDL_AllocateRenderVertices(renderer, count * 16 * sizeof (GLfloat), 0, &cmd->data.draw.first);
+    int i;
+
+    if (!verts) {
+        return -1;
+    }
+
+    cmd->data.draw.count = count;
+
+    /* Each sprite is four corners (already rotated), the texture coordinates and the color. */
+    for (i = 0; i < count; i++, sprites++) {
+        const SDL_Rect *srcrect = &sprites->srcrect;
+        const SDL_FRect *dstrect = &sprites->dstrect;
+        const GLfloat minx = dstrect->x;
+        const GLfloat miny = dstrect->y;
+        const GLfloat maxx = dstrect->x + dstrect->w;
+        const GLfloat maxy = dstrect->y + dstrect->h;
+
+        if (sprites->angle != 0.0) {
+            const double radian_angle = M_PI * sprites->angle / 180.0;
+            const GLfloat s = (GLfloat) SDL_sin(radian_angle);
+            const GLfloat c = (GLfloat) SDL_cos(radian_angle);
+            const GLfloat centerx = dstrect->x + dstrect->w / 2.0f;
+            const GLfloat centery = dstrect->y + dstrect->h / 2.0f;
+            const GLfloat dx = dstrect->w / 2.0f;
+            const GLfloat dy = dstrect->h / 2.0f;
+            *(verts++) = centerx + c * -dx - s * -dy;
+            *(verts++) = centery + s * -dx + c * -dy;
+            *(verts++) = centerx + c * dx - s * -dy;
+            *(verts++) = centery + s * dx + c * -dy;
+            *(verts++) = centerx + c * dx - s * dy;
+            *(verts++) = centery + s * dx + c * dy;
+            *(verts++) = centerx + c * -dx - s * dy;
+            *(verts++) = centery + s * -dx + c * dy;
+        } else {
+            *(verts++) = minx;
+            *(verts++) = miny;
+            *(verts++) = maxx;
+            *(verts++) = miny;
+            *(verts++) = maxx;
+            *(verts++) = maxy;
+            *(verts++) = minx;
+            *(verts++) = maxy;
+        }
+
+        *(verts++) = ((GLfloat) srcrect->x / texture->w) * texturedata->texw;
+        *(verts++) = ((GLfloat) (srcrect->x + srcrect->w) / texture->w) * texturedata->texw;
+        *(verts++) = ((GLfloat) srcrect->y / texture->h) * texturedata->texh;
+        *(verts++) = ((GLfloat) (srcrect->y + srcrect->h) / texture->h) * texturedata->texh;
+
+        *(verts++) = sprites->color.r * inv255f;
+        *(verts++) = sprites->color.g * inv255f;
+        *(verts++) = sprites->color.b * inv255f;
+        *(verts++) = sprites->color.a * inv255f;
+    }
+    return 0;
+}
+
 static int
 GL_QueueCopyEx(SDL_Renderer * renderer, SDL_RenderCommand *cmd, SDL_Texture * texture,
                const SDL_Rect * srcrect, const SDL_FRect * dstrect,
@@ -1295,26 +1358,29 @@ GL_RunCommandQueue(SDL_Renderer * renderer, SDL_RenderCommand *cmd, void *vertic
             }
 
             case SDL_RENDERCMD_COPY: {
+                const size_t count = cmd->data.draw.count;
                 const GLfloat *verts = (GLfloat *) (((Uint8 *) vertices) + cmd->data.draw.first);
-                const GLfloat minx = verts[0];
-                const GLfloat miny = verts[1];
-                const GLfloat maxx = verts[2];
-                const GLfloat maxy = verts[3];
-                const GLfloat minu = verts[4];
-                const GLfloat maxu = verts[5];
-                const GLfloat minv = verts[6];
-                const GLfloat maxv = verts[7];
                 SetCopyState(data, cmd);
-                data->glBegin(GL_TRIANGLE_STRIP);
-                data->glTexCoord2f(minu, minv);
-                data->glVertex2f(minx, miny);
-                data->glTexCoord2f(maxu, minv);
-                data->glVertex2f(maxx, miny);
-                data->glTexCoord2f(minu, maxv);
-                data->glVertex2f(minx, maxy);
-                data->glTexCoord2f(maxu, maxv);
-                data->glVertex2f(maxx, maxy);
-                data->glEnd();
+                for (i = 0; i < count; ++i, verts += 8) {
+                    const GLfloat minx = verts[0];
+                    const GLfloat miny = verts[1];
+                    const GLfloat maxx = verts[2];
+                    const GLfloat maxy = verts[3];
+                    const GLfloat minu = verts[4];
+                    const GLfloat maxu = verts[5];
+                    const GLfloat minv = verts[6];
+                    const GLfloat maxv = verts[7];
+                    data->glBegin(GL_TRIANGLE_STRIP);
+                    data->glTexCoord2f(minu, minv);
+                    data->glVertex2f(minx, miny);
+                    data->glTexCoord2f(maxu, minv);
+                    data->glVertex2f(maxx, miny);
+                    data->glTexCoord2f(minu, maxv);
+                    data->glVertex2f(minx, maxy);
+                    data->glTexCoord2f(maxu, maxv);
+                    data->glVertex2f(maxx, maxy);
+                    data->glEnd();
+                }
                 break;
             }
 
@@ -1351,6 +1417,36 @@ GL_RunCommandQueue(SDL_Renderer * renderer, SDL_RenderCommand *cmd, void *vertic
                 break;
             }
 
+            case SDL_RENDERCMD_COPY_SPRITES: {
+                const size_t count = cmd->data.draw.count;
+                const GLfloat *verts = (GLfloat *) (((Uint8 *) vertices) + cmd->data.draw.first);
+                const Uint32 color = data->drawstate.color;
+                SetCopyState(data, cmd);
+                data->glBegin(GL_QUADS);
+                for (i = 0; i < count; ++i, verts += 16) {
+                    const GLfloat minu = verts[8];
+                    const GLfloat maxu = verts[9];
+                    const GLfloat minv = verts[10];
+                    const GLfloat maxv = verts[11];
+                    data->glColor4f(verts[12], verts[13], verts[14], verts[15]);
+                    data->glTexCoord2f(minu, minv);
+                    data->glVertex2f(verts[0], verts[1]);
+                    data->glTexCoord2f(maxu, minv);
+                    data->glVertex2f(verts[2], verts[3]);
+                    data->glTexCoord2f(maxu, maxv);
+                    data->glVertex2f(verts[4], verts[5]);
+                    data->glTexCoord2f(minu, maxv);
+                    data->glVertex2f(verts[6], verts[7]);
+                }
+                data->glEnd();
+                /* put back the color the SETDRAWCOLOR commands are tracking */
+                data->glColor4f((GLfloat) ((color >> 16) & 0xFF) * inv255f,
+                                (GLfloat) ((color >> 8) & 0xFF) * inv255f,
+                                (GLfloat) (color & 0xFF) * inv255f,
+                                (GLfloat) ((color >> 24) & 0xFF) * inv255f);
+                break;
+            }
+
             case SDL_RENDERCMD_NO_OP:
                 break;
         }
@@ -1623,7 +1719,10 @@ GL_CreateRenderer(SDL_Window * window, Uint32 flags)
     renderer->QueueFillRects = GL_QueueFillRects;
     renderer->QueueCopy = GL_QueueCopy;
     renderer->QueueCopyEx = GL_QueueCopyEx;
+    renderer->QueueCopySprites = GL_QueueCopySprites;
     renderer->RunCommandQueue = GL_RunCommandQueue;
+    renderer->merge_fill_rects = SDL_TRUE;
+    renderer->merge_copies = SDL_TRUE;
     renderer->RenderReadPixels = GL_RenderReadPixels;
     renderer->RenderPresent = GL_RenderPresent;
     renderer->DestroyTexture = GL_DestroyTexture;
@@ -953,6 +953,7 @@ GLES_RunCommandQueue(SDL_Renderer * renderer, SDL_RenderCommand *cmd, void *vert
                 break;
             }
 
+            case SDL_RENDERCMD_COPY_SPRITES:  /* not queued, there is no QueueCopySprites */
             case SDL_RENDERCMD_NO_OP:
                 break;
         }
@@ -941,6 +941,92 @@ GLES2_QueueCopyEx(SDL_Renderer * renderer, SDL_RenderCommand *cmd, SDL_Texture *
     return 0;
 }
 
+static int
+GLES2_QueueCopySprites(SDL_Renderer * renderer, SDL_RenderCommand *cmd, SDL_Texture * texture,
+                       const SDL_RenderSprite * sprites, int count)
+{
+    /* All the positions (six per sprite, drawn as GL_TRIANGLES), then all the
+       texcoords, then one color per sprite, so runs of sprites with the same
+       color can go out in a single glDrawArrays(). Rotation is done here. */
+    const size_t vertlen = count * 12 * sizeof (GLfloat);
+    GLfloat *verts = (GLfloat *) SDL_AllocateRenderVertices(renderer, (vertlen * 2) + (count * sizeof (Uint32)), 0, &cmd->data.draw.first);
+    GLfloat *texcoords;
+    Uint32 *colors;
+    int i;
+
+    if (!verts) {
+        return -1;
+    }
+
+    texcoords = (GLfloat *) (((Uint8 *) verts) + vertlen);
+    colors = (Uint32 *) (((Uint8 *) texcoords) + vertlen);
+
+    cmd->data.draw.count = count;
+
+    for (i = 0; i < count; i++, sprites++) {
+        const SDL_Rect *srcrect = &sprites->srcrect;
+        const SDL_FRect *dstrect = &sprites->dstrect;
+        const GLfloat minu = ((GLfloat) srcrect->x) / ((GLfloat) texture->w);
+        const GLfloat maxu = ((GLfloat) (srcrect->x + srcrect->w)) / ((GLfloat) texture->w);
+        const GLfloat minv = ((GLfloat) srcrect->y) / ((GLfloat) texture->h);
+        const GLfloat maxv = ((GLfloat) (srcrect->y + srcrect->h)) / ((GLfloat) texture->h);
+        GLfloat x[4], y[4];  /* top left, top right, bottom left, bottom right */
+
+        if (sprites->angle != 0.0) {
+            const double radian_angle = M_PI * sprites->angle / 180.0;
+            const GLfloat s = (GLfloat) SDL_sin(radian_angle);
+            const GLfloat c = (GLfloat) SDL_cos(radian_angle);
+            const GLfloat centerx = dstrect->x + dstrect->w / 2.0f;
+            const GLfloat centery = dstrect->y + dstrect->h / 2.0f;
+            const GLfloat dx = dstrect->w / 2.0f;
+            const GLfloat dy = dstrect->h / 2.0f;
+            x[0] = centerx - c * dx + s * dy;
+            y[0] = centery - s * dx - c * dy;
+            x[1] = centerx + c * dx + s * dy;
+            y[1] = centery + s * dx - c * dy;
+            x[2] = centerx - c * dx - s * dy;
+            y[2] = centery - s * dx + c * dy;
+            x[3] = centerx + c * dx - s * dy;
+            y[3] = centery + s * dx + c * dy;
+        } else {
+            x[0] = x[2] = dstrect->x;
+            x[1] = x[3] = dstrect->x + dstrect->w;
+            y[0] = y[1] = dstrect->y;
+            y[2] = y[3] = dstrect->y + dstrect->h;
+        }
+
+        *(verts++) = x[0];
+        *(verts++) = y[0];
+        *(verts++) = x[1];
+        *(verts++) = y[1];
+        *(verts++) = x[2];
+        *(verts++) = y[2];
+        *(verts++) = x[1];
+        *(verts++) = y[1];
+        *(verts++) = x[3];
+        *(verts++) = y[3];
+        *(verts++) = x[2];
+        *(verts++) = y[2];
+
+        *(texcoords++) = minu;
+        *(texcoords++) = minv;
+        *(texcoords++) = maxu;
+        *(texcoords++) = minv;
+        *(texcoords++) = minu;
+        *(texcoords++) = maxv;
+        *(texcoords++) = maxu;
+        *(texcoords++) = minv;
+        *(texcoords++) = maxu;
+        *(texcoords++) = maxv;
+        *(texcoords++) = minu;
+        *(texcoords++) = maxv;
+
+        *(colors++) = ((sprites->color.a << 24) | (sprites->color.r << 16) | (sprites->color.g << 8) | sprites->color.b);
+    }
+
+    return 0;
+}
+
 static int
 SetDrawState(GLES2_RenderData *data, const SDL_RenderCommand *cmd, const GLES2_ImageSource imgsrc)
 {
@@ -1320,7 +1406,20 @@ GLES2_RunCommandQueue(SDL_Renderer * renderer, SDL_RenderCommand *cmd, void *ver
                 break;
             }
 
-            case SDL_RENDERCMD_COPY:
+            case SDL_RENDERCMD_COPY: {
+                /* Each copy is 8 position floats followed by 8 texcoord floats,
+                   so with both attribs pointing at the first copy, copy N starts
+                   at vertex N*8 for both of them. */
+                const size_t count = cmd->data.draw.count;
+                size_t offset = 0;
+                if (SetCopyState(renderer, cmd) == 0) {
+                    for (i = 0; i < count; ++i, offset += 8) {
+                        data->glDrawArrays(GL_TRIANGLE_STRIP, (GLsizei) offset, 4);
+                    }
+                }
+                break;
+            }
+
             case SDL_RENDERCMD_COPY_EX: {
                 if (SetCopyState(renderer, cmd) == 0) {
                     data->glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
@@ -1328,6 +1427,38 @@ GLES2_RunCommandQueue(SDL_Renderer * renderer, SDL_RenderCommand *cmd, void *ver
                 break;
             }
 
+            case SDL_RENDERCMD_COPY_SPRITES: {
+                const size_t count = cmd->data.draw.count;
+                const size_t vertlen = count * 12 * sizeof (GLfloat);
+                const Uint32 *colors = (const Uint32 *) (((Uint8 *) vertices) + cmd->data.draw.first + (vertlen * 2));
+                if (SetCopyState(renderer, cmd) == 0) {
+                    GLES2_ProgramCacheEntry *program = data->drawstate.program;
+                    const GLint location = program->uniform_locations[GLES2_UNIFORM_COLOR];
+                    size_t start = 0;
+
+                    data->glVertexAttribPointer(GLES2_ATTRIBUTE_TEXCOORD, 2, GL_FLOAT, GL_FALSE, 0, (const GLvoid *) (cmd->data.draw.first + vertlen));
+
+                    while (start < count) {
+                        const Uint32 color = colors[start];
+                        size_t end = start + 1;
+                        while (end < count && colors[end] == color) {
+                            ++end;
+                        }
+                        if (location != -1 && program->color != color) {
+                            const Uint8 r = (color >> 16) & 0xFF;
+                            const Uint8 g = (color >> 8) & 0xFF;
+                            const Uint8 b = (color >> 0) & 0xFF;
+                            const Uint8 a = (color >> 24) & 0xFF;
+                            data->glUniform4f(location, r * inv255f, g * inv255f, b * inv255f, a * inv255f);
+                            program->color = color;
+                        }
+                        data->glDrawArrays(GL_TRIANGLES, (GLsizei) (start * 6), (GLsizei) ((end - start) * 6));
+                        start = end;
+                    }
+                }
+                break;
+            }
+
             case SDL_RENDERCMD_NO_OP:
                 break;
         }
@@ -2103,7 +2234,10 @@ GLES2_CreateRenderer(SDL_Window *window, Uint32 flags)
     renderer->QueueFillRects      = GLES2_QueueFillRects;
     renderer->QueueCopy           = GLES2_QueueCopy;
     renderer->QueueCopyEx         = GLES2_QueueCopyEx;
+    renderer->QueueCopySprites    = GLES2_QueueCopySprites;
     renderer->RunCommandQueue     = GLES2_RunCommandQueue;
+    renderer->merge_fill_rects    = SDL_TRUE;
+    renderer->merge_copies        = SDL_TRUE;
     renderer->RenderReadPixels    = GLES2_RenderReadPixels;
     renderer->RenderPresent       = GLES2_RenderPresent;
     renderer->DestroyTexture      = GLES2_DestroyTexture;
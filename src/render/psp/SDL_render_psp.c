@@ -848,6 +848,7 @@ PSP_RunCommandQueue(SDL_Renderer * renderer, SDL_RenderCommand *cmd, void *verti
                 break;
             }
 
+            case SDL_RENDERCMD_COPY_SPRITES:  /* not queued, there is no QueueCopySprites */
             case SDL_RENDERCMD_NO_OP:
                 break;
         }
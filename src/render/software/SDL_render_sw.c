@@ -26,6 +26,9 @@
 #include "SDL_render_sw_c.h"
 #include "SDL_hints.h"
 #include "SDL_assert.h"
+#include "SDL_thread.h"
+#include "../../thread/SDL_systhread.h"
+#include "../../video/SDL_pixels_c.h"
 
 #include "SDL_draw.h"
 #include "SDL_blendfillrect.h"
@@ -37,18 +40,48 @@
 
 /* SDL surface based renderer implementation */
 
+/* Tiles shorter than this aren't worth a thread */
+#define SW_MIN_TILE_HEIGHT      16
+#define SW_MAX_TILES            64
+
+/* Maximum number of distinct textures copied by one parallel run */
+#define SW_MAX_TILE_TEXTURES    32
+
 typedef struct
 {
     const SDL_Rect *viewport;
     const SDL_Rect *cliprect;
+    const SDL_Rect *tile;       /**< Extra clipping when drawing a single tile, or NULL */
     SDL_bool surface_cliprect_dirty;
 } SW_DrawStateCache;
 
+typedef struct SW_RenderData SW_RenderData;
+
 typedef struct
+{
+    SDL_Renderer *renderer;
+    SW_RenderData *data;
+    SDL_Thread *thread;
+    SDL_sem *start;
+    SDL_Surface *surface;       /**< Shares the render target pixels, but has its own clip rect */
+    SDL_Rect tile;
+} SW_TileWorker;
+
+struct SW_RenderData
 {
     SDL_Surface *surface;
     SDL_Surface *window;
-} SW_RenderData;
+
+    /* Tile-parallel command execution, see SDL_HINT_RENDER_SOFTWARE_THREADS */
+    int num_tiles;
+    SW_TileWorker *tiles;
+    SDL_sem *tiles_done;
+    SDL_bool tiles_quit;
+    const SDL_RenderCommand *tile_first;
+    const SDL_RenderCommand *tile_end;
+    void *tile_vertices;
+    SW_DrawStateCache tile_drawstate;
+};
 
 
 static SDL_Surface *
@@ -334,6 +367,42 @@ SW_QueueCopyEx(SDL_Renderer * renderer, SDL_RenderCommand *cmd, SDL_Texture * te
     return 0;
 }
 
+typedef struct CopySpriteData
+{
+    SDL_Rect srcrect;
+    SDL_Rect dstrect;
+    double angle;
+    SDL_Color color;
+} CopySpriteData;
+
+static int
+SW_QueueCopySprites(SDL_Renderer * renderer, SDL_RenderCommand *cmd, SDL_Texture * texture,
+                    const SDL_RenderSprite * sprites, int count)
+{
+    CopySpriteData *verts = (CopySpriteData *) SDL_AllocateRenderVertices(renderer, count * sizeof (CopySpriteData), 0, &cmd->data.draw.first);
+    const int x = renderer->viewport.x;
+    const int y = renderer->viewport.y;
+    int i;
+
+    if (!verts) {
+        return -1;
+    }
+
+    cmd->data.draw.count = count;
+
+    for (i = 0; i < count; i++, verts++, sprites++) {
+        SDL_memcpy(&verts->srcrect, &sprites->srcrect, sizeof (SDL_Rect));
+        verts->dstrect.x = (int)(x + sprites->dstrect.x);
+        verts->dstrect.y = (int)(y + sprites->dstrect.y);
+        verts->dstrect.w = (int)sprites->dstrect.w;
+        verts->dstrect.h = (int)sprites->dstrect.h;
+        verts->angle = sprites->angle;
+        verts->color = sprites->color;
+    }
+
+    return 0;
+}
+
 static int
 SW_RenderCopyEx(SDL_Renderer * renderer, SDL_Surface *surface, SDL_Texture * texture,
                 const SDL_Rect * srcrect, const SDL_Rect * final_rect,
@@ -435,7 +504,7 @@ SW_RenderCopyEx(SDL_Renderer * renderer, SDL_Surface *surface, SDL_Texture * tex
             retval = -1;
         } else {
             SDL_SetSurfaceBlendMode(src_clone, SDL_BLENDMODE_NONE);
-            retval = SDL_BlitScaled(src_clone, srcrect, src_scaled, &scale_rect);
+            retval = SDL_PrivateUpperBlitScaled(src_clone, srcrect, src_scaled, &scale_rect, texture->scaleMode);
             SDL_FreeSurface(src_clone);
             src_clone = src_scaled;
             src_scaled = NULL;
@@ -562,15 +631,9 @@ SW_RenderCopyEx(SDL_Renderer * renderer, SDL_Surface *surface, SDL_Texture * tex
 }
 
 static void
-PrepTextureForCopy(const SDL_RenderCommand *cmd)
+PrepSurfaceForCopy(SDL_Surface *surface, const Uint8 r, const Uint8 g, const Uint8 b, const Uint8 a,
+                   const SDL_BlendMode blend)
 {
-    const Uint8 r = cmd->data.draw.r;
-    const Uint8 g = cmd->data.draw.g;
-    const Uint8 b = cmd->data.draw.b;
-    const Uint8 a = cmd->data.draw.a;
-    const SDL_BlendMode blend = cmd->data.draw.blend;
-    SDL_Texture *texture = cmd->data.draw.texture;
-    SDL_Surface *surface = (SDL_Surface *) texture->driverdata;
     const SDL_bool colormod = ((r & g & b) != 0xFF);
     const SDL_bool alphamod = (a != 0xFF);
     const SDL_bool blending = ((blend == SDL_BLENDMODE_ADD) || (blend == SDL_BLENDMODE_MOD) || (blend == SDL_BLENDMODE_MUL));
@@ -585,6 +648,14 @@ PrepTextureForCopy(const SDL_RenderCommand *cmd)
     SDL_SetSurfaceBlendMode(surface, blend);
 }
 
+static void
+PrepTextureForCopy(const SDL_RenderCommand *cmd)
+{
+    PrepSurfaceForCopy((SDL_Surface *) cmd->data.draw.texture->driverdata,
+                       cmd->data.draw.r, cmd->data.draw.g, cmd->data.draw.b, cmd->data.draw.a,
+                       cmd->data.draw.blend);
+}
+
 static void
 SetDrawState(SDL_Surface *surface, SW_DrawStateCache *drawstate)
 {
@@ -604,141 +675,572 @@ SetDrawState(SDL_Surface *surface, SW_DrawStateCache *drawstate)
         } else {
             SDL_SetClipRect(surface, drawstate->viewport);
         }
+        if (drawstate->tile != NULL) {
+            const SDL_Rect clip_rect = surface->clip_rect;
+            SDL_IntersectRect(&clip_rect, drawstate->tile, &surface->clip_rect);
+        }
         drawstate->surface_cliprect_dirty = SDL_FALSE;
     }
 }
 
-static int
-SW_RunCommandQueue(SDL_Renderer * renderer, SDL_RenderCommand *cmd, void *vertices, size_t vertsize)
+static void
+SW_RunCommand(SDL_Renderer * renderer, SDL_Surface *surface, const SDL_RenderCommand *cmd, void *vertices, SW_DrawStateCache *drawstate)
 {
-    SDL_Surface *surface = SW_ActivateRenderer(renderer);
-    SW_DrawStateCache drawstate;
+    switch (cmd->command) {
+        case SDL_RENDERCMD_SETDRAWCOLOR: {
+            break;  /* Not used in this backend. */
+        }
 
-    if (!surface) {
-        return -1;
+        case SDL_RENDERCMD_SETVIEWPORT: {
+            drawstate->viewport = &cmd->data.viewport.rect;
+            drawstate->surface_cliprect_dirty = SDL_TRUE;
+            break;
+        }
+
+        case SDL_RENDERCMD_SETCLIPRECT: {
+            drawstate->cliprect = cmd->data.cliprect.enabled ? &cmd->data.cliprect.rect : NULL;
+            drawstate->surface_cliprect_dirty = SDL_TRUE;
+            break;
+        }
+
+        case SDL_RENDERCMD_CLEAR: {
+            const Uint8 r = cmd->data.color.r;
+            const Uint8 g = cmd->data.color.g;
+            const Uint8 b = cmd->data.color.b;
+            const Uint8 a = cmd->data.color.a;
+            /* By definition the clear ignores the clip rect */
+            SDL_SetClipRect(surface, drawstate->tile);
+            SDL_FillRect(surface, NULL, SDL_MapRGBA(surface->format, r, g, b, a));
+            drawstate->surface_cliprect_dirty = SDL_TRUE;
+            break;
+        }
+
+        case SDL_RENDERCMD_DRAW_POINTS: {
+            const Uint8 r = cmd->data.draw.r;
+            const Uint8 g = cmd->data.draw.g;
+            const Uint8 b = cmd->data.draw.b;
+            const Uint8 a = cmd->data.draw.a;
+            const int count = (int) cmd->data.draw.count;
+            const SDL_Point *verts = (SDL_Point *) (((Uint8 *) vertices) + cmd->data.draw.first);
+            const SDL_BlendMode blend = cmd->data.draw.blend;
+            SetDrawState(surface, drawstate);
+            if (blend == SDL_BLENDMODE_NONE) {
+                SDL_DrawPoints(surface, verts, count, SDL_MapRGBA(surface->format, r, g, b, a));
+            } else {
+                SDL_BlendPoints(surface, verts, count, blend, r, g, b, a);
+            }
+            break;
+        }
+
+        case SDL_RENDERCMD_DRAW_LINES: {
+            const Uint8 r = cmd->data.draw.r;
+            const Uint8 g = cmd->data.draw.g;
+            const Uint8 b = cmd->data.draw.b;
+            const Uint8 a = cmd->data.draw.a;
+            const int count = (int) cmd->data.draw.count;
+            const SDL_Point *verts = (SDL_Point *) (((Uint8 *) vertices) + cmd->data.draw.first);
+            const SDL_BlendMode blend = cmd->data.draw.blend;
+            SetDrawState(surface, drawstate);
+            if (blend == SDL_BLENDMODE_NONE) {
+                SDL_DrawLines(surface, verts, count, SDL_MapRGBA(surface->format, r, g, b, a));
+            } else {
+                SDL_BlendLines(surface, verts, count, blend, r, g, b, a);
+            }
+            break;
+        }
+
+        case SDL_RENDERCMD_FILL_RECTS: {
+            const Uint8 r = cmd->data.draw.r;
+            const Uint8 g = cmd->data.draw.g;
+            const Uint8 b = cmd->data.draw.b;
+            const Uint8 a = cmd->data.draw.a;
+            const int count = (int) cmd->data.draw.count;
+            const SDL_Rect *verts = (SDL_Rect *) (((Uint8 *) vertices) + cmd->data.draw.first);
+            const SDL_BlendMode blend = cmd->data.draw.blend;
+            SetDrawState(surface, drawstate);
+            if (blend == SDL_BLENDMODE_NONE) {
+                SDL_FillRects(surface, verts, count, SDL_MapRGBA(surface->format, r, g, b, a));
+            } else {
+                SDL_BlendFillRects(surface, verts, count, blend, r, g, b, a);
+            }
+            break;
+        }
+
+        case SDL_RENDERCMD_COPY: {
+            SDL_Rect *verts = (SDL_Rect *) (((Uint8 *) vertices) + cmd->data.draw.first);
+            const size_t count = cmd->data.draw.count;
+            SDL_Texture *texture = cmd->data.draw.texture;
+            SDL_Surface *src = (SDL_Surface *) texture->driverdata;
+            size_t i;
+
+            SetDrawState(surface, drawstate);
+
+            PrepTextureForCopy(cmd);
+
+            /* merged copies are stored as consecutive srcrect/dstrect pairs. */
+            for (i = 0; i < count; i++, verts += 2) {
+                const SDL_Rect *srcrect = verts;
+                SDL_Rect *dstrect = verts + 1;
+                if ( srcrect->w == dstrect->w && srcrect->h == dstrect->h ) {
+                    SDL_BlitSurface(src, srcrect, surface, dstrect);
+                } else {
+                    /* If scaling is ever done, permanently disable RLE (which doesn't support scaling)
+                     * to avoid potentially frequent RLE encoding/decoding.
+                     */
+                    SDL_SetSurfaceRLE(surface, 0);
+                    SDL_PrivateUpperBlitScaled(src, srcrect, surface, dstrect, texture->scaleMode);
+                }
+            }
+            break;
+        }
+
+        case SDL_RENDERCMD_COPY_EX: {
+            const CopyExData *copydata = (CopyExData *) (((Uint8 *) vertices) + cmd->data.draw.first);
+            SetDrawState(surface, drawstate);
+            PrepTextureForCopy(cmd);
+            SW_RenderCopyEx(renderer, surface, cmd->data.draw.texture, &copydata->srcrect,
+                            &copydata->dstrect, copydata->angle, &copydata->center, copydata->flip);
+            break;
+        }
+
+        case SDL_RENDERCMD_COPY_SPRITES: {
+            const CopySpriteData *sprite = (CopySpriteData *) (((Uint8 *) vertices) + cmd->data.draw.first);
+            const size_t count = cmd->data.draw.count;
+            SDL_Texture *texture = cmd->data.draw.texture;
+            SDL_Surface *src = (SDL_Surface *) texture->driverdata;
+            Uint32 color = 0;
+            size_t i;
+
+            SetDrawState(surface, drawstate);
+
+            for (i = 0; i < count; i++, sprite++) {
+                SDL_Rect dstrect = sprite->dstrect;
+                const Uint32 sprite_color = ((sprite->color.a << 24) | (sprite->color.r << 16) | (sprite->color.g << 8) | sprite->color.b);
+
+                if (i == 0 || sprite_color != color) {
+                    PrepSurfaceForCopy(src, sprite->color.r, sprite->color.g, sprite->color.b, sprite->color.a, cmd->data.draw.blend);
+                    color = sprite_color;
+                }
+
+                if (sprite->angle != 0.0) {
+                    SDL_FPoint center;
+                    center.x = dstrect.w / 2.0f;
+                    center.y = dstrect.h / 2.0f;
+                    SW_RenderCopyEx(renderer, surface, texture, &sprite->srcrect, &dstrect,
+                                    sprite->angle, &center, SDL_FLIP_NONE);
+                } else if (sprite->srcrect.w == dstrect.w && sprite->srcrect.h == dstrect.h) {
+                    SDL_BlitSurface(src, &sprite->srcrect, surface, &dstrect);
+                } else {
+                    SDL_SetSurfaceRLE(surface, 0);
+                    SDL_PrivateUpperBlitScaled(src, &sprite->srcrect, surface, &dstrect, texture->scaleMode);
+                }
+            }
+            break;
+        }
+
+        case SDL_RENDERCMD_NO_OP:
+            break;
+    }
+}
+
+/* Same clipping as SDL_UpperBlit(), but the blitter runs on a private copy of
+   the blit info, so several tiles can read the same source surface at once. */
+static void
+SW_BlitTile(SDL_Surface *src, const SDL_Rect *srcrect, SDL_Surface *dst, const SDL_Rect *dstrect)
+{
+    const SDL_Rect *clip = &dst->clip_rect;
+    int srcx = srcrect->x;
+    int srcy = srcrect->y;
+    int dstx = dstrect->x;
+    int dsty = dstrect->y;
+    int w = srcrect->w;
+    int h = srcrect->h;
+    int dx, dy;
+    SDL_BlitInfo info;
+
+    dx = clip->x - dstx;
+    if (dx > 0) {
+        w -= dx;
+        dstx += dx;
+        srcx += dx;
+    }
+    dx = dstx + w - clip->x - clip->w;
+    if (dx > 0) {
+        w -= dx;
+    }
+
+    dy = clip->y - dsty;
+    if (dy > 0) {
+        h -= dy;
+        dsty += dy;
+        srcy += dy;
+    }
+    dy = dsty + h - clip->y - clip->h;
+    if (dy > 0) {
+        h -= dy;
+    }
+
+    if (w <= 0 || h <= 0) {
+        return;
     }
 
+    info = src->map->info;
+    info.src = (Uint8 *) src->pixels + srcy * src->pitch + srcx * info.src_fmt->BytesPerPixel;
+    info.src_w = w;
+    info.src_h = h;
+    info.src_pitch = src->pitch;
+    info.src_skip = info.src_pitch - w * info.src_fmt->BytesPerPixel;
+    info.dst = (Uint8 *) dst->pixels + dsty * dst->pitch + dstx * info.dst_fmt->BytesPerPixel;
+    info.dst_w = w;
+    info.dst_h = h;
+    info.dst_pitch = dst->pitch;
+    info.dst_skip = info.dst_pitch - w * info.dst_fmt->BytesPerPixel;
+    ((SDL_BlitFunc) src->map->data)(&info);
+}
+
+static void
+SW_RunTile(SW_RenderData *data, SW_TileWorker *worker)
+{
+    SDL_Surface *surface = worker->surface;
+    void *vertices = data->tile_vertices;
+    SW_DrawStateCache drawstate = data->tile_drawstate;
+    const SDL_RenderCommand *cmd;
+
+    drawstate.tile = &worker->tile;
+    drawstate.surface_cliprect_dirty = SDL_TRUE;
+
+    for (cmd = data->tile_first; cmd != data->tile_end; cmd = cmd->next) {
+        if (cmd->command == SDL_RENDERCMD_COPY) {
+            /* SW_PrepareTileCopy() already set up the texture and its blit mapping */
+            const SDL_Rect *verts = (SDL_Rect *) (((Uint8 *) vertices) + cmd->data.draw.first);
+            size_t i;
+            SetDrawState(surface, &drawstate);
+            for (i = 0; i < cmd->data.draw.count; i++, verts += 2) {
+                SW_BlitTile((SDL_Surface *) cmd->data.draw.texture->driverdata, &verts[0], surface, &verts[1]);
+            }
+        } else {
+            SDL_assert(cmd->command != SDL_RENDERCMD_DRAW_LINES && cmd->command != SDL_RENDERCMD_COPY_EX &&
+                       cmd->command != SDL_RENDERCMD_COPY_SPRITES);
+            SW_RunCommand(worker->renderer, surface, cmd, vertices, &drawstate);
+        }
+    }
+}
+
+static int SDLCALL
+SW_TileThread(void *ptr)
+{
+    SW_TileWorker *worker = (SW_TileWorker *) ptr;
+    SW_RenderData *data = worker->data;
+
+    for ( ; ; ) {
+        SDL_SemWait(worker->start);
+        if (data->tiles_quit) {
+            break;
+        }
+        SW_RunTile(data, worker);
+        SDL_SemPost(data->tiles_done);
+    }
+    return 0;
+}
+
+static void
+SW_DestroyTiles(SW_RenderData *data)
+{
+    int i;
+
+    if (data->tiles) {
+        data->tiles_quit = SDL_TRUE;
+        for (i = 0; i < data->num_tiles; ++i) {
+            SW_TileWorker *worker = &data->tiles[i];
+            if (worker->thread) {
+                SDL_SemPost(worker->start);
+                SDL_WaitThread(worker->thread, NULL);
+            }
+            if (worker->start) {
+                SDL_DestroySemaphore(worker->start);
+            }
+            SDL_FreeSurface(worker->surface);
+        }
+        SDL_free(data->tiles);
+        data->tiles = NULL;
+    }
+    if (data->tiles_done) {
+        SDL_DestroySemaphore(data->tiles_done);
+        data->tiles_done = NULL;
+    }
+    data->tiles_quit = SDL_FALSE;
+}
+
+static SDL_bool
+SW_PrepareTiles(SDL_Renderer * renderer, SDL_Surface *surface)
+{
+    SW_RenderData *data = (SW_RenderData *) renderer->driverdata;
+    const int num_tiles = data->num_tiles;
+    int tile_h, i;
+
+    if (num_tiles < 2 || surface->h < num_tiles * SW_MIN_TILE_HEIGHT) {
+        return SDL_FALSE;
+    }
+    /* The tiles alias the target pixels, so they can't deal with locking or palettes */
+    if (SDL_MUSTLOCK(surface) || surface->format->palette || surface->format->format == SDL_PIXELFORMAT_UNKNOWN) {
+        return SDL_FALSE;
+    }
+
+    if (!data->tiles) {
+        data->tiles = (SW_TileWorker *) SDL_calloc(num_tiles, sizeof (SW_TileWorker));
+        data->tiles_done = SDL_CreateSemaphore(0);
+        if (!data->tiles || !data->tiles_done) {
+            SW_DestroyTiles(data);
+            data->num_tiles = 0;
+            return SDL_FALSE;
+        }
+        for (i = 0; i < num_tiles; ++i) {
+            SW_TileWorker *worker = &data->tiles[i];
+            worker->renderer = renderer;
+            worker->data = data;
+            if (i == 0) {
+                continue;  /* the first tile is drawn by the calling thread. */
+            }
+            worker->start = SDL_CreateSemaphore(0);
+            if (worker->start) {
+                worker->thread = SDL_CreateThreadInternal(SW_TileThread, "SDLSoftwareRender", 0, worker);
+            }
+            if (!worker->thread) {
+                SW_DestroyTiles(data);
+                data->num_tiles = 0;
+                return SDL_FALSE;
+            }
+        }
+    }
+
+    tile_h = (surface->h + num_tiles - 1) / num_tiles;
+    for (i = 0; i < num_tiles; ++i) {
+        SW_TileWorker *worker = &data->tiles[i];
+        SDL_Surface *alias = worker->surface;
+
+        if (!alias || alias->pixels != surface->pixels ||
+            alias->w != surface->w || alias->h != surface->h ||
+            alias->pitch != surface->pitch || alias->format->format != surface->format->format) {
+            SDL_FreeSurface(alias);
+            worker->surface = SDL_CreateRGBSurfaceWithFormatFrom(surface->pixels, surface->w, surface->h,
+                                                                 surface->format->BitsPerPixel, surface->pitch,
+                                                                 surface->format->format);
+            if (!worker->surface) {
+                return SDL_FALSE;
+            }
+        }
+
+        worker->tile.x = 0;
+        worker->tile.y = i * tile_h;
+        worker->tile.w = surface->w;
+        worker->tile.h = SDL_max(0, SDL_min(tile_h, surface->h - worker->tile.y));
+    }
+    return SDL_TRUE;
+}
+
+/* Returns SDL_TRUE if the copy can be split across tiles. This sets up the
+   texture state and blit mapping the tiles will use, so every copy of the
+   texture in the same parallel run must use the same modulation and blend. */
+static SDL_bool
+SW_IsScaledCopy(const SDL_RenderCommand *cmd, void *vertices)
+{
+    const SDL_Rect *verts = (SDL_Rect *) (((Uint8 *) vertices) + cmd->data.draw.first);
+    size_t i;
+
+    for (i = 0; i < cmd->data.draw.count; i++, verts += 2) {
+        if (verts[0].w != verts[1].w || verts[0].h != verts[1].h) {
+            return SDL_TRUE;
+        }
+    }
+    return SDL_FALSE;
+}
+
+static SDL_bool
+SW_PrepareTileCopy(SDL_Surface *surface, const SDL_RenderCommand *cmd, void *vertices)
+{
+    SDL_Surface *src = (SDL_Surface *) cmd->data.draw.texture->driverdata;
+
+    /* Scaled blits recompute their sampling from the clipped rect, so they'd
+       show seams at the tile edges. */
+    if (SW_IsScaledCopy(cmd, vertices) || src == surface) {
+        return SDL_FALSE;
+    }
+
+    PrepTextureForCopy(cmd);
+
+    /* RLE blits can't be run through SW_BlitTile() */
+    SDL_SetSurfaceRLE(src, 0);
+
+    if (src->map->info.flags & SDL_COPY_NEAREST) {
+        src->map->info.flags &= ~SDL_COPY_NEAREST;
+        SDL_InvalidateMap(src->map);
+    }
+    if (src->map->dst != surface) {
+        if (SDL_MapSurface(src, surface) < 0) {
+            return SDL_FALSE;
+        }
+    }
+    return (src->map->data != NULL);
+}
+
+static SDL_bool
+SW_SameTextureState(const SDL_RenderCommand *a, const SDL_RenderCommand *b)
+{
+    return (a->data.draw.r == b->data.draw.r &&
+            a->data.draw.g == b->data.draw.g &&
+            a->data.draw.b == b->data.draw.b &&
+            a->data.draw.a == b->data.draw.a &&
+            a->data.draw.blend == b->data.draw.blend);
+}
+
+static void
+SW_RunTiles(SW_RenderData *data, const SDL_RenderCommand *first, const SDL_RenderCommand *end,
+            void *vertices, const SW_DrawStateCache *drawstate)
+{
+    int i;
+
+    data->tile_first = first;
+    data->tile_end = end;
+    data->tile_vertices = vertices;
+    data->tile_drawstate = *drawstate;
+
+    for (i = 1; i < data->num_tiles; ++i) {
+        SDL_SemPost(data->tiles[i].start);
+    }
+    SW_RunTile(data, &data->tiles[0]);
+    for (i = 1; i < data->num_tiles; ++i) {
+        SDL_SemWait(data->tiles_done);
+    }
+}
+
+/* Groups runs of commands that give the same pixels when clipped to each tile
+   and draws those runs on all tiles at once. Everything else is drawn on this
+   thread in between, so the order of draws is kept for every pixel. */
+static int
+SW_RunCommandQueueTiled(SDL_Renderer * renderer, SDL_Surface *surface, SDL_RenderCommand *cmd, void *vertices)
+{
+    SW_RenderData *data = (SW_RenderData *) renderer->driverdata;
+    const SDL_RenderCommand *textured[SW_MAX_TILE_TEXTURES];
+    int num_textured = 0;
+    const SDL_RenderCommand *first = NULL;
+    SDL_bool drawing = SDL_FALSE;
+    SW_DrawStateCache drawstate;
+    SW_DrawStateCache first_drawstate;
+
     drawstate.viewport = NULL;
     drawstate.cliprect = NULL;
+    drawstate.tile = NULL;
     drawstate.surface_cliprect_dirty = SDL_TRUE;
+    first_drawstate = drawstate;
 
     while (cmd) {
-        switch (cmd->command) {
-            case SDL_RENDERCMD_SETDRAWCOLOR: {
-                break;  /* Not used in this backend. */
-            }
+        const SW_DrawStateCache previous = drawstate;
+        SDL_bool tiled = SDL_TRUE;
 
-            case SDL_RENDERCMD_SETVIEWPORT: {
+        switch (cmd->command) {
+            case SDL_RENDERCMD_SETVIEWPORT:
                 drawstate.viewport = &cmd->data.viewport.rect;
                 drawstate.surface_cliprect_dirty = SDL_TRUE;
                 break;
-            }
 
-            case SDL_RENDERCMD_SETCLIPRECT: {
-                drawstate.cliprect = cmd->data.cliprect.enabled ? &cmd->data.cliprect.rect : NULL;                
+            case SDL_RENDERCMD_SETCLIPRECT:
+                drawstate.cliprect = cmd->data.cliprect.enabled ? &cmd->data.cliprect.rect : NULL;
                 drawstate.surface_cliprect_dirty = SDL_TRUE;
                 break;
-            }
 
-            case SDL_RENDERCMD_CLEAR: {
-                const Uint8 r = cmd->data.color.r;
-                const Uint8 g = cmd->data.color.g;
-                const Uint8 b = cmd->data.color.b;
-                const Uint8 a = cmd->data.color.a;
-                /* By definition the clear ignores the clip rect */
-                SDL_SetClipRect(surface, NULL);
-                SDL_FillRect(surface, NULL, SDL_MapRGBA(surface->format, r, g, b, a));
-                drawstate.surface_cliprect_dirty = SDL_TRUE;
+            case SDL_RENDERCMD_CLEAR:
+            case SDL_RENDERCMD_DRAW_POINTS:
+            case SDL_RENDERCMD_FILL_RECTS:
+                drawing = SDL_TRUE;
                 break;
-            }
 
-            case SDL_RENDERCMD_DRAW_POINTS: {
-                const Uint8 r = cmd->data.draw.r;
-                const Uint8 g = cmd->data.draw.g;
-                const Uint8 b = cmd->data.draw.b;
-                const Uint8 a = cmd->data.draw.a;
-                const int count = (int) cmd->data.draw.count;
-                const SDL_Point *verts = (SDL_Point *) (((Uint8 *) vertices) + cmd->data.draw.first);
-                const SDL_BlendMode blend = cmd->data.draw.blend;
-                SetDrawState(surface, &drawstate);
-                if (blend == SDL_BLENDMODE_NONE) {
-                    SDL_DrawPoints(surface, verts, count, SDL_MapRGBA(surface->format, r, g, b, a));
+            case SDL_RENDERCMD_COPY: {
+                int i;
+                for (i = 0; i < num_textured; ++i) {
+                    if (textured[i]->data.draw.texture == cmd->data.draw.texture) {
+                        break;
+                    }
+                }
+                if ((i < num_textured && !SW_SameTextureState(textured[i], cmd)) ||
+                    (i == num_textured && num_textured == SW_MAX_TILE_TEXTURES)) {
+                    /* Finish the current run before changing the texture state */
+                    if (first && drawing) {
+                        SW_RunTiles(data, first, cmd, vertices, &first_drawstate);
+                    }
+                    first = NULL;
+                    drawing = SDL_FALSE;
+                    num_textured = 0;
+                    i = 0;
+                }
+                if (i == num_textured) {
+                    if (SW_PrepareTileCopy(surface, cmd, vertices)) {
+                        textured[num_textured++] = cmd;
+                    } else {
+                        tiled = SDL_FALSE;
+                    }
                 } else {
-                    SDL_BlendPoints(surface, verts, count, blend, r, g, b, a);
+                    tiled = !SW_IsScaledCopy(cmd, vertices);
                 }
+                drawing = drawing || tiled;
                 break;
             }
 
-            case SDL_RENDERCMD_DRAW_LINES: {
-                const Uint8 r = cmd->data.draw.r;
-                const Uint8 g = cmd->data.draw.g;
-                const Uint8 b = cmd->data.draw.b;
-                const Uint8 a = cmd->data.draw.a;
-                const int count = (int) cmd->data.draw.count;
-                const SDL_Point *verts = (SDL_Point *) (((Uint8 *) vertices) + cmd->data.draw.first);
-                const SDL_BlendMode blend = cmd->data.draw.blend;
-                SetDrawState(surface, &drawstate);
-                if (blend == SDL_BLENDMODE_NONE) {
-                    SDL_DrawLines(surface, verts, count, SDL_MapRGBA(surface->format, r, g, b, a));
-                } else {
-                    SDL_BlendLines(surface, verts, count, blend, r, g, b, a);
-                }
+            case SDL_RENDERCMD_DRAW_LINES:
+            case SDL_RENDERCMD_COPY_EX:
+            case SDL_RENDERCMD_COPY_SPRITES:
+                tiled = SDL_FALSE;
                 break;
-            }
 
-            case SDL_RENDERCMD_FILL_RECTS: {
-                const Uint8 r = cmd->data.draw.r;
-                const Uint8 g = cmd->data.draw.g;
-                const Uint8 b = cmd->data.draw.b;
-                const Uint8 a = cmd->data.draw.a;
-                const int count = (int) cmd->data.draw.count;
-                const SDL_Rect *verts = (SDL_Rect *) (((Uint8 *) vertices) + cmd->data.draw.first);
-                const SDL_BlendMode blend = cmd->data.draw.blend;
-                SetDrawState(surface, &drawstate);
-                if (blend == SDL_BLENDMODE_NONE) {
-                    SDL_FillRects(surface, verts, count, SDL_MapRGBA(surface->format, r, g, b, a));
-                } else {
-                    SDL_BlendFillRects(surface, verts, count, blend, r, g, b, a);
-                }
+            default:
                 break;
+        }
+
+        if (tiled) {
+            if (!first) {
+                first = cmd;
+                first_drawstate = previous;
             }
+        } else {
+            if (first && drawing) {
+                SW_RunTiles(data, first, cmd, vertices, &first_drawstate);
+            }
+            first = NULL;
+            drawing = SDL_FALSE;
+            num_textured = 0;
+            SW_RunCommand(renderer, surface, cmd, vertices, &drawstate);
+        }
 
-            case SDL_RENDERCMD_COPY: {
-                SDL_Rect *verts = (SDL_Rect *) (((Uint8 *) vertices) + cmd->data.draw.first);
-                const SDL_Rect *srcrect = verts;
-                SDL_Rect *dstrect = verts + 1;
-                SDL_Texture *texture = cmd->data.draw.texture;
-                SDL_Surface *src = (SDL_Surface *) texture->driverdata;
+        cmd = cmd->next;
+    }
 
-                SetDrawState(surface, &drawstate);
+    if (first && drawing) {
+        SW_RunTiles(data, first, NULL, vertices, &first_drawstate);
+    }
+
+    return 0;
+}
 
-                PrepTextureForCopy(cmd);
+static int
+SW_RunCommandQueue(SDL_Renderer * renderer, SDL_RenderCommand *cmd, void *vertices, size_t vertsize)
+{
+    SDL_Surface *surface = SW_ActivateRenderer(renderer);
+    SW_DrawStateCache drawstate;
 
-                if ( srcrect->w == dstrect->w && srcrect->h == dstrect->h ) {
-                    SDL_BlitSurface(src, srcrect, surface, dstrect);
-                } else {
-                    /* If scaling is ever done, permanently disable RLE (which doesn't support scaling)
-                     * to avoid potentially frequent RLE encoding/decoding.
-                     */
-                    SDL_SetSurfaceRLE(surface, 0);
-                    SDL_BlitScaled(src, srcrect, surface, dstrect);
-                }
-                break;
-            }
+    if (!surface) {
+        return -1;
+    }
 
-            case SDL_RENDERCMD_COPY_EX: {
-                const CopyExData *copydata = (CopyExData *) (((Uint8 *) vertices) + cmd->data.draw.first);
-                SetDrawState(surface, &drawstate);
-                PrepTextureForCopy(cmd);
-                SW_RenderCopyEx(renderer, surface, cmd->data.draw.texture, &copydata->srcrect,
-                                &copydata->dstrect, copydata->angle, &copydata->center, copydata->flip);
-                break;
-            }
+    if (SW_PrepareTiles(renderer, surface)) {
+        return SW_RunCommandQueueTiled(renderer, surface, cmd, vertices);
+    }
 
-            case SDL_RENDERCMD_NO_OP:
-                break;
-        }
+    drawstate.viewport = NULL;
+    drawstate.cliprect = NULL;
+    drawstate.tile = NULL;
+    drawstate.surface_cliprect_dirty = SDL_TRUE;
 
+    while (cmd) {
+        SW_RunCommand(renderer, surface, cmd, vertices, &drawstate);
         cmd = cmd->next;
     }
 
@@ -799,6 +1301,9 @@ SW_DestroyRenderer(SDL_Renderer * renderer)
 {
     SW_RenderData *data = (SW_RenderData *) renderer->driverdata;
 
+    if (data) {
+        SW_DestroyTiles(data);
+    }
     SDL_free(data);
     SDL_free(renderer);
 }
@@ -808,6 +1313,7 @@ SW_CreateRendererForSurface(SDL_Surface * surface)
 {
     SDL_Renderer *renderer;
     SW_RenderData *data;
+    const char *hint;
 
     if (!surface) {
         SDL_SetError("Can't create renderer for NULL surface");
@@ -829,6 +1335,11 @@ SW_CreateRendererForSurface(SDL_Surface * surface)
     data->surface = surface;
     data->window = surface;
 
+    hint = SDL_GetHint(SDL_HINT_RENDER_SOFTWARE_THREADS);
+    if (hint) {
+        data->num_tiles = SDL_min(SDL_max(SDL_atoi(hint), 0), SW_MAX_TILES);
+    }
+
     renderer->WindowEvent = SW_WindowEvent;
     renderer->GetOutputSize = SW_GetOutputSize;
     renderer->CreateTexture = SW_CreateTexture;
@@ -844,7 +1355,10 @@ SW_CreateRendererForSurface(SDL_Surface * surface)
     renderer->QueueFillRects = SW_QueueFillRects;
     renderer->QueueCopy = SW_QueueCopy;
     renderer->QueueCopyEx = SW_QueueCopyEx;
+    renderer->QueueCopySprites = SW_QueueCopySprites;
     renderer->RunCommandQueue = SW_RunCommandQueue;
+    renderer->merge_fill_rects = SDL_TRUE;
+    renderer->merge_copies = SDL_TRUE;
     renderer->RenderReadPixels = SW_RenderReadPixels;
     renderer->RenderPresent = SW_RenderPresent;
     renderer->DestroyTexture = SW_DestroyTexture;
@@ -34,7 +34,9 @@ typedef struct _SDL_Timer
     SDL_TimerCallback callback;
     void *param;
     Uint32 interval;
-    Uint32 scheduled;
+    SDL_bool microseconds;
+    Uint64 scheduled;
+    Uint32 sequence;
     SDL_atomic_t canceled;
     struct _SDL_Timer *next;
 } SDL_Timer;
@@ -46,7 +48,7 @@ typedef struct _SDL_TimerMap
     struct _SDL_TimerMap *next;
 } SDL_TimerMap;
 
-/* The timers are kept in a sorted list */
+/* The timers are kept in a binary min-heap, ordered by performance counter deadline */
 typedef struct {
     /* Data used by the main thread */
     SDL_Thread *thread;
@@ -64,8 +66,12 @@ typedef struct {
     SDL_Timer *freelist;
     SDL_atomic_t active;
 
-    /* List of timers - this is only touched by the timer thread */
-    SDL_Timer *timers;
+    /* Heap of timers - this is only touched by the timer thread */
+    SDL_Timer **timers;
+    int num_timers;
+    int max_timers;
+    Uint32 sequence;
+    Uint64 frequency;
 } SDL_TimerData;
 
 static SDL_TimerData SDL_timer_data;
@@ -76,25 +82,79 @@ static SDL_TimerData SDL_timer_data;
  * Timers are removed by simply setting a canceled flag
  */
 
-static void
+/* Convert a timer interval into performance counter units, without overflowing */
+static Uint64
+SDL_TimerIntervalToCounter(const SDL_TimerData *data, Uint32 interval, SDL_bool microseconds)
+{
+    const Uint64 units = microseconds ? 1000000 : 1000;
+
+    return (interval / units) * data->frequency +
+           ((interval % units) * data->frequency) / units;
+}
+
+/* Timers due at the same time run in the order they were scheduled */
+static SDL_bool
+SDL_TimerBefore(const SDL_Timer *a, const SDL_Timer *b)
+{
+    if (a->scheduled != b->scheduled) {
+        return (a->scheduled < b->scheduled) ? SDL_TRUE : SDL_FALSE;
+    }
+    return ((Sint32)(a->sequence - b->sequence) < 0) ? SDL_TRUE : SDL_FALSE;
+}
+
+static int
 SDL_AddTimerInternal(SDL_TimerData *data, SDL_Timer *timer)
 {
-    SDL_Timer *prev, *curr;
+    SDL_Timer **timers = data->timers;
+    int i, parent;
 
-    prev = NULL;
-    for (curr = data->timers; curr; prev = curr, curr = curr->next) {
-        if ((Sint32)(timer->scheduled-curr->scheduled) < 0) {
+    if (data->num_timers == data->max_timers) {
+        const int max_timers = data->max_timers ? (data->max_timers * 2) : 64;
+        timers = (SDL_Timer **)SDL_realloc(data->timers, max_timers * sizeof(*timers));
+        if (!timers) {
+            return -1;
+        }
+        data->timers = timers;
+        data->max_timers = max_timers;
+    }
+
+    timer->sequence = data->sequence++;
+
+    /* Sift up from the new leaf */
+    for (i = data->num_timers++; i > 0; i = parent) {
+        parent = (i - 1) / 2;
+        if (!SDL_TimerBefore(timer, timers[parent])) {
             break;
         }
+        timers[i] = timers[parent];
     }
+    timers[i] = timer;
+    return 0;
+}
 
-    /* Insert the timer here! */
-    if (prev) {
-        prev->next = timer;
-    } else {
-        data->timers = timer;
+static SDL_Timer *
+SDL_RemoveFirstTimer(SDL_TimerData *data)
+{
+    SDL_Timer **timers = data->timers;
+    SDL_Timer *first = timers[0];
+    SDL_Timer *last = timers[--data->num_timers];
+    const int count = data->num_timers;
+    int i, child;
+
+    /* Sift the last leaf down from the root */
+    for (i = 0; (child = 2 * i + 1) < count; i = child) {
+        if (child + 1 < count && SDL_TimerBefore(timers[child + 1], timers[child])) {
+            ++child;
+        }
+        if (!SDL_TimerBefore(timers[child], last)) {
+            break;
+        }
+        timers[i] = timers[child];
     }
-    timer->next = curr;
+    if (count > 0) {
+        timers[i] = last;
+    }
+    return first;
 }
 
 static int SDLCALL
@@ -105,7 +165,9 @@ SDL_TimerThread(void *_data)
     SDL_Timer *current;
     SDL_Timer *freelist_head = NULL;
     SDL_Timer *freelist_tail = NULL;
-    Uint32 tick, now, interval, delay;
+    Uint64 tick, now, delay, slop;
+    Uint32 interval;
+    SDL_bool spin;
 
     /* Threaded timer loop:
      *  1. Queue timers added by other threads
@@ -128,37 +190,59 @@ SDL_TimerThread(void *_data)
         }
         SDL_AtomicUnlock(&data->lock);
 
-        /* Sort the pending timers into our list */
+        freelist_head = NULL;
+        freelist_tail = NULL;
+
+        /* Sort the pending timers into our heap */
         while (pending) {
             current = pending;
             pending = pending->next;
-            SDL_AddTimerInternal(data, current);
+            if (SDL_AddTimerInternal(data, current) < 0) {
+                /* Out of memory, drop the timer */
+                SDL_AtomicSet(&current->canceled, 1);
+                current->next = freelist_head;
+                freelist_head = current;
+                if (!freelist_tail) {
+                    freelist_tail = current;
+                }
+            }
         }
-        freelist_head = NULL;
-        freelist_tail = NULL;
 
         /* Check to see if we're still running, after maintenance */
         if (!SDL_AtomicGet(&data->active)) {
+            /* Free any timers we couldn't queue, the rest are cleaned up by SDL_TimerQuit() */
+            while (freelist_head) {
+                current = freelist_head;
+                freelist_head = current->next;
+                SDL_free(current);
+            }
             break;
         }
 
-        /* Initial delay if there are no timers */
-        delay = SDL_MUTEX_MAXWAIT;
+        /* No delay means there are no timers, wait for one to be added */
+        delay = 0;
+        spin = SDL_FALSE;
 
-        tick = SDL_GetTicks();
+        tick = SDL_GetPerformanceCounter();
+
+        /* Millisecond timers can't be waited for more precisely than that,
+           so they are due when they're within half a millisecond.
+         */
+        slop = data->frequency / 2000;
 
         /* Process all the pending timers for this tick */
-        while (data->timers) {
-            current = data->timers;
+        while (data->num_timers > 0) {
+            current = data->timers[0];
 
-            if ((Sint32)(tick-current->scheduled) < 0) {
+            if (current->scheduled > tick + (current->microseconds ? 0 : slop)) {
                 /* Scheduled for the future, wait a bit */
                 delay = (current->scheduled - tick);
+                spin = current->microseconds;
                 break;
             }
 
             /* We're going to do something with this timer */
-            data->timers = current->next;
+            SDL_RemoveFirstTimer(data);
 
             if (SDL_AtomicGet(&current->canceled)) {
                 interval = 0;
@@ -167,38 +251,62 @@ SDL_TimerThread(void *_data)
             }
 
             if (interval > 0) {
-                /* Reschedule this timer */
+                /* Reschedule this timer, relative to when it was due so it doesn't drift */
                 current->interval = interval;
-                current->scheduled = tick + interval;
-                SDL_AddTimerInternal(data, current);
-            } else {
-                if (!freelist_head) {
-                    freelist_head = current;
+                current->scheduled += SDL_TimerIntervalToCounter(data, interval, current->microseconds);
+                if (current->scheduled <= tick) {
+                    /* We fell behind, skip the missed intervals */
+                    current->scheduled = tick + SDL_TimerIntervalToCounter(data, interval, current->microseconds);
                 }
-                if (freelist_tail) {
-                    freelist_tail->next = current;
+                if (SDL_AddTimerInternal(data, current) == 0) {
+                    continue;
                 }
-                freelist_tail = current;
+            }
 
-                SDL_AtomicSet(&current->canceled, 1);
+            if (!freelist_head) {
+                freelist_head = current;
+            }
+            if (freelist_tail) {
+                freelist_tail->next = current;
             }
+            freelist_tail = current;
+            current->next = NULL;
+
+            SDL_AtomicSet(&current->canceled, 1);
+        }
+
+        if (delay == 0) {
+            /* Note that each time a timer is added, this will return
+               immediately, but we process the timers added all at once.
+               That's okay, it just means we run through the loop a few
+               extra times.
+             */
+            SDL_SemWait(data->sem);
+            continue;
         }
 
         /* Adjust the delay based on processing time */
-        now = SDL_GetTicks();
-        interval = (now - tick);
-        if (interval > delay) {
-            delay = 0;
+        now = SDL_GetPerformanceCounter();
+        if ((now - tick) >= delay) {
+            continue;
+        }
+        delay -= (now - tick);
+
+        if (spin && delay < data->frequency / 1000) {
+            /* Less than a millisecond to a microsecond timer, the semaphore
+               can't wait that precisely, so poll until it's due.
+             */
+            while (SDL_SemTryWait(data->sem) == SDL_MUTEX_TIMEDOUT) {
+                if ((SDL_GetPerformanceCounter() - now) >= delay) {
+                    break;
+                }
+            }
+        } else if (spin) {
+            /* Wake up early and spin for the rest */
+            SDL_SemWaitTimeout(data->sem, (Uint32)((delay * 1000) / data->frequency));
         } else {
-            delay -= interval;
+            SDL_SemWaitTimeout(data->sem, (Uint32)((delay * 1000 + data->frequency / 2) / data->frequency));
         }
-
-        /* Note that each time a timer is added, this will return
-           immediately, but we process the timers added all at once.
-           That's okay, it just means we run through the loop a few
-           extra times.
-         */
-        SDL_SemWaitTimeout(data->sem, delay);
     }
     return 0;
 }
@@ -221,6 +329,8 @@ SDL_TimerInit(void)
             return -1;
         }
 
+        data->frequency = SDL_GetPerformanceFrequency();
+
         SDL_AtomicSet(&data->active, 1);
 
         /* Timer threads use a callback into the app, so we can't set a limited stack size here. */
@@ -254,9 +364,15 @@ SDL_TimerQuit(void)
         data->sem = NULL;
 
         /* Clean up the timer entries */
-        while (data->timers) {
-            timer = data->timers;
-            data->timers = timer->next;
+        while (data->num_timers > 0) {
+            SDL_free(data->timers[--data->num_timers]);
+        }
+        SDL_free(data->timers);
+        data->timers = NULL;
+        data->max_timers = 0;
+        while (data->pending) {
+            timer = data->pending;
+            data->pending = timer->next;
             SDL_free(timer);
         }
         while (data->freelist) {
@@ -275,8 +391,8 @@ SDL_TimerQuit(void)
     }
 }
 
-SDL_TimerID
-SDL_AddTimer(Uint32 interval, SDL_TimerCallback callback, void *param)
+static SDL_TimerID
+SDL_CreateTimer(Uint32 interval, SDL_bool microseconds, SDL_TimerCallback callback, void *param)
 {
     SDL_TimerData *data = &SDL_timer_data;
     SDL_Timer *timer;
@@ -309,7 +425,8 @@ SDL_AddTimer(Uint32 interval, SDL_TimerCallback callback, void *param)
     timer->callback = callback;
     timer->param = param;
     timer->interval = interval;
-    timer->scheduled = SDL_GetTicks() + interval;
+    timer->microseconds = microseconds;
+    timer->scheduled = SDL_GetPerformanceCounter() + SDL_TimerIntervalToCounter(data, interval, microseconds);
     SDL_AtomicSet(&timer->canceled, 0);
 
     entry = (SDL_TimerMap *)SDL_malloc(sizeof(*entry));
@@ -338,6 +455,18 @@ SDL_AddTimer(Uint32 interval, SDL_TimerCallback callback, void *param)
     return entry->timerID;
 }
 
+SDL_TimerID
+SDL_AddTimer(Uint32 interval, SDL_TimerCallback callback, void *param)
+{
+    return SDL_CreateTimer(interval, SDL_FALSE, callback, param);
+}
+
+SDL_TimerID
+SDL_AddTimerMicroseconds(Uint32 interval, SDL_TimerCallback callback, void *param)
+{
+    return SDL_CreateTimer(interval, SDL_TRUE, callback, param);
+}
+
 SDL_bool
 SDL_RemoveTimer(SDL_TimerID id)
 {
@@ -28,6 +28,161 @@
 #include "SDL_blit_slow.h"
 #include "SDL_RLEaccel_c.h"
 #include "SDL_pixels_c.h"
+#include "SDL_hints.h"
+#include "SDL_atomic.h"
+#include "SDL_thread.h"
+#include "../thread/SDL_systhread.h"
+
+/* Blitting big surfaces on several threads...
+
+   Unless it's scaling, every blitter works on each row by itself, so a
+   large blit is cut into bands of rows that a small pool of worker threads
+   share with the calling thread. The pool is started the first time it's
+   needed and stopped by SDL_Quit(). Only one blit uses it at a time; any
+   other blit that comes along meanwhile runs on its own thread as usual. */
+
+#define BLIT_MAX_THREADS 16
+#define BLIT_THREADED_MIN_PIXELS (512 * 512)  /* smaller blits aren't worth waking threads for. */
+#define BLIT_THREADED_MIN_BAND (128 * 1024)   /* pixels in each band, at least. */
+
+typedef struct
+{
+    SDL_BlitFunc blit;
+    const SDL_BlitInfo *info;
+    int band_h;
+    int numbands;
+    SDL_atomic_t next_band;
+} SDL_BlitJob;
+
+typedef struct
+{
+    SDL_SpinLock lock;  /* held while a blit is using the pool, or it's being stopped. */
+    SDL_sem *work;
+    SDL_sem *done;
+    SDL_Thread *threads[BLIT_MAX_THREADS - 1];
+    int numthreads;
+    SDL_BlitJob *job;
+    SDL_bool quit;
+} SDL_BlitPool;
+
+static SDL_BlitPool SDL_blit_pool;
+
+/* Take bands off the job until there are none left */
+static void
+SDL_RunBlitBands(SDL_BlitJob *job)
+{
+    int band;
+
+    while ((band = SDL_AtomicAdd(&job->next_band, 1)) < job->numbands) {
+        SDL_BlitInfo info = *job->info;
+        const int y = band * job->band_h;
+
+        info.src += y * info.src_pitch;
+        info.dst += y * info.dst_pitch;
+        info.src_h = info.dst_h = SDL_min(job->band_h, job->info->dst_h - y);
+        job->blit(&info);
+    }
+}
+
+static int SDLCALL
+SDL_BlitThread(void *data)
+{
+    SDL_BlitPool *pool = (SDL_BlitPool *) data;
+
+    for (;;) {
+        SDL_SemWait(pool->work);
+        if (pool->quit) {
+            break;
+        }
+        SDL_RunBlitBands(pool->job);
+        SDL_SemPost(pool->done);
+    }
+    return 0;
+}
+
+/* Returns SDL_TRUE if the blit was done here, SDL_FALSE if the caller should do it. */
+static SDL_bool
+SDL_SoftBlitThreaded(SDL_BlitFunc blit, const SDL_BlitInfo *info)
+{
+    SDL_BlitPool *pool = &SDL_blit_pool;
+    const Uint8 *src_end = info->src + info->src_h * info->src_pitch;
+    const Uint8 *dst_end = info->dst + info->dst_h * info->dst_pitch;
+    const char *hint;
+    SDL_BlitJob job;
+    int threads, workers, i;
+
+    if (info->dst_w * info->dst_h < BLIT_THREADED_MIN_PIXELS) {
+        return SDL_FALSE;
+    }
+    /* Scaled blits step through the source in ways that don't split into
+       bands, and if the pixels overlap one band could overwrite rows that
+       another one hasn't read yet. */
+    if (info->src_w != info->dst_w || info->src_h != info->dst_h) {
+        return SDL_FALSE;
+    }
+    if (info->src < dst_end && info->dst < src_end) {
+        return SDL_FALSE;
+    }
+
+    hint = SDL_GetHint(SDL_HINT_BLIT_THREADS);
+    threads = hint ? SDL_atoi(hint) : 1;
+    if (threads <= 0) {
+        threads = SDL_GetCPUCount();
+    }
+    threads = SDL_min(threads, BLIT_MAX_THREADS);
+    threads = SDL_min(threads, (info->dst_w * info->dst_h) / BLIT_THREADED_MIN_BAND);
+    if (threads <= 1) {
+        return SDL_FALSE;
+    }
+
+    if (!SDL_AtomicTryLock(&pool->lock)) {
+        return SDL_FALSE;  /* another blit has the pool. */
+    }
+
+    if (!pool->work) {
+        pool->work = SDL_CreateSemaphore(0);
+        pool->done = SDL_CreateSemaphore(0);
+        if (!pool->work || !pool->done) {
+            if (pool->work) {
+                SDL_DestroySemaphore(pool->work);
+                pool->work = NULL;
+            }
+            if (pool->done) {
+                SDL_DestroySemaphore(pool->done);
+                pool->done = NULL;
+            }
+            SDL_AtomicUnlock(&pool->lock);
+            return SDL_FALSE;
+        }
+    }
+    while (pool->numthreads < threads - 1) {
+        SDL_Thread *thread = SDL_CreateThreadInternal(SDL_BlitThread, "SDLBlit", 0, pool);
+        if (!thread) {
+            break;  /* make do with the threads we have. */
+        }
+        pool->threads[pool->numthreads++] = thread;
+    }
+    workers = SDL_min(threads - 1, pool->numthreads);
+
+    job.blit = blit;
+    job.info = info;
+    job.band_h = (info->dst_h + threads - 1) / threads;
+    job.numbands = (info->dst_h + job.band_h - 1) / job.band_h;
+    SDL_AtomicSet(&job.next_band, 0);
+    pool->job = &job;
+
+    for (i = 0; i < workers; i++) {
+        SDL_SemPost(pool->work);
+    }
+    SDL_RunBlitBands(&job);  /* this thread takes its share, too. */
+    for (i = 0; i < workers; i++) {
+        SDL_SemWait(pool->done);
+    }
+
+    pool->job = NULL;
+    SDL_AtomicUnlock(&pool->lock);
+    return SDL_TRUE;
+}
 
 /* The general purpose software blit routine */
 static int SDLCALL
@@ -84,8 +239,10 @@ SDL_SoftBlit(SDL_Surface * src, SDL_Rect * srcrect,
             info->dst_pitch - info->dst_w * info->dst_fmt->BytesPerPixel;
         RunBlit = (SDL_BlitFunc) src->map->data;
 
-        /* Run the actual software blit */
-        RunBlit(info);
+        /* Run the actual software blit, on several threads if it's big */
+        if (!SDL_SoftBlitThreaded(RunBlit, info)) {
+            RunBlit(info);
+        }
     }
 
     /* We need to unlock the surfaces if they're locked */
@@ -99,8 +256,6 @@ SDL_SoftBlit(SDL_Surface * src, SDL_Rect * srcrect,
     return (okay ? 0 : -1);
 }
 
-#if SDL_HAVE_BLIT_AUTO
-
 #ifdef __MACOSX__
 #include <sys/sysctl.h>
 
@@ -126,44 +281,59 @@ SDL_UseAltivecPrefetch()
 }
 #endif /* __MACOSX__ */
 
-static SDL_BlitFunc
-SDL_ChooseBlitFunc(Uint32 src_format, Uint32 dst_format, int flags,
-                   SDL_BlitFuncEntry * entries)
+/* The SDL_CPU_* features the blitters may use. The SDL_BLIT_CPU_FEATURES
+   hint or environment variable overrides them for testing, and is checked
+   every time so that a test can switch blitters between blits. */
+Uint32
+SDL_GetBlitCPUFeatures(void)
 {
-    int i, flagcheck = (flags & (SDL_COPY_MODULATE_COLOR | SDL_COPY_MODULATE_ALPHA | SDL_COPY_BLEND | SDL_COPY_ADD | SDL_COPY_MOD | SDL_COPY_MUL | SDL_COPY_COLORKEY | SDL_COPY_NEAREST));
-    static int features = 0x7fffffff;
-
-    /* Get the available CPU features */
-    if (features == 0x7fffffff) {
-        const char *override = SDL_getenv("SDL_BLIT_CPU_FEATURES");
+    static Uint32 detected = 0xFFFFFFFF;
+    const char *override = SDL_GetHint("SDL_BLIT_CPU_FEATURES");
+    Uint32 features = SDL_CPU_ANY;
 
-        features = SDL_CPU_ANY;
+    if (override) {
+        SDL_sscanf(override, "%u", &features);
+        return features;
+    }
 
-        /* Allow an override for testing .. */
-        if (override) {
-            SDL_sscanf(override, "%u", &features);
-        } else {
-            if (SDL_HasMMX()) {
-                features |= SDL_CPU_MMX;
-            }
-            if (SDL_Has3DNow()) {
-                features |= SDL_CPU_3DNOW;
-            }
-            if (SDL_HasSSE()) {
-                features |= SDL_CPU_SSE;
-            }
-            if (SDL_HasSSE2()) {
-                features |= SDL_CPU_SSE2;
-            }
-            if (SDL_HasAltiVec()) {
-                if (SDL_UseAltivecPrefetch()) {
-                    features |= SDL_CPU_ALTIVEC_PREFETCH;
-                } else {
-                    features |= SDL_CPU_ALTIVEC_NOPREFETCH;
-                }
+    if (detected == 0xFFFFFFFF) {
+        if (SDL_HasMMX()) {
+            features |= SDL_CPU_MMX;
+        }
+        if (SDL_Has3DNow()) {
+            features |= SDL_CPU_3DNOW;
+        }
+        if (SDL_HasSSE()) {
+            features |= SDL_CPU_SSE;
+        }
+        if (SDL_HasSSE2()) {
+            features |= SDL_CPU_SSE2;
+        }
+        if (SDL_HasSSE41()) {
+            features |= SDL_CPU_SSE41;
+        }
+        if (SDL_HasAVX2()) {
+            features |= SDL_CPU_AVX2;
+        }
+        if (SDL_HasAltiVec()) {
+            if (SDL_UseAltivecPrefetch()) {
+                features |= SDL_CPU_ALTIVEC_PREFETCH;
+            } else {
+                features |= SDL_CPU_ALTIVEC_NOPREFETCH;
             }
         }
+        detected = features;
     }
+    return detected;
+}
+
+#if SDL_HAVE_BLIT_AUTO
+static SDL_BlitFunc
+SDL_ChooseBlitFunc(Uint32 src_format, Uint32 dst_format, int flags,
+                   SDL_BlitFuncEntry * entries)
+{
+    int i, flagcheck = (flags & (SDL_COPY_MODULATE_COLOR | SDL_COPY_MODULATE_ALPHA | SDL_COPY_BLEND | SDL_COPY_ADD | SDL_COPY_MOD | SDL_COPY_MUL | SDL_COPY_COLORKEY | SDL_COPY_NEAREST));
+    const Uint32 features = SDL_GetBlitCPUFeatures();
 
     for (i = 0; entries[i].func; ++i) {
         /* Check for matching pixel formats */
@@ -191,6 +361,83 @@ SDL_ChooseBlitFunc(Uint32 src_format, Uint32 dst_format, int flags,
 }
 #endif /* SDL_HAVE_BLIT_AUTO */
 
+/* Blit functions that have been chosen before...
+
+   Remapping a surface to a new destination searches the blitter tables
+   again, so the functions they pick are remembered in a small hash table.
+   The choice only depends on the two pixel formats, the copy flags,
+   whether the formats are identical and the CPU features in use, and every
+   pixel format except SDL_PIXELFORMAT_UNKNOWN is fully described by its
+   enum value. */
+
+#define BLIT_CACHE_BITS 8
+#define BLIT_CACHE_SIZE (1 << BLIT_CACHE_BITS)
+
+typedef struct
+{
+    Uint32 src_format;
+    Uint32 dst_format;
+    int flags;
+    int identity;
+    Uint32 features;
+    SDL_BlitFunc func;
+} SDL_BlitCacheEntry;
+
+static SDL_BlitCacheEntry SDL_blit_cache[BLIT_CACHE_SIZE];
+static SDL_SpinLock SDL_blit_cache_lock;
+
+/* Returns SDL_FALSE if the blit function for this surface can't be cached */
+static SDL_bool
+SDL_GetBlitCacheKey(SDL_Surface * surface, SDL_BlitCacheEntry * key, Uint32 * hash)
+{
+    SDL_BlitMap *map = surface->map;
+
+    key->src_format = surface->format->format;
+    key->dst_format = map->dst->format->format;
+    if (key->src_format == SDL_PIXELFORMAT_UNKNOWN ||
+        key->dst_format == SDL_PIXELFORMAT_UNKNOWN) {
+        return SDL_FALSE;
+    }
+    key->flags = (map->info.flags & ~SDL_COPY_RLE_MASK);
+    key->identity = map->identity;
+    key->features = SDL_GetBlitCPUFeatures();
+    key->func = NULL;
+
+    *hash = (key->src_format * 0x9E3779B1u) ^ (key->dst_format * 0x85EBCA77u) ^
+            ((Uint32) key->flags * 0xC2B2AE3Du) ^ (Uint32) key->identity ^
+            (key->features * 0x27D4EB2Fu);
+    *hash = (*hash * 0x9E3779B1u) >> (32 - BLIT_CACHE_BITS);
+    return SDL_TRUE;
+}
+
+static SDL_BlitFunc
+SDL_LookupBlitFunc(const SDL_BlitCacheEntry * key, Uint32 hash)
+{
+    SDL_BlitCacheEntry *entry = &SDL_blit_cache[hash];
+    SDL_BlitFunc func = NULL;
+
+    SDL_AtomicLock(&SDL_blit_cache_lock);
+    if (entry->func &&
+        entry->src_format == key->src_format &&
+        entry->dst_format == key->dst_format &&
+        entry->flags == key->flags &&
+        entry->identity == key->identity &&
+        entry->features == key->features) {
+        func = entry->func;
+    }
+    SDL_AtomicUnlock(&SDL_blit_cache_lock);
+    return func;
+}
+
+static void
+SDL_CacheBlitFunc(const SDL_BlitCacheEntry * key, Uint32 hash, SDL_BlitFunc func)
+{
+    SDL_AtomicLock(&SDL_blit_cache_lock);
+    SDL_blit_cache[hash] = *key;
+    SDL_blit_cache[hash].func = func;
+    SDL_AtomicUnlock(&SDL_blit_cache_lock);
+}
+
 /* Figure out which of many blit routines to set up on a surface */
 int
 SDL_CalculateBlit(SDL_Surface * surface)
@@ -198,6 +445,9 @@ SDL_CalculateBlit(SDL_Surface * surface)
     SDL_BlitFunc blit = NULL;
     SDL_BlitMap *map = surface->map;
     SDL_Surface *dst = map->dst;
+    SDL_BlitCacheEntry key;
+    Uint32 hash = 0;
+    SDL_bool cached;
 
     /* We don't currently support blitting to < 8 bpp surfaces */
     if (dst->format->BitsPerPixel < 8) {
@@ -227,6 +477,16 @@ SDL_CalculateBlit(SDL_Surface * surface)
     }
 #endif
 
+    /* Use the blit function we chose last time, if there was one */
+    cached = SDL_GetBlitCacheKey(surface, &key, &hash);
+    if (cached) {
+        blit = SDL_LookupBlitFunc(&key, hash);
+        if (blit) {
+            map->data = blit;
+            return 0;
+        }
+    }
+
     /* Choose a standard blit function */
     if (map->identity && !(map->info.flags & ~SDL_COPY_RLE_DESIRED)) {
         blit = SDL_BlitCopy;
@@ -290,7 +550,42 @@ SDL_CalculateBlit(SDL_Surface * surface)
         return SDL_SetError("Blit combination not supported");
     }
 
+    if (cached) {
+        SDL_CacheBlitFunc(&key, hash, blit);
+    }
     return 0;
 }
 
+/* Stop the blit threads and forget the blit functions, for SDL_Quit() */
+void
+SDL_QuitBlit(void)
+{
+    SDL_BlitPool *pool = &SDL_blit_pool;
+    int i;
+
+    SDL_AtomicLock(&pool->lock);
+    pool->quit = SDL_TRUE;
+    for (i = 0; i < pool->numthreads; i++) {
+        SDL_SemPost(pool->work);
+    }
+    for (i = 0; i < pool->numthreads; i++) {
+        SDL_WaitThread(pool->threads[i], NULL);
+    }
+    pool->numthreads = 0;
+    if (pool->work) {
+        SDL_DestroySemaphore(pool->work);
+        pool->work = NULL;
+    }
+    if (pool->done) {
+        SDL_DestroySemaphore(pool->done);
+        pool->done = NULL;
+    }
+    pool->quit = SDL_FALSE;
+    SDL_AtomicUnlock(&pool->lock);
+
+    SDL_AtomicLock(&SDL_blit_cache_lock);
+    SDL_zero(SDL_blit_cache);
+    SDL_AtomicUnlock(&SDL_blit_cache_lock);
+}
+
 /* vi: set ts=4 sw=4 expandtab: */
@@ -25,6 +25,23 @@
 #include "SDL_video.h"
 #include "SDL_blit.h"
 
+/* The SSE4.1 and AVX2 blitters are built for those instruction sets
+   regardless of the compiler flags, and only chosen at runtime on CPUs that
+   have them. MSVC allows any intrinsic without a flag, GCC and Clang need
+   the target attribute on every function that uses them. */
+#if defined(HAVE_IMMINTRIN_H) && !defined(SDL_DISABLE_IMMINTRIN_H) && \
+    (defined(__i386__) || defined(__x86_64__) || defined(_M_IX86) || defined(_M_X64))
+#if defined(__clang__) || (defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9)))
+#define SDL_TARGETING(x) __attribute__((target(x)))
+#define HAVE_SSE41_INTRINSICS 1
+#define HAVE_AVX2_INTRINSICS 1
+#elif defined(_MSC_VER)
+#define SDL_TARGETING(x)
+#define HAVE_SSE41_INTRINSICS 1
+#define HAVE_AVX2_INTRINSICS 1
+#endif
+#endif
+
 /* Functions to perform alpha blended blitting */
 
 /* N->1 blending with per-surface alpha */
@@ -455,6 +472,326 @@ BlitRGBtoRGBPixelAlphaARMNEON(SDL_BlitInfo * info)
 }
 #endif
 
+#if HAVE_SSE41_INTRINSICS || HAVE_AVX2_INTRINSICS
+/* Shuffles for blending between any two 32-bit formats with whole-byte
+   channels. The source is swizzled into the destination's channel order
+   with its alpha byte cleared, and each pixel's alpha is spread over its
+   four channels, widened to 16 bits. Both are per 128-bit lane. */
+typedef struct
+{
+    Uint8 swizzle[16];
+    Uint8 alpha_lo[16];         /* alpha of pixels 0 and 1 */
+    Uint8 alpha_hi[16];         /* alpha of pixels 2 and 3 */
+    Uint16 alpha_lanes[8];      /* the destination's alpha (or padding) byte */
+    Uint32 src_amask;
+    Uint32 dst_keep;            /* bits the destination format really has */
+} SDL_Blend8888Masks;
+
+static SDL_bool
+IsByteAligned8888(const SDL_PixelFormat * fmt)
+{
+    return (fmt->BytesPerPixel == 4
+            && fmt->Rloss == 0 && fmt->Gloss == 0 && fmt->Bloss == 0
+            && fmt->Rshift % 8 == 0 && fmt->Gshift % 8 == 0
+            && fmt->Bshift % 8 == 0
+            && (fmt->Amask == 0
+                || (fmt->Aloss == 0 && fmt->Ashift % 8 == 0)));
+}
+
+static void BlitRGBtoRGBSurfaceAlpha128(SDL_BlitInfo * info);
+
+/* Surface alpha 128 between RGB888 layouts has a shortcut that beats the
+   vector blend. The alpha can change without the blitter being chosen
+   again, so the surface alpha blitters check for it on every blit. */
+static SDL_bool
+UseSurfaceAlpha128(const SDL_BlitInfo * info)
+{
+    const SDL_PixelFormat *sf = info->src_fmt;
+    const SDL_PixelFormat *df = info->dst_fmt;
+
+    return (info->a == 128
+            && sf->Rmask == df->Rmask && sf->Gmask == df->Gmask
+            && sf->Bmask == df->Bmask
+            && (sf->Rmask | sf->Gmask | sf->Bmask) == 0xffffff);
+}
+
+/* Use the same alpha 128 shortcut the MMX blitter would have taken */
+static void
+BlitSurfaceAlpha128(SDL_BlitInfo * info)
+{
+#ifdef __MMX__
+    if (SDL_HasMMX()) {
+        BlitRGBtoRGBSurfaceAlpha128MMX(info);
+        return;
+    }
+#endif
+    BlitRGBtoRGBSurfaceAlpha128(info);
+}
+
+static void
+GetBlend8888Masks(const SDL_PixelFormat * srcfmt,
+                  const SDL_PixelFormat * dstfmt, SDL_Blend8888Masks * masks)
+{
+    /* Byte offsets in a little endian pixel; without an alpha channel,
+       the padding byte is the one the color channels leave free. */
+    const int sr = srcfmt->Rshift / 8;
+    const int sg = srcfmt->Gshift / 8;
+    const int sb = srcfmt->Bshift / 8;
+    const int sa = srcfmt->Amask ? srcfmt->Ashift / 8 : 6 - sr - sg - sb;
+    const int dr = dstfmt->Rshift / 8;
+    const int dg = dstfmt->Gshift / 8;
+    const int db = dstfmt->Bshift / 8;
+    const int da = 6 - dr - dg - db;
+    int i;
+
+    for (i = 0; i < 4; ++i) {
+        masks->swizzle[i * 4 + dr] = (Uint8) (i * 4 + sr);
+        masks->swizzle[i * 4 + dg] = (Uint8) (i * 4 + sg);
+        masks->swizzle[i * 4 + db] = (Uint8) (i * 4 + sb);
+        masks->swizzle[i * 4 + da] = 0x80;
+    }
+    for (i = 0; i < 8; ++i) {
+        masks->alpha_lo[i * 2] = (Uint8) ((i / 4) * 4 + sa);
+        masks->alpha_hi[i * 2] = (Uint8) ((i / 4 + 2) * 4 + sa);
+        masks->alpha_lo[i * 2 + 1] = masks->alpha_hi[i * 2 + 1] = 0x80;
+        masks->alpha_lanes[i] = (i % 4 == da) ? 0xFFFF : 0;
+    }
+    masks->src_amask = srcfmt->Amask;
+    masks->dst_keep = dstfmt->Rmask | dstfmt->Gmask | dstfmt->Bmask | dstfmt->Amask;
+}
+
+#endif /* HAVE_SSE41_INTRINSICS || HAVE_AVX2_INTRINSICS */
+
+#if HAVE_SSE41_INTRINSICS
+typedef struct
+{
+    __m128i swizzle;
+    __m128i alpha_lo;
+    __m128i alpha_hi;
+    __m128i alpha_lanes;
+    __m128i src_amask;
+    __m128i dst_keep;
+    __m128i surface_alpha;
+} SDL_Blend8888_SSE41;
+
+/* d + (s - d) * a / 255 on 16-bit channels, rounded toward zero exactly
+   like ALPHA_BLEND_RGBA. Working on |s - d| keeps the product in 16 bits,
+   where (x + 1 + (x >> 8)) >> 8 is x / 255. The source alpha byte was
+   cleared, so adding a there gives dA - dA * a / 255 + a, the blended
+   alpha. */
+static SDL_INLINE __m128i SDL_TARGETING("sse4.1")
+BlendChannels_SSE41(__m128i s, __m128i d, __m128i a, __m128i alpha_lanes)
+{
+    const __m128i negative = _mm_cmpgt_epi16(d, s);
+    __m128i x = _mm_mullo_epi16(_mm_sub_epi16(_mm_max_epu16(s, d), _mm_min_epu16(s, d)), a);
+    x = _mm_srli_epi16(_mm_add_epi16(x, _mm_add_epi16(_mm_srli_epi16(x, 8), _mm_set1_epi16(1))), 8);
+    x = _mm_sub_epi16(_mm_xor_si128(x, negative), negative);
+    return _mm_add_epi16(_mm_add_epi16(d, x), _mm_and_si128(a, alpha_lanes));
+}
+
+static SDL_INLINE __m128i SDL_TARGETING("sse4.1")
+BlendPixels_SSE41(__m128i src, __m128i dst, const SDL_Blend8888_SSE41 * v,
+                  SDL_bool pixel_alpha)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i s = _mm_shuffle_epi8(src, v->swizzle);
+    const __m128i alpha_lo = pixel_alpha ? _mm_shuffle_epi8(src, v->alpha_lo) : v->surface_alpha;
+    const __m128i alpha_hi = pixel_alpha ? _mm_shuffle_epi8(src, v->alpha_hi) : v->surface_alpha;
+    const __m128i lo = BlendChannels_SSE41(_mm_unpacklo_epi8(s, zero), _mm_unpacklo_epi8(dst, zero), alpha_lo, v->alpha_lanes);
+    const __m128i hi = BlendChannels_SSE41(_mm_unpackhi_epi8(s, zero), _mm_unpackhi_epi8(dst, zero), alpha_hi, v->alpha_lanes);
+    __m128i result = _mm_and_si128(_mm_packus_epi16(lo, hi), v->dst_keep);
+
+    if (pixel_alpha) {
+        /* Leave transparent pixels untouched, as the generic blitter does */
+        result = _mm_blendv_epi8(result, dst, _mm_cmpeq_epi32(_mm_and_si128(src, v->src_amask), zero));
+    }
+    return result;
+}
+
+/* 8888->8888 blending between any channel orders, four pixels at a time */
+static SDL_INLINE void SDL_TARGETING("sse4.1")
+Blit8888to8888AlphaSSE41(SDL_BlitInfo * info, SDL_bool pixel_alpha)
+{
+    int width = info->dst_w;
+    int height = info->dst_h;
+    Uint8 *src = info->src;
+    int srcskip = info->src_skip;
+    Uint8 *dst = info->dst;
+    int dstskip = info->dst_skip;
+    SDL_Blend8888Masks masks;
+    SDL_Blend8888_SSE41 v;
+
+    if (!pixel_alpha && !info->a) {
+        return;
+    }
+
+    GetBlend8888Masks(info->src_fmt, info->dst_fmt, &masks);
+    v.swizzle = _mm_loadu_si128((const __m128i *) masks.swizzle);
+    v.alpha_lo = _mm_loadu_si128((const __m128i *) masks.alpha_lo);
+    v.alpha_hi = _mm_loadu_si128((const __m128i *) masks.alpha_hi);
+    v.alpha_lanes = _mm_loadu_si128((const __m128i *) masks.alpha_lanes);
+    v.src_amask = _mm_set1_epi32((int) masks.src_amask);
+    v.dst_keep = _mm_set1_epi32((int) masks.dst_keep);
+    v.surface_alpha = _mm_set1_epi16(info->a);
+
+    while (height--) {
+        int n;
+        for (n = width; n >= 4; n -= 4) {
+            const __m128i s = _mm_loadu_si128((const __m128i *) src);
+            const __m128i d = _mm_loadu_si128((const __m128i *) dst);
+            _mm_storeu_si128((__m128i *) dst, BlendPixels_SSE41(s, d, &v, pixel_alpha));
+            src += 16;
+            dst += 16;
+        }
+        if (n) {
+            /* Go through a buffer rather than touch memory past the row */
+            Uint32 buf[8];
+            __m128i d;
+            SDL_zero(buf);
+            SDL_memcpy(buf, src, n * 4);
+            SDL_memcpy(buf + 4, dst, n * 4);
+            d = _mm_loadu_si128((const __m128i *) (buf + 4));
+            d = BlendPixels_SSE41(_mm_loadu_si128((const __m128i *) buf), d, &v, pixel_alpha);
+            _mm_storeu_si128((__m128i *) (buf + 4), d);
+            SDL_memcpy(dst, buf + 4, n * 4);
+            src += n * 4;
+            dst += n * 4;
+        }
+        src += srcskip;
+        dst += dstskip;
+    }
+}
+
+static void SDL_TARGETING("sse4.1")
+BlitRGBtoRGBPixelAlphaSSE41(SDL_BlitInfo * info)
+{
+    Blit8888to8888AlphaSSE41(info, SDL_TRUE);
+}
+
+static void SDL_TARGETING("sse4.1")
+BlitRGBtoRGBSurfaceAlphaSSE41(SDL_BlitInfo * info)
+{
+    if (UseSurfaceAlpha128(info)) {
+        BlitSurfaceAlpha128(info);
+    } else {
+        Blit8888to8888AlphaSSE41(info, SDL_FALSE);
+    }
+}
+#endif /* HAVE_SSE41_INTRINSICS */
+
+#if HAVE_AVX2_INTRINSICS
+typedef struct
+{
+    __m256i swizzle;
+    __m256i alpha_lo;
+    __m256i alpha_hi;
+    __m256i alpha_lanes;
+    __m256i src_amask;
+    __m256i dst_keep;
+    __m256i surface_alpha;
+} SDL_Blend8888_AVX2;
+
+/* Same as BlendChannels_SSE41() */
+static SDL_INLINE __m256i SDL_TARGETING("avx2")
+BlendChannels_AVX2(__m256i s, __m256i d, __m256i a, __m256i alpha_lanes)
+{
+    const __m256i negative = _mm256_cmpgt_epi16(d, s);
+    __m256i x = _mm256_mullo_epi16(_mm256_sub_epi16(_mm256_max_epu16(s, d), _mm256_min_epu16(s, d)), a);
+    x = _mm256_srli_epi16(_mm256_add_epi16(x, _mm256_add_epi16(_mm256_srli_epi16(x, 8), _mm256_set1_epi16(1))), 8);
+    x = _mm256_sub_epi16(_mm256_xor_si256(x, negative), negative);
+    return _mm256_add_epi16(_mm256_add_epi16(d, x), _mm256_and_si256(a, alpha_lanes));
+}
+
+static SDL_INLINE __m256i SDL_TARGETING("avx2")
+BlendPixels_AVX2(__m256i src, __m256i dst, const SDL_Blend8888_AVX2 * v,
+                 SDL_bool pixel_alpha)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i s = _mm256_shuffle_epi8(src, v->swizzle);
+    const __m256i alpha_lo = pixel_alpha ? _mm256_shuffle_epi8(src, v->alpha_lo) : v->surface_alpha;
+    const __m256i alpha_hi = pixel_alpha ? _mm256_shuffle_epi8(src, v->alpha_hi) : v->surface_alpha;
+    const __m256i lo = BlendChannels_AVX2(_mm256_unpacklo_epi8(s, zero), _mm256_unpacklo_epi8(dst, zero), alpha_lo, v->alpha_lanes);
+    const __m256i hi = BlendChannels_AVX2(_mm256_unpackhi_epi8(s, zero), _mm256_unpackhi_epi8(dst, zero), alpha_hi, v->alpha_lanes);
+    __m256i result = _mm256_and_si256(_mm256_packus_epi16(lo, hi), v->dst_keep);
+
+    if (pixel_alpha) {
+        result = _mm256_blendv_epi8(result, dst, _mm256_cmpeq_epi32(_mm256_and_si256(src, v->src_amask), zero));
+    }
+    return result;
+}
+
+/* 8888->8888 blending between any channel orders, eight pixels at a time */
+static SDL_INLINE void SDL_TARGETING("avx2")
+Blit8888to8888AlphaAVX2(SDL_BlitInfo * info, SDL_bool pixel_alpha)
+{
+    int width = info->dst_w;
+    int height = info->dst_h;
+    Uint8 *src = info->src;
+    int srcskip = info->src_skip;
+    Uint8 *dst = info->dst;
+    int dstskip = info->dst_skip;
+    SDL_Blend8888Masks masks;
+    SDL_Blend8888_AVX2 v;
+
+    if (!pixel_alpha && !info->a) {
+        return;
+    }
+
+    /* The byte shuffles and unpacks work within 128-bit lanes, so both
+       lanes use the same masks. */
+    GetBlend8888Masks(info->src_fmt, info->dst_fmt, &masks);
+    v.swizzle = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *) masks.swizzle));
+    v.alpha_lo = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *) masks.alpha_lo));
+    v.alpha_hi = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *) masks.alpha_hi));
+    v.alpha_lanes = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *) masks.alpha_lanes));
+    v.src_amask = _mm256_set1_epi32((int) masks.src_amask);
+    v.dst_keep = _mm256_set1_epi32((int) masks.dst_keep);
+    v.surface_alpha = _mm256_set1_epi16(info->a);
+
+    while (height--) {
+        int n;
+        for (n = width; n >= 8; n -= 8) {
+            const __m256i s = _mm256_loadu_si256((const __m256i *) src);
+            const __m256i d = _mm256_loadu_si256((const __m256i *) dst);
+            _mm256_storeu_si256((__m256i *) dst, BlendPixels_AVX2(s, d, &v, pixel_alpha));
+            src += 32;
+            dst += 32;
+        }
+        if (n) {
+            Uint32 buf[16];
+            __m256i d;
+            SDL_zero(buf);
+            SDL_memcpy(buf, src, n * 4);
+            SDL_memcpy(buf + 8, dst, n * 4);
+            d = _mm256_loadu_si256((const __m256i *) (buf + 8));
+            d = BlendPixels_AVX2(_mm256_loadu_si256((const __m256i *) buf), d, &v, pixel_alpha);
+            _mm256_storeu_si256((__m256i *) (buf + 8), d);
+            SDL_memcpy(dst, buf + 8, n * 4);
+            src += n * 4;
+            dst += n * 4;
+        }
+        src += srcskip;
+        dst += dstskip;
+    }
+}
+
+static void SDL_TARGETING("avx2")
+BlitRGBtoRGBPixelAlphaAVX2(SDL_BlitInfo * info)
+{
+    Blit8888to8888AlphaAVX2(info, SDL_TRUE);
+}
+
+static void SDL_TARGETING("avx2")
+BlitRGBtoRGBSurfaceAlphaAVX2(SDL_BlitInfo * info)
+{
+    if (UseSurfaceAlpha128(info)) {
+        BlitSurfaceAlpha128(info);
+    } else {
+        Blit8888to8888AlphaAVX2(info, SDL_FALSE);
+    }
+}
+#endif /* HAVE_AVX2_INTRINSICS */
+
 /* fast RGB888->(A)RGB888 blending with surface alpha=128 special case */
 static void
 BlitRGBtoRGBSurfaceAlpha128(SDL_BlitInfo * info)
@@ -1378,6 +1715,19 @@ SDL_CalculateBlitA(SDL_Surface * surface)
             return BlitNtoNPixelAlpha;
 
         case 4:
+#if HAVE_SSE41_INTRINSICS || HAVE_AVX2_INTRINSICS
+            if (sf->Amask && IsByteAligned8888(sf) && IsByteAligned8888(df)) {
+                const Uint32 features = SDL_GetBlitCPUFeatures();
+#if HAVE_AVX2_INTRINSICS
+                if (features & SDL_CPU_AVX2)
+                    return BlitRGBtoRGBPixelAlphaAVX2;
+#endif
+#if HAVE_SSE41_INTRINSICS
+                if (features & SDL_CPU_SSE41)
+                    return BlitRGBtoRGBPixelAlphaSSE41;
+#endif
+            }
+#endif /* HAVE_SSE41_INTRINSICS || HAVE_AVX2_INTRINSICS */
             if (sf->Rmask == df->Rmask
                 && sf->Gmask == df->Gmask
                 && sf->Bmask == df->Bmask && sf->BytesPerPixel == 4) {
@@ -1449,6 +1799,19 @@ SDL_CalculateBlitA(SDL_Surface * surface)
                 return BlitNtoNSurfaceAlpha;
 
             case 4:
+#if HAVE_SSE41_INTRINSICS || HAVE_AVX2_INTRINSICS
+                if (IsByteAligned8888(sf) && IsByteAligned8888(df)) {
+                    const Uint32 features = SDL_GetBlitCPUFeatures();
+#if HAVE_AVX2_INTRINSICS
+                    if (features & SDL_CPU_AVX2)
+                        return BlitRGBtoRGBSurfaceAlphaAVX2;
+#endif
+#if HAVE_SSE41_INTRINSICS
+                    if (features & SDL_CPU_SSE41)
+                        return BlitRGBtoRGBSurfaceAlphaSSE41;
+#endif
+                }
+#endif /* HAVE_SSE41_INTRINSICS || HAVE_AVX2_INTRINSICS */
                 if (sf->Rmask == df->Rmask
                     && sf->Gmask == df->Gmask
                     && sf->Bmask == df->Bmask && sf->BytesPerPixel == 4) {
@@ -23,6 +23,7 @@
 /* General (mostly internal) pixel/color manipulation routines for SDL */
 
 #include "SDL_endian.h"
+#include "SDL_atomic.h"
 #include "SDL_video.h"
 #include "SDL_sysvideo.h"
 #include "SDL_blit.h"
@@ -642,6 +643,23 @@ SDL_FreeFormat(SDL_PixelFormat *format)
     SDL_free(format);
 }
 
+/* Palette versions are unique across all palettes, so a version number
+   stands for one set of colors and can be used to look up blit tables. */
+static SDL_atomic_t SDL_palette_version;
+
+static Uint32
+SDL_NextPaletteVersion(void)
+{
+    Uint32 version;
+
+    do {
+        version = (Uint32) SDL_AtomicAdd(&SDL_palette_version, 1) + 1;
+    } while (version == 0);  /* zero means no palette */
+    return version;
+}
+
+static void SDL_FreeBlitTablesForPalette(const SDL_Palette * palette);
+
 SDL_Palette *
 SDL_AllocPalette(int ncolors)
 {
@@ -665,7 +683,7 @@ SDL_AllocPalette(int ncolors)
         return NULL;
     }
     palette->ncolors = ncolors;
-    palette->version = 1;
+    palette->version = SDL_NextPaletteVersion();
     palette->refcount = 1;
 
     SDL_memset(palette->colors, 0xFF, ncolors * sizeof(*palette->colors));
@@ -720,10 +738,7 @@ SDL_SetPaletteColors(SDL_Palette * palette, const SDL_Color * colors,
         SDL_memcpy(palette->colors + firstcolor, colors,
                    ncolors * sizeof(*colors));
     }
-    ++palette->version;
-    if (!palette->version) {
-        palette->version = 1;
-    }
+    palette->version = SDL_NextPaletteVersion();
 
     return status;
 }
@@ -738,6 +753,7 @@ SDL_FreePalette(SDL_Palette * palette)
     if (--palette->refcount > 0) {
         return;
     }
+    SDL_FreeBlitTablesForPalette(palette);
     SDL_free(palette->colors);
     SDL_free(palette);
 }
@@ -878,10 +894,159 @@ SDL_GetRGBA(Uint32 pixel, const SDL_PixelFormat * format,
     }
 }
 
+/* Blit tables are shared between blit maps...
+
+   Making a lookup table means searching the destination palette for every
+   source color, and a surface that is blitted onto many different surfaces
+   would otherwise do that each time it's remapped. Tables are reference
+   counted, and the most recent ones are kept in a small hash table, keyed
+   on what they were made from. Since palette versions are never reused, a
+   palette that's changed or freed can't match an old table. */
+
+#define BLIT_TABLE_CACHE_BITS 6
+#define BLIT_TABLE_CACHE_SIZE (1 << BLIT_TABLE_CACHE_BITS)
+
+typedef struct
+{
+    const SDL_Palette *src;     /* NULL for the dither palette */
+    Uint32 src_version;
+    const SDL_Palette *dst;     /* NULL when mapping to a pixel format */
+    Uint32 dst_version;
+    Uint32 dst_format;
+    Uint8 r, g, b, a;
+} SDL_BlitTableKey;
+
+typedef struct
+{
+    SDL_BlitTableKey key;
+    Uint32 hash;
+    int refcount;
+} SDL_BlitTable;
+
+/* The table itself follows the header, aligned for 32-bit entries */
+#define BLIT_TABLE_HEADER ((sizeof (SDL_BlitTable) + 15) & ~15)
+#define BLIT_TABLE(data) ((SDL_BlitTable *) ((Uint8 *) (data) - BLIT_TABLE_HEADER))
+
+static SDL_BlitTable *SDL_blit_tables[BLIT_TABLE_CACHE_SIZE];
+static SDL_SpinLock SDL_blit_tables_lock;
+
+static Uint32
+HashBlitTableKey(const SDL_BlitTableKey * key)
+{
+    const Uint8 *bytes = (const Uint8 *) key;
+    Uint32 hash = 2166136261u;
+    size_t i;
+
+    for (i = 0; i < sizeof (*key); ++i) {
+        hash = (hash ^ bytes[i]) * 16777619u;
+    }
+    return hash;
+}
+
+static Uint8 *
+AllocBlitTable(size_t len)
+{
+    SDL_BlitTable *table = (SDL_BlitTable *) SDL_calloc(1, BLIT_TABLE_HEADER + len);
+
+    if (table == NULL) {
+        SDL_OutOfMemory();
+        return (NULL);
+    }
+    table->refcount = 1;
+    return ((Uint8 *) table + BLIT_TABLE_HEADER);
+}
+
+/* Must be called with the lock held */
+static void
+ReleaseBlitTable(SDL_BlitTable * table)
+{
+    if (--table->refcount == 0) {
+        SDL_free(table);
+    }
+}
+
+static void
+FreeBlitTable(Uint8 * data)
+{
+    if (data) {
+        SDL_AtomicLock(&SDL_blit_tables_lock);
+        ReleaseBlitTable(BLIT_TABLE(data));
+        SDL_AtomicUnlock(&SDL_blit_tables_lock);
+    }
+}
+
+static Uint8 *
+LookupBlitTable(const SDL_BlitTableKey * key, Uint32 hash)
+{
+    SDL_BlitTable *table;
+    Uint8 *data = NULL;
+
+    SDL_AtomicLock(&SDL_blit_tables_lock);
+    table = SDL_blit_tables[hash & (BLIT_TABLE_CACHE_SIZE - 1)];
+    if (table && table->hash == hash &&
+        SDL_memcmp(&table->key, key, sizeof (*key)) == 0) {
+        ++table->refcount;
+        data = (Uint8 *) table + BLIT_TABLE_HEADER;
+    }
+    SDL_AtomicUnlock(&SDL_blit_tables_lock);
+    return data;
+}
+
+static void
+CacheBlitTable(const SDL_BlitTableKey * key, Uint32 hash, Uint8 * data)
+{
+    SDL_BlitTable *table = BLIT_TABLE(data);
+    SDL_BlitTable **slot = &SDL_blit_tables[hash & (BLIT_TABLE_CACHE_SIZE - 1)];
+
+    table->key = *key;
+    table->hash = hash;
+
+    SDL_AtomicLock(&SDL_blit_tables_lock);
+    if (*slot) {
+        ReleaseBlitTable(*slot);
+    }
+    ++table->refcount;
+    *slot = table;
+    SDL_AtomicUnlock(&SDL_blit_tables_lock);
+}
+
+static void
+SDL_FreeBlitTablesForPalette(const SDL_Palette * palette)
+{
+    int i;
+
+    SDL_AtomicLock(&SDL_blit_tables_lock);
+    for (i = 0; i < BLIT_TABLE_CACHE_SIZE; ++i) {
+        SDL_BlitTable *table = SDL_blit_tables[i];
+        if (table && (table->key.src == palette || table->key.dst == palette)) {
+            ReleaseBlitTable(table);
+            SDL_blit_tables[i] = NULL;
+        }
+    }
+    SDL_AtomicUnlock(&SDL_blit_tables_lock);
+}
+
+void
+SDL_QuitBlitTables(void)
+{
+    int i;
+
+    SDL_AtomicLock(&SDL_blit_tables_lock);
+    for (i = 0; i < BLIT_TABLE_CACHE_SIZE; ++i) {
+        if (SDL_blit_tables[i]) {
+            ReleaseBlitTable(SDL_blit_tables[i]);
+            SDL_blit_tables[i] = NULL;
+        }
+    }
+    SDL_AtomicUnlock(&SDL_blit_tables_lock);
+}
+
 /* Map from Palette to Palette */
 static Uint8 *
 Map1to1(SDL_Palette * src, SDL_Palette * dst, int *identical)
 {
+    SDL_BlitTableKey key;
+    Uint32 hash;
     Uint8 *map;
     int i;
 
@@ -899,9 +1064,20 @@ Map1to1(SDL_Palette * src, SDL_Palette * dst, int *identical)
         }
         *identical = 0;
     }
-    map = (Uint8 *) SDL_malloc(src->ncolors);
+
+    SDL_zero(key);
+    key.src = src->version ? src : NULL;
+    key.src_version = src->version;
+    key.dst = dst;
+    key.dst_version = dst->version;
+    hash = HashBlitTableKey(&key);
+    map = LookupBlitTable(&key, hash);
+    if (map) {
+        return (map);
+    }
+
+    map = AllocBlitTable(src->ncolors);
     if (map == NULL) {
-        SDL_OutOfMemory();
         return (NULL);
     }
     for (i = 0; i < src->ncolors; ++i) {
@@ -909,6 +1085,7 @@ Map1to1(SDL_Palette * src, SDL_Palette * dst, int *identical)
                                src->colors[i].r, src->colors[i].g,
                                src->colors[i].b, src->colors[i].a);
     }
+    CacheBlitTable(&key, hash, map);
     return (map);
 }
 
@@ -917,15 +1094,33 @@ static Uint8 *
 Map1toN(SDL_PixelFormat * src, Uint8 Rmod, Uint8 Gmod, Uint8 Bmod, Uint8 Amod,
         SDL_PixelFormat * dst)
 {
+    SDL_BlitTableKey key;
+    Uint32 hash = 0;
     Uint8 *map;
     int i;
     int bpp;
     SDL_Palette *pal = src->palette;
 
+    /* Formats without an enum value can't be told apart */
+    SDL_zero(key);
+    if (dst->format != SDL_PIXELFORMAT_UNKNOWN) {
+        key.src = pal;
+        key.src_version = pal->version;
+        key.dst_format = dst->format;
+        key.r = Rmod;
+        key.g = Gmod;
+        key.b = Bmod;
+        key.a = Amod;
+        hash = HashBlitTableKey(&key);
+        map = LookupBlitTable(&key, hash);
+        if (map) {
+            return (map);
+        }
+    }
+
     bpp = ((dst->BytesPerPixel == 3) ? 4 : dst->BytesPerPixel);
-    map = (Uint8 *) SDL_malloc(pal->ncolors * bpp);
+    map = AllocBlitTable(pal->ncolors * bpp);
     if (map == NULL) {
-        SDL_OutOfMemory();
         return (NULL);
     }
 
@@ -937,6 +1132,9 @@ Map1toN(SDL_PixelFormat * src, Uint8 Rmod, Uint8 Gmod, Uint8 Bmod, Uint8 Amod,
         Uint8 A = (Uint8) ((pal->colors[i].a * Amod) / 255);
         ASSEMBLE_RGBA(&map[i * bpp], dst->BytesPerPixel, dst, R, G, B, A);
     }
+    if (key.src) {
+        CacheBlitTable(&key, hash, map);
+    }
     return (map);
 }
 
@@ -952,6 +1150,7 @@ MapNto1(SDL_PixelFormat * src, SDL_PixelFormat * dst, int *identical)
     dithered.ncolors = 256;
     SDL_DitherColors(colors, 8);
     dithered.colors = colors;
+    dithered.version = 0;
     return (Map1to1(&dithered, pal, identical));
 }
 
@@ -990,7 +1189,7 @@ SDL_InvalidateMap(SDL_BlitMap * map)
     map->dst = NULL;
     map->src_palette_version = 0;
     map->dst_palette_version = 0;
-    SDL_free(map->info.table);
+    FreeBlitTable(map->info.table);
     map->info.table = NULL;
 }
 
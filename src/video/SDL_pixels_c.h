@@ -27,6 +27,7 @@
 /* Useful functions and variables from SDL_pixel.c */
 
 #include "SDL_blit.h"
+#include "SDL_render.h"
 
 /* Pixel format functions */
 extern int SDL_InitFormat(SDL_PixelFormat * format, Uint32 pixel_format);
@@ -36,6 +37,13 @@ extern SDL_BlitMap *SDL_AllocBlitMap(void);
 extern void SDL_InvalidateMap(SDL_BlitMap * map);
 extern int SDL_MapSurface(SDL_Surface * src, SDL_Surface * dst);
 extern void SDL_FreeBlitMap(SDL_BlitMap * map);
+extern void SDL_QuitBlitTables(void);
+
+/* Scaled blits with a texture scale mode, for the software renderer */
+extern int SDL_PrivateUpperBlitScaled(SDL_Surface * src, const SDL_Rect * srcrect,
+                                      SDL_Surface * dst, SDL_Rect * dstrect, SDL_ScaleMode scaleMode);
+extern int SDL_PrivateLowerBlitScaled(SDL_Surface * src, SDL_Rect * srcrect,
+                                      SDL_Surface * dst, SDL_Rect * dstrect, SDL_ScaleMode scaleMode);
 
 /* Miscellaneous functions */
 extern void SDL_DitherColors(SDL_Color * colors, int bpp);
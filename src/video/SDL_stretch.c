@@ -29,125 +29,14 @@
 #include "SDL_video.h"
 #include "SDL_blit.h"
 
-/* This isn't ready for general consumption yet - it should be folded
-   into the general blitting mechanism.
-*/
-
-#if ((defined(_MSC_VER) && defined(_M_IX86))    || \
-     (defined(__WATCOMC__) && defined(__386__)) || \
-     (defined(__GNUC__) && defined(__i386__))) && SDL_ASSEMBLY_ROUTINES
-/* There's a bug with gcc 4.4.1 and -O2 where srcp doesn't get the correct
- * value after the first scanline.  FIXME? */
-/* #define USE_ASM_STRETCH */
-#endif
-
-#ifdef USE_ASM_STRETCH
-
-#ifdef HAVE_MPROTECT
-#include <sys/types.h>
-#include <sys/mman.h>
-#endif
-#ifdef __GNUC__
-#define PAGE_ALIGNED __attribute__((__aligned__(4096)))
-#else
-#define PAGE_ALIGNED
+#ifdef __SSE2__
+#define HAVE_SSE2_INTRINSICS 1
 #endif
 
-#if defined(_M_IX86) || defined(__i386__) || defined(__386__)
-#define PREFIX16    0x66
-#define STORE_BYTE  0xAA
-#define STORE_WORD  0xAB
-#define LOAD_BYTE   0xAC
-#define LOAD_WORD   0xAD
-#define RETURN      0xC3
-#else
-#error Need assembly opcodes for this architecture
+#ifdef __ARM_NEON
+#define HAVE_NEON_INTRINSICS 1
 #endif
 
-static unsigned char copy_row[4096] PAGE_ALIGNED;
-
-static int
-generate_rowbytes(int src_w, int dst_w, int bpp)
-{
-    static struct
-    {
-        int bpp;
-        int src_w;
-        int dst_w;
-        int status;
-    } last;
-
-    int i;
-    int pos, inc;
-    unsigned char *eip, *fence;
-    unsigned char load, store;
-
-    /* See if we need to regenerate the copy buffer */
-    if ((src_w == last.src_w) && (dst_w == last.dst_w) && (bpp == last.bpp)) {
-        return (last.status);
-    }
-    last.bpp = bpp;
-    last.src_w = src_w;
-    last.dst_w = dst_w;
-    last.status = -1;
-
-    switch (bpp) {
-    case 1:
-        load = LOAD_BYTE;
-        store = STORE_BYTE;
-        break;
-    case 2:
-    case 4:
-        load = LOAD_WORD;
-        store = STORE_WORD;
-        break;
-    default:
-        return SDL_SetError("ASM stretch of %d bytes isn't supported", bpp);
-    }
-#ifdef HAVE_MPROTECT
-    /* Make the code writeable */
-    if (mprotect(copy_row, sizeof(copy_row), PROT_READ | PROT_WRITE) < 0) {
-        return SDL_SetError("Couldn't make copy buffer writeable");
-    }
-#endif
-    pos = 0x10000;
-    inc = (src_w << 16) / dst_w;
-    eip = copy_row;
-    fence = copy_row + sizeof(copy_row)-2;
-    for (i = 0; i < dst_w; ++i) {
-        while (pos >= 0x10000L) {
-            if (eip == fence) {
-                return -1;
-            }
-            if (bpp == 2) {
-                *eip++ = PREFIX16;
-            }
-            *eip++ = load;
-            pos -= 0x10000L;
-        }
-        if (eip == fence) {
-            return -1;
-        }
-        if (bpp == 2) {
-            *eip++ = PREFIX16;
-        }
-        *eip++ = store;
-        pos += inc;
-    }
-    *eip++ = RETURN;
-
-#ifdef HAVE_MPROTECT
-    /* Make the code executable but not writeable */
-    if (mprotect(copy_row, sizeof(copy_row), PROT_READ | PROT_EXEC) < 0) {
-        return SDL_SetError("Couldn't make copy buffer executable");
-    }
-#endif
-    last.status = 0;
-    return (0);
-}
-
-#endif /* USE_ASM_STRETCH */
-
 #define DEFINE_COPY_ROW(name, type)         \
 static void name(type *src, int src_w, type *dst, int dst_w)    \
 {                                           \
@@ -172,7 +61,6 @@ DEFINE_COPY_ROW(copy_row2, Uint16)
 DEFINE_COPY_ROW(copy_row4, Uint32)
 /* *INDENT-ON* */
 
-/* The ASM code doesn't handle 24-bpp stretch blits */
 static void
 copy_row3(Uint8 * src, int src_w, Uint8 * dst, int dst_w)
 {
@@ -196,80 +84,95 @@ copy_row3(Uint8 * src, int src_w, Uint8 * dst, int dst_w)
     }
 }
 
-/* Perform a stretch blit between two surfaces of the same format.
-   NOTE:  This function is not safe to call from multiple threads!
-*/
-int
-SDL_SoftStretch(SDL_Surface * src, const SDL_Rect * srcrect,
-                SDL_Surface * dst, const SDL_Rect * dstrect)
-{
-    int src_locked;
-    int dst_locked;
-    int pos, inc;
-    int dst_maxrow;
-    int src_row, dst_row;
-    Uint8 *srcp = NULL;
-    Uint8 *dstp;
-    SDL_Rect full_src;
-    SDL_Rect full_dst;
-#ifdef USE_ASM_STRETCH
-    SDL_bool use_asm = SDL_TRUE;
-#ifdef __GNUC__
-    int u1, u2;
-#endif
-#endif /* USE_ASM_STRETCH */
-    const int bpp = dst->format->BytesPerPixel;
-
-    if (src->format->format != dst->format->format) {
-        return SDL_SetError("Only works with same format surfaces");
-    }
 
-    /* Verify the blit rectangles */
-    if (srcrect) {
-        if ((srcrect->x < 0) || (srcrect->y < 0) ||
-            ((srcrect->x + srcrect->w) > src->w) ||
-            ((srcrect->y + srcrect->h) > src->h)) {
+/* Check the blit rectangles, defaulting to the whole surfaces */
+static int
+CheckStretchRects(SDL_Surface * src, const SDL_Rect ** srcrect, SDL_Rect * full_src,
+                  SDL_Surface * dst, const SDL_Rect ** dstrect, SDL_Rect * full_dst)
+{
+    if (*srcrect) {
+        if (((*srcrect)->x < 0) || ((*srcrect)->y < 0) ||
+            (((*srcrect)->x + (*srcrect)->w) > src->w) ||
+            (((*srcrect)->y + (*srcrect)->h) > src->h)) {
             return SDL_SetError("Invalid source blit rectangle");
         }
     } else {
-        full_src.x = 0;
-        full_src.y = 0;
-        full_src.w = src->w;
-        full_src.h = src->h;
-        srcrect = &full_src;
+        full_src->x = 0;
+        full_src->y = 0;
+        full_src->w = src->w;
+        full_src->h = src->h;
+        *srcrect = full_src;
     }
-    if (dstrect) {
-        if ((dstrect->x < 0) || (dstrect->y < 0) ||
-            ((dstrect->x + dstrect->w) > dst->w) ||
-            ((dstrect->y + dstrect->h) > dst->h)) {
+    if (*dstrect) {
+        if (((*dstrect)->x < 0) || ((*dstrect)->y < 0) ||
+            (((*dstrect)->x + (*dstrect)->w) > dst->w) ||
+            (((*dstrect)->y + (*dstrect)->h) > dst->h)) {
             return SDL_SetError("Invalid destination blit rectangle");
         }
     } else {
-        full_dst.x = 0;
-        full_dst.y = 0;
-        full_dst.w = dst->w;
-        full_dst.h = dst->h;
-        dstrect = &full_dst;
+        full_dst->x = 0;
+        full_dst->y = 0;
+        full_dst->w = dst->w;
+        full_dst->h = dst->h;
+        *dstrect = full_dst;
     }
+    return 0;
+}
 
-    /* Lock the destination if it's in hardware */
-    dst_locked = 0;
+/* Lock the surfaces if they're in hardware */
+static int
+LockStretchSurfaces(SDL_Surface * src, SDL_Surface * dst)
+{
     if (SDL_MUSTLOCK(dst)) {
         if (SDL_LockSurface(dst) < 0) {
             return SDL_SetError("Unable to lock destination surface");
         }
-        dst_locked = 1;
     }
-    /* Lock the source if it's in hardware */
-    src_locked = 0;
     if (SDL_MUSTLOCK(src)) {
         if (SDL_LockSurface(src) < 0) {
-            if (dst_locked) {
+            if (SDL_MUSTLOCK(dst)) {
                 SDL_UnlockSurface(dst);
             }
             return SDL_SetError("Unable to lock source surface");
         }
-        src_locked = 1;
+    }
+    return 0;
+}
+
+static void
+UnlockStretchSurfaces(SDL_Surface * src, SDL_Surface * dst)
+{
+    if (SDL_MUSTLOCK(dst)) {
+        SDL_UnlockSurface(dst);
+    }
+    if (SDL_MUSTLOCK(src)) {
+        SDL_UnlockSurface(src);
+    }
+}
+
+/* Perform a nearest neighbour stretch blit between two surfaces of the
+   same format. */
+int
+SDL_SoftStretch(SDL_Surface * src, const SDL_Rect * srcrect,
+                SDL_Surface * dst, const SDL_Rect * dstrect)
+{
+    int pos, inc;
+    int dst_maxrow;
+    int src_row, dst_row;
+    Uint8 *srcp = NULL;
+    Uint8 *dstp;
+    SDL_Rect full_src;
+    SDL_Rect full_dst;
+    const int bpp = dst->format->BytesPerPixel;
+
+    if (src->format->format != dst->format->format) {
+        return SDL_SetError("Only works with same format surfaces");
+    }
+    if (CheckStretchRects(src, &srcrect, &full_src, dst, &dstrect, &full_dst) < 0) {
+        return -1;
+    }
+    if (LockStretchSurfaces(src, dst) < 0) {
+        return -1;
     }
 
     /* Set up the data... */
@@ -278,13 +181,6 @@ SDL_SoftStretch(SDL_Surface * src, const SDL_Rect * srcrect,
     src_row = srcrect->y;
     dst_row = dstrect->y;
 
-#ifdef USE_ASM_STRETCH
-    /* Write the opcodes for this stretch */
-    if ((bpp == 3) || (generate_rowbytes(srcrect->w, dstrect->w, bpp) < 0)) {
-        use_asm = SDL_FALSE;
-    }
-#endif
-
     /* Perform the stretch blit */
     for (dst_maxrow = dst_row + dstrect->h; dst_row < dst_maxrow; ++dst_row) {
         dstp = (Uint8 *) dst->pixels + (dst_row * dst->pitch)
@@ -295,59 +191,323 @@ SDL_SoftStretch(SDL_Surface * src, const SDL_Rect * srcrect,
             ++src_row;
             pos -= 0x10000L;
         }
-#ifdef USE_ASM_STRETCH
-        if (use_asm) {
-#ifdef __GNUC__
-            __asm__ __volatile__("call *%4":"=&D"(u1), "=&S"(u2)
-                                 :"0"(dstp), "1"(srcp), "r"(copy_row)
-                                 :"memory");
-#elif defined(_MSC_VER) || defined(__WATCOMC__)
-            /* *INDENT-OFF* */
-            {
-                void *code = copy_row;
-                __asm {
-                    push edi
-                    push esi
-                    mov edi, dstp
-                    mov esi, srcp
-                    call dword ptr code
-                    pop esi
-                    pop edi
+        switch (bpp) {
+        case 1:
+            copy_row1(srcp, srcrect->w, dstp, dstrect->w);
+            break;
+        case 2:
+            copy_row2((Uint16 *) srcp, srcrect->w,
+                      (Uint16 *) dstp, dstrect->w);
+            break;
+        case 3:
+            copy_row3(srcp, srcrect->w, dstp, dstrect->w);
+            break;
+        case 4:
+            copy_row4((Uint32 *) srcp, srcrect->w,
+                      (Uint32 *) dstp, dstrect->w);
+            break;
+        }
+        pos += inc;
+    }
+
+    UnlockStretchSurfaces(src, dst);
+    return (0);
+}
+
+/* Filtered stretching works in fixed point. The filter weights are 14-bit
+   fractions that sum to exactly one. The vertical pass keeps 7 fraction
+   bits per channel in 16 bits, and the horizontal pass rounds back to
+   8 bits. The SIMD versions do the same integer math as the C version, so
+   the results don't depend on the CPU. */
+#define STRETCH_WEIGHT_BITS 14
+#define STRETCH_WEIGHT_ONE  (1 << STRETCH_WEIGHT_BITS)
+#define STRETCH_ROW_BITS    7
+#define STRETCH_PIXEL_BITS  (STRETCH_WEIGHT_BITS + STRETCH_ROW_BITS)
+
+typedef struct
+{
+    int taps;           /* weights per output pixel, always even */
+    int *first;         /* first source pixel of each output pixel */
+    Sint16 *weights;    /* 'taps' weights per output pixel, zero padded */
+} SDL_StretchFilter;
+
+/* When enlarging, each output pixel is a bilinear mix of the two source
+   pixels nearest its center. When shrinking, it's the average of the
+   source pixels it covers, weighted by how much of each it covers. */
+static int
+InitStretchFilter(SDL_StretchFilter * filter, int src_size, int dst_size)
+{
+    const SDL_bool shrink = (dst_size < src_size);
+    int i;
+
+    filter->taps = shrink ? ((src_size + dst_size - 1) / dst_size + 1) : 2;
+    filter->taps += (filter->taps & 1);
+    filter->first = (int *) SDL_calloc(dst_size, sizeof (int) + filter->taps * sizeof (Sint16));
+    if (!filter->first) {
+        return SDL_OutOfMemory();
+    }
+    filter->weights = (Sint16 *) (filter->first + dst_size);
+
+    for (i = 0; i < dst_size; ++i) {
+        Sint16 *weights = filter->weights + i * filter->taps;
+
+        if (shrink) {
+            /* Output pixel i covers [i * src_size, (i + 1) * src_size) and
+               source pixel j covers [j * dst_size, (j + 1) * dst_size) */
+            const Sint64 start = (Sint64) i * src_size;
+            const Sint64 end = start + src_size;
+            const int first = (int) (start / dst_size);
+            const int last = (int) ((end - 1) / dst_size);
+            int j, total = 0, largest = 0;
+
+            for (j = first; j <= last; ++j) {
+                const Sint64 left = SDL_max(start, (Sint64) j * dst_size);
+                const Sint64 right = SDL_min(end, (Sint64) (j + 1) * dst_size);
+                weights[j - first] = (Sint16) (((right - left) * STRETCH_WEIGHT_ONE + src_size / 2) / src_size);
+                total += weights[j - first];
+                if (weights[j - first] > weights[largest]) {
+                    largest = j - first;
                 }
             }
-            /* *INDENT-ON* */
-#else
-#error Need inline assembly for this compiler
-#endif
-        } else
-#endif
-            switch (bpp) {
-            case 1:
-                copy_row1(srcp, srcrect->w, dstp, dstrect->w);
-                break;
-            case 2:
-                copy_row2((Uint16 *) srcp, srcrect->w,
-                          (Uint16 *) dstp, dstrect->w);
-                break;
-            case 3:
-                copy_row3(srcp, srcrect->w, dstp, dstrect->w);
-                break;
-            case 4:
-                copy_row4((Uint32 *) srcp, srcrect->w,
-                          (Uint32 *) dstp, dstrect->w);
-                break;
+            /* Put the rounding error where it matters least */
+            weights[largest] += (Sint16) (STRETCH_WEIGHT_ONE - total);
+            filter->first[i] = first;
+        } else {
+            /* The center of output pixel i, in source pixels */
+            const Sint64 center = (Sint64) (2 * i + 1) * src_size - dst_size;
+            const Sint64 pos = (center > 0) ? ((center << STRETCH_WEIGHT_BITS) / (2 * dst_size)) : 0;
+            const int first = (int) (pos >> STRETCH_WEIGHT_BITS);
+
+            if (first >= src_size - 1) {
+                filter->first[i] = src_size - 1;
+                weights[0] = STRETCH_WEIGHT_ONE;
+            } else {
+                const int frac = (int) (pos & (STRETCH_WEIGHT_ONE - 1));
+                filter->first[i] = first;
+                weights[0] = (Sint16) (STRETCH_WEIGHT_ONE - frac);
+                weights[1] = (Sint16) frac;
             }
-        pos += inc;
+        }
     }
+    return 0;
+}
 
-    /* We need to unlock the surfaces if they're locked */
-    if (dst_locked) {
-        SDL_UnlockSurface(dst);
+/* Filter 'taps' source rows into one row of 16-bit channels */
+typedef void (*SDL_StretchRowsFunc)(const Uint8 * const *rows, const Sint16 *weights, int taps, int width, Sint16 *out);
+
+/* Filter a row of 16-bit channels into 'width' 32-bit output pixels */
+typedef void (*SDL_StretchColumnsFunc)(const Sint16 *row, const SDL_StretchFilter *filter, int width, Uint8 *out);
+
+static SDL_INLINE void
+StretchRowsRange(const Uint8 * const *rows, const Sint16 * weights, int taps,
+                 int start, int end, Sint16 * out)
+{
+    int i, k;
+
+    for (i = start; i < end; ++i) {
+        int sum = 1 << (STRETCH_ROW_BITS - 1);
+        for (k = 0; k < taps; ++k) {
+            sum += weights[k] * rows[k][i];
+        }
+        out[i] = (Sint16) (sum >> STRETCH_ROW_BITS);
     }
-    if (src_locked) {
-        SDL_UnlockSurface(src);
+}
+
+static void
+SDL_StretchRows_Scalar(const Uint8 * const *rows, const Sint16 * weights, int taps, int width, Sint16 * out)
+{
+    StretchRowsRange(rows, weights, taps, 0, width, out);
+}
+
+static void
+SDL_StretchColumns_Scalar(const Sint16 * row, const SDL_StretchFilter * filter, int width, Uint8 * out)
+{
+    const int taps = filter->taps;
+    int i, k, c;
+
+    for (i = 0; i < width; ++i) {
+        const Sint16 *src = row + filter->first[i] * 4;
+        const Sint16 *weights = filter->weights + i * taps;
+        for (c = 0; c < 4; ++c) {
+            int sum = 1 << (STRETCH_PIXEL_BITS - 1);
+            for (k = 0; k < taps; ++k) {
+                sum += weights[k] * src[k * 4 + c];
+            }
+            *out++ = (Uint8) (sum >> STRETCH_PIXEL_BITS);
+        }
     }
-    return (0);
+}
+
+#if HAVE_SSE2_INTRINSICS
+static void
+SDL_StretchRows_SSE2(const Uint8 * const *rows, const Sint16 * weights, int taps, int width, Sint16 * out)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i round = _mm_set1_epi32(1 << (STRETCH_ROW_BITS - 1));
+    int i, k;
+
+    for (i = 0; i + 16 <= width; i += 16) {
+        __m128i sum0 = round, sum1 = round, sum2 = round, sum3 = round;
+        for (k = 0; k < taps; k += 2) {
+            /* Interleave two rows, so each madd applies a pair of weights */
+            const __m128i a = _mm_loadu_si128((const __m128i *) (rows[k] + i));
+            const __m128i b = _mm_loadu_si128((const __m128i *) (rows[k + 1] + i));
+            const __m128i w = _mm_set1_epi32((int) ((Uint16) weights[k] | ((Uint32) (Uint16) weights[k + 1] << 16)));
+            const __m128i lo = _mm_unpacklo_epi8(a, b);
+            const __m128i hi = _mm_unpackhi_epi8(a, b);
+            sum0 = _mm_add_epi32(sum0, _mm_madd_epi16(_mm_unpacklo_epi8(lo, zero), w));
+            sum1 = _mm_add_epi32(sum1, _mm_madd_epi16(_mm_unpackhi_epi8(lo, zero), w));
+            sum2 = _mm_add_epi32(sum2, _mm_madd_epi16(_mm_unpacklo_epi8(hi, zero), w));
+            sum3 = _mm_add_epi32(sum3, _mm_madd_epi16(_mm_unpackhi_epi8(hi, zero), w));
+        }
+        _mm_storeu_si128((__m128i *) (out + i), _mm_packs_epi32(_mm_srai_epi32(sum0, STRETCH_ROW_BITS), _mm_srai_epi32(sum1, STRETCH_ROW_BITS)));
+        _mm_storeu_si128((__m128i *) (out + i + 8), _mm_packs_epi32(_mm_srai_epi32(sum2, STRETCH_ROW_BITS), _mm_srai_epi32(sum3, STRETCH_ROW_BITS)));
+    }
+    StretchRowsRange(rows, weights, taps, i, width, out);
+}
+
+static void
+SDL_StretchColumns_SSE2(const Sint16 * row, const SDL_StretchFilter * filter, int width, Uint8 * out)
+{
+    const __m128i round = _mm_set1_epi32(1 << (STRETCH_PIXEL_BITS - 1));
+    const int taps = filter->taps;
+    int i, k;
+
+    for (i = 0; i < width; ++i) {
+        const Sint16 *src = row + filter->first[i] * 4;
+        const Sint16 *weights = filter->weights + i * taps;
+        __m128i sum = round;
+        for (k = 0; k < taps; k += 2) {
+            /* Two neighbouring pixels, interleaved by channel */
+            __m128i pixels = _mm_loadu_si128((const __m128i *) (src + k * 4));
+            const __m128i w = _mm_set1_epi32((int) ((Uint16) weights[k] | ((Uint32) (Uint16) weights[k + 1] << 16)));
+            pixels = _mm_unpacklo_epi16(pixels, _mm_unpackhi_epi64(pixels, pixels));
+            sum = _mm_add_epi32(sum, _mm_madd_epi16(pixels, w));
+        }
+        sum = _mm_srai_epi32(sum, STRETCH_PIXEL_BITS);
+        sum = _mm_packs_epi32(sum, sum);
+        *(Uint32 *) (out + i * 4) = (Uint32) _mm_cvtsi128_si32(_mm_packus_epi16(sum, sum));
+    }
+}
+#endif /* HAVE_SSE2_INTRINSICS */
+
+#if HAVE_NEON_INTRINSICS
+static void
+SDL_StretchRows_NEON(const Uint8 * const *rows, const Sint16 * weights, int taps, int width, Sint16 * out)
+{
+    int i, k;
+
+    for (i = 0; i + 8 <= width; i += 8) {
+        uint32x4_t sum0 = vdupq_n_u32(0);
+        uint32x4_t sum1 = vdupq_n_u32(0);
+        for (k = 0; k < taps; ++k) {
+            const uint16x8_t a = vmovl_u8(vld1_u8(rows[k] + i));
+            sum0 = vmlal_n_u16(sum0, vget_low_u16(a), (Uint16) weights[k]);
+            sum1 = vmlal_n_u16(sum1, vget_high_u16(a), (Uint16) weights[k]);
+        }
+        vst1q_s16(out + i, vreinterpretq_s16_u16(vcombine_u16(vrshrn_n_u32(sum0, STRETCH_ROW_BITS), vrshrn_n_u32(sum1, STRETCH_ROW_BITS))));
+    }
+    StretchRowsRange(rows, weights, taps, i, width, out);
+}
+
+static void
+SDL_StretchColumns_NEON(const Sint16 * row, const SDL_StretchFilter * filter, int width, Uint8 * out)
+{
+    const int taps = filter->taps;
+    int i, k;
+
+    for (i = 0; i < width; ++i) {
+        const Uint16 *src = (const Uint16 *) row + filter->first[i] * 4;
+        const Sint16 *weights = filter->weights + i * taps;
+        uint32x4_t sum = vdupq_n_u32(0);
+        uint16x4_t narrow;
+        for (k = 0; k < taps; ++k) {
+            sum = vmlal_n_u16(sum, vld1_u16(src + k * 4), (Uint16) weights[k]);
+        }
+        narrow = vmovn_u32(vrshrq_n_u32(sum, STRETCH_PIXEL_BITS));
+        vst1_lane_u32((uint32_t *) (out + i * 4), vreinterpret_u32_u8(vmovn_u16(vcombine_u16(narrow, narrow))), 0);
+    }
+}
+#endif /* HAVE_NEON_INTRINSICS */
+
+/* Perform a bilinear (enlarging) or area-averaging (shrinking) stretch blit
+   between two surfaces of the same 32-bit format. */
+int
+SDL_SoftStretchLinear(SDL_Surface * src, const SDL_Rect * srcrect,
+                      SDL_Surface * dst, const SDL_Rect * dstrect)
+{
+    SDL_StretchRowsFunc StretchRows = SDL_StretchRows_Scalar;
+    SDL_StretchColumnsFunc StretchColumns = SDL_StretchColumns_Scalar;
+    SDL_StretchFilter filter_x, filter_y;
+    SDL_Rect full_src;
+    SDL_Rect full_dst;
+    const Uint8 **rows;
+    Sint16 *row;
+    int y, k;
+
+    if (src->format->format != dst->format->format) {
+        return SDL_SetError("Only works with same format surfaces");
+    }
+    if (src->format->BytesPerPixel != 4 ||
+        SDL_PIXELLAYOUT(src->format->format) != SDL_PACKEDLAYOUT_8888) {
+        return SDL_SetError("Only works with 32-bit surfaces with 8-bit channels");
+    }
+    if (CheckStretchRects(src, &srcrect, &full_src, dst, &dstrect, &full_dst) < 0) {
+        return -1;
+    }
+    if (srcrect->w <= 0 || srcrect->h <= 0 || dstrect->w <= 0 || dstrect->h <= 0) {
+        return 0;
+    }
+
+#if HAVE_SSE2_INTRINSICS
+    if (SDL_HasSSE2()) {
+        StretchRows = SDL_StretchRows_SSE2;
+        StretchColumns = SDL_StretchColumns_SSE2;
+    }
+#endif
+#if HAVE_NEON_INTRINSICS
+    if (SDL_HasNEON()) {
+        StretchRows = SDL_StretchRows_NEON;
+        StretchColumns = SDL_StretchColumns_NEON;
+    }
+#endif
+
+    if (InitStretchFilter(&filter_x, srcrect->w, dstrect->w) < 0) {
+        return -1;
+    }
+    if (InitStretchFilter(&filter_y, srcrect->h, dstrect->h) < 0) {
+        SDL_free(filter_x.first);
+        return -1;
+    }
+    /* The filtered row is padded with transparent black for the zero
+       weighted taps that run past its end. */
+    rows = (const Uint8 **) SDL_malloc(filter_y.taps * sizeof (*rows));
+    row = (Sint16 *) SDL_calloc(srcrect->w + filter_x.taps, 4 * sizeof (Sint16));
+    if (!rows || !row || LockStretchSurfaces(src, dst) < 0) {
+        SDL_free(row);
+        SDL_free((void *) rows);
+        SDL_free(filter_y.first);
+        SDL_free(filter_x.first);
+        return (!rows || !row) ? SDL_OutOfMemory() : -1;
+    }
+
+    for (y = 0; y < dstrect->h; ++y) {
+        const int first = filter_y.first[y];
+        for (k = 0; k < filter_y.taps; ++k) {
+            const int src_row = srcrect->y + SDL_min(first + k, srcrect->h - 1);
+            rows[k] = (const Uint8 *) src->pixels + src_row * src->pitch + srcrect->x * 4;
+        }
+        StretchRows(rows, filter_y.weights + y * filter_y.taps, filter_y.taps, srcrect->w * 4, row);
+        StretchColumns(row, &filter_x, dstrect->w,
+                       (Uint8 *) dst->pixels + (dstrect->y + y) * dst->pitch + dstrect->x * 4);
+    }
+
+    UnlockStretchSurfaces(src, dst);
+    SDL_free(row);
+    SDL_free((void *) rows);
+    SDL_free(filter_y.first);
+    SDL_free(filter_x.first);
+    return 0;
 }
 
 /* vi: set ts=4 sw=4 expandtab: */
@@ -723,6 +723,13 @@ SDL_UpperBlit(SDL_Surface * src, const SDL_Rect * srcrect,
 int
 SDL_UpperBlitScaled(SDL_Surface * src, const SDL_Rect * srcrect,
               SDL_Surface * dst, SDL_Rect * dstrect)
+{
+    return SDL_PrivateUpperBlitScaled(src, srcrect, dst, dstrect, SDL_ScaleModeNearest);
+}
+
+int
+SDL_PrivateUpperBlitScaled(SDL_Surface * src, const SDL_Rect * srcrect,
+                           SDL_Surface * dst, SDL_Rect * dstrect, SDL_ScaleMode scaleMode)
 {
     double src_x0, src_y0, src_x1, src_y1;
     double dst_x0, dst_y0, dst_x1, dst_y1;
@@ -867,7 +874,112 @@ SDL_UpperBlitScaled(SDL_Surface * src, const SDL_Rect * srcrect,
         return 0;
     }
 
-    return SDL_LowerBlitScaled(src, &final_src, dst, &final_dst);
+    return SDL_PrivateLowerBlitScaled(src, &final_src, dst, &final_dst, scaleMode);
+}
+
+static const Uint32 complex_copy_flags = (
+    SDL_COPY_MODULATE_COLOR | SDL_COPY_MODULATE_ALPHA |
+    SDL_COPY_BLEND | SDL_COPY_ADD | SDL_COPY_MOD | SDL_COPY_MUL |
+    SDL_COPY_COLORKEY
+);
+
+/* SDL_SoftStretchLinear() needs a 32-bit format with 8-bit channels */
+static SDL_bool
+SDL_CanStretchLinear(const SDL_PixelFormat * format)
+{
+    return (format->BytesPerPixel == 4 &&
+            SDL_PIXELLAYOUT(format->format) == SDL_PACKEDLAYOUT_8888);
+}
+
+/* Filtered scaled blit. The source is stretched into a temporary surface,
+   converting it to ARGB8888 first if SDL_SoftStretchLinear() can't handle
+   it, and the result is blitted with the source's blend mode and
+   modulation. */
+static int
+SDL_LowerBlitScaledLinear(SDL_Surface * src, SDL_Rect * srcrect,
+                          SDL_Surface * dst, SDL_Rect * dstrect)
+{
+    const Uint32 copy_flags = src->map->info.flags;
+    SDL_Color copy_color;
+    SDL_Surface *converted = NULL;
+    SDL_Surface *stretched;
+    SDL_Rect rect;
+    int ret;
+
+    if (!(copy_flags & complex_copy_flags) &&
+        src->format->format == dst->format->format &&
+        SDL_CanStretchLinear(src->format)) {
+        return SDL_SoftStretchLinear(src, srcrect, dst, dstrect);
+    }
+
+    copy_color.r = src->map->info.r;
+    copy_color.g = src->map->info.g;
+    copy_color.b = src->map->info.b;
+    copy_color.a = src->map->info.a;
+
+    rect.x = 0;
+    rect.y = 0;
+    rect.w = srcrect->w;
+    rect.h = srcrect->h;
+
+    /* Copy the source rectangle without modulation, the way
+       SDL_ConvertSurface() does. Color keyed pixels are left transparent. */
+    if ((copy_flags & SDL_COPY_COLORKEY) || !SDL_CanStretchLinear(src->format)) {
+        converted = SDL_CreateRGBSurfaceWithFormat(0, srcrect->w, srcrect->h, 32, SDL_PIXELFORMAT_ARGB8888);
+        if (!converted) {
+            return -1;
+        }
+        src->map->info.r = 0xFF;
+        src->map->info.g = 0xFF;
+        src->map->info.b = 0xFF;
+        src->map->info.a = 0xFF;
+        src->map->info.flags = (copy_flags & SDL_COPY_COLORKEY);
+        SDL_InvalidateMap(src->map);
+
+        ret = SDL_LowerBlit(src, srcrect, converted, &rect);
+
+        src->map->info.r = copy_color.r;
+        src->map->info.g = copy_color.g;
+        src->map->info.b = copy_color.b;
+        src->map->info.a = copy_color.a;
+        src->map->info.flags = copy_flags;
+        SDL_InvalidateMap(src->map);
+
+        if (ret < 0) {
+            SDL_FreeSurface(converted);
+            return ret;
+        }
+        src = converted;
+        srcrect = &rect;
+    }
+
+    stretched = SDL_CreateRGBSurfaceWithFormat(0, dstrect->w, dstrect->h, 32, src->format->format);
+    if (!stretched) {
+        SDL_FreeSurface(converted);
+        return -1;
+    }
+    ret = SDL_SoftStretchLinear(src, srcrect, stretched, NULL);
+    if (ret == 0) {
+        /* Blend away the transparent pixels a color key left behind */
+        Uint32 flags = (copy_flags & (complex_copy_flags & ~SDL_COPY_COLORKEY));
+        if ((copy_flags & SDL_COPY_COLORKEY) &&
+            !(flags & (SDL_COPY_BLEND | SDL_COPY_ADD | SDL_COPY_MOD | SDL_COPY_MUL))) {
+            flags |= SDL_COPY_BLEND;
+        }
+        stretched->map->info.r = copy_color.r;
+        stretched->map->info.g = copy_color.g;
+        stretched->map->info.b = copy_color.b;
+        stretched->map->info.a = copy_color.a;
+        stretched->map->info.flags = flags;
+        SDL_InvalidateMap(stretched->map);
+
+        rect.w = dstrect->w;
+        rect.h = dstrect->h;
+        ret = SDL_LowerBlit(stretched, &rect, dst, dstrect);
+    }
+    SDL_FreeSurface(stretched);
+    SDL_FreeSurface(converted);
+    return ret;
 }
 
 /**
@@ -878,11 +990,16 @@ int
 SDL_LowerBlitScaled(SDL_Surface * src, SDL_Rect * srcrect,
                 SDL_Surface * dst, SDL_Rect * dstrect)
 {
-    static const Uint32 complex_copy_flags = (
-        SDL_COPY_MODULATE_COLOR | SDL_COPY_MODULATE_ALPHA |
-        SDL_COPY_BLEND | SDL_COPY_ADD | SDL_COPY_MOD | SDL_COPY_MUL |
-        SDL_COPY_COLORKEY
-    );
+    return SDL_PrivateLowerBlitScaled(src, srcrect, dst, dstrect, SDL_ScaleModeNearest);
+}
+
+int
+SDL_PrivateLowerBlitScaled(SDL_Surface * src, SDL_Rect * srcrect,
+                           SDL_Surface * dst, SDL_Rect * dstrect, SDL_ScaleMode scaleMode)
+{
+    if (scaleMode != SDL_ScaleModeNearest) {
+        return SDL_LowerBlitScaledLinear(src, srcrect, dst, dstrect);
+    }
 
     if (!(src->map->info.flags & SDL_COPY_NEAREST)) {
         src->map->info.flags |= SDL_COPY_NEAREST;
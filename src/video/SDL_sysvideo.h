@@ -292,6 +292,14 @@ struct SDL_VideoDevice
      */
     void (*PumpEvents) (_THIS);
 
+    /* Block until there's input to pump, SendWakeupEvent() is called from
+       another thread, or timeout milliseconds pass (-1 waits forever).
+       Returns 0 if the timeout expired, -1 if waiting is no longer possible.
+       SendWakeupEvent() is also called from signal handlers, so it must be
+       async-signal-safe. Both are optional. */
+    int (*WaitEventTimeout) (_THIS, int timeout);
+    void (*SendWakeupEvent) (_THIS);
+
     /* Suspend the screensaver */
     void (*SuspendScreenSaver) (_THIS);
 
@@ -26,6 +26,8 @@
 #include "SDL_kmsdrmvideo.h"
 #include "SDL_kmsdrmevents.h"
 
+#include "../../core/unix/SDL_poll.h"
+
 #ifdef SDL_INPUT_LINUXEV
 #include "../../core/linux/SDL_evdev.h"
 #endif
@@ -38,5 +40,25 @@ void KMSDRM_PumpEvents(_THIS)
 
 }
 
+int KMSDRM_WaitEventTimeout(_THIS, int timeout)
+{
+    int fds[SDL_IOREADY_MAX_FDS];
+    int numfds = 0;
+
+#ifdef SDL_INPUT_LINUXEV
+    numfds = SDL_EVDEV_GetFDs(fds, SDL_arraysize(fds));
+    if (numfds == SDL_arraysize(fds)) {
+        /* There may be more devices than we can wait on, check back soon */
+        timeout = (timeout < 0) ? 10 : SDL_min(timeout, 10);
+    }
+#endif
+    return SDL_IOReadyOrWoken(fds, numfds, timeout);
+}
+
+void KMSDRM_SendWakeupEvent(_THIS)
+{
+    SDL_IOSendWakeup();
+}
+
 #endif /* SDL_VIDEO_DRIVER_KMSDRM */
 
@@ -32,6 +32,8 @@
 #include "../../events/SDL_mouse_c.h"
 #include "../../events/SDL_keyboard_c.h"
 
+#include "../../core/unix/SDL_poll.h"
+
 #ifdef SDL_INPUT_LINUXEV
 #include "../../core/linux/SDL_evdev.h"
 #endif
@@ -221,6 +223,8 @@ KMSDRM_CreateDevice(int devindex)
     device->GL_DeleteContext = KMSDRM_GLES_DeleteContext;
 #endif
     device->PumpEvents = KMSDRM_PumpEvents;
+    device->WaitEventTimeout = KMSDRM_WaitEventTimeout;
+    device->SendWakeupEvent = KMSDRM_SendWakeupEvent;
     device->free = KMSDRM_DeleteDevice;
 
     return device;
@@ -600,6 +604,12 @@ KMSDRM_VideoInit(_THIS)
 
     KMSDRM_InitMouse(_this);
 
+    /* Without a wakeup, SDL_WaitEvent() has to keep polling */
+    if (SDL_IOWakeupInit() < 0) {
+        _this->WaitEventTimeout = NULL;
+        _this->SendWakeupEvent = NULL;
+    }
+
     return ret;
 
 cleanup:
@@ -681,6 +691,10 @@ KMSDRM_VideoQuit(_THIS)
 #ifdef SDL_INPUT_LINUXEV
     SDL_EVDEV_Quit();
 #endif
+
+    if (_this->WaitEventTimeout) {
+        SDL_IOWakeupQuit();
+    }
 }
 
 void
@@ -187,6 +187,30 @@ touch_surface(SDL_TouchID id)
     return NULL;
 }
 
+int
+Wayland_WaitEventTimeout(_THIS, int timeout)
+{
+    SDL_VideoData *d = _this->driverdata;
+    const int fd = WAYLAND_wl_display_get_fd(d->display);
+
+    if (d->display_disconnected) {
+        return SDL_SetError("Wayland display connection closed by server");
+    }
+
+    /* Events already read off the connection won't make the fd readable */
+    if (WAYLAND_wl_display_dispatch_pending(d->display) > 0) {
+        return 1;
+    }
+    WAYLAND_wl_display_flush(d->display);
+    return SDL_IOReadyOrWoken(&fd, 1, timeout);
+}
+
+void
+Wayland_SendWakeupEvent(_THIS)
+{
+    SDL_IOSendWakeup();
+}
+
 void
 Wayland_PumpEvents(_THIS)
 {
@@ -31,6 +31,8 @@
 struct SDL_WaylandInput;
 
 extern void Wayland_PumpEvents(_THIS);
+extern int Wayland_WaitEventTimeout(_THIS, int timeout);
+extern void Wayland_SendWakeupEvent(_THIS);
 
 extern void Wayland_display_add_input(SDL_VideoData *d, uint32_t id);
 extern void Wayland_display_destroy_input(SDL_VideoData *d);
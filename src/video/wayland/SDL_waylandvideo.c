@@ -27,6 +27,7 @@
 #include "SDL_mouse.h"
 #include "SDL_stdinc.h"
 #include "../../events/SDL_events_c.h"
+#include "../../core/unix/SDL_poll.h"
 
 #include "SDL_waylandvideo.h"
 #include "SDL_waylandevents_c.h"
@@ -168,6 +169,8 @@ Wayland_CreateDevice(int devindex)
     device->GetWindowWMInfo = Wayland_GetWindowWMInfo;
 
     device->PumpEvents = Wayland_PumpEvents;
+    device->WaitEventTimeout = Wayland_WaitEventTimeout;
+    device->SendWakeupEvent = Wayland_SendWakeupEvent;
 
     device->GL_SwapWindow = Wayland_GLES_SwapWindow;
     device->GL_GetSwapInterval = Wayland_GLES_GetSwapInterval;
@@ -448,6 +451,12 @@ Wayland_VideoInit(_THIS)
 
     WAYLAND_wl_display_flush(data->display);
 
+    /* Without a wakeup, SDL_WaitEvent() has to keep polling */
+    if (SDL_IOWakeupInit() < 0) {
+        _this->WaitEventTimeout = NULL;
+        _this->SendWakeupEvent = NULL;
+    }
+
     return 0;
 }
 
@@ -472,6 +481,10 @@ Wayland_VideoQuit(_THIS)
 
     Wayland_FiniMouse ();
 
+    if (_this->WaitEventTimeout) {
+        SDL_IOWakeupQuit();
+    }
+
     for (i = 0; i < _this->num_displays; ++i) {
         SDL_VideoDisplay *display = &_this->displays[i];
 
@@ -1432,6 +1432,48 @@ X11_Pending(Display * display)
     return (0);
 }
 
+int
+X11_WaitEventTimeout(_THIS, int timeout)
+{
+    SDL_VideoData *videodata = (SDL_VideoData *) _this->driverdata;
+    Display *display = videodata->display;
+    const int fd = ConnectionNumber(display);
+    const Uint32 now = SDL_GetTicks();
+    int i;
+
+    /* Some things only happen when pumping, don't sleep past them */
+    for (i = 0; i < videodata->numwindows; ++i) {
+        SDL_WindowData *data = videodata->windowlist[i];
+        if (data && data->pending_focus != PENDING_FOCUS_NONE) {
+            const int delay = SDL_max((int) (data->pending_focus_time - now), 0);
+            timeout = (timeout < 0) ? delay : SDL_min(timeout, delay);
+        }
+    }
+    if (_this->suspend_screensaver) {
+        const int delay = SDL_max((int) (videodata->screensaver_activity + 30000 - now), 0);
+        timeout = (timeout < 0) ? delay : SDL_min(timeout, delay);
+    }
+#ifdef SDL_USE_IME
+    if (SDL_GetEventState(SDL_TEXTINPUT) == SDL_ENABLE) {
+        /* The input method talks to us over D-Bus, which we don't wait on */
+        timeout = (timeout < 0) ? 10 : SDL_min(timeout, 10);
+    }
+#endif
+
+    /* Xlib may already have read events off the connection */
+    X11_XFlush(display);
+    if (X11_XEventsQueued(display, QueuedAlready)) {
+        return 1;
+    }
+    return SDL_IOReadyOrWoken(&fd, 1, timeout);
+}
+
+void
+X11_SendWakeupEvent(_THIS)
+{
+    SDL_IOSendWakeup();
+}
+
 void
 X11_PumpEvents(_THIS)
 {
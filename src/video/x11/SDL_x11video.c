@@ -30,6 +30,7 @@
 #include "SDL_hints.h"
 #include "../SDL_sysvideo.h"
 #include "../SDL_pixels_c.h"
+#include "../../core/unix/SDL_poll.h"
 
 #include "SDL_x11video.h"
 #include "SDL_x11framebuffer.h"
@@ -231,6 +232,8 @@ X11_CreateDevice(int devindex)
     device->SetDisplayMode = X11_SetDisplayMode;
     device->SuspendScreenSaver = X11_SuspendScreenSaver;
     device->PumpEvents = X11_PumpEvents;
+    device->WaitEventTimeout = X11_WaitEventTimeout;
+    device->SendWakeupEvent = X11_SendWakeupEvent;
 
     device->CreateSDLWindow = X11_CreateWindow;
     device->CreateSDLWindowFrom = X11_CreateWindowFrom;
@@ -463,6 +466,12 @@ X11_VideoInit(_THIS)
     SDL_DBus_Init();
 #endif
 
+    /* Without a wakeup, SDL_WaitEvent() has to keep polling */
+    if (SDL_IOWakeupInit() < 0) {
+        _this->WaitEventTimeout = NULL;
+        _this->SendWakeupEvent = NULL;
+    }
+
     return 0;
 }
 
@@ -487,6 +496,10 @@ X11_VideoQuit(_THIS)
     X11_QuitMouse(_this);
     X11_QuitTouch(_this);
 
+    if (_this->WaitEventTimeout) {
+        SDL_IOWakeupQuit();
+    }
+
 /* !!! FIXME: other subsystems use D-Bus, so we shouldn't quit it here;
        have SDL.c do this at a higher level, or add refcounting. */
 #if SDL_USE_LIBDBUS
@@ -73,9 +73,11 @@ static const RGB2YUVParam RGB2YUV[3] = {
 #define RGB_FORMAT_ABGR		6
 
 // divide by PRECISION_FACTOR and clamp to [0:255] interval
-// input must be in the [-128*PRECISION_FACTOR:384*PRECISION_FACTOR] range
+// input outside the [-128*PRECISION_FACTOR:384*PRECISION_FACTOR] range is clamped to the ends of the table,
+// it happens when the chroma of a 2x2 block doesn't match the luma of some of its pixels
 static uint8_t clampU8(int32_t v)
 {
+	int32_t index = (v+128*PRECISION_FACTOR)>>PRECISION;
 	static const uint8_t lut[512] = 
 	{0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
 	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
@@ -91,7 +93,7 @@ static uint8_t clampU8(int32_t v)
 	255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,
 	255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255
 	};
-	return lut[(v+128*PRECISION_FACTOR)>>PRECISION];
+	return lut[index < 0 ? 0 : index > 511 ? 511 : index];
 }
 
 
@@ -242,6 +244,118 @@ void rgb24_yuv420_std(
 	}
 }
 
+#ifdef YUV_RGB_HAVE_NEON
+
+#define NEON_FUNCTION_NAME	yuv420_rgb565_neon
+#define STD_FUNCTION_NAME	yuv420_rgb565_std
+#define YUV_FORMAT			YUV_FORMAT_420
+#define RGB_FORMAT			RGB_FORMAT_RGB565
+#include "yuv_rgb_neon_func.h"
+
+#define NEON_FUNCTION_NAME	yuv420_rgb24_neon
+#define STD_FUNCTION_NAME	yuv420_rgb24_std
+#define YUV_FORMAT			YUV_FORMAT_420
+#define RGB_FORMAT			RGB_FORMAT_RGB24
+#include "yuv_rgb_neon_func.h"
+
+#define NEON_FUNCTION_NAME	yuv420_rgba_neon
+#define STD_FUNCTION_NAME	yuv420_rgba_std
+#define YUV_FORMAT			YUV_FORMAT_420
+#define RGB_FORMAT			RGB_FORMAT_RGBA
+#include "yuv_rgb_neon_func.h"
+
+#define NEON_FUNCTION_NAME	yuv420_bgra_neon
+#define STD_FUNCTION_NAME	yuv420_bgra_std
+#define YUV_FORMAT			YUV_FORMAT_420
+#define RGB_FORMAT			RGB_FORMAT_BGRA
+#include "yuv_rgb_neon_func.h"
+
+#define NEON_FUNCTION_NAME	yuv420_argb_neon
+#define STD_FUNCTION_NAME	yuv420_argb_std
+#define YUV_FORMAT			YUV_FORMAT_420
+#define RGB_FORMAT			RGB_FORMAT_ARGB
+#include "yuv_rgb_neon_func.h"
+
+#define NEON_FUNCTION_NAME	yuv420_abgr_neon
+#define STD_FUNCTION_NAME	yuv420_abgr_std
+#define YUV_FORMAT			YUV_FORMAT_420
+#define RGB_FORMAT			RGB_FORMAT_ABGR
+#include "yuv_rgb_neon_func.h"
+
+#define NEON_FUNCTION_NAME	yuv422_rgb565_neon
+#define STD_FUNCTION_NAME	yuv422_rgb565_std
+#define YUV_FORMAT			YUV_FORMAT_422
+#define RGB_FORMAT			RGB_FORMAT_RGB565
+#include "yuv_rgb_neon_func.h"
+
+#define NEON_FUNCTION_NAME	yuv422_rgb24_neon
+#define STD_FUNCTION_NAME	yuv422_rgb24_std
+#define YUV_FORMAT			YUV_FORMAT_422
+#define RGB_FORMAT			RGB_FORMAT_RGB24
+#include "yuv_rgb_neon_func.h"
+
+#define NEON_FUNCTION_NAME	yuv422_rgba_neon
+#define STD_FUNCTION_NAME	yuv422_rgba_std
+#define YUV_FORMAT			YUV_FORMAT_422
+#define RGB_FORMAT			RGB_FORMAT_RGBA
+#include "yuv_rgb_neon_func.h"
+
+#define NEON_FUNCTION_NAME	yuv422_bgra_neon
+#define STD_FUNCTION_NAME	yuv422_bgra_std
+#define YUV_FORMAT			YUV_FORMAT_422
+#define RGB_FORMAT			RGB_FORMAT_BGRA
+#include "yuv_rgb_neon_func.h"
+
+#define NEON_FUNCTION_NAME	yuv422_argb_neon
+#define STD_FUNCTION_NAME	yuv422_argb_std
+#define YUV_FORMAT			YUV_FORMAT_422
+#define RGB_FORMAT			RGB_FORMAT_ARGB
+#include "yuv_rgb_neon_func.h"
+
+#define NEON_FUNCTION_NAME	yuv422_abgr_neon
+#define STD_FUNCTION_NAME	yuv422_abgr_std
+#define YUV_FORMAT			YUV_FORMAT_422
+#define RGB_FORMAT			RGB_FORMAT_ABGR
+#include "yuv_rgb_neon_func.h"
+
+#define NEON_FUNCTION_NAME	yuvnv12_rgb565_neon
+#define STD_FUNCTION_NAME	yuvnv12_rgb565_std
+#define YUV_FORMAT			YUV_FORMAT_NV12
+#define RGB_FORMAT			RGB_FORMAT_RGB565
+#include "yuv_rgb_neon_func.h"
+
+#define NEON_FUNCTION_NAME	yuvnv12_rgb24_neon
+#define STD_FUNCTION_NAME	yuvnv12_rgb24_std
+#define YUV_FORMAT			YUV_FORMAT_NV12
+#define RGB_FORMAT			RGB_FORMAT_RGB24
+#include "yuv_rgb_neon_func.h"
+
+#define NEON_FUNCTION_NAME	yuvnv12_rgba_neon
+#define STD_FUNCTION_NAME	yuvnv12_rgba_std
+#define YUV_FORMAT			YUV_FORMAT_NV12
+#define RGB_FORMAT			RGB_FORMAT_RGBA
+#include "yuv_rgb_neon_func.h"
+
+#define NEON_FUNCTION_NAME	yuvnv12_bgra_neon
+#define STD_FUNCTION_NAME	yuvnv12_bgra_std
+#define YUV_FORMAT			YUV_FORMAT_NV12
+#define RGB_FORMAT			RGB_FORMAT_BGRA
+#include "yuv_rgb_neon_func.h"
+
+#define NEON_FUNCTION_NAME	yuvnv12_argb_neon
+#define STD_FUNCTION_NAME	yuvnv12_argb_std
+#define YUV_FORMAT			YUV_FORMAT_NV12
+#define RGB_FORMAT			RGB_FORMAT_ARGB
+#include "yuv_rgb_neon_func.h"
+
+#define NEON_FUNCTION_NAME	yuvnv12_abgr_neon
+#define STD_FUNCTION_NAME	yuvnv12_abgr_std
+#define YUV_FORMAT			YUV_FORMAT_NV12
+#define RGB_FORMAT			RGB_FORMAT_ABGR
+#include "yuv_rgb_neon_func.h"
+
+#endif //YUV_RGB_HAVE_NEON
+
 #ifdef __SSE2__
 
 #define SSE_FUNCTION_NAME	yuv420_rgb565_sse
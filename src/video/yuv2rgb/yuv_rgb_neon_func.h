@@ -0,0 +1,267 @@
+// NEON counterpart of yuv_rgb_sse_func.h
+// Distributed under BSD 3-Clause License
+
+/* You need to define the following macros before including this file:
+	NEON_FUNCTION_NAME
+	STD_FUNCTION_NAME
+	YUV_FORMAT
+	RGB_FORMAT
+*/
+
+/* Each step converts 16 pixels of one line, or of two lines sharing the same
+   chroma samples. Saturating adds followed by a saturating narrowing shift
+   give the same result as clampU8() in the standard functions. */
+
+#define UV2RGB_16(U, V) \
+{ \
+	const int16x8_t u_16 = vreinterpretq_s16_u16(vsubl_u8(U, uv_shift)); \
+	const int16x8_t v_16 = vreinterpretq_s16_u16(vsubl_u8(V, uv_shift)); \
+	const int16x8_t r_tmp = vmulq_n_s16(v_16, param->v_r_factor); \
+	const int16x8_t g_tmp = vmlaq_n_s16(vmulq_n_s16(u_16, param->u_g_factor), v_16, param->v_g_factor); \
+	const int16x8_t b_tmp = vmulq_n_s16(u_16, param->u_b_factor); \
+	r_uv = vzipq_s16(r_tmp, r_tmp); \
+	g_uv = vzipq_s16(g_tmp, g_tmp); \
+	b_uv = vzipq_s16(b_tmp, b_tmp); \
+}
+
+#define ADD_Y2RGB_16(Y, R, G, B) \
+{ \
+	const int16x8_t y_lo = vmulq_n_s16(vreinterpretq_s16_u16(vsubl_u8(vget_low_u8(Y), y_shift)), param->y_factor); \
+	const int16x8_t y_hi = vmulq_n_s16(vreinterpretq_s16_u16(vsubl_u8(vget_high_u8(Y), y_shift)), param->y_factor); \
+	R = vcombine_u8(vqshrun_n_s16(vqaddq_s16(y_lo, r_uv.val[0]), PRECISION), \
+	                vqshrun_n_s16(vqaddq_s16(y_hi, r_uv.val[1]), PRECISION)); \
+	G = vcombine_u8(vqshrun_n_s16(vqaddq_s16(y_lo, g_uv.val[0]), PRECISION), \
+	                vqshrun_n_s16(vqaddq_s16(y_hi, g_uv.val[1]), PRECISION)); \
+	B = vcombine_u8(vqshrun_n_s16(vqaddq_s16(y_lo, b_uv.val[0]), PRECISION), \
+	                vqshrun_n_s16(vqaddq_s16(y_hi, b_uv.val[1]), PRECISION)); \
+}
+
+/* The 32-bit formats are stored in little endian byte order, the same as the
+   standard functions write them on the targets that have NEON */
+#if RGB_FORMAT == RGB_FORMAT_RGB565
+
+#define SAVE_PIXELS(rgb_ptr, R, G, B) \
+{ \
+	uint16x8_t lo, hi; \
+	lo = vshll_n_u8(vget_low_u8(R), 8); \
+	hi = vshll_n_u8(vget_high_u8(R), 8); \
+	lo = vsriq_n_u16(lo, vshll_n_u8(vget_low_u8(G), 8), 5); \
+	hi = vsriq_n_u16(hi, vshll_n_u8(vget_high_u8(G), 8), 5); \
+	lo = vsriq_n_u16(lo, vshll_n_u8(vget_low_u8(B), 8), 11); \
+	hi = vsriq_n_u16(hi, vshll_n_u8(vget_high_u8(B), 8), 11); \
+	vst1q_u8(rgb_ptr, vreinterpretq_u8_u16(lo)); \
+	vst1q_u8(rgb_ptr+16, vreinterpretq_u8_u16(hi)); \
+}
+
+#elif RGB_FORMAT == RGB_FORMAT_RGB24
+
+#define SAVE_PIXELS(rgb_ptr, R, G, B) \
+{ \
+	uint8x16x3_t rgb; \
+	rgb.val[0] = R; \
+	rgb.val[1] = G; \
+	rgb.val[2] = B; \
+	vst3q_u8(rgb_ptr, rgb); \
+}
+
+#else
+
+#if RGB_FORMAT == RGB_FORMAT_RGBA
+#define PIXEL_BYTES(R, G, B, A) A, B, G, R
+#elif RGB_FORMAT == RGB_FORMAT_BGRA
+#define PIXEL_BYTES(R, G, B, A) A, R, G, B
+#elif RGB_FORMAT == RGB_FORMAT_ARGB
+#define PIXEL_BYTES(R, G, B, A) B, G, R, A
+#elif RGB_FORMAT == RGB_FORMAT_ABGR
+#define PIXEL_BYTES(R, G, B, A) R, G, B, A
+#else
+#error PIXEL_BYTES unimplemented
+#endif
+
+#define STORE_BYTES(rgb_ptr, B0, B1, B2, B3) \
+{ \
+	uint8x16x4_t rgba; \
+	rgba.val[0] = B0; \
+	rgba.val[1] = B1; \
+	rgba.val[2] = B2; \
+	rgba.val[3] = B3; \
+	vst4q_u8(rgb_ptr, rgba); \
+}
+#define STORE_PIXEL_BYTES(rgb_ptr, BYTES) STORE_BYTES(rgb_ptr, BYTES)
+
+#define SAVE_PIXELS(rgb_ptr, R, G, B) \
+	STORE_PIXEL_BYTES(rgb_ptr, PIXEL_BYTES(R, G, B, alpha))
+
+#endif
+
+#if YUV_FORMAT == YUV_FORMAT_420
+
+#define READ_UV \
+	u = vld1_u8(u_ptr); \
+	v = vld1_u8(v_ptr);
+
+#define READ_Y(y_ptr) \
+	y = vld1q_u8(y_ptr);
+
+#elif YUV_FORMAT == YUV_FORMAT_NV12
+
+/* NV21 is passed as NV12 with V one byte before U, so load the pairs from
+   whichever comes first */
+#define READ_UV \
+{ \
+	const uint8x8x2_t uv = vld2_u8(v_first ? v_ptr : u_ptr); \
+	u = v_first ? uv.val[1] : uv.val[0]; \
+	v = v_first ? uv.val[0] : uv.val[1]; \
+}
+
+#define READ_Y(y_ptr) \
+	y = vld1q_u8(y_ptr);
+
+#elif YUV_FORMAT == YUV_FORMAT_422
+
+/* Deinterleave 8 macropixels, the lanes are the byte offsets of Y, U and V
+   in YUY2, UYVY or YVYU */
+#define LANE(q, lane) ((lane) == 0 ? (q).val[0] : (lane) == 1 ? (q).val[1] : (lane) == 2 ? (q).val[2] : (q).val[3])
+
+#define READ_UV \
+	packed = vld4_u8(y_ptr1 - y_lane); \
+	u = LANE(packed, u_lane); \
+	v = LANE(packed, v_lane);
+
+#define READ_Y(y_ptr) \
+{ \
+	const uint8x8x2_t y_zip = vzip_u8(LANE(packed, y_lane), LANE(packed, y_lane + 2)); \
+	y = vcombine_u8(y_zip.val[0], y_zip.val[1]); \
+}
+
+#else
+#error READ_UV unimplemented
+#endif
+
+
+void NEON_FUNCTION_NAME(uint32_t width, uint32_t height,
+	const uint8_t *Y, const uint8_t *U, const uint8_t *V, uint32_t Y_stride, uint32_t UV_stride,
+	uint8_t *RGB, uint32_t RGB_stride,
+	YCbCrType yuv_type)
+{
+	const YUV2RGBParam *const param = &(YUV2RGB[yuv_type]);
+#if YUV_FORMAT == YUV_FORMAT_420
+	const int y_pixel_stride = 1;
+	const int uv_pixel_stride = 1;
+	const int uv_x_sample_interval = 2;
+	const int uv_y_sample_interval = 2;
+#elif YUV_FORMAT == YUV_FORMAT_422
+	const int y_pixel_stride = 2;
+	const int uv_pixel_stride = 4;
+	const int uv_x_sample_interval = 2;
+	const int uv_y_sample_interval = 1;
+	const int y_lane = (U < Y || V < Y) ? 1 : 0;
+	const int u_lane = (int)(U - (Y - y_lane));
+	const int v_lane = (int)(V - (Y - y_lane));
+#elif YUV_FORMAT == YUV_FORMAT_NV12
+	const int y_pixel_stride = 1;
+	const int uv_pixel_stride = 2;
+	const int uv_x_sample_interval = 2;
+	const int uv_y_sample_interval = 2;
+	const int v_first = (V < U);
+#endif
+#if RGB_FORMAT == RGB_FORMAT_RGB565
+	const int rgb_pixel_stride = 2;
+#elif RGB_FORMAT == RGB_FORMAT_RGB24
+	const int rgb_pixel_stride = 3;
+#elif RGB_FORMAT == RGB_FORMAT_RGBA || RGB_FORMAT == RGB_FORMAT_BGRA || \
+      RGB_FORMAT == RGB_FORMAT_ARGB || RGB_FORMAT == RGB_FORMAT_ABGR
+	const int rgb_pixel_stride = 4;
+	const uint8x16_t alpha = vdupq_n_u8(0xFF);
+#else
+#error Unknown RGB pixel size
+#endif
+	const uint8x8_t y_shift = vdup_n_u8(param->y_shift);
+	const uint8x8_t uv_shift = vdup_n_u8(128);
+
+	if (width >= 16) {
+		uint32_t xpos, ypos;
+		for(ypos=0; ypos<(height-(uv_y_sample_interval-1)); ypos+=uv_y_sample_interval)
+		{
+			const uint8_t *y_ptr1=Y+ypos*Y_stride,
+				*u_ptr=U+(ypos/uv_y_sample_interval)*UV_stride,
+				*v_ptr=V+(ypos/uv_y_sample_interval)*UV_stride;
+			uint8_t *rgb_ptr1=RGB+ypos*RGB_stride;
+#if YUV_FORMAT != YUV_FORMAT_422
+			const uint8_t *y_ptr2=Y+(ypos+1)*Y_stride;
+			uint8_t *rgb_ptr2=RGB+(ypos+1)*RGB_stride;
+#endif
+
+			for(xpos=0; xpos<(width-15); xpos+=16)
+			{
+				int16x8x2_t r_uv, g_uv, b_uv;
+				uint8x16_t y, r, g, b;
+				uint8x8_t u, v;
+#if YUV_FORMAT == YUV_FORMAT_422
+				uint8x8x4_t packed;
+#endif
+
+				READ_UV
+				UV2RGB_16(u, v)
+
+				READ_Y(y_ptr1)
+				ADD_Y2RGB_16(y, r, g, b)
+				SAVE_PIXELS(rgb_ptr1, r, g, b)
+
+#if YUV_FORMAT != YUV_FORMAT_422
+				READ_Y(y_ptr2)
+				ADD_Y2RGB_16(y, r, g, b)
+				SAVE_PIXELS(rgb_ptr2, r, g, b)
+
+				y_ptr2+=16*y_pixel_stride;
+				rgb_ptr2+=16*rgb_pixel_stride;
+#endif
+				y_ptr1+=16*y_pixel_stride;
+				u_ptr+=16*uv_pixel_stride/uv_x_sample_interval;
+				v_ptr+=16*uv_pixel_stride/uv_x_sample_interval;
+				rgb_ptr1+=16*rgb_pixel_stride;
+			}
+		}
+
+		/* Catch the last line, if needed */
+		if (uv_y_sample_interval == 2 && ypos == (height-1))
+		{
+			const uint8_t *y_ptr=Y+ypos*Y_stride,
+				*u_ptr=U+(ypos/uv_y_sample_interval)*UV_stride,
+				*v_ptr=V+(ypos/uv_y_sample_interval)*UV_stride;
+
+			uint8_t *rgb_ptr=RGB+ypos*RGB_stride;
+
+			STD_FUNCTION_NAME(width, 1, y_ptr, u_ptr, v_ptr, Y_stride, UV_stride, rgb_ptr, RGB_stride, yuv_type);
+		}
+	}
+
+	/* Catch the right column, if needed */
+	{
+		int converted = (width & ~15);
+		if (converted != width)
+		{
+			const uint8_t *y_ptr=Y+converted*y_pixel_stride,
+				*u_ptr=U+converted*uv_pixel_stride/uv_x_sample_interval,
+				*v_ptr=V+converted*uv_pixel_stride/uv_x_sample_interval;
+
+			uint8_t *rgb_ptr=RGB+converted*rgb_pixel_stride;
+
+			STD_FUNCTION_NAME(width-converted, height, y_ptr, u_ptr, v_ptr, Y_stride, UV_stride, rgb_ptr, RGB_stride, yuv_type);
+		}
+	}
+}
+
+#undef NEON_FUNCTION_NAME
+#undef STD_FUNCTION_NAME
+#undef YUV_FORMAT
+#undef RGB_FORMAT
+#undef UV2RGB_16
+#undef ADD_Y2RGB_16
+#undef SAVE_PIXELS
+#undef PIXEL_BYTES
+#undef STORE_BYTES
+#undef STORE_PIXEL_BYTES
+#undef LANE
+#undef READ_UV
+#undef READ_Y
@@ -0,0 +1,235 @@
+/*
+  Copyright (C) 1997-2020 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely.
+*/
+/* Compare drawing many small images from their own textures vs. from a texture atlas */
+
+#include <stdlib.h>
+#include <stdio.h>
+
+#include "SDL.h"
+
+#define MIN_IMAGE_SIZE  8
+#define MAX_IMAGE_SIZE  64
+
+static int width = 1024;
+static int height = 768;
+static int num_images = 500;
+static Uint32 seconds = 2;
+
+static Uint32 rand_state;
+
+static int
+Random(int max)
+{
+    rand_state = rand_state * 1103515245 + 12345;
+    return (int) ((rand_state >> 16) % (Uint32) max);
+}
+
+static SDL_Surface *
+CreateImage(int index)
+{
+    SDL_Surface *surface;
+    int w, h, x, y;
+    Uint32 color;
+
+    rand_state = index;
+    w = MIN_IMAGE_SIZE + Random(MAX_IMAGE_SIZE - MIN_IMAGE_SIZE + 1);
+    h = MIN_IMAGE_SIZE + Random(MAX_IMAGE_SIZE - MIN_IMAGE_SIZE + 1);
+    color = ((Uint32) Random(256) << 16) | ((Uint32) Random(256) << 8) | (Uint32) Random(256);
+
+    surface = SDL_CreateRGBSurfaceWithFormat(0, w, h, 32, SDL_PIXELFORMAT_ARGB8888);
+    if (!surface) {
+        return NULL;
+    }
+    for (y = 0; y < h; ++y) {
+        Uint32 *row = (Uint32 *) ((Uint8 *) surface->pixels + y * surface->pitch);
+        for (x = 0; x < w; ++x) {
+            /* Solid border, so a bad source rect shows up in the output */
+            const Uint32 a = (x == 0 || y == 0 || x == w - 1 || y == h - 1) ? 255 : (Uint32) ((x + y) * 255 / (w + h));
+            row[x] = (a << 24) | color;
+        }
+    }
+    return surface;
+}
+
+static void
+DrawFrame(SDL_Renderer *renderer, SDL_Texture **textures, Uint32 frame)
+{
+    int i;
+
+    rand_state = frame;
+
+    SDL_SetRenderDrawColor(renderer, 0x20, 0x20, 0x40, 0xFF);
+    SDL_RenderClear(renderer);
+
+    for (i = 0; i < num_images; ++i) {
+        SDL_Rect rect;
+        SDL_QueryTexture(textures[i], NULL, NULL, &rect.w, &rect.h);
+        rect.x = Random(width) - rect.w / 2;
+        rect.y = Random(height) - rect.h / 2;
+        SDL_RenderCopy(renderer, textures[i], NULL, &rect);
+    }
+
+    SDL_RenderPresent(renderer);
+}
+
+static int
+RunBenchmark(SDL_Surface **images, SDL_bool use_atlas, SDL_Surface *reference)
+{
+    SDL_Surface *surface;
+    SDL_Renderer *renderer;
+    SDL_TextureAtlas *atlas = NULL;
+    SDL_Texture **textures;
+    Uint32 frames = 0;
+    Uint64 start, elapsed;
+    int commands_in = 0, commands_out = 0;
+    int i, matches;
+
+    surface = SDL_CreateRGBSurfaceWithFormat(0, width, height, 32, SDL_PIXELFORMAT_ARGB8888);
+    renderer = surface ? SDL_CreateSoftwareRenderer(surface) : NULL;
+    textures = (SDL_Texture **) SDL_calloc(num_images, sizeof (*textures));
+    if (!renderer || !textures) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't set up renderer: %s\n", SDL_GetError());
+        return -1;
+    }
+
+    if (use_atlas) {
+        atlas = SDL_CreateTextureAtlas(renderer, 0, 0);
+        if (!atlas) {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't create atlas: %s\n", SDL_GetError());
+            return -1;
+        }
+    }
+    for (i = 0; i < num_images; ++i) {
+        if (atlas) {
+            textures[i] = SDL_AtlasAddSurface(atlas, images[i]);
+        } else {
+            textures[i] = SDL_CreateTextureFromSurface(renderer, images[i]);
+        }
+        if (!textures[i]) {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't create texture: %s\n", SDL_GetError());
+            return -1;
+        }
+    }
+
+    /* The first frame is always the same, compare it with the separate textures */
+    DrawFrame(renderer, textures, 0);
+    if (!reference->userdata) {
+        SDL_memcpy(reference->pixels, surface->pixels, (size_t) surface->pitch * height);
+        reference->userdata = reference;
+        matches = 1;
+    } else {
+        matches = (SDL_memcmp(surface->pixels, reference->pixels, (size_t) surface->pitch * height) == 0);
+    }
+
+    start = SDL_GetPerformanceCounter();
+    do {
+        DrawFrame(renderer, textures, ++frames);
+        elapsed = SDL_GetPerformanceCounter() - start;
+    } while (elapsed < seconds * SDL_GetPerformanceFrequency());
+
+    SDL_RenderGetCommandStats(renderer, &commands_in, &commands_out);
+
+    SDL_Log("%-8s: %8.2f frames/sec, %d of %d commands run%s\n", use_atlas ? "atlas" : "textures",
+            (double) frames * SDL_GetPerformanceFrequency() / elapsed,
+            commands_out, commands_in,
+            matches ? "" : "  (output differs from separate textures!)");
+
+    if (atlas) {
+        int pages = 0, packed = 0;
+        float efficiency = 0.0f;
+        SDL_GetTextureAtlasInfo(atlas, &pages, &packed, &efficiency);
+        SDL_Log("          %d images on %d page%s, %.1f%% of the page area used\n",
+                packed, pages, pages == 1 ? "" : "s", efficiency * 100.0f);
+        SDL_DestroyTextureAtlas(atlas);
+    } else {
+        for (i = 0; i < num_images; ++i) {
+            SDL_DestroyTexture(textures[i]);
+        }
+    }
+    SDL_free(textures);
+    SDL_DestroyRenderer(renderer);
+    SDL_FreeSurface(surface);
+    return matches ? 0 : -1;
+}
+
+int
+main(int argc, char *argv[])
+{
+    SDL_Surface **images;
+    SDL_Surface *reference;
+    int i, status = 0;
+
+    /* Enable standard application logging */
+    SDL_LogSetPriority(SDL_LOG_CATEGORY_APPLICATION, SDL_LOG_PRIORITY_INFO);
+
+    for (i = 1; i < argc; ++i) {
+        if (SDL_strcmp(argv[i], "--images") == 0 && argv[i+1]) {
+            num_images = SDL_atoi(argv[++i]);
+            if (num_images < 1) {
+                num_images = 1;
+            }
+        } else if (SDL_strcmp(argv[i], "--size") == 0 && argv[i+1]) {
+            if (SDL_sscanf(argv[++i], "%dx%d", &width, &height) != 2) {
+                width = 1024;
+                height = 768;
+            }
+        } else if (SDL_strcmp(argv[i], "--seconds") == 0 && argv[i+1]) {
+            seconds = (Uint32) SDL_atoi(argv[++i]);
+        } else {
+            SDL_Log("USAGE: %s [--images N] [--size WxH] [--seconds N]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    /* Queue up the whole frame, so draws from the same texture can be merged */
+    SDL_SetHint(SDL_HINT_RENDER_BATCHING, "1");
+
+    if (SDL_Init(0) < 0) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't initialize SDL: %s\n", SDL_GetError());
+        return 1;
+    }
+
+    images = (SDL_Surface **) SDL_calloc(num_images, sizeof (*images));
+    reference = SDL_CreateRGBSurfaceWithFormat(0, width, height, 32, SDL_PIXELFORMAT_ARGB8888);
+    if (!images || !reference) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't create surface: %s\n", SDL_GetError());
+        SDL_Quit();
+        return 1;
+    }
+    for (i = 0; i < num_images; ++i) {
+        images[i] = CreateImage(i);
+        if (!images[i]) {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't create surface: %s\n", SDL_GetError());
+            SDL_Quit();
+            return 1;
+        }
+    }
+
+    SDL_Log("Software renderer, %dx%d, %d images of %d-%d pixels per frame\n",
+            width, height, num_images, MIN_IMAGE_SIZE, MAX_IMAGE_SIZE);
+    if (RunBenchmark(images, SDL_FALSE, reference) < 0) {
+        status = 1;
+    }
+    if (RunBenchmark(images, SDL_TRUE, reference) < 0) {
+        status = 1;
+    }
+
+    for (i = 0; i < num_images; ++i) {
+        SDL_FreeSurface(images[i]);
+    }
+    SDL_free(images);
+    SDL_FreeSurface(reference);
+    SDL_Quit();
+    return status;
+}
+
+/* vi: set ts=4 sw=4 expandtab: */
@@ -708,6 +708,117 @@ static void RunFIFOTest(SDL_bool lock_free)
 /* End FIFO test */
 /**************************************************************************/
 
+/**************************************************************************/
+/* Event queue contention test
+ *
+ * Several threads push events with SDL_PushEvent() while the main thread
+ * takes them off with SDL_PeepEvents(), the way input, network and audio
+ * threads share the real event queue.
+ */
+
+#define EVENTS_PER_PUSHER   100000
+#define PEEP_BATCH          64
+
+static SDL_atomic_t pushersRunning;
+
+typedef struct
+{
+    int index;
+    int waits;
+    char padding[SDL_CACHELINE_SIZE-(2*sizeof(int))%SDL_CACHELINE_SIZE];
+} PusherData;
+
+static int SDLCALL EventQueue_Pusher(void* _data)
+{
+    PusherData *data = (PusherData *)_data;
+    SDL_Event event;
+    int i;
+
+    SDL_zero(event);
+    event.type = SDL_USEREVENT;
+    event.user.data1 = data;
+
+    for (i = 0; i < EVENTS_PER_PUSHER; ++i) {
+        event.user.code = i;
+        while (SDL_PushEvent(&event) != 1) {
+            ++data->waits;
+            SDL_Delay(0);
+        }
+    }
+    SDL_AtomicAdd(&pushersRunning, -1);
+    return 0;
+}
+
+static void RunEventQueueTest(void)
+{
+    PusherData pusherData[NUM_WRITERS];
+    SDL_Thread *threads[NUM_WRITERS];
+    int next_code[NUM_WRITERS];
+    SDL_Event events[PEEP_BATCH];
+    Uint64 start, end;
+    int i, total = 0, out_of_order = 0, empty_peeps = 0;
+
+    SDL_Log("\nEvent queue test---------------------------------\n\n");
+
+    if (SDL_InitSubSystem(SDL_INIT_EVENTS) < 0) {
+        SDL_Log("Couldn't initialize events: %s\n", SDL_GetError());
+        return;
+    }
+
+    SDL_zeroa(pusherData);
+    SDL_zeroa(next_code);
+
+    start = SDL_GetPerformanceCounter();
+
+    SDL_Log("Starting %d pushers\n", NUM_WRITERS);
+    SDL_AtomicSet(&pushersRunning, NUM_WRITERS);
+    for (i = 0; i < NUM_WRITERS; ++i) {
+        char name[64];
+        SDL_snprintf(name, sizeof (name), "EventPusher%d", i);
+        pusherData[i].index = i;
+        threads[i] = SDL_CreateThread(EventQueue_Pusher, name, &pusherData[i]);
+    }
+
+    for ( ; ; ) {
+        const SDL_bool done = (SDL_AtomicGet(&pushersRunning) == 0);
+        const int count = SDL_PeepEvents(events, PEEP_BATCH, SDL_GETEVENT, SDL_USEREVENT, SDL_USEREVENT);
+
+        for (i = 0; i < count; ++i) {
+            const PusherData *pusher = (const PusherData *)events[i].user.data1;
+            if (events[i].user.code != next_code[pusher->index]) {
+                ++out_of_order;
+            }
+            next_code[pusher->index] = events[i].user.code + 1;
+        }
+        total += SDL_max(count, 0);
+
+        if (count <= 0) {
+            if (done) {
+                break;
+            }
+            ++empty_peeps;
+            SDL_Delay(0);
+        }
+    }
+
+    end = SDL_GetPerformanceCounter();
+
+    for (i = 0; i < NUM_WRITERS; ++i) {
+        SDL_WaitThread(threads[i], NULL);
+    }
+    SDL_QuitSubSystem(SDL_INIT_EVENTS);
+
+    SDL_Log("Finished in %f sec\n", (double)(end - start) / SDL_GetPerformanceFrequency());
+    for (i = 0; i < NUM_WRITERS; ++i) {
+        SDL_Log("Pusher %d pushed %d events, had %d waits\n", i, EVENTS_PER_PUSHER, pusherData[i].waits);
+    }
+    SDL_Log("Main thread got %d of %d events, %d out of order, %d empty peeps\n",
+            total, NUM_WRITERS*EVENTS_PER_PUSHER, out_of_order, empty_peeps);
+}
+
+/* End event queue test */
+/**************************************************************************/
+
 int
 main(int argc, char *argv[])
 {
@@ -721,6 +832,7 @@ main(int argc, char *argv[])
     RunFIFOTest(SDL_FALSE);
 #endif
     RunFIFOTest(SDL_TRUE);
+    RunEventQueueTest();
     return 0;
 }
 
@@ -0,0 +1,137 @@
+/*
+  Copyright (C) 1997-2020 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely.
+*/
+/* Print an audio device's thread timing statistics while it plays a tone */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+
+#include "SDL.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846264338327950288
+#endif
+
+static SDL_AudioSpec spec;
+static double phase;
+static Uint32 load_us = 0;
+
+static void SDLCALL
+fill_audio(void *userdata, Uint8 *stream, int len)
+{
+    float *samples = (float *) stream;
+    const int frames = len / (int) (sizeof (float) * spec.channels);
+    int i, chan;
+
+    for (i = 0; i < frames; ++i) {
+        const float sample = (float) (0.25 * sin(phase));
+        for (chan = 0; chan < spec.channels; ++chan) {
+            *(samples++) = sample;
+        }
+        phase += 2.0 * M_PI * 440.0 / spec.freq;
+    }
+
+    /* Pretend to be an expensive callback */
+    if (load_us) {
+        const Uint64 end = SDL_GetPerformanceCounter() + (SDL_GetPerformanceFrequency() * load_us) / 1000000;
+        while (SDL_GetPerformanceCounter() < end) {
+            /* spin */
+        }
+    }
+}
+
+static void
+PrintStats(SDL_AudioDeviceID dev)
+{
+    SDL_AudioDeviceStats stats;
+    char histogram[SDL_AUDIO_STATS_HISTOGRAM_SIZE * 6 + 1];
+    int i, pos = 0;
+
+    if (SDL_GetAudioDeviceStats(dev, &stats) < 0) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't get stats: %s\n", SDL_GetError());
+        return;
+    }
+    SDL_ResetAudioDeviceStats(dev);
+
+    for (i = 0; i < SDL_AUDIO_STATS_HISTOGRAM_SIZE; ++i) {
+        pos += SDL_snprintf(histogram + pos, sizeof (histogram) - pos, " %4u", stats.callback_histogram[i]);
+    }
+
+    SDL_Log("%u periods of %u us: jitter avg %u us max %u us, %u late | callback avg %u us max %u us | xruns %u, buffered %u bytes\n",
+            stats.periods, stats.period_us, stats.jitter_avg_us, stats.jitter_max_us, stats.late_periods,
+            stats.callback_avg_us, stats.callback_max_us, stats.xruns, stats.stream_fill);
+    SDL_Log("  callback time in 1/8 periods:%s\n", histogram);
+}
+
+int
+main(int argc, char *argv[])
+{
+    const char *driver = SDL_getenv("SDL_AUDIODRIVER");
+    Uint32 seconds = 5;
+    Uint32 second;
+    int samples = 1024;
+    int i;
+    SDL_AudioDeviceID dev;
+
+    /* Enable standard application logging */
+    SDL_LogSetPriority(SDL_LOG_CATEGORY_APPLICATION, SDL_LOG_PRIORITY_INFO);
+
+    for (i = 1; i < argc; ++i) {
+        if (SDL_strcmp(argv[i], "--driver") == 0 && argv[i+1]) {
+            driver = argv[++i];
+        } else if (SDL_strcmp(argv[i], "--samples") == 0 && argv[i+1]) {
+            samples = SDL_atoi(argv[++i]);
+        } else if (SDL_strcmp(argv[i], "--load") == 0 && argv[i+1]) {
+            load_us = (Uint32) SDL_atoi(argv[++i]);
+        } else if (SDL_strcmp(argv[i], "--seconds") == 0 && argv[i+1]) {
+            seconds = (Uint32) SDL_atoi(argv[++i]);
+        } else {
+            SDL_Log("USAGE: %s [--driver dummy|disk|...] [--samples N] [--load us] [--seconds N]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    /* Default to a driver that works anywhere and doesn't make noise */
+    SDL_setenv("SDL_AUDIODRIVER", driver ? driver : "dummy", 1);
+    if (SDL_Init(SDL_INIT_AUDIO) < 0) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't initialize SDL: %s\n", SDL_GetError());
+        return 1;
+    }
+
+    SDL_zero(spec);
+    spec.freq = 48000;
+    spec.format = AUDIO_F32SYS;
+    spec.channels = 2;
+    spec.samples = (Uint16) SDL_max(samples, 16);
+    spec.callback = fill_audio;
+    dev = SDL_OpenAudioDevice(NULL, 0, &spec, &spec, 0);
+    if (!dev) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't open audio: %s\n", SDL_GetError());
+        SDL_Quit();
+        return 1;
+    }
+
+    SDL_Log("Playing on %s, %d Hz, %d frames per callback, %u us of load per callback\n",
+            SDL_GetCurrentAudioDriver(), spec.freq, spec.samples, load_us);
+    SDL_PauseAudioDevice(dev, 0);
+
+    for (second = 0; second < seconds; ++second) {
+        SDL_Delay(1000);
+        PrintStats(dev);
+    }
+
+    SDL_CloseAudioDevice(dev);
+    SDL_Quit();
+    return 0;
+}
+
+/* vi: set ts=4 sw=4 expandtab: */
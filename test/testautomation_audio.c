@@ -968,6 +968,441 @@ int audio_openCloseAudioDeviceConnected()
 }
 
 
+/**
+ * \brief Mixes several voices and checks the gain, pan and clipping.
+ *
+ * \sa https://wiki.libsdl.org/SDL_CreateAudioMixer
+ */
+int audio_mixVoices()
+{
+   SDL_AudioMixer *mixer;
+   float stereo[64 * 2], mono[64], out[128 * 2];
+   Sint16 out16[64 * 2];
+   Uint8 out8[3];
+   int a, b, c, i, result;
+
+   for (i = 0; i < 64; i++) {
+     stereo[i * 2] = stereo[i * 2 + 1] = 0.25f;
+     mono[i] = 0.5f;
+   }
+
+   mixer = SDL_CreateAudioMixer(AUDIO_F32SYS, 2, 48000);
+   SDLTest_AssertPass("Call to SDL_CreateAudioMixer(AUDIO_F32SYS, 2, 48000)");
+   SDLTest_AssertCheck(mixer != NULL, "Validate mixer is not NULL");
+   if (mixer == NULL) return TEST_ABORTED;
+
+   a = SDL_AudioMixerAddVoice(mixer, AUDIO_F32SYS, 2, 48000);
+   b = SDL_AudioMixerAddVoice(mixer, AUDIO_F32SYS, 1, 48000);
+   SDLTest_AssertPass("Call to SDL_AudioMixerAddVoice()");
+   SDLTest_AssertCheck(a >= 0 && b >= 0 && a != b, "Validate voice IDs; got: %i, %i", a, b);
+
+   result = SDL_AudioMixerSetVoiceGain(mixer, b, 1.0f, -1.0f);
+   SDLTest_AssertCheck(result == 0, "Validate result of SDL_AudioMixerSetVoiceGain; expected: 0, got: %i", result);
+   SDL_AudioMixerPutVoice(mixer, a, stereo, sizeof (stereo));
+   SDL_AudioMixerPutVoice(mixer, b, mono, sizeof (mono));
+   result = SDL_AudioMixerVoiceQueued(mixer, b);
+   SDLTest_AssertCheck(result == (int) sizeof (stereo), "Validate converted voice size; expected: %i, got: %i", (int) sizeof (stereo), result);
+
+   /* Render more than was queued, the rest should be silence */
+   SDL_AudioMixerRender(mixer, (Uint8 *) out, sizeof (out));
+   SDLTest_AssertPass("Call to SDL_AudioMixerRender()");
+   SDLTest_AssertCheck(out[0] == 0.75f && out[1] == 0.25f, "Validate mixed frame; expected: 0.75, 0.25, got: %f, %f", out[0], out[1]);
+   SDLTest_AssertCheck(out[126] == 0.75f && out[127] == 0.25f, "Validate last mixed frame; got: %f, %f", out[126], out[127]);
+   SDLTest_AssertCheck(out[128] == 0.0f && out[255] == 0.0f, "Validate silence after underrun; got: %f, %f", out[128], out[255]);
+
+   /* A loud voice clips the sum, not each voice */
+   c = SDL_AudioMixerAddVoice(mixer, AUDIO_F32SYS, 2, 48000);
+   SDL_AudioMixerSetVoiceGain(mixer, c, 6.0f, 0.0f);
+   SDL_AudioMixerSetVoiceGain(mixer, a, -2.0f, 0.0f);
+   SDL_AudioMixerPutVoice(mixer, a, stereo, sizeof (stereo));
+   SDL_AudioMixerPutVoice(mixer, c, stereo, sizeof (stereo));
+   SDL_AudioMixerRender(mixer, (Uint8 *) out, sizeof (stereo));
+   SDLTest_AssertCheck(out[0] == 1.0f && out[1] == 1.0f, "Validate clipped frame; expected: 1.0, 1.0, got: %f, %f", out[0], out[1]);
+
+   SDL_AudioMixerRemoveVoice(mixer, c);
+   SDLTest_AssertPass("Call to SDL_AudioMixerRemoveVoice()");
+   result = SDL_AudioMixerPutVoice(mixer, c, stereo, sizeof (stereo));
+   SDLTest_AssertCheck(result == -1, "Validate removed voice is rejected; expected: -1, got: %i", result);
+   SDL_FreeAudioMixer(mixer);
+
+   /* Integer output is clipped by the conversion */
+   mixer = SDL_CreateAudioMixer(AUDIO_S16SYS, 2, 48000);
+   SDLTest_AssertCheck(mixer != NULL, "Validate S16 mixer is not NULL");
+   if (mixer == NULL) return TEST_ABORTED;
+   a = SDL_AudioMixerAddVoice(mixer, AUDIO_F32SYS, 2, 48000);
+   SDL_AudioMixerSetVoiceGain(mixer, a, 8.0f, 0.5f);
+   SDL_AudioMixerPutVoice(mixer, a, stereo, sizeof (stereo));
+   SDL_AudioMixerRender(mixer, (Uint8 *) out16, sizeof (out16));
+   SDLTest_AssertCheck(out16[0] == 32767 && out16[1] == 32767, "Validate clipped S16 frame; expected: 32767, 32767, got: %i, %i", out16[0], out16[1]);
+   SDL_AudioMixerSetVoiceGain(mixer, a, 1.0f, 0.5f);
+   SDL_AudioMixerPutVoice(mixer, a, stereo, sizeof (stereo));
+   SDL_AudioMixerRender(mixer, (Uint8 *) out16, sizeof (out16));
+   SDLTest_AssertCheck(SDL_abs(out16[0] - 4096) <= 1 && SDL_abs(out16[1] - 8192) <= 1,
+                       "Validate panned S16 frame; expected: 4096, 8192, got: %i, %i", out16[0], out16[1]);
+   SDL_FreeAudioMixer(mixer);
+
+   /* A partial frame at the end is filled with the format's silence */
+   mixer = SDL_CreateAudioMixer(AUDIO_U8, 2, 48000);
+   SDLTest_AssertCheck(mixer != NULL, "Validate U8 mixer is not NULL");
+   if (mixer == NULL) return TEST_ABORTED;
+   SDL_memset(out8, 0x55, sizeof (out8));
+   SDL_AudioMixerRender(mixer, out8, sizeof (out8));
+   SDLTest_AssertCheck(SDL_abs(out8[0] - 0x80) <= 1 && SDL_abs(out8[1] - 0x80) <= 1,
+                       "Validate U8 silent frame; expected: 0x80, got: 0x%x, 0x%x", out8[0], out8[1]);
+   SDLTest_AssertCheck(out8[2] == 0x80, "Validate U8 partial frame; expected: 0x80, got: 0x%x", out8[2]);
+   SDL_FreeAudioMixer(mixer);
+
+   /* The callback must not crash on the audio thread without a mixer */
+   SDL_ClearError();
+   SDL_memset(out16, 0x55, sizeof (out16));
+   SDL_AudioMixerCallback(NULL, (Uint8 *) out16, sizeof (out16));
+   SDLTest_AssertPass("Call to SDL_AudioMixerCallback(NULL, ...)");
+   SDLTest_AssertCheck(out16[0] == 0 && out16[63 * 2 + 1] == 0, "Validate silence without a mixer; got: %i, %i", out16[0], out16[63 * 2 + 1]);
+   SDLTest_AssertCheck(*SDL_GetError() != '\0', "Validate an error was set");
+
+   return TEST_COMPLETED;
+}
+
+/**
+ * \brief Queues audio through the fixed size ring and checks the xrun count.
+ *
+ * \sa https://wiki.libsdl.org/SDL_QueueAudio
+ * \sa https://wiki.libsdl.org/SDL_GetQueuedAudioXruns
+ */
+int audio_queueAudioRing()
+{
+   SDL_AudioDeviceID id;
+   SDL_AudioSpec desired, obtained;
+   Uint8 buffer[4096];
+   Uint32 size;
+   int result, i;
+
+   /* The dummy driver always has a device to queue to */
+   SDL_AudioQuit();
+   SDLTest_AssertPass("Call to SDL_AudioQuit()");
+   result = SDL_AudioInit("dummy");
+   SDLTest_AssertPass("Call to SDL_AudioInit(\"dummy\")");
+   SDLTest_AssertCheck(result == 0, "Validate result of SDL_AudioInit; expected: 0, got: %i", result);
+
+   SDL_SetHint(SDL_HINT_AUDIO_QUEUE_RING_SIZE, "4096");
+   SDLTest_AssertPass("Call to SDL_SetHint(SDL_HINT_AUDIO_QUEUE_RING_SIZE, \"4096\")");
+
+   SDL_zero(desired);
+   desired.freq = 22050;
+   desired.format = AUDIO_S16SYS;
+   desired.channels = 2;
+   desired.samples = 512;
+   desired.callback = NULL;
+   id = SDL_OpenAudioDevice(NULL, 0, &desired, &obtained, 0);
+   SDL_SetHint(SDL_HINT_AUDIO_QUEUE_RING_SIZE, NULL);
+   SDLTest_AssertPass("Call to SDL_OpenAudioDevice(NULL, 0, ...)");
+   SDLTest_AssertCheck(id > 0, "Validate device ID; expected: >0, got: %u", (unsigned int) id);
+   if (id == 0) {
+     SDLTest_LogError("%s", SDL_GetError());
+     SDL_AudioQuit();
+     SDL_AudioInit(NULL);
+     return TEST_ABORTED;
+   }
+
+   for (i = 0; i < sizeof (buffer); i++) {
+     buffer[i] = (Uint8) i;
+   }
+
+   /* The device is paused, so nothing drains yet */
+   result = SDL_QueueAudio(id, buffer, sizeof (buffer));
+   SDLTest_AssertCheck(result == 0, "Validate result of SDL_QueueAudio; expected: 0, got: %i", result);
+   size = SDL_GetQueuedAudioSize(id);
+   SDLTest_AssertCheck(size == sizeof (buffer), "Validate queued size; expected: %i, got: %u", (int) sizeof (buffer), size);
+   result = SDL_QueueAudio(id, buffer, 1);
+   SDLTest_AssertCheck(result == -1, "Validate queueing into a full ring fails; expected: -1, got: %i", result);
+   SDL_ClearQueuedAudio(id);
+   size = SDL_GetQueuedAudioSize(id);
+   SDLTest_AssertCheck(size == 0, "Validate queued size after clearing; expected: 0, got: %u", size);
+   SDLTest_AssertCheck(SDL_GetQueuedAudioXruns(id) == 0, "Validate no xruns while paused");
+
+   /* Wrap around the end of the ring, then let it run dry */
+   result = SDL_QueueAudio(id, buffer, 3000);
+   SDLTest_AssertCheck(result == 0, "Validate result of SDL_QueueAudio; expected: 0, got: %i", result);
+   SDL_PauseAudioDevice(id, 0);
+   for (i = 0; i < 100 && SDL_GetQueuedAudioXruns(id) == 0; i++) {
+     SDL_Delay(10);
+   }
+   SDLTest_AssertCheck(SDL_GetQueuedAudioSize(id) == 0, "Validate queue drained");
+   SDLTest_AssertCheck(SDL_GetQueuedAudioXruns(id) == 1, "Validate xrun count; expected: 1, got: %u", SDL_GetQueuedAudioXruns(id));
+   result = SDL_QueueAudio(id, buffer, sizeof (buffer));
+   SDLTest_AssertCheck(result == 0, "Validate result of SDL_QueueAudio across the wrap; expected: 0, got: %i", result);
+
+   SDL_CloseAudioDevice(id);
+   SDLTest_AssertPass("Call to SDL_CloseAudioDevice()");
+
+   /* Back to the default driver for the tests after this one */
+   SDL_AudioQuit();
+   SDLTest_AssertPass("Call to SDL_AudioQuit()");
+   result = SDL_AudioInit(NULL);
+   SDLTest_AssertPass("Call to SDL_AudioInit(NULL)");
+   SDLTest_AssertCheck(result == 0, "Validate result of SDL_AudioInit; expected: 0, got: %i", result);
+
+   return TEST_COMPLETED;
+}
+
+/* Writes a WAVE file header for 'datalen' bytes of data into 'wav' */
+static size_t
+_writeWAVHeader(Uint8 *wav, Uint16 tag, Uint16 channels, Uint16 bits, Uint16 blockalign, Uint16 samplesperblock, Uint32 datalen)
+{
+   const Uint32 fmtlen = (tag == 1) ? 16 : 20;
+   Uint32 fields[5];
+   Uint16 fmt[10];
+   size_t pos = 0;
+
+   fields[0] = SDL_SwapLE32(0x46464952); /* RIFF */
+   fields[1] = SDL_SwapLE32(4 + 8 + fmtlen + 8 + datalen);
+   fields[2] = SDL_SwapLE32(0x45564157); /* WAVE */
+   fields[3] = SDL_SwapLE32(0x20746D66); /* fmt  */
+   fields[4] = SDL_SwapLE32(fmtlen);
+   SDL_memcpy(wav + pos, fields, sizeof (fields));
+   pos += sizeof (fields);
+
+   fmt[0] = SDL_SwapLE16(tag);
+   fmt[1] = SDL_SwapLE16(channels);
+   fmt[2] = SDL_SwapLE16(22050);
+   fmt[3] = 0;
+   fmt[4] = 0;
+   fmt[5] = 0;
+   fmt[6] = SDL_SwapLE16(blockalign);
+   fmt[7] = SDL_SwapLE16(bits);
+   fmt[8] = SDL_SwapLE16(2);
+   fmt[9] = SDL_SwapLE16(samplesperblock);
+   SDL_memcpy(wav + pos, fmt, fmtlen);
+   pos += fmtlen;
+
+   fields[0] = SDL_SwapLE32(0x61746164); /* data */
+   fields[1] = SDL_SwapLE32(datalen);
+   SDL_memcpy(wav + pos, fields, 8);
+   return pos + 8;
+}
+
+/* Compares the output of a WAVE stream with SDL_LoadWAV_RW, reading in odd sizes and after seeking */
+static void
+_compareWAVStream(Uint8 *wav, size_t wavlen, Uint32 seekframe)
+{
+   SDL_AudioSpec loadspec, streamspec;
+   SDL_WAVStream *stream;
+   Uint8 *audio = NULL, *streamed;
+   Uint32 audiolen = 0, framesize, pos = 0;
+   int result, i;
+
+   SDL_LoadWAV_RW(SDL_RWFromConstMem(wav, (int) wavlen), 1, &loadspec, &audio, &audiolen);
+   SDLTest_AssertCheck(audio != NULL, "Validate SDL_LoadWAV_RW() result is not NULL");
+   stream = SDL_OpenWAVStream_RW(SDL_RWFromConstMem(wav, (int) wavlen), 1, &streamspec);
+   SDLTest_AssertPass("Call to SDL_OpenWAVStream_RW()");
+   SDLTest_AssertCheck(stream != NULL, "Validate stream is not NULL");
+   if (audio == NULL || stream == NULL) {
+     SDL_FreeWAV(audio);
+     SDL_CloseWAVStream(stream);
+     return;
+   }
+   SDLTest_AssertCheck(streamspec.format == loadspec.format && streamspec.channels == loadspec.channels && streamspec.freq == loadspec.freq,
+                       "Validate stream spec; expected: %04x %i %i, got: %04x %i %i",
+                       loadspec.format, loadspec.channels, loadspec.freq, streamspec.format, streamspec.channels, streamspec.freq);
+   framesize = SDL_AUDIO_BITSIZE(streamspec.format) / 8 * streamspec.channels;
+   SDLTest_AssertCheck(SDL_WAVStreamLength(stream) * framesize == audiolen,
+                       "Validate stream length; expected: %u, got: %u", audiolen / framesize, SDL_WAVStreamLength(stream));
+
+   streamed = (Uint8 *) SDL_malloc(audiolen + 4096);
+   SDLTest_AssertCheck(streamed != NULL, "Validate buffer is not NULL");
+   if (streamed != NULL) {
+     for (i = 1; (result = SDL_ReadWAVStream(stream, streamed + pos, i * 333)) > 0; i++) {
+       pos += (Uint32) result;
+     }
+     SDLTest_AssertCheck(result == 0, "Validate last SDL_ReadWAVStream() result; expected: 0, got: %i", result);
+     SDLTest_AssertCheck(pos == audiolen, "Validate streamed length; expected: %u, got: %u", audiolen, pos);
+     SDLTest_AssertCheck(SDL_memcmp(streamed, audio, SDL_min(pos, audiolen)) == 0, "Validate streamed data matches loaded data");
+
+     result = SDL_SeekWAVStream(stream, seekframe);
+     SDLTest_AssertCheck(result == 0, "Validate SDL_SeekWAVStream() result; expected: 0, got: %i", result);
+     result = SDL_ReadWAVStream(stream, streamed, 4096);
+     SDLTest_AssertCheck(result == (int) (4096 / framesize * framesize), "Validate read after seek; expected: %i, got: %i", (int) (4096 / framesize * framesize), result);
+     SDLTest_AssertCheck(result > 0 && SDL_memcmp(streamed, audio + seekframe * framesize, result) == 0, "Validate data after seek matches loaded data");
+     SDLTest_AssertCheck(SDL_WAVStreamTell(stream) == seekframe + result / framesize,
+                         "Validate stream position; expected: %u, got: %u", seekframe + result / framesize, SDL_WAVStreamTell(stream));
+
+     result = SDL_SeekWAVStream(stream, SDL_WAVStreamLength(stream) + 1);
+     SDLTest_AssertCheck(result == -1, "Validate seeking past the end fails; expected: -1, got: %i", result);
+     SDL_free(streamed);
+   }
+
+   SDL_CloseWAVStream(stream);
+   SDLTest_AssertPass("Call to SDL_CloseWAVStream()");
+   SDL_FreeWAV(audio);
+}
+
+/**
+ * \brief Streams PCM and IMA ADPCM WAVE data and compares it with SDL_LoadWAV_RW.
+ *
+ * \sa https://wiki.libsdl.org/SDL_LoadWAV_RW
+ */
+int audio_streamWAV()
+{
+   const Uint32 pcmframes = 10000;
+   const Uint16 imablocks = 9, imaalign = 256;
+   Uint8 *wav;
+   size_t pos, i;
+
+   wav = (Uint8 *) SDL_malloc(64 + pcmframes * 4);
+   SDLTest_AssertCheck(wav != NULL, "Validate buffer is not NULL");
+   if (wav == NULL) return TEST_ABORTED;
+
+   /* Stereo 16-bit PCM, decoded in more than one piece */
+   pos = _writeWAVHeader(wav, 1, 2, 16, 4, 0, pcmframes * 4);
+   for (i = 0; i < pcmframes * 4; i++) {
+     wav[pos + i] = (Uint8) (i * 7 + i / 13);
+   }
+   _compareWAVStream(wav, pos + pcmframes * 4, 6000);
+
+   /* Mono IMA ADPCM, seeking into the middle of a block */
+   pos = _writeWAVHeader(wav, 0x11, 1, 4, imaalign, (imaalign - 4) * 2 + 1, imablocks * imaalign);
+   for (i = 0; i < (size_t) imablocks * imaalign; i++) {
+     wav[pos + i] = (Uint8) (i * 11 + i / 7);
+     if (i % imaalign == 2) {
+       wav[pos + i] %= 89; /* step index */
+     } else if (i % imaalign == 3) {
+       wav[pos + i] = 0;
+     }
+   }
+   _compareWAVStream(wav, pos + imablocks * imaalign, 1000);
+
+   SDL_free(wav);
+
+   return TEST_COMPLETED;
+}
+
+/* Reads sample (i) of (format) as a number in the format's own range, e.g. 0 to 65535 for U16 */
+static Sint64 _readSample(const Uint8 *buf, SDL_AudioFormat format, int i)
+{
+   const int bytes = SDL_AUDIO_BITSIZE(format) / 8;
+   const Uint8 *p = buf + i * bytes;
+   Uint32 value = 0;
+   int b;
+
+   for (b = 0; b < bytes; b++) {
+     const int shift = SDL_AUDIO_ISBIGENDIAN(format) ? (bytes - 1 - b) * 8 : b * 8;
+     value |= ((Uint32) p[b]) << shift;
+   }
+   if (!SDL_AUDIO_ISSIGNED(format)) {
+     return (Sint64) value;
+   } else if (bytes == 1) {
+     return (Sint8) value;
+   } else if (bytes == 2) {
+     return (Sint16) value;
+   }
+   return (Sint32) value;
+}
+
+/**
+ * \brief Converts float audio streams to every integer format, with and without dither.
+ *
+ * \sa https://wiki.libsdl.org/SDL_NewAudioStream
+ */
+int audio_streamDither()
+{
+   const SDL_AudioFormat formats[] = { AUDIO_U8, AUDIO_S8, AUDIO_S16LSB, AUDIO_S16MSB, AUDIO_U16LSB, AUDIO_U16MSB, AUDIO_S32LSB, AUDIO_S32MSB };
+   const int samples = 1000;
+   float input[1000];
+   Uint8 output[1000 * 4];
+   Uint8 reference[2000 * 4];
+   SDL_AudioStream *stream;
+   int dither, f, i, got, maxdiff, changed;
+
+   /* A ramp from below -1 to above 1, to check the clamping too */
+   for (i = 0; i < samples; i++) {
+     input[i] = ((float) (i - samples / 2)) / (samples * 0.4f);
+   }
+
+   for (dither = 0; dither <= 1; dither++) {
+     SDL_SetHint(SDL_HINT_AUDIO_DITHER, dither ? "1" : "0");
+     for (f = 0; f < SDL_arraysize(formats); f++) {
+       const SDL_AudioFormat format = formats[f];
+       const int bits = SDL_AUDIO_BITSIZE(format);
+       const Sint64 bias = SDL_AUDIO_ISSIGNED(format) ? 0 : ((Sint64) 1 << (bits - 1));
+
+       stream = SDL_NewAudioStream(AUDIO_F32SYS, 2, 48000, format, 2, 48000);
+       SDLTest_AssertPass("Call to SDL_NewAudioStream(AUDIO_F32SYS, ..., 0x%.4x, ...), dither %d", format, dither);
+       SDLTest_AssertCheck(stream != NULL, "Validate stream is not NULL");
+       if (stream == NULL) continue;
+
+       SDL_AudioStreamPut(stream, input, sizeof (input));
+       got = SDL_AudioStreamGet(stream, output, sizeof (output));
+       SDLTest_AssertCheck(got == samples * bits / 8, "Validate got %d bytes, expected %d", got, samples * bits / 8);
+
+       maxdiff = 0;
+       changed = 0;
+       for (i = 0; i < samples; i++) {
+         const float sample = SDL_max(-1.0f, SDL_min(input[i], 1.0f));
+         Sint64 expected, diff;
+         if (bits == 32) {
+           expected = (Sint64) (((Sint32) (sample * 8388607.0f)) * 256);
+         } else {
+           const int half = 1 << (bits - 1);
+           expected = ((Sint64) ((sample * (half - 1)) + (half + 0.5f))) - half + bias;
+         }
+         diff = _readSample(output, format, i) - expected;
+         diff = (diff < 0) ? -diff : diff;
+         maxdiff = SDL_max(maxdiff, (int) diff);
+         changed += (diff != 0);
+       }
+       if (dither && bits < 32) {
+         SDLTest_AssertCheck(maxdiff <= 1, "Validate dithered samples are within 1 LSB, got %d", maxdiff);
+         SDLTest_AssertCheck(changed > 0 && changed < samples, "Validate dither changed some samples, changed %d", changed);
+       } else {
+         SDLTest_AssertCheck(maxdiff == 0, "Validate samples are rounded, max difference %d", maxdiff);
+       }
+
+       SDL_FreeAudioStream(stream);
+     }
+   }
+
+   /* Resampled and remixed, the integer output matches the float output */
+   SDL_SetHint(SDL_HINT_AUDIO_DITHER, "0");
+   for (f = 0; f < 2; f++) {
+     stream = SDL_NewAudioStream(AUDIO_F32SYS, 1, 44100, f ? AUDIO_S16MSB : AUDIO_F32SYS, 2, 48000);
+     SDLTest_AssertCheck(stream != NULL, "Validate resampling stream %d is not NULL", f);
+     if (stream == NULL) continue;
+     SDL_AudioStreamPut(stream, input + samples / 4, (samples / 2) * sizeof (float));
+     SDL_AudioStreamFlush(stream);
+     got = SDL_AudioStreamGet(stream, f ? output : reference, sizeof (reference));
+     SDLTest_AssertCheck(got > 0, "Validate resampling stream %d gave %d bytes", f, got);
+     SDL_FreeAudioStream(stream);
+   }
+   maxdiff = 0;
+   for (i = 0; i < got / 2; i++) {
+     const Sint64 expected = (Sint64) SDL_floor(((const float *) reference)[i] * 32767.0f + 0.5f);
+     const Sint64 diff = _readSample(output, AUDIO_S16MSB, i) - expected;
+     maxdiff = SDL_max(maxdiff, (int) (diff < 0 ? -diff : diff));
+   }
+   SDLTest_AssertCheck(maxdiff <= 1, "Validate resampled S16 output matches float output, max difference %d", maxdiff);
+
+   /* Dither is off unless asked for, and never turns silence into noise */
+   SDL_memset(input, 0, sizeof (input));
+   for (dither = 0; dither <= 1; dither++) {
+     SDL_SetHint(SDL_HINT_AUDIO_DITHER, dither ? "1" : NULL);
+     stream = SDL_NewAudioStream(AUDIO_F32SYS, 2, 48000, AUDIO_S16SYS, 2, 48000);
+     SDLTest_AssertCheck(stream != NULL, "Validate silent stream %d is not NULL", dither);
+     if (stream == NULL) continue;
+     SDL_AudioStreamPut(stream, input, sizeof (input));
+     got = SDL_AudioStreamGet(stream, output, sizeof (output));
+     changed = 0;
+     for (i = 0; i < got / 2; i++) {
+       changed += (_readSample(output, AUDIO_S16SYS, i) != 0);
+     }
+     SDLTest_AssertCheck(got == samples * 2 && changed == 0, "Validate silence stays silent, dither %d, got %d bytes, %d nonzero", dither, got, changed);
+     SDL_FreeAudioStream(stream);
+   }
+
+   SDL_SetHint(SDL_HINT_AUDIO_DITHER, NULL);
+
+   return TEST_COMPLETED;
+}
+
 
 /* ================= Test Case References ================== */
 
@@ -1022,11 +1457,24 @@ static const SDLTest_TestCaseReference audioTest14 =
 static const SDLTest_TestCaseReference audioTest15 =
         { (SDLTest_TestCaseFp)audio_pauseUnpauseAudio, "audio_pauseUnpauseAudio", "Pause and Unpause audio for various audio specs while testing callback.", TEST_ENABLED };
 
+static const SDLTest_TestCaseReference audioTest16 =
+        { (SDLTest_TestCaseFp)audio_mixVoices, "audio_mixVoices", "Mix several voices with gain, pan and clipping.", TEST_ENABLED };
+
+static const SDLTest_TestCaseReference audioTest17 =
+        { (SDLTest_TestCaseFp)audio_queueAudioRing, "audio_queueAudioRing", "Queue audio through a fixed size ring and count xruns.", TEST_ENABLED };
+
+static const SDLTest_TestCaseReference audioTest18 =
+        { (SDLTest_TestCaseFp)audio_streamWAV, "audio_streamWAV", "Stream WAVE data and compare it with the loaded data.", TEST_ENABLED };
+
+static const SDLTest_TestCaseReference audioTest19 =
+        { (SDLTest_TestCaseFp)audio_streamDither, "audio_streamDither", "Convert float audio streams to integer formats, with and without dither.", TEST_ENABLED };
+
 /* Sequence of Audio test cases */
 static const SDLTest_TestCaseReference *audioTests[] =  {
     &audioTest1, &audioTest2, &audioTest3, &audioTest4, &audioTest5, &audioTest6,
     &audioTest7, &audioTest8, &audioTest9, &audioTest10, &audioTest11,
-    &audioTest12, &audioTest13, &audioTest14, &audioTest15, NULL
+    &audioTest12, &audioTest13, &audioTest14, &audioTest15, &audioTest16, &audioTest17,
+    &audioTest18, &audioTest19, NULL
 };
 
 /* Audio test suite (global) */
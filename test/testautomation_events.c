@@ -174,6 +174,127 @@ events_addDelEventWatchWithUserdata(void *arg)
    return TEST_COMPLETED;
 }
 
+/**
+ * @brief Push several events and poll them back in a batch, filtered by type.
+ *
+ * @sa http://wiki.libsdl.org/moin.cgi/SDL_PollEvents
+ */
+int
+events_pushAndPollEventsBatch(void *arg)
+{
+   SDL_Event event;
+   SDL_Event events[16];
+   int i, result;
+
+   /* Start with an empty queue */
+   SDL_PumpEvents();
+   SDL_FlushEvents(SDL_FIRSTEVENT, SDL_LASTEVENT);
+
+   /* Interleave user events with events of another type */
+   for (i = 0; i < 8; i++) {
+      SDL_zero(event);
+      event.type = SDL_USEREVENT;
+      event.user.code = i;
+      SDL_PushEvent(&event);
+
+      SDL_zero(event);
+      event.type = SDL_USEREVENT + 1;
+      event.user.code = i;
+      SDL_PushEvent(&event);
+   }
+   SDLTest_AssertPass("Call to SDL_PushEvent() 16 times");
+
+   /* Only the user events should come back, in order */
+   result = SDL_PollEvents(events, SDL_arraysize(events), SDL_USEREVENT, SDL_USEREVENT);
+   SDLTest_AssertPass("Call to SDL_PollEvents()");
+   SDLTest_AssertCheck(result == 8, "Check result from SDL_PollEvents, expected: 8, got: %d", result);
+   for (i = 0; i < result; i++) {
+      SDLTest_AssertCheck(events[i].type == SDL_USEREVENT && events[i].user.code == i,
+                          "Check event %d, expected: type %d code %d, got: type %d code %d",
+                          i, SDL_USEREVENT, i, events[i].type, events[i].user.code);
+   }
+
+   /* The rest are still queued, and are limited by numevents */
+   result = SDL_PollEvents(events, 5, SDL_FIRSTEVENT, SDL_LASTEVENT);
+   SDLTest_AssertPass("Call to SDL_PollEvents()");
+   SDLTest_AssertCheck(result == 5, "Check result from SDL_PollEvents, expected: 5, got: %d", result);
+   result = SDL_PollEvents(events, SDL_arraysize(events), SDL_USEREVENT + 1, SDL_USEREVENT + 1);
+   SDLTest_AssertCheck(result == 3, "Check result from SDL_PollEvents, expected: 3, got: %d", result);
+   SDLTest_AssertCheck(result < 1 || events[0].user.code == 5, "Check first remaining event code, expected: 5, got: %d", events[0].user.code);
+
+   /* Invalid parameters */
+   result = SDL_PollEvents(NULL, 1, SDL_FIRSTEVENT, SDL_LASTEVENT);
+   SDLTest_AssertCheck(result == -1, "Check result from SDL_PollEvents(NULL), expected: -1, got: %d", result);
+
+   return TEST_COMPLETED;
+}
+
+/**
+ * @brief Check that consecutive motion events are coalesced when the hint is set.
+ *
+ * @sa http://wiki.libsdl.org/moin.cgi/SDL_GetCoalescedEventCount
+ */
+int
+events_coalesceMotion(void *arg)
+{
+   SDL_Event event;
+   SDL_Event events[8];
+   int i, folded, result;
+
+   SDL_PumpEvents();
+   SDL_FlushEvents(SDL_FIRSTEVENT, SDL_LASTEVENT);
+   SDL_SetHint(SDL_HINT_EVENT_COALESCE_MOTION, "1");
+   folded = SDL_GetCoalescedEventCount(SDL_MOUSEMOTION);
+
+   /* Three moves, a click, then two more moves */
+   for (i = 0; i < 5; i++) {
+      if (i == 3) {
+         SDL_zero(event);
+         event.type = SDL_MOUSEBUTTONDOWN;
+         event.button.button = SDL_BUTTON_LEFT;
+         SDL_PushEvent(&event);
+      }
+      SDL_zero(event);
+      event.type = SDL_MOUSEMOTION;
+      event.motion.x = 10 * (i + 1);
+      event.motion.y = 20 * (i + 1);
+      event.motion.xrel = 10;
+      event.motion.yrel = 20;
+      SDL_PushEvent(&event);
+   }
+   SDLTest_AssertPass("Call to SDL_PushEvent() 6 times");
+
+   result = SDL_PeepEvents(events, SDL_arraysize(events), SDL_GETEVENT, SDL_FIRSTEVENT, SDL_LASTEVENT);
+   SDLTest_AssertCheck(result == 3, "Check number of queued events, expected: 3, got: %d", result);
+   if (result == 3) {
+      SDLTest_AssertCheck(events[0].type == SDL_MOUSEMOTION && events[0].motion.x == 30 && events[0].motion.xrel == 30 && events[0].motion.yrel == 60,
+                          "Check first merged motion, expected: x 30 xrel 30 yrel 60, got: x %d xrel %d yrel %d",
+                          events[0].motion.x, events[0].motion.xrel, events[0].motion.yrel);
+      SDLTest_AssertCheck(events[1].type == SDL_MOUSEBUTTONDOWN, "Check button event is kept in order");
+      SDLTest_AssertCheck(events[2].type == SDL_MOUSEMOTION && events[2].motion.x == 50 && events[2].motion.xrel == 20,
+                          "Check second merged motion, expected: x 50 xrel 20, got: x %d xrel %d",
+                          events[2].motion.x, events[2].motion.xrel);
+   }
+   result = SDL_GetCoalescedEventCount(SDL_MOUSEMOTION) - folded;
+   SDLTest_AssertCheck(result == 3, "Check SDL_GetCoalescedEventCount(), expected: 3, got: %d", result);
+
+   /* Different fingers aren't merged */
+   for (i = 0; i < 4; i++) {
+      SDL_zero(event);
+      event.type = SDL_FINGERMOTION;
+      event.tfinger.fingerId = i / 2;
+      event.tfinger.dx = 0.25f;
+      SDL_PushEvent(&event);
+   }
+   result = SDL_PeepEvents(events, SDL_arraysize(events), SDL_GETEVENT, SDL_FIRSTEVENT, SDL_LASTEVENT);
+   SDLTest_AssertCheck(result == 2, "Check number of queued finger events, expected: 2, got: %d", result);
+   SDLTest_AssertCheck(result < 1 || events[0].tfinger.dx == 0.5f, "Check merged finger motion, expected: 0.5, got: %f", events[0].tfinger.dx);
+
+   SDL_SetHint(SDL_HINT_EVENT_COALESCE_MOTION, NULL);
+
+   return TEST_COMPLETED;
+}
+
 
 /* ================= Test References ================== */
 
@@ -187,9 +308,15 @@ static const SDLTest_TestCaseReference eventsTest2 =
 static const SDLTest_TestCaseReference eventsTest3 =
         { (SDLTest_TestCaseFp)events_addDelEventWatchWithUserdata, "events_addDelEventWatchWithUserdata", "Adds and deletes an event watch function with userdata", TEST_ENABLED };
 
+static const SDLTest_TestCaseReference eventsTest4 =
+        { (SDLTest_TestCaseFp)events_pushAndPollEventsBatch, "events_pushAndPollEventsBatch", "Pushes events and polls them back in a batch, filtered by type", TEST_ENABLED };
+
+static const SDLTest_TestCaseReference eventsTest5 =
+        { (SDLTest_TestCaseFp)events_coalesceMotion, "events_coalesceMotion", "Checks that consecutive motion events are coalesced", TEST_ENABLED };
+
 /* Sequence of Events test cases */
 static const SDLTest_TestCaseReference *eventsTests[] =  {
-    &eventsTest1, &eventsTest2, &eventsTest3, NULL
+    &eventsTest1, &eventsTest2, &eventsTest3, &eventsTest4, &eventsTest5, NULL
 };
 
 /* Events test suite (global) */
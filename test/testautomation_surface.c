@@ -589,6 +589,198 @@ surface_testBlitBlendLoop(void *arg) {
 
 }
 
+/* Fill a 32-bit surface with a function of the pixel position */
+static void
+_fillStretchSurface(SDL_Surface *surface, int checkerboard)
+{
+   int x, y;
+
+   for (y = 0; y < surface->h; y++) {
+      Uint32 *row = (Uint32 *)((Uint8 *)surface->pixels + y * surface->pitch);
+      for (x = 0; x < surface->w; x++) {
+         if (checkerboard) {
+            row[x] = ((x ^ y) & 1) ? 0xFFFFFFFF : 0x00000000;
+         } else {
+            row[x] = SDL_MapRGBA(surface->format, (Uint8)(x * 7), (Uint8)(y * 11), (Uint8)(x + y), 0xFF);
+         }
+      }
+   }
+}
+
+/* Check that every pixel of a surface is within tolerance of a color */
+static int
+_countStretchErrors(SDL_Surface *surface, Uint32 color, int tolerance)
+{
+   int x, y, c, errors = 0;
+
+   for (y = 0; y < surface->h; y++) {
+      const Uint32 *row = (const Uint32 *)((const Uint8 *)surface->pixels + y * surface->pitch);
+      for (x = 0; x < surface->w; x++) {
+         for (c = 0; c < 32; c += 8) {
+            if (SDL_abs((int)((row[x] >> c) & 0xFF) - (int)((color >> c) & 0xFF)) > tolerance) {
+               errors++;
+               break;
+            }
+         }
+      }
+   }
+   return errors;
+}
+
+/**
+ * @brief Tests filtered stretching with SDL_SoftStretchLinear
+ *
+ * @sa http://wiki.libsdl.org/SDL_SoftStretchLinear
+ */
+int
+surface_testSoftStretchLinear(void *arg)
+{
+   SDL_Surface *src, *dst, *other;
+   SDL_Rect rect;
+   int ret, errors;
+
+   src = SDL_CreateRGBSurfaceWithFormat(0, 64, 48, 32, SDL_PIXELFORMAT_ARGB8888);
+   dst = SDL_CreateRGBSurfaceWithFormat(0, 64, 48, 32, SDL_PIXELFORMAT_ARGB8888);
+   SDLTest_AssertCheck(src != NULL && dst != NULL, "Verify surfaces are not NULL");
+   if (src == NULL || dst == NULL) {
+      return TEST_ABORTED;
+   }
+
+   /* Same size copies the pixels unchanged */
+   _fillStretchSurface(src, 0);
+   ret = SDL_SoftStretchLinear(src, NULL, dst, NULL);
+   SDLTest_AssertPass("Call to SDL_SoftStretchLinear() with the same size");
+   SDLTest_AssertCheck(ret == 0, "Verify result value; expected: 0, got: %i", ret);
+   errors = SDL_memcmp(src->pixels, dst->pixels, src->h * src->pitch);
+   SDLTest_AssertCheck(errors == 0, "Verify the pixels are unchanged");
+
+   /* A solid color stays solid when enlarged or shrunk */
+   SDL_FillRect(src, NULL, 0x80C04020);
+   rect.x = 3;
+   rect.y = 2;
+   rect.w = 7;
+   rect.h = 5;
+   ret = SDL_SoftStretchLinear(src, &rect, dst, NULL);
+   SDLTest_AssertPass("Call to SDL_SoftStretchLinear() enlarging a solid color");
+   SDLTest_AssertCheck(ret == 0, "Verify result value; expected: 0, got: %i", ret);
+   errors = _countStretchErrors(dst, 0x80C04020, 0);
+   SDLTest_AssertCheck(errors == 0, "Verify enlarged color; expected: 0 errors, got: %i", errors);
+
+   SDL_FillRect(dst, NULL, 0);
+   rect.w = 13;
+   rect.h = 11;
+   ret = SDL_SoftStretchLinear(src, NULL, dst, &rect);
+   SDLTest_AssertPass("Call to SDL_SoftStretchLinear() shrinking a solid color");
+   SDLTest_AssertCheck(ret == 0, "Verify result value; expected: 0, got: %i", ret);
+   other = SDL_CreateRGBSurfaceWithFormatFrom((Uint8 *)dst->pixels + rect.y * dst->pitch + rect.x * 4,
+                                              rect.w, rect.h, 32, dst->pitch, SDL_PIXELFORMAT_ARGB8888);
+   errors = other ? _countStretchErrors(other, 0x80C04020, 0) : -1;
+   SDLTest_AssertCheck(errors == 0, "Verify shrunk color; expected: 0 errors, got: %i", errors);
+   SDL_FreeSurface(other);
+   errors = _countStretchErrors(dst, 0, 0);
+   SDLTest_AssertCheck(errors == rect.w * rect.h, "Verify pixels outside dstrect are untouched; expected: %i changed, got: %i", rect.w * rect.h, errors);
+
+   /* Halving a checkerboard averages it to gray instead of aliasing */
+   _fillStretchSurface(src, 1);
+   other = SDL_CreateRGBSurfaceWithFormat(0, 32, 24, 32, SDL_PIXELFORMAT_ARGB8888);
+   SDLTest_AssertCheck(other != NULL, "Verify surface is not NULL");
+   if (other != NULL) {
+      ret = SDL_SoftStretchLinear(src, NULL, other, NULL);
+      SDLTest_AssertPass("Call to SDL_SoftStretchLinear() halving a checkerboard");
+      SDLTest_AssertCheck(ret == 0, "Verify result value; expected: 0, got: %i", ret);
+      errors = _countStretchErrors(other, 0x80808080, 1);
+      SDLTest_AssertCheck(errors == 0, "Verify averaged color; expected: 0 errors, got: %i", errors);
+      SDL_FreeSurface(other);
+   }
+
+   /* Formats must match and be 32-bit */
+   other = SDL_CreateRGBSurfaceWithFormat(0, 32, 24, 32, SDL_PIXELFORMAT_ABGR8888);
+   if (other != NULL) {
+      ret = SDL_SoftStretchLinear(src, NULL, other, NULL);
+      SDLTest_AssertPass("Call to SDL_SoftStretchLinear() with different formats");
+      SDLTest_AssertCheck(ret == -1, "Verify result value; expected: -1, got: %i", ret);
+      SDL_FreeSurface(other);
+   }
+   other = SDL_CreateRGBSurfaceWithFormat(0, 32, 24, 16, SDL_PIXELFORMAT_RGB565);
+   if (other != NULL) {
+      ret = SDL_SoftStretchLinear(other, NULL, other, &rect);
+      SDLTest_AssertPass("Call to SDL_SoftStretchLinear() with a 16-bit format");
+      SDLTest_AssertCheck(ret == -1, "Verify result value; expected: -1, got: %i", ret);
+      SDL_FreeSurface(other);
+   }
+
+   SDL_FreeSurface(dst);
+   SDL_FreeSurface(src);
+   return TEST_COMPLETED;
+}
+
+/**
+ * @brief Tests that blits pick up palette changes after remapping
+ *
+ * @sa http://wiki.libsdl.org/SDL_SetPaletteColors
+ */
+int
+surface_testBlitPaletteChanges(void *arg)
+{
+   SDL_Surface *src, *dst1, *dst2, *indexed;
+   SDL_Color colors[2];
+   Uint32 pixel;
+   int ret, i;
+
+   src = SDL_CreateRGBSurfaceWithFormat(0, 1, 1, 8, SDL_PIXELFORMAT_INDEX8);
+   dst1 = SDL_CreateRGBSurfaceWithFormat(0, 1, 1, 32, SDL_PIXELFORMAT_ARGB8888);
+   dst2 = SDL_CreateRGBSurfaceWithFormat(0, 1, 1, 32, SDL_PIXELFORMAT_ARGB8888);
+   indexed = SDL_CreateRGBSurfaceWithFormat(0, 1, 1, 8, SDL_PIXELFORMAT_INDEX8);
+   SDLTest_AssertCheck(src != NULL && dst1 != NULL && dst2 != NULL && indexed != NULL, "Verify surfaces are not NULL");
+   if (src == NULL || dst1 == NULL || dst2 == NULL || indexed == NULL) {
+      return TEST_ABORTED;
+   }
+   *(Uint8 *)src->pixels = 0;
+
+   /* Blit to two destinations in turn, so the source is remapped each time */
+   colors[0].r = 255; colors[0].g = 0; colors[0].b = 0; colors[0].a = 255;
+   SDL_SetPaletteColors(src->format->palette, colors, 0, 1);
+   for (i = 0; i < 2; i++) {
+      SDL_BlitSurface(src, NULL, dst1, NULL);
+      SDL_BlitSurface(src, NULL, dst2, NULL);
+   }
+   pixel = *(Uint32 *)dst2->pixels;
+   SDLTest_AssertCheck(pixel == 0xFFFF0000, "Verify blitted pixel, expected: 0xFFFF0000, got: 0x%.8x", pixel);
+
+   colors[0].r = 0; colors[0].g = 255;
+   SDL_SetPaletteColors(src->format->palette, colors, 0, 1);
+   SDLTest_AssertPass("Call to SDL_SetPaletteColors() on the source");
+   SDL_BlitSurface(src, NULL, dst1, NULL);
+   pixel = *(Uint32 *)dst1->pixels;
+   SDLTest_AssertCheck(pixel == 0xFF00FF00, "Verify blitted pixel, expected: 0xFF00FF00, got: 0x%.8x", pixel);
+
+   /* Changing the destination palette changes the mapping too */
+   colors[0].r = 0; colors[0].g = 0; colors[0].b = 255;
+   colors[1].r = 0; colors[1].g = 255; colors[1].b = 0; colors[1].a = 255;
+   SDL_SetPaletteColors(indexed->format->palette, colors, 0, 2);
+   ret = SDL_BlitSurface(src, NULL, indexed, NULL);
+   SDLTest_AssertCheck(ret == 0, "Verify result from SDL_BlitSurface, expected: 0, got: %i", ret);
+   SDL_BlitSurface(src, NULL, dst2, NULL);
+   SDL_BlitSurface(src, NULL, indexed, NULL);
+   pixel = *(Uint8 *)indexed->pixels;
+   SDLTest_AssertCheck(pixel == 1, "Verify blitted index, expected: 1, got: %u", (unsigned int) pixel);
+
+   colors[0] = colors[1];
+   colors[1].g = 0; colors[1].b = 255;
+   SDL_SetPaletteColors(indexed->format->palette, colors, 0, 2);
+   SDLTest_AssertPass("Call to SDL_SetPaletteColors() on the destination");
+   SDL_BlitSurface(src, NULL, dst2, NULL);
+   SDL_BlitSurface(src, NULL, indexed, NULL);
+   pixel = *(Uint8 *)indexed->pixels;
+   SDLTest_AssertCheck(pixel == 0, "Verify blitted index, expected: 0, got: %u", (unsigned int) pixel);
+
+   SDL_FreeSurface(indexed);
+   SDL_FreeSurface(dst2);
+   SDL_FreeSurface(dst1);
+   SDL_FreeSurface(src);
+   return TEST_COMPLETED;
+}
+
 /* ================= Test References ================== */
 
 /* Surface test cases */
@@ -631,11 +823,18 @@ static const SDLTest_TestCaseReference surfaceTest11 =
 static const SDLTest_TestCaseReference surfaceTest12 =
         { (SDLTest_TestCaseFp)surface_testBlitBlendMod, "surface_testBlitBlendMod", "Tests blitting routines with mod blending mode.", TEST_ENABLED};
 
+static const SDLTest_TestCaseReference surfaceTest13 =
+        { (SDLTest_TestCaseFp)surface_testSoftStretchLinear, "surface_testSoftStretchLinear", "Tests filtered stretching with SDL_SoftStretchLinear.", TEST_ENABLED};
+
+static const SDLTest_TestCaseReference surfaceTest14 =
+        { (SDLTest_TestCaseFp)surface_testBlitPaletteChanges, "surface_testBlitPaletteChanges", "Tests that blits pick up palette changes after remapping.", TEST_ENABLED};
+
 /* Sequence of Surface test cases */
 static const SDLTest_TestCaseReference *surfaceTests[] =  {
     &surfaceTest1, &surfaceTest2, &surfaceTest3, &surfaceTest4, &surfaceTest5,
     &surfaceTest6, &surfaceTest7, &surfaceTest8, &surfaceTest9, &surfaceTest10,
-    &surfaceTest11, &surfaceTest12, NULL
+    &surfaceTest11, &surfaceTest12, &surfaceTest13,
+    &surfaceTest14, NULL
 };
 
 /* Surface test suite (global) */
@@ -0,0 +1,247 @@
+/*
+  Copyright (C) 1997-2020 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely.
+*/
+/* Benchmark alpha blended blits between 32-bit formats with each of the
+   SIMD blitters, and check them against an exact blend */
+
+#include <stdlib.h>
+#include <stdio.h>
+
+#include "SDL.h"
+
+/* These match SDL_CPU_* in src/video/SDL_blit.h, for SDL_BLIT_CPU_FEATURES */
+#define BLIT_CPU_SSE41  0x40
+#define BLIT_CPU_AVX2   0x80
+
+typedef struct
+{
+    Uint32 src_format;
+    Uint32 dst_format;
+    int surface_alpha;      /* -1 for per-pixel alpha */
+} Blit;
+
+static const Blit blits[] = {
+    { SDL_PIXELFORMAT_ARGB8888, SDL_PIXELFORMAT_ARGB8888, -1 },
+    { SDL_PIXELFORMAT_ARGB8888, SDL_PIXELFORMAT_RGB888, -1 },
+    { SDL_PIXELFORMAT_ABGR8888, SDL_PIXELFORMAT_ARGB8888, -1 },
+    { SDL_PIXELFORMAT_ARGB8888, SDL_PIXELFORMAT_ABGR8888, -1 },
+    { SDL_PIXELFORMAT_RGBA8888, SDL_PIXELFORMAT_BGRA8888, -1 },
+    { SDL_PIXELFORMAT_BGRA8888, SDL_PIXELFORMAT_RGBX8888, -1 },
+    { SDL_PIXELFORMAT_RGB888, SDL_PIXELFORMAT_RGB888, 100 },
+    { SDL_PIXELFORMAT_RGB888, SDL_PIXELFORMAT_ARGB8888, 128 },
+    { SDL_PIXELFORMAT_BGR888, SDL_PIXELFORMAT_RGB888, 200 },
+    { SDL_PIXELFORMAT_RGBX8888, SDL_PIXELFORMAT_ABGR8888, 37 },
+};
+
+typedef struct
+{
+    const char *name;
+    unsigned int features;
+} Config;
+
+static Config configs[] = {
+    { "C", 0 },
+    { "SSE4.1", BLIT_CPU_SSE41 },
+    { "AVX2", BLIT_CPU_SSE41 | BLIT_CPU_AVX2 },
+};
+
+static int width = 1920;
+static int height = 1080;
+
+static double
+Elapsed(Uint64 start)
+{
+    return (double) (SDL_GetPerformanceCounter() - start) / SDL_GetPerformanceFrequency();
+}
+
+static SDL_Surface *
+CreateRandomSurface(Uint32 format)
+{
+    SDL_Surface *surface = SDL_CreateRGBSurfaceWithFormat(0, width, height, 32, format);
+    int x, y;
+
+    if (surface) {
+        for (y = 0; y < surface->h; ++y) {
+            Uint32 *row = (Uint32 *) ((Uint8 *) surface->pixels + y * surface->pitch);
+            for (x = 0; x < surface->w; ++x) {
+                row[x] = ((Uint32) rand() << 16) ^ (Uint32) rand();
+            }
+        }
+    }
+    return surface;
+}
+
+/* Blend with the same arithmetic as ALPHA_BLEND_RGBA in SDL_blit.h */
+static void
+BlendExact(SDL_Surface *src, SDL_Surface *dst, int surface_alpha)
+{
+    int x, y;
+
+    for (y = 0; y < src->h; ++y) {
+        const Uint32 *s = (const Uint32 *) ((const Uint8 *) src->pixels + y * src->pitch);
+        Uint32 *d = (Uint32 *) ((Uint8 *) dst->pixels + y * dst->pitch);
+        for (x = 0; x < src->w; ++x) {
+            Uint8 sR, sG, sB, sA, dR, dG, dB, dA;
+            SDL_GetRGBA(s[x], src->format, &sR, &sG, &sB, &sA);
+            if (surface_alpha >= 0) {
+                sA = (Uint8) surface_alpha;
+            }
+            if (!sA) {
+                continue;
+            }
+            SDL_GetRGBA(d[x], dst->format, &dR, &dG, &dB, &dA);
+            if (!dst->format->Amask) {
+                dA = 0;
+            }
+            dR = (Uint8) ((((int) sR - dR) * sA) / 255 + dR);
+            dG = (Uint8) ((((int) sG - dG) * sA) / 255 + dG);
+            dB = (Uint8) ((((int) sB - dB) * sA) / 255 + dB);
+            dA = (Uint8) (sA + dA - (sA * dA) / 255);
+            d[x] = SDL_MapRGBA(dst->format, dR, dG, dB, dA);
+        }
+    }
+}
+
+static int
+CountDifferences(SDL_Surface *a, SDL_Surface *b)
+{
+    int x, y, count = 0;
+
+    for (y = 0; y < a->h; ++y) {
+        const Uint32 *pa = (const Uint32 *) ((const Uint8 *) a->pixels + y * a->pitch);
+        const Uint32 *pb = (const Uint32 *) ((const Uint8 *) b->pixels + y * b->pitch);
+        for (x = 0; x < a->w; ++x) {
+            if (pa[x] != pb[x]) {
+                ++count;
+            }
+        }
+    }
+    return count;
+}
+
+static int
+RunBenchmark(const Blit *blit)
+{
+    SDL_Surface *src = CreateRandomSurface(blit->src_format);
+    SDL_Surface *dst = CreateRandomSurface(blit->dst_format);
+    SDL_Surface *expected = CreateRandomSurface(blit->dst_format);
+    SDL_Surface *original = CreateRandomSurface(blit->dst_format);
+    double base_rate = 0.0;
+    char alpha[32];
+    int i;
+
+    if (!src || !dst || !expected || !original) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't create surfaces: %s\n", SDL_GetError());
+        return -1;
+    }
+
+    SDL_SetSurfaceBlendMode(original, SDL_BLENDMODE_NONE);
+    SDL_SetSurfaceBlendMode(src, SDL_BLENDMODE_BLEND);
+    if (blit->surface_alpha >= 0) {
+        SDL_SetSurfaceAlphaMod(src, (Uint8) blit->surface_alpha);
+        SDL_snprintf(alpha, sizeof (alpha), "surface alpha %d", blit->surface_alpha);
+    } else {
+        SDL_strlcpy(alpha, "pixel alpha", sizeof (alpha));
+    }
+
+    SDL_BlitSurface(original, NULL, expected, NULL);
+    BlendExact(src, expected, blit->surface_alpha);
+
+    SDL_Log("%s -> %s, %s:\n", SDL_GetPixelFormatName(blit->src_format),
+            SDL_GetPixelFormatName(blit->dst_format), alpha);
+
+    for (i = 0; i < SDL_arraysize(configs); ++i) {
+        char features[16];
+        Uint64 start;
+        double rate;
+        int runs = 0, differences;
+
+        if (!configs[i].features && i > 0) {
+            continue;
+        }
+
+        /* Changing the blend mode makes SDL choose the blitter again */
+        SDL_snprintf(features, sizeof (features), "%u", configs[i].features);
+        SDL_SetHint("SDL_BLIT_CPU_FEATURES", features);
+        SDL_SetSurfaceBlendMode(src, SDL_BLENDMODE_NONE);
+        SDL_SetSurfaceBlendMode(src, SDL_BLENDMODE_BLEND);
+
+        SDL_BlitSurface(original, NULL, dst, NULL);
+        SDL_BlitSurface(src, NULL, dst, NULL);
+        differences = CountDifferences(dst, expected);
+
+        start = SDL_GetPerformanceCounter();
+        do {
+            SDL_BlitSurface(src, NULL, dst, NULL);
+            ++runs;
+        } while (Elapsed(start) < 1.0);
+        rate = (double) width * height * runs / Elapsed(start) / 1000000.0;
+        if (i == 0) {
+            base_rate = rate;
+        }
+
+        SDL_Log("    %-6s %8.1f Mpixels/s, %4.2fx, %d pixels differ from an exact blend\n",
+                configs[i].name, rate, rate / base_rate, differences);
+    }
+
+    SDL_FreeSurface(original);
+    SDL_FreeSurface(expected);
+    SDL_FreeSurface(dst);
+    SDL_FreeSurface(src);
+    return 0;
+}
+
+int
+main(int argc, char *argv[])
+{
+    int i, status = 0;
+
+    /* Enable standard application logging */
+    SDL_LogSetPriority(SDL_LOG_CATEGORY_APPLICATION, SDL_LOG_PRIORITY_INFO);
+
+    for (i = 1; i < argc; ++i) {
+        if (SDL_strcmp(argv[i], "--width") == 0 && argv[i+1]) {
+            width = SDL_atoi(argv[++i]);
+        } else if (SDL_strcmp(argv[i], "--height") == 0 && argv[i+1]) {
+            height = SDL_atoi(argv[++i]);
+        } else {
+            SDL_Log("USAGE: %s [--width N] [--height N]\n", argv[0]);
+            return 1;
+        }
+    }
+    width = SDL_max(width, 1);
+    height = SDL_max(height, 1);
+
+    if (SDL_Init(0) < 0) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't initialize SDL: %s\n", SDL_GetError());
+        return 1;
+    }
+
+    /* Only compare the blitters this CPU can run */
+    if (!SDL_HasSSE41()) {
+        configs[1].features = 0;
+    }
+    if (!SDL_HasAVX2()) {
+        configs[2].features = 0;
+    }
+
+    SDL_Log("Blending %dx%d surfaces\n", width, height);
+    for (i = 0; i < SDL_arraysize(blits); ++i) {
+        if (RunBenchmark(&blits[i]) < 0) {
+            status = 1;
+        }
+    }
+
+    SDL_Quit();
+    return status;
+}
+
+/* vi: set ts=4 sw=4 expandtab: */
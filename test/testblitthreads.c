@@ -0,0 +1,212 @@
+/*
+  Copyright (C) 1997-2020 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely.
+*/
+/* Benchmark large surface blits and pixel conversions with different numbers of threads */
+
+#include <stdlib.h>
+#include <stdio.h>
+
+#include "SDL.h"
+
+typedef struct
+{
+    const char *name;
+    Uint32 src_format;
+    Uint32 dst_format;
+    SDL_BlendMode blend;
+    SDL_bool convert_pixels;    /* SDL_ConvertPixels() instead of SDL_BlitSurface() */
+} Blit;
+
+static const Blit blits[] = {
+    { "copy", SDL_PIXELFORMAT_ARGB8888, SDL_PIXELFORMAT_ARGB8888, SDL_BLENDMODE_NONE, SDL_FALSE },
+    { "convert", SDL_PIXELFORMAT_ARGB8888, SDL_PIXELFORMAT_ABGR8888, SDL_BLENDMODE_NONE, SDL_FALSE },
+    { "convert", SDL_PIXELFORMAT_RGB24, SDL_PIXELFORMAT_ARGB8888, SDL_BLENDMODE_NONE, SDL_FALSE },
+    { "convert", SDL_PIXELFORMAT_ARGB8888, SDL_PIXELFORMAT_RGB565, SDL_BLENDMODE_NONE, SDL_FALSE },
+    { "blend", SDL_PIXELFORMAT_ARGB8888, SDL_PIXELFORMAT_RGB888, SDL_BLENDMODE_BLEND, SDL_FALSE },
+    { "blend", SDL_PIXELFORMAT_ABGR8888, SDL_PIXELFORMAT_RGB565, SDL_BLENDMODE_BLEND, SDL_FALSE },
+    { "pixels", SDL_PIXELFORMAT_ARGB8888, SDL_PIXELFORMAT_RGB24, SDL_BLENDMODE_NONE, SDL_TRUE },
+    { "pixels", SDL_PIXELFORMAT_RGB565, SDL_PIXELFORMAT_ABGR8888, SDL_BLENDMODE_NONE, SDL_TRUE },
+};
+
+typedef struct
+{
+    const char *name;
+    int w;
+    int h;
+} Size;
+
+static const Size sizes[] = {
+    { "1080p", 1920, 1080 },
+    { "4K", 3840, 2160 },
+};
+
+static int max_threads = 0;
+
+static double
+Elapsed(Uint64 start)
+{
+    return (double) (SDL_GetPerformanceCounter() - start) / SDL_GetPerformanceFrequency();
+}
+
+static SDL_Surface *
+CreateRandomSurface(Uint32 format, int w, int h)
+{
+    SDL_Surface *surface = SDL_CreateRGBSurfaceWithFormat(0, w, h, SDL_BITSPERPIXEL(format), format);
+    int x, y;
+
+    if (surface) {
+        for (y = 0; y < surface->h; ++y) {
+            Uint8 *row = (Uint8 *) surface->pixels + y * surface->pitch;
+            for (x = 0; x < surface->pitch; ++x) {
+                row[x] = (Uint8) rand();
+            }
+        }
+    }
+    return surface;
+}
+
+static void
+RunBlit(const Blit *blit, SDL_Surface *src, SDL_Surface *dst)
+{
+    if (blit->convert_pixels) {
+        SDL_ConvertPixels(src->w, src->h, src->format->format, src->pixels, src->pitch,
+                          dst->format->format, dst->pixels, dst->pitch);
+    } else {
+        SDL_BlitSurface(src, NULL, dst, NULL);
+    }
+}
+
+/* Blit with the given number of threads, returning the time per blit */
+static double
+TimeBlit(const Blit *blit, SDL_Surface *src, SDL_Surface *dst, SDL_Surface *original, int threads)
+{
+    char value[16];
+    double elapsed;
+    int runs = 0;
+    Uint64 start;
+
+    SDL_snprintf(value, sizeof (value), "%d", threads);
+    SDL_SetHint(SDL_HINT_BLIT_THREADS, value);
+
+    start = SDL_GetPerformanceCounter();
+    do {
+        RunBlit(blit, src, dst);
+        ++runs;
+    } while (Elapsed(start) < 1.0);
+    elapsed = Elapsed(start) / runs;
+
+    /* Leave a single blit's worth of output, to compare */
+    SDL_BlitSurface(original, NULL, dst, NULL);
+    RunBlit(blit, src, dst);
+
+    SDL_SetHint(SDL_HINT_BLIT_THREADS, NULL);
+    return elapsed;
+}
+
+static SDL_bool
+SameSurfaces(SDL_Surface *a, SDL_Surface *b)
+{
+    const int len = a->w * a->format->BytesPerPixel;
+    int y;
+
+    for (y = 0; y < a->h; ++y) {
+        if (SDL_memcmp((Uint8 *) a->pixels + y * a->pitch, (Uint8 *) b->pixels + y * b->pitch, len) != 0) {
+            return SDL_FALSE;
+        }
+    }
+    return SDL_TRUE;
+}
+
+static int
+RunBenchmark(const Blit *blit, const Size *size)
+{
+    SDL_Surface *src = CreateRandomSurface(blit->src_format, size->w, size->h);
+    SDL_Surface *dst = CreateRandomSurface(blit->dst_format, size->w, size->h);
+    SDL_Surface *original = CreateRandomSurface(blit->dst_format, size->w, size->h);
+    SDL_Surface *expected = CreateRandomSurface(blit->dst_format, size->w, size->h);
+    double single_time;
+    int threads, status = 0;
+
+    if (!src || !dst || !original || !expected) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't create surfaces: %s\n", SDL_GetError());
+        return -1;
+    }
+    SDL_SetSurfaceBlendMode(original, SDL_BLENDMODE_NONE);
+    SDL_SetSurfaceBlendMode(dst, SDL_BLENDMODE_NONE);
+    SDL_SetSurfaceBlendMode(src, blit->blend);
+
+    SDL_BlitSurface(original, NULL, dst, NULL);
+    single_time = TimeBlit(blit, src, dst, original, 1);
+    SDL_BlitSurface(dst, NULL, expected, NULL);
+
+    SDL_Log("%-7s %-5s %s -> %s: 1 thread %7.1f Mpixels/s\n", blit->name, size->name,
+            SDL_GetPixelFormatName(blit->src_format), SDL_GetPixelFormatName(blit->dst_format),
+            size->w * size->h / single_time / 1000000.0);
+
+    for (threads = 2; threads <= max_threads; threads *= 2) {
+        const double time = TimeBlit(blit, src, dst, original, threads);
+        const SDL_bool same = SameSurfaces(dst, expected);
+
+        SDL_Log("    %2d threads %7.1f Mpixels/s, %4.2fx%s\n", threads,
+                size->w * size->h / time / 1000000.0, single_time / time,
+                same ? "" : " (output differs!)");
+        if (!same) {
+            status = -1;
+        }
+    }
+
+    SDL_FreeSurface(expected);
+    SDL_FreeSurface(original);
+    SDL_FreeSurface(dst);
+    SDL_FreeSurface(src);
+    return status;
+}
+
+int
+main(int argc, char *argv[])
+{
+    int i, j, status = 0;
+
+    /* Enable standard application logging */
+    SDL_LogSetPriority(SDL_LOG_CATEGORY_APPLICATION, SDL_LOG_PRIORITY_INFO);
+
+    for (i = 1; i < argc; ++i) {
+        if (SDL_strcmp(argv[i], "--threads") == 0 && argv[i+1]) {
+            max_threads = SDL_atoi(argv[++i]);
+        } else {
+            SDL_Log("USAGE: %s [--threads N]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    if (SDL_Init(0) < 0) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't initialize SDL: %s\n", SDL_GetError());
+        return 1;
+    }
+
+    if (max_threads <= 0) {
+        max_threads = SDL_max(SDL_GetCPUCount(), 4);
+    }
+
+    SDL_Log("Blitting on up to %d threads, %d CPU cores\n", max_threads, SDL_GetCPUCount());
+    for (i = 0; i < SDL_arraysize(sizes); ++i) {
+        for (j = 0; j < SDL_arraysize(blits); ++j) {
+            if (RunBenchmark(&blits[j], &sizes[i]) < 0) {
+                status = 1;
+            }
+        }
+    }
+
+    SDL_Quit();
+    return status;
+}
+
+/* vi: set ts=4 sw=4 expandtab: */
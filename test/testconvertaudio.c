@@ -0,0 +1,206 @@
+/*
+  Copyright (C) 1997-2020 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely.
+*/
+/* Benchmark SDL_ConvertAudio on large buffers with different numbers of threads */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+
+#include "SDL.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846264338327950288
+#endif
+
+typedef struct
+{
+    SDL_AudioFormat src_format;
+    Uint8 src_channels;
+    int src_rate;
+    SDL_AudioFormat dst_format;
+    Uint8 dst_channels;
+    int dst_rate;
+} Conversion;
+
+static const Conversion conversions[] = {
+    { AUDIO_S16MSB, 2, 44100, AUDIO_S16LSB, 2, 44100 },
+    { AUDIO_S16SYS, 2, 44100, AUDIO_F32SYS, 2, 44100 },
+    { AUDIO_U8,     1, 22050, AUDIO_F32SYS, 8, 22050 },
+    { AUDIO_F32SYS, 6, 48000, AUDIO_S16SYS, 2, 48000 },
+    { AUDIO_S16SYS, 2, 44100, AUDIO_F32SYS, 2, 48000 },
+    { AUDIO_S16SYS, 1, 22050, AUDIO_S16SYS, 2, 44100 },
+    { AUDIO_S32SYS, 8, 96000, AUDIO_S16SYS, 2, 44100 },
+    { AUDIO_F32SYS, 2, 44100, AUDIO_F32SYS, 2, 47999 },
+};
+
+static int seconds = 10;
+static int max_threads = 0;
+
+static double
+Elapsed(Uint64 start)
+{
+    return (double) (SDL_GetPerformanceCounter() - start) / SDL_GetPerformanceFrequency();
+}
+
+static const char *
+FormatName(SDL_AudioFormat format)
+{
+    switch (format) {
+        case AUDIO_U8: return "U8";
+        case AUDIO_S8: return "S8";
+        case AUDIO_S16LSB: return "S16LSB";
+        case AUDIO_S16MSB: return "S16MSB";
+        case AUDIO_U16LSB: return "U16LSB";
+        case AUDIO_U16MSB: return "U16MSB";
+        case AUDIO_S32LSB: return "S32LSB";
+        case AUDIO_S32MSB: return "S32MSB";
+        case AUDIO_F32LSB: return "F32LSB";
+        case AUDIO_F32MSB: return "F32MSB";
+        default: return "???";
+    }
+}
+
+/* Convert the input with the given number of threads, returning the time per conversion */
+static double
+TimeConversion(SDL_AudioCVT *cvt, const Uint8 *input, int threads)
+{
+    char value[16];
+    double elapsed;
+    int runs = 0;
+    Uint64 start;
+
+    SDL_snprintf(value, sizeof (value), "%d", threads);
+    SDL_SetHint(SDL_HINT_AUDIO_CONVERT_THREADS, value);
+
+    start = SDL_GetPerformanceCounter();
+    do {
+        SDL_memcpy(cvt->buf, input, cvt->len);
+        SDL_ConvertAudio(cvt);
+        ++runs;
+    } while (Elapsed(start) < 1.0);
+    elapsed = Elapsed(start) / runs;
+
+    SDL_SetHint(SDL_HINT_AUDIO_CONVERT_THREADS, NULL);
+    return elapsed;
+}
+
+static int
+RunBenchmark(const Conversion *conv)
+{
+    const int frames = conv->src_rate * seconds;
+    const int samples = frames * conv->src_channels;
+    SDL_AudioCVT cvt;
+    Uint8 *input, *expected;
+    double single_time;
+    int expected_len, threads, i, status = 0;
+
+    if (SDL_BuildAudioCVT(&cvt, conv->src_format, conv->src_channels, conv->src_rate,
+                          conv->dst_format, conv->dst_channels, conv->dst_rate) <= 0) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't build converter: %s\n", SDL_GetError());
+        return -1;
+    }
+
+    /* A tone and some noise, converted to the source format with SDL itself */
+    cvt.len = samples * (int) sizeof (float);
+    input = (Uint8 *) SDL_malloc(cvt.len);
+    expected = (Uint8 *) SDL_malloc(cvt.len * cvt.len_mult);
+    cvt.buf = (Uint8 *) SDL_malloc(cvt.len * cvt.len_mult);
+    if (!input || !expected || !cvt.buf) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Out of memory\n");
+        return -1;
+    }
+    for (i = 0; i < samples; i++) {
+        const double t = (double) (i / conv->src_channels) / conv->src_rate;
+        ((float *) input)[i] = (float) (0.5 * sin(2.0 * M_PI * (440.0 + 110.0 * (i % conv->src_channels)) * t) +
+                                        0.2 * ((rand() / (double) RAND_MAX) - 0.5));
+    }
+    {
+        SDL_AudioCVT tosrc;
+        SDL_BuildAudioCVT(&tosrc, AUDIO_F32SYS, conv->src_channels, conv->src_rate,
+                          conv->src_format, conv->src_channels, conv->src_rate);
+        tosrc.buf = input;
+        tosrc.len = cvt.len;
+        SDL_ConvertAudio(&tosrc);
+        cvt.len = tosrc.len_cvt;
+    }
+
+    single_time = TimeConversion(&cvt, input, 1);
+    expected_len = cvt.len_cvt;
+    SDL_memcpy(expected, cvt.buf, expected_len);
+
+    SDL_Log("%s %d ch %5d Hz -> %s %d ch %5d Hz, %d bytes: 1 thread %7.1f MB/s\n",
+            FormatName(conv->src_format), conv->src_channels, conv->src_rate,
+            FormatName(conv->dst_format), conv->dst_channels, conv->dst_rate,
+            cvt.len, cvt.len / single_time / (1024.0 * 1024.0));
+
+    for (threads = 2; threads <= max_threads; threads *= 2) {
+        const double time = TimeConversion(&cvt, input, threads);
+        const SDL_bool same = (cvt.len_cvt == expected_len) && (SDL_memcmp(cvt.buf, expected, expected_len) == 0);
+
+        SDL_Log("    %2d threads %7.1f MB/s, %4.2fx%s\n", threads,
+                cvt.len / time / (1024.0 * 1024.0), single_time / time,
+                same ? "" : " (output differs!)");
+        if (!same) {
+            status = -1;
+        }
+    }
+
+    SDL_free(cvt.buf);
+    SDL_free(expected);
+    SDL_free(input);
+    return status;
+}
+
+int
+main(int argc, char *argv[])
+{
+    int i, status = 0;
+
+    /* Enable standard application logging */
+    SDL_LogSetPriority(SDL_LOG_CATEGORY_APPLICATION, SDL_LOG_PRIORITY_INFO);
+
+    for (i = 1; i < argc; ++i) {
+        if (SDL_strcmp(argv[i], "--seconds") == 0 && argv[i+1]) {
+            seconds = SDL_atoi(argv[++i]);
+            if (seconds < 1) {
+                seconds = 1;
+            }
+        } else if (SDL_strcmp(argv[i], "--threads") == 0 && argv[i+1]) {
+            max_threads = SDL_atoi(argv[++i]);
+        } else {
+            SDL_Log("USAGE: %s [--seconds N] [--threads N]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    if (SDL_Init(0) < 0) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't initialize SDL: %s\n", SDL_GetError());
+        return 1;
+    }
+
+    if (max_threads <= 0) {
+        max_threads = SDL_max(SDL_GetCPUCount(), 4);
+    }
+
+    SDL_Log("Converting %d second%s of audio on up to %d threads, %d CPU cores\n",
+            seconds, seconds == 1 ? "" : "s", max_threads, SDL_GetCPUCount());
+    for (i = 0; i < SDL_arraysize(conversions); ++i) {
+        if (RunBenchmark(&conversions[i]) < 0) {
+            status = 1;
+        }
+    }
+
+    SDL_Quit();
+    return status;
+}
+
+/* vi: set ts=4 sw=4 expandtab: */
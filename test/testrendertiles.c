@@ -0,0 +1,217 @@
+/*
+  Copyright (C) 1997-2020 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely.
+*/
+/* Benchmark the software renderer with SDL_HINT_RENDER_SOFTWARE_THREADS */
+
+#include <stdlib.h>
+#include <stdio.h>
+
+#include "SDL.h"
+
+#define NUM_RECTS       2000
+#define NUM_SPRITES     2000
+#define NUM_POINTS      2000
+#define SPRITE_SIZE     32
+
+static int width = 1920;
+static int height = 1080;
+static Uint32 seconds = 2;
+
+static Uint32 rand_state;
+
+static int
+Random(int max)
+{
+    rand_state = rand_state * 1103515245 + 12345;
+    return (int) ((rand_state >> 16) % (Uint32) max);
+}
+
+static SDL_Texture *
+CreateSprite(SDL_Renderer *renderer)
+{
+    SDL_Texture *texture;
+    SDL_Surface *surface;
+    int x, y;
+
+    surface = SDL_CreateRGBSurfaceWithFormat(0, SPRITE_SIZE, SPRITE_SIZE, 32, SDL_PIXELFORMAT_ARGB8888);
+    if (!surface) {
+        return NULL;
+    }
+    for (y = 0; y < SPRITE_SIZE; ++y) {
+        Uint32 *row = (Uint32 *) ((Uint8 *) surface->pixels + y * surface->pitch);
+        for (x = 0; x < SPRITE_SIZE; ++x) {
+            const Uint32 a = (Uint32) ((x + y) * 255 / (2 * SPRITE_SIZE - 2));
+            row[x] = (a << 24) | ((x * 8) << 16) | ((y * 8) << 8) | 0x80;
+        }
+    }
+    texture = SDL_CreateTextureFromSurface(renderer, surface);
+    SDL_FreeSurface(surface);
+    if (texture) {
+        SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+    }
+    return texture;
+}
+
+static void
+DrawFrame(SDL_Renderer *renderer, SDL_Texture *sprite, Uint32 frame)
+{
+    SDL_Point points[NUM_POINTS];
+    int i;
+
+    rand_state = frame;
+
+    SDL_SetRenderDrawColor(renderer, 0x20, 0x20, 0x40, 0xFF);
+    SDL_RenderClear(renderer);
+
+    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+    for (i = 0; i < NUM_RECTS; ++i) {
+        SDL_Rect rect;
+        rect.x = Random(width);
+        rect.y = Random(height);
+        rect.w = 8 + Random(120);
+        rect.h = 8 + Random(120);
+        SDL_SetRenderDrawColor(renderer, (Uint8) Random(256), (Uint8) Random(256), (Uint8) Random(256), 0x80);
+        SDL_RenderFillRect(renderer, &rect);
+    }
+
+    for (i = 0; i < NUM_SPRITES; ++i) {
+        SDL_Rect rect;
+        rect.x = Random(width) - SPRITE_SIZE / 2;
+        rect.y = Random(height) - SPRITE_SIZE / 2;
+        rect.w = SPRITE_SIZE;
+        rect.h = SPRITE_SIZE;
+        SDL_RenderCopy(renderer, sprite, NULL, &rect);
+    }
+
+    for (i = 0; i < NUM_POINTS; ++i) {
+        points[i].x = Random(width);
+        points[i].y = Random(height);
+    }
+    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_NONE);
+    SDL_SetRenderDrawColor(renderer, 0xFF, 0xFF, 0xFF, 0xFF);
+    SDL_RenderDrawPoints(renderer, points, NUM_POINTS);
+
+    SDL_RenderPresent(renderer);
+}
+
+static int
+RunBenchmark(int threads, SDL_Surface *reference)
+{
+    SDL_Surface *surface;
+    SDL_Renderer *renderer;
+    SDL_Texture *sprite;
+    Uint32 frames = 0;
+    Uint64 start, elapsed;
+    char value[16];
+    int matches;
+    int commands_in = 0, commands_out = 0;
+
+    SDL_snprintf(value, sizeof (value), "%d", threads);
+    SDL_SetHint(SDL_HINT_RENDER_SOFTWARE_THREADS, value);
+
+    surface = SDL_CreateRGBSurfaceWithFormat(0, width, height, 32, SDL_PIXELFORMAT_ARGB8888);
+    renderer = surface ? SDL_CreateSoftwareRenderer(surface) : NULL;
+    sprite = renderer ? CreateSprite(renderer) : NULL;
+    if (!sprite) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't set up renderer: %s\n", SDL_GetError());
+        return -1;
+    }
+
+    /* The first frame is always the same, compare it with the single threaded output */
+    DrawFrame(renderer, sprite, 0);
+    if (!reference->userdata) {
+        SDL_memcpy(reference->pixels, surface->pixels, (size_t) surface->pitch * height);
+        reference->userdata = reference;
+        matches = 1;
+    } else {
+        matches = (SDL_memcmp(surface->pixels, reference->pixels, (size_t) surface->pitch * height) == 0);
+    }
+
+    start = SDL_GetPerformanceCounter();
+    do {
+        DrawFrame(renderer, sprite, ++frames);
+        elapsed = SDL_GetPerformanceCounter() - start;
+    } while (elapsed < seconds * SDL_GetPerformanceFrequency());
+
+    SDL_RenderGetCommandStats(renderer, &commands_in, &commands_out);
+
+    SDL_Log("%2d thread%s: %8.2f frames/sec, %d of %d commands run%s\n", threads, threads == 1 ? " " : "s",
+            (double) frames * SDL_GetPerformanceFrequency() / elapsed,
+            commands_out, commands_in,
+            matches ? "" : "  (output differs from 1 thread!)");
+
+    SDL_DestroyTexture(sprite);
+    SDL_DestroyRenderer(renderer);
+    SDL_FreeSurface(surface);
+    return matches ? 0 : -1;
+}
+
+int
+main(int argc, char *argv[])
+{
+    SDL_Surface *reference;
+    int max_threads = SDL_GetCPUCount();
+    int threads;
+    int i, status = 0;
+
+    /* Enable standard application logging */
+    SDL_LogSetPriority(SDL_LOG_CATEGORY_APPLICATION, SDL_LOG_PRIORITY_INFO);
+
+    for (i = 1; i < argc; ++i) {
+        if (SDL_strcmp(argv[i], "--threads") == 0 && argv[i+1]) {
+            max_threads = SDL_atoi(argv[++i]);
+        } else if (SDL_strcmp(argv[i], "--size") == 0 && argv[i+1]) {
+            if (SDL_sscanf(argv[++i], "%dx%d", &width, &height) != 2) {
+                width = 1920;
+                height = 1080;
+            }
+        } else if (SDL_strcmp(argv[i], "--seconds") == 0 && argv[i+1]) {
+            seconds = (Uint32) SDL_atoi(argv[++i]);
+        } else {
+            SDL_Log("USAGE: %s [--threads N] [--size WxH] [--seconds N]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    /* Queue up the whole frame, so the tiles have something to work on */
+    SDL_SetHint(SDL_HINT_RENDER_BATCHING, "1");
+
+    if (SDL_Init(0) < 0) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't initialize SDL: %s\n", SDL_GetError());
+        return 1;
+    }
+
+    reference = SDL_CreateRGBSurfaceWithFormat(0, width, height, 32, SDL_PIXELFORMAT_ARGB8888);
+    if (!reference) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't create surface: %s\n", SDL_GetError());
+        SDL_Quit();
+        return 1;
+    }
+
+    SDL_Log("Software renderer, %dx%d, %d rects + %d sprites + %d points per frame\n",
+            width, height, NUM_RECTS, NUM_SPRITES, NUM_POINTS);
+    for (threads = 1; threads <= SDL_max(max_threads, 1); threads *= 2) {
+        if (RunBenchmark(threads, reference) < 0) {
+            status = 1;
+        }
+    }
+    if (threads / 2 != max_threads && max_threads > 1) {
+        if (RunBenchmark(max_threads, reference) < 0) {
+            status = 1;
+        }
+    }
+
+    SDL_FreeSurface(reference);
+    SDL_Quit();
+    return status;
+}
+
+/* vi: set ts=4 sw=4 expandtab: */
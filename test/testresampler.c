@@ -0,0 +1,264 @@
+/*
+  Copyright (C) 1997-2020 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely.
+*/
+/* Benchmark SDL's resampler against the per-sample scalar resampler it replaced */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+
+#include "SDL.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846264338327950288
+#endif
+
+/* This is the resampler from SDL 2.0.12, for comparison */
+#define RESAMPLER_ZERO_CROSSINGS 5
+#define RESAMPLER_BITS_PER_SAMPLE 16
+#define RESAMPLER_SAMPLES_PER_ZERO_CROSSING  (1 << ((RESAMPLER_BITS_PER_SAMPLE / 2) + 1))
+#define RESAMPLER_FILTER_SIZE ((RESAMPLER_SAMPLES_PER_ZERO_CROSSING * RESAMPLER_ZERO_CROSSINGS) + 1)
+
+static float ResamplerFilter[RESAMPLER_FILTER_SIZE];
+static float ResamplerFilterDifference[RESAMPLER_FILTER_SIZE];
+
+static double
+bessel(const double x)
+{
+    const double xdiv2 = x / 2.0;
+    double i0 = 1.0f;
+    double f = 1.0f;
+    int i = 1;
+
+    while (SDL_TRUE) {
+        const double diff = SDL_pow(xdiv2, i * 2) / SDL_pow(f, 2);
+        if (diff < 1.0e-21f) {
+            break;
+        }
+        i0 += diff;
+        i++;
+        f *= (double) i;
+    }
+
+    return i0;
+}
+
+static void
+kaiser_and_sinc(float *table, float *diffs, const int tablelen, const double beta)
+{
+    const int lenm1 = tablelen - 1;
+    const int lenm1div2 = lenm1 / 2;
+    int i;
+
+    table[0] = 1.0f;
+    for (i = 1; i < tablelen; i++) {
+        const double kaiser = bessel(beta * SDL_sqrt(1.0 - SDL_pow(((i - lenm1) / 2.0) / lenm1div2, 2.0))) / bessel(beta);
+        table[tablelen - i] = (float) kaiser;
+    }
+
+    for (i = 1; i < tablelen; i++) {
+        const float x = (((float) i) / ((float) RESAMPLER_SAMPLES_PER_ZERO_CROSSING)) * ((float) M_PI);
+        table[i] *= SDL_sinf(x) / x;
+        diffs[i - 1] = table[i] - table[i - 1];
+    }
+    diffs[lenm1] = 0.0f;
+}
+
+static int
+ResamplerPadding(const int inrate, const int outrate)
+{
+    if (inrate == outrate) {
+        return 0;
+    } else if (inrate > outrate) {
+        return (int) SDL_ceil(((float) (RESAMPLER_SAMPLES_PER_ZERO_CROSSING * inrate) / ((float) outrate)));
+    }
+    return RESAMPLER_SAMPLES_PER_ZERO_CROSSING;
+}
+
+static int
+ScalarResampleAudio(const int chans, const int inrate, const int outrate,
+                    const float *lpadding, const float *rpadding,
+                    const float *inbuf, const int inbuflen,
+                    float *outbuf, const int outbuflen)
+{
+    const double finrate = (double) inrate;
+    const double outtimeincr = 1.0 / ((float) outrate);
+    const double  ratio = ((float) outrate) / ((float) inrate);
+    const int paddinglen = ResamplerPadding(inrate, outrate);
+    const int framelen = chans * (int)sizeof (float);
+    const int inframes = inbuflen / framelen;
+    const int wantedoutframes = (int) ((inbuflen / framelen) * ratio);
+    const int maxoutframes = outbuflen / framelen;
+    const int outframes = SDL_min(wantedoutframes, maxoutframes);
+    float *dst = outbuf;
+    double outtime = 0.0;
+    int i, j, chan;
+
+    for (i = 0; i < outframes; i++) {
+        const int srcindex = (int) (outtime * inrate);
+        const double intime = ((double) srcindex) / finrate;
+        const double innexttime = ((double) (srcindex + 1)) / finrate;
+        const double interpolation1 = 1.0 - ((innexttime - outtime) / (innexttime - intime));
+        const int filterindex1 = (int) (interpolation1 * RESAMPLER_SAMPLES_PER_ZERO_CROSSING);
+        const double interpolation2 = 1.0 - interpolation1;
+        const int filterindex2 = (int) (interpolation2 * RESAMPLER_SAMPLES_PER_ZERO_CROSSING);
+
+        for (chan = 0; chan < chans; chan++) {
+            float outsample = 0.0f;
+
+            for (j = 0; (filterindex1 + (j * RESAMPLER_SAMPLES_PER_ZERO_CROSSING)) < RESAMPLER_FILTER_SIZE; j++) {
+                const int srcframe = srcindex - j;
+                const float insample = (srcframe < 0) ? lpadding[((paddinglen + srcframe) * chans) + chan] : inbuf[(srcframe * chans) + chan];
+                outsample += (float)(insample * (ResamplerFilter[filterindex1 + (j * RESAMPLER_SAMPLES_PER_ZERO_CROSSING)] + (interpolation1 * ResamplerFilterDifference[filterindex1 + (j * RESAMPLER_SAMPLES_PER_ZERO_CROSSING)])));
+            }
+
+            for (j = 0; (filterindex2 + (j * RESAMPLER_SAMPLES_PER_ZERO_CROSSING)) < RESAMPLER_FILTER_SIZE; j++) {
+                const int srcframe = srcindex + 1 + j;
+                const float insample = (srcframe >= inframes) ? rpadding[((srcframe - inframes) * chans) + chan] : inbuf[(srcframe * chans) + chan];
+                outsample += (float)(insample * (ResamplerFilter[filterindex2 + (j * RESAMPLER_SAMPLES_PER_ZERO_CROSSING)] + (interpolation2 * ResamplerFilterDifference[filterindex2 + (j * RESAMPLER_SAMPLES_PER_ZERO_CROSSING)])));
+            }
+            *(dst++) = outsample;
+        }
+
+        outtime += outtimeincr;
+    }
+
+    return outframes * chans * sizeof (float);
+}
+
+static const int layouts[] = { 1, 2, 4, 6, 8 };
+static const int rates[][2] = {
+    { 48000, 44100 },
+    { 44100, 48000 },
+    { 22050, 44100 },
+    { 48000, 24000 },
+};
+
+static int seconds = 1;
+
+static double
+Elapsed(Uint64 start)
+{
+    return (double) (SDL_GetPerformanceCounter() - start) / SDL_GetPerformanceFrequency();
+}
+
+static int
+RunBenchmark(const int chans, const int inrate, const int outrate)
+{
+    const int inframes = inrate * seconds;
+    const int inlen = inframes * chans * (int) sizeof (float);
+    const int paddinglen = ResamplerPadding(inrate, outrate) * chans;
+    float *input, *padding, *scalar;
+    SDL_AudioCVT cvt;
+    double scalar_time, simd_time, maxdiff = 0.0;
+    int scalar_len, i, runs;
+    Uint64 start;
+
+    if (SDL_BuildAudioCVT(&cvt, AUDIO_F32SYS, (Uint8) chans, inrate, AUDIO_F32SYS, (Uint8) chans, outrate) <= 0) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't build converter: %s\n", SDL_GetError());
+        return -1;
+    }
+    cvt.len = inlen;
+    cvt.buf = (Uint8 *) SDL_malloc(cvt.len * cvt.len_mult);
+    input = (float *) SDL_malloc(inlen);
+    padding = (float *) SDL_calloc(paddinglen + 1, sizeof (float));
+    scalar = (float *) SDL_malloc(inlen * 2 + 64);
+    if (!cvt.buf || !input || !padding || !scalar) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Out of memory\n");
+        return -1;
+    }
+
+    /* A few tones and some noise, different in each channel */
+    for (i = 0; i < inframes * chans; i++) {
+        const int chan = i % chans;
+        const double t = (double) (i / chans) / inrate;
+        input[i] = (float) (0.3 * sin(2.0 * M_PI * (440.0 + 110.0 * chan) * t) +
+                            0.2 * sin(2.0 * M_PI * 5000.0 * t) +
+                            0.1 * ((rand() / (double) RAND_MAX) - 0.5));
+    }
+
+    runs = 0;
+    start = SDL_GetPerformanceCounter();
+    do {
+        scalar_len = ScalarResampleAudio(chans, inrate, outrate, padding, padding, input, inlen, scalar, inlen * 2);
+        ++runs;
+    } while (Elapsed(start) < 0.5);
+    scalar_time = Elapsed(start) / runs;
+
+    runs = 0;
+    start = SDL_GetPerformanceCounter();
+    do {
+        SDL_memcpy(cvt.buf, input, inlen);
+        SDL_ConvertAudio(&cvt);
+        ++runs;
+    } while (Elapsed(start) < 0.5);
+    simd_time = Elapsed(start) / runs;
+
+    for (i = 0; i < SDL_min(scalar_len, cvt.len_cvt) / (int) sizeof (float); i++) {
+        const double diff = fabs(scalar[i] - ((float *) cvt.buf)[i]);
+        if (diff > maxdiff) {
+            maxdiff = diff;
+        }
+    }
+
+    SDL_Log("%d channel%s %5d -> %5d: scalar %10.0f frames/sec, SDL %10.0f frames/sec, %5.1fx, max difference %.5f%s\n",
+            chans, chans == 1 ? " " : "s", inrate, outrate,
+            inframes / scalar_time, inframes / simd_time, scalar_time / simd_time, maxdiff,
+            (scalar_len != cvt.len_cvt) ? " (lengths differ!)" : "");
+
+    SDL_free(cvt.buf);
+    SDL_free(input);
+    SDL_free(padding);
+    SDL_free(scalar);
+    return (scalar_len == cvt.len_cvt) ? 0 : -1;
+}
+
+int
+main(int argc, char *argv[])
+{
+    int i, j, status = 0;
+
+    /* Enable standard application logging */
+    SDL_LogSetPriority(SDL_LOG_CATEGORY_APPLICATION, SDL_LOG_PRIORITY_INFO);
+
+    for (i = 1; i < argc; ++i) {
+        if (SDL_strcmp(argv[i], "--seconds") == 0 && argv[i+1]) {
+            seconds = SDL_atoi(argv[++i]);
+            if (seconds < 1) {
+                seconds = 1;
+            }
+        } else {
+            SDL_Log("USAGE: %s [--seconds N]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    if (SDL_Init(0) < 0) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't initialize SDL: %s\n", SDL_GetError());
+        return 1;
+    }
+
+    kaiser_and_sinc(ResamplerFilter, ResamplerFilterDifference, RESAMPLER_FILTER_SIZE, 0.1102 * (80.0 - 8.7));
+
+    SDL_Log("Resampling %d second%s of float audio\n", seconds, seconds == 1 ? "" : "s");
+    for (i = 0; i < SDL_arraysize(rates); ++i) {
+        for (j = 0; j < SDL_arraysize(layouts); ++j) {
+            if (RunBenchmark(layouts[j], rates[i][0], rates[i][1]) < 0) {
+                status = 1;
+            }
+        }
+    }
+
+    SDL_Quit();
+    return status;
+}
+
+/* vi: set ts=4 sw=4 expandtab: */
@@ -35,6 +35,7 @@ static int current_alpha = 0;
 static int current_color = 0;
 static SDL_Rect *positions;
 static SDL_Rect *velocities;
+static SDL_RenderSprite *batch;
 static int sprite_w, sprite_h;
 static SDL_BlendMode blendMode = SDL_BLENDMODE_BLEND;
 static Uint32 next_fps_check, frames;
@@ -53,6 +54,7 @@ quit(int rc)
     SDL_free(sprites);
     SDL_free(positions);
     SDL_free(velocities);
+    SDL_free(batch);
     SDLTest_CommonQuit(state);
     exit(rc);
 }
@@ -232,11 +234,24 @@ MoveSprites(SDL_Renderer * renderer, SDL_Texture * sprite)
     }
 
     /* Draw sprites */
-    for (i = 0; i < num_sprites; ++i) {
-        position = &positions[i];
+    if (batch) {
+        for (i = 0; i < num_sprites; ++i) {
+            position = &positions[i];
+            batch[i].dstrect.x = (float) position->x;
+            batch[i].dstrect.y = (float) position->y;
+            batch[i].dstrect.w = (float) position->w;
+            batch[i].dstrect.h = (float) position->h;
+        }
+
+        /* Blit all the sprites onto the screen at once */
+        SDL_RenderCopySprites(renderer, sprite, batch, num_sprites);
+    } else {
+        for (i = 0; i < num_sprites; ++i) {
+            position = &positions[i];
 
-        /* Blit the sprite onto the screen */
-        SDL_RenderCopy(renderer, sprite, NULL, position);
+            /* Blit the sprite onto the screen */
+            SDL_RenderCopy(renderer, sprite, NULL, position);
+        }
     }
 
     /* Update the screen! */
@@ -284,6 +299,7 @@ main(int argc, char *argv[])
     int i;
     Uint64 seed;
     const char *icon = "icon.bmp";
+    SDL_bool use_batch = SDL_FALSE;
 
     /* Initialize parameters */
     num_sprites = NUM_SPRITES;
@@ -328,6 +344,9 @@ main(int argc, char *argv[])
             } else if (SDL_strcasecmp(argv[i], "--cyclecolor") == 0) {
                 cycle_color = SDL_TRUE;
                 consumed = 1;
+            } else if (SDL_strcasecmp(argv[i], "--batch") == 0) {
+                use_batch = SDL_TRUE;
+                consumed = 1;
             } else if (SDL_strcasecmp(argv[i], "--cyclealpha") == 0) {
                 cycle_alpha = SDL_TRUE;
                 consumed = 1;
@@ -340,7 +359,7 @@ main(int argc, char *argv[])
             }
         }
         if (consumed < 0) {
-            static const char *options[] = { "[--blend none|blend|add|mod]", "[--cyclecolor]", "[--cyclealpha]", "[--iterations N]", "[num_sprites]", "[icon.bmp]", NULL };
+            static const char *options[] = { "[--blend none|blend|add|mod]", "[--cyclecolor]", "[--cyclealpha]", "[--batch]", "[--iterations N]", "[num_sprites]", "[icon.bmp]", NULL };
             SDLTest_CommonLogUsage(state, argv[0], options);
             quit(1);
         }
@@ -373,6 +392,21 @@ main(int argc, char *argv[])
         SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Out of memory!\n");
         quit(2);
     }
+    if (use_batch) {
+        batch = (SDL_RenderSprite *) SDL_malloc(num_sprites * sizeof(SDL_RenderSprite));
+        if (!batch) {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Out of memory!\n");
+            quit(2);
+        }
+        for (i = 0; i < num_sprites; ++i) {
+            batch[i].srcrect.x = 0;
+            batch[i].srcrect.y = 0;
+            batch[i].srcrect.w = sprite_w;
+            batch[i].srcrect.h = sprite_h;
+            batch[i].color.r = batch[i].color.g = batch[i].color.b = batch[i].color.a = 0xFF;
+            batch[i].angle = 0.0;
+        }
+    }
 
     /* Position sprites and set their velocities using the fuzzer */ 
     if (iterations >= 0) {
@@ -0,0 +1,170 @@
+/*
+  Copyright (C) 1997-2020 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely.
+*/
+/* Measure how late timer callbacks run with many timers active */
+
+#include <stdlib.h>
+#include <stdio.h>
+
+#include "SDL.h"
+
+typedef struct
+{
+    SDL_TimerID id;
+    Uint64 due;
+    Uint64 period;
+} TimerInfo;
+
+static int num_timers = 10000;
+static Uint32 seconds = 5;
+
+static Uint64 frequency;
+static SDL_atomic_t measuring;
+static SDL_atomic_t dispatched;
+static Uint64 total_late;
+static Uint64 max_late;
+
+static Uint32 SDLCALL
+callback(Uint32 interval, void *param)
+{
+    TimerInfo *info = (TimerInfo *) param;
+    const Uint64 now = SDL_GetPerformanceCounter();
+
+    /* Only the timer thread touches this, so no locking is needed */
+    if (SDL_AtomicGet(&measuring) && now > info->due) {
+        const Uint64 late = now - info->due;
+        total_late += late;
+        if (late > max_late) {
+            max_late = late;
+        }
+    }
+    SDL_AtomicIncRef(&dispatched);
+
+    /* The timer skips ahead if it falls a whole period behind */
+    info->due += info->period;
+    if (info->due <= now) {
+        info->due = now + info->period;
+    }
+    return interval;
+}
+
+static void
+RunBenchmark(Uint32 interval, SDL_bool microseconds)
+{
+    TimerInfo *timers;
+    Uint32 count;
+    Uint64 start;
+    int i;
+
+    timers = (TimerInfo *) SDL_calloc(num_timers, sizeof (*timers));
+    if (!timers) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Out of memory\n");
+        return;
+    }
+
+    /* Spread the timers out over one period of each other */
+    for (i = 0; i < num_timers; ++i) {
+        TimerInfo *info = &timers[i];
+        const Uint32 period = interval + (Uint32) i % interval;
+
+        info->period = ((Uint64) period * frequency) / (microseconds ? 1000000 : 1000);
+        info->due = SDL_GetPerformanceCounter() + info->period;
+        if (microseconds) {
+            info->id = SDL_AddTimerMicroseconds(period, callback, info);
+        } else {
+            info->id = SDL_AddTimer(period, callback, info);
+        }
+        if (!info->id) {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't add timer: %s\n", SDL_GetError());
+            num_timers = i;
+            break;
+        }
+    }
+
+    /* Let things settle before measuring */
+    SDL_Delay(500);
+    total_late = 0;
+    max_late = 0;
+    SDL_AtomicSet(&dispatched, 0);
+    SDL_AtomicSet(&measuring, 1);
+    start = SDL_GetPerformanceCounter();
+
+    SDL_Delay(seconds * 1000);
+
+    SDL_AtomicSet(&measuring, 0);
+    count = (Uint32) SDL_AtomicGet(&dispatched);
+    for (i = 0; i < num_timers; ++i) {
+        SDL_RemoveTimer(timers[i].id);
+    }
+    /* Wait for the timer thread to finish with the callback */
+    SDL_Delay(100);
+
+    SDL_Log("%d timers, %u-%u %s: %.0f callbacks/sec, average late %.1f us, max late %.1f us\n",
+            num_timers, interval, 2 * interval - 1, microseconds ? "us" : "ms",
+            (double) count * frequency / (SDL_GetPerformanceCounter() - start),
+            count ? (double) total_late * 1000000.0 / frequency / count : 0.0,
+            (double) max_late * 1000000.0 / frequency);
+
+    SDL_free(timers);
+}
+
+int
+main(int argc, char *argv[])
+{
+    Uint32 interval = 10;
+    Uint32 interval_us = 500;
+    int i;
+
+    /* Enable standard application logging */
+    SDL_LogSetPriority(SDL_LOG_CATEGORY_APPLICATION, SDL_LOG_PRIORITY_INFO);
+
+    for (i = 1; i < argc; ++i) {
+        if (SDL_strcmp(argv[i], "--timers") == 0 && argv[i+1]) {
+            num_timers = SDL_atoi(argv[++i]);
+            if (num_timers < 1) {
+                num_timers = 1;
+            }
+        } else if (SDL_strcmp(argv[i], "--interval") == 0 && argv[i+1]) {
+            interval = (Uint32) SDL_atoi(argv[++i]);
+            if (interval < 1) {
+                interval = 1;
+            }
+        } else if (SDL_strcmp(argv[i], "--interval-us") == 0 && argv[i+1]) {
+            interval_us = (Uint32) SDL_atoi(argv[++i]);
+        } else if (SDL_strcmp(argv[i], "--seconds") == 0 && argv[i+1]) {
+            seconds = (Uint32) SDL_atoi(argv[++i]);
+        } else {
+            SDL_Log("USAGE: %s [--timers N] [--interval ms] [--interval-us us] [--seconds N]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    if (SDL_Init(SDL_INIT_TIMER) < 0) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't initialize SDL: %s\n", SDL_GetError());
+        return 1;
+    }
+    frequency = SDL_GetPerformanceFrequency();
+
+    RunBenchmark(interval, SDL_FALSE);
+
+    /* A single microsecond timer on its own shows the best case precision */
+    if (interval_us > 0) {
+        const int saved = num_timers;
+        num_timers = 1;
+        RunBenchmark(interval_us, SDL_TRUE);
+        num_timers = saved;
+    }
+
+    SDL_Quit();
+    return 0;
+}
+
+/* vi: set ts=4 sw=4 expandtab: */
@@ -0,0 +1,453 @@
+/*
+  Copyright (C) 1997-2020 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely.
+*/
+/* Benchmark SDL's ADPCM and G.711 WAVE decoders against the per-sample decoders they replaced */
+
+#include <stdlib.h>
+#include <stdio.h>
+
+#include "SDL.h"
+
+#define PCM_CODE        0x0001
+#define MS_ADPCM_CODE   0x0002
+#define ALAW_CODE       0x0006
+#define MULAW_CODE      0x0007
+#define IMA_ADPCM_CODE  0x0011
+
+/* These are the decoders from SDL 2.0.12, for comparison */
+static Sint16
+RefMSADPCMNibble(Uint16 *delta, Sint16 coeff1, Sint16 coeff2, Sint32 sample1, Sint32 sample2, Uint8 nybble)
+{
+    const Uint16 adaptive[] = {
+        230, 230, 230, 230, 307, 409, 512, 614,
+        768, 614, 512, 409, 307, 230, 230, 230
+    };
+    Sint32 new_sample = (sample1 * coeff1 + sample2 * coeff2) / 256;
+    Uint32 d = *delta;
+
+    new_sample += (Sint32)d * ((Sint32)nybble - (nybble >= 0x08 ? 0x10 : 0));
+    if (new_sample < -32768) {
+        new_sample = -32768;
+    } else if (new_sample > 32767) {
+        new_sample = 32767;
+    }
+    d = (d * adaptive[nybble]) / 256;
+    if (d < 16) {
+        d = 16;
+    } else if (d > 65535) {
+        d = 65535;
+    }
+    *delta = (Uint16)d;
+    return (Sint16)new_sample;
+}
+
+static void
+RefMSADPCMBlock(const Uint8 *block, int channels, int samplesperblock, Sint16 *out)
+{
+    static const Sint16 coeffs[14] = {256, 0, 512, -256, 0, 0, 192, 64, 240, 0, 460, -208, 392, -232};
+    Sint16 coeff1[2], coeff2[2];
+    Uint16 delta[2];
+    Uint16 nybble = 0;
+    int c, i, o = 0, pos = channels * 7;
+
+    for (c = 0; c < channels; c++) {
+        coeff1[c] = coeffs[block[c] * 2];
+        coeff2[c] = coeffs[block[c] * 2 + 1];
+        delta[c] = block[channels + c * 2] | (block[channels + c * 2 + 1] << 8);
+        out[c + channels] = (Sint16)(block[channels * 3 + c * 2] | (block[channels * 3 + c * 2 + 1] << 8));
+        out[c] = (Sint16)(block[channels * 5 + c * 2] | (block[channels * 5 + c * 2 + 1] << 8));
+    }
+    o = channels * 2;
+    for (i = 2; i < samplesperblock; i++) {
+        for (c = 0; c < channels; c++) {
+            if (nybble & 0x4000) {
+                nybble <<= 4;
+            } else {
+                nybble = block[pos++] | 0x4000;
+            }
+            out[o] = RefMSADPCMNibble(&delta[c], coeff1[c], coeff2[c], out[o - channels], out[o - channels * 2], (nybble >> 4) & 0x0f);
+            o++;
+        }
+    }
+}
+
+static Sint16
+RefIMAADPCMNibble(Sint8 *cindex, Sint16 lastsample, Uint8 nybble)
+{
+    const Sint8 index_table_4b[16] = {
+        -1, -1, -1, -1, 2, 4, 6, 8,
+        -1, -1, -1, -1, 2, 4, 6, 8
+    };
+    const Uint16 step_table[89] = {
+        7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31,
+        34, 37, 41, 45, 50, 55, 60, 66, 73, 80, 88, 97, 107, 118, 130,
+        143, 157, 173, 190, 209, 230, 253, 279, 307, 337, 371, 408,
+        449, 494, 544, 598, 658, 724, 796, 876, 963, 1060, 1166, 1282,
+        1411, 1552, 1707, 1878, 2066, 2272, 2499, 2749, 3024, 3327,
+        3660, 4026, 4428, 4871, 5358, 5894, 6484, 7132, 7845, 8630,
+        9493, 10442, 11487, 12635, 13899, 15289, 16818, 18500, 20350,
+        22385, 24623, 27086, 29794, 32767
+    };
+    Sint8 index = *cindex;
+    Uint32 step;
+    Sint32 sample, delta;
+
+    if (index > 88) {
+        index = 88;
+    } else if (index < 0) {
+        index = 0;
+    }
+    step = step_table[(size_t)index];
+    *cindex = index + index_table_4b[nybble];
+
+    delta = step >> 3;
+    if (nybble & 0x04)
+        delta += step;
+    if (nybble & 0x02)
+        delta += step >> 1;
+    if (nybble & 0x01)
+        delta += step >> 2;
+    if (nybble & 0x08)
+        delta = -delta;
+
+    sample = lastsample + delta;
+    if (sample > 32767) {
+        sample = 32767;
+    } else if (sample < -32768) {
+        sample = -32768;
+    }
+    return (Sint16)sample;
+}
+
+static void
+RefIMAADPCMBlock(const Uint8 *block, int channels, int samplesperblock, Sint16 *out)
+{
+    Sint8 cindex[255];
+    int c, i, o, pos = channels * 4;
+
+    for (c = 0; c < channels; c++) {
+        out[c] = (Sint16)(block[c * 4] | (block[c * 4 + 1] << 8));
+        cindex[c] = (Sint8)block[c * 4 + 2];
+    }
+    for (o = channels; o < samplesperblock * channels; o += channels * 8) {
+        for (c = 0; c < channels; c++) {
+            Sint16 sample = out[o + c - channels];
+            Uint8 nybble = 0;
+            for (i = 0; i < 8; i++) {
+                if (i & 1) {
+                    nybble >>= 4;
+                } else {
+                    nybble = block[pos++];
+                }
+                sample = RefIMAADPCMNibble(&cindex[c], sample, nybble & 0x0f);
+                out[o + c + i * channels] = sample;
+            }
+        }
+    }
+}
+
+static Sint16
+RefLaw(Uint16 encoding, Uint8 byte)
+{
+    if (encoding == ALAW_CODE) {
+        Uint8 exponent = (byte & 0x7f) ^ 0x55;
+        Sint16 mantissa = exponent & 0xf;
+
+        exponent >>= 4;
+        if (exponent > 0) {
+            mantissa |= 0x10;
+        }
+        mantissa = (mantissa << 4) | 0x8;
+        if (exponent > 1) {
+            mantissa <<= exponent - 1;
+        }
+        return byte & 0x80 ? mantissa : -mantissa;
+    } else {
+        Uint8 nibble = ~byte;
+        Sint16 mantissa = nibble & 0xf;
+        Uint8 exponent = (nibble >> 4) & 0x7;
+        Sint16 step = 4 << (exponent + 1);
+
+        mantissa = (0x80 << exponent) + step * mantissa + step / 2 - 132;
+        return nibble & 0x80 ? -mantissa : mantissa;
+    }
+}
+
+typedef struct
+{
+    const char *name;
+    Uint16 encoding;
+    Uint16 channels;
+    Uint16 blockalign;
+} TestFormat;
+
+static const TestFormat formats[] = {
+    { "A-law mono", ALAW_CODE, 1, 1 },
+    { "mu-law stereo", MULAW_CODE, 2, 2 },
+    { "IMA ADPCM mono", IMA_ADPCM_CODE, 1, 512 },
+    { "IMA ADPCM stereo", IMA_ADPCM_CODE, 2, 1024 },
+    { "IMA ADPCM 5.1", IMA_ADPCM_CODE, 6, 3072 },
+    { "MS ADPCM mono", MS_ADPCM_CODE, 1, 512 },
+    { "MS ADPCM stereo", MS_ADPCM_CODE, 2, 1024 },
+};
+
+static int seconds = 10;
+static Uint32 rand_state = 1;
+
+static Uint8
+Random8(void)
+{
+    rand_state = rand_state * 1103515245 + 12345;
+    return (Uint8)(rand_state >> 16);
+}
+
+static void
+Put16(Uint8 *p, Uint16 v)
+{
+    p[0] = (Uint8)v;
+    p[1] = (Uint8)(v >> 8);
+}
+
+static void
+Put32(Uint8 *p, Uint32 v)
+{
+    Put16(p, (Uint16)v);
+    Put16(p + 2, (Uint16)(v >> 16));
+}
+
+static int
+SamplesPerBlock(const TestFormat *format)
+{
+    switch (format->encoding) {
+    case IMA_ADPCM_CODE:
+        return (format->blockalign - format->channels * 4) * 2 / format->channels + 1;
+    case MS_ADPCM_CODE:
+        return (format->blockalign - format->channels * 7) * 2 / format->channels + 2;
+    }
+    return 1;
+}
+
+/* Builds a WAVE file with noise for data and decodes it with the reference decoders */
+static Uint8 *
+CreateWAV(const TestFormat *format, Uint32 *wavlen, Sint16 **expected, Uint32 *expectedlen)
+{
+    static const Sint16 coeffs[14] = {256, 0, 512, -256, 0, 0, 192, 64, 240, 0, 460, -208, 392, -232};
+    const int samplesperblock = SamplesPerBlock(format);
+    const Uint32 blocks = (Uint32)(44100 * seconds / samplesperblock);
+    const Uint32 datalen = blocks * format->blockalign;
+    const Uint32 fmtlen = format->encoding == MS_ADPCM_CODE ? 50 : 20;
+    const Uint32 headerlen = 12 + 8 + fmtlen + 8;
+    Uint8 *wav, *data;
+    Uint32 i, b;
+    int c;
+
+    *wavlen = headerlen + datalen;
+    *expectedlen = blocks * samplesperblock * format->channels * sizeof(Sint16);
+    wav = (Uint8 *)SDL_malloc(*wavlen);
+    *expected = (Sint16 *)SDL_malloc(*expectedlen);
+    if (!wav || !*expected) {
+        return NULL;
+    }
+
+    SDL_memcpy(wav, "RIFF", 4);
+    Put32(wav + 4, *wavlen - 8);
+    SDL_memcpy(wav + 8, "WAVEfmt ", 8);
+    Put32(wav + 16, fmtlen);
+    Put16(wav + 20, format->encoding);
+    Put16(wav + 22, format->channels);
+    Put32(wav + 24, 44100);
+    Put32(wav + 28, 44100 * format->blockalign / samplesperblock);
+    Put16(wav + 32, format->blockalign);
+    Put16(wav + 34, format->encoding == ALAW_CODE || format->encoding == MULAW_CODE ? 8 : 4);
+    Put16(wav + 36, (Uint16)(fmtlen - 18));
+    Put16(wav + 38, (Uint16)samplesperblock);
+    if (format->encoding == MS_ADPCM_CODE) {
+        Put16(wav + 40, 7);
+        for (i = 0; i < 14; i++) {
+            Put16(wav + 42 + i * 2, (Uint16)coeffs[i]);
+        }
+    }
+    SDL_memcpy(wav + headerlen - 8, "data", 4);
+    Put32(wav + headerlen - 4, datalen);
+
+    data = wav + headerlen;
+    for (i = 0; i < datalen; i++) {
+        data[i] = Random8();
+    }
+
+    /* Make the block headers valid */
+    for (b = 0; b < blocks; b++) {
+        Uint8 *block = data + b * format->blockalign;
+        Sint16 *out = *expected + b * samplesperblock * format->channels;
+        switch (format->encoding) {
+        case IMA_ADPCM_CODE:
+            for (c = 0; c < format->channels; c++) {
+                block[c * 4 + 2] %= 89;
+                block[c * 4 + 3] = 0;
+            }
+            RefIMAADPCMBlock(block, format->channels, samplesperblock, out);
+            break;
+        case MS_ADPCM_CODE:
+            for (c = 0; c < format->channels; c++) {
+                block[c] %= 7;
+                block[format->channels + c * 2 + 1] &= 0x0f;
+            }
+            RefMSADPCMBlock(block, format->channels, samplesperblock, out);
+            break;
+        default:
+            for (c = 0; c < format->channels; c++) {
+                out[c] = RefLaw(format->encoding, block[c]);
+            }
+            break;
+        }
+    }
+
+    return wav;
+}
+
+static double
+Elapsed(Uint64 start)
+{
+    return (double) (SDL_GetPerformanceCounter() - start) / SDL_GetPerformanceFrequency();
+}
+
+/* Decodes the file repeatedly and returns the average time per decode */
+static double
+TimeDecode(Uint8 *wav, Uint32 wavlen, Uint8 **audio, Uint32 *audiolen)
+{
+    SDL_AudioSpec spec;
+    Uint64 start = SDL_GetPerformanceCounter();
+    int runs = 0;
+
+    do {
+        if (*audio) {
+            SDL_FreeWAV(*audio);
+            *audio = NULL;
+        }
+        if (!SDL_LoadWAV_RW(SDL_RWFromConstMem(wav, (int) wavlen), 1, &spec, audio, audiolen)) {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't load WAVE data: %s\n", SDL_GetError());
+            return -1.0;
+        }
+        ++runs;
+    } while (Elapsed(start) < 1.0);
+
+    return Elapsed(start) / runs;
+}
+
+static int
+RunBenchmark(const TestFormat *format)
+{
+    Uint8 *wav, *audio = NULL;
+    Sint16 *expected = NULL;
+    Uint32 wavlen, expectedlen, audiolen = 0;
+    double sdl_time;
+    int matches;
+
+    wav = CreateWAV(format, &wavlen, &expected, &expectedlen);
+    if (!wav) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Out of memory\n");
+        return -1;
+    }
+
+    sdl_time = TimeDecode(wav, wavlen, &audio, &audiolen);
+    matches = (sdl_time >= 0.0 && audiolen == expectedlen && SDL_memcmp(audio, expected, expectedlen) == 0);
+
+    SDL_Log("%-17s: %8.1f MB/s in, %8.1f MB/s out%s\n", format->name,
+            wavlen / sdl_time / (1024 * 1024), audiolen / sdl_time / (1024 * 1024),
+            matches ? "" : "  (output differs from the reference decoder!)");
+
+    SDL_FreeWAV(audio);
+    SDL_free(wav);
+    SDL_free(expected);
+    return matches ? 0 : -1;
+}
+
+/* Files given on the command line are only timed */
+static int
+RunFile(const char *file)
+{
+    SDL_RWops *rw = SDL_RWFromFile(file, "rb");
+    Sint64 size = rw ? SDL_RWsize(rw) : -1;
+    Uint8 *wav, *audio = NULL;
+    Uint32 audiolen = 0;
+    double sdl_time;
+
+    if (size <= 0 || size > SDL_MAX_SINT32) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't open %s: %s\n", file, SDL_GetError());
+        if (rw) {
+            SDL_RWclose(rw);
+        }
+        return -1;
+    }
+    wav = (Uint8 *)SDL_malloc((size_t)size);
+    if (!wav || SDL_RWread(rw, wav, (size_t)size, 1) != 1) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't read %s\n", file);
+        SDL_RWclose(rw);
+        SDL_free(wav);
+        return -1;
+    }
+    SDL_RWclose(rw);
+
+    sdl_time = TimeDecode(wav, (Uint32)size, &audio, &audiolen);
+    if (sdl_time >= 0.0) {
+        SDL_Log("%s: %8.1f MB/s in, %8.1f MB/s out\n", file,
+                size / sdl_time / (1024 * 1024), audiolen / sdl_time / (1024 * 1024));
+    }
+    SDL_FreeWAV(audio);
+    SDL_free(wav);
+    return sdl_time >= 0.0 ? 0 : -1;
+}
+
+int
+main(int argc, char *argv[])
+{
+    int i, status = 0, files = 0;
+
+    /* Enable standard application logging */
+    SDL_LogSetPriority(SDL_LOG_CATEGORY_APPLICATION, SDL_LOG_PRIORITY_INFO);
+
+    if (SDL_Init(0) < 0) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't initialize SDL: %s\n", SDL_GetError());
+        return 1;
+    }
+
+    for (i = 1; i < argc; ++i) {
+        if (SDL_strcmp(argv[i], "--seconds") == 0 && argv[i+1]) {
+            seconds = SDL_atoi(argv[++i]);
+            if (seconds < 1) {
+                seconds = 1;
+            }
+        } else if (argv[i][0] != '-') {
+            if (RunFile(argv[i]) < 0) {
+                status = 1;
+            }
+            ++files;
+        } else {
+            SDL_Log("USAGE: %s [--seconds N] [file.wav ...]\n", argv[0]);
+            SDL_Quit();
+            return 1;
+        }
+    }
+
+    if (!files) {
+        SDL_Log("Decoding %d second%s of 44100 Hz audio\n", seconds, seconds == 1 ? "" : "s");
+        for (i = 0; i < SDL_arraysize(formats); ++i) {
+            if (RunBenchmark(&formats[i]) < 0) {
+                status = 1;
+            }
+        }
+    }
+
+    SDL_Quit();
+    return status;
+}
+
+/* vi: set ts=4 sw=4 expandtab: */
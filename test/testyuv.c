@@ -45,7 +45,7 @@ static SDL_Surface *generate_test_pattern(int pattern_size)
 
         /* R, G, B in alternating horizontal bands */
         for (y = 0; y < pattern->h; y += thickness) {
-            for (i = 0; i < thickness; ++i) {
+            for (i = 0; i < thickness && (y + i) < pattern->h; ++i) {
                 p = (Uint8 *)pattern->pixels + (y + i) * pattern->pitch + ((y/thickness) % 3);
                 for (x = 0; x < pattern->w; ++x) {
                     *p = 0xFF;
@@ -57,7 +57,7 @@ static SDL_Surface *generate_test_pattern(int pattern_size)
         /* Black and white in alternating vertical bands */
         c = 0xFF;
         for (x = 1*thickness; x < pattern->w; x += 2*thickness) {
-            for (i = 0; i < thickness; ++i) {
+            for (i = 0; i < thickness && (x + i) < pattern->w; ++i) {
                 p = (Uint8 *)pattern->pixels + (x + i)*3;
                 for (y = 0; y < pattern->h; ++y) {
                     SDL_memset(p, c, 3);
@@ -219,6 +219,92 @@ done:
     return result;
 }
 
+/* Time conversion from each YUV format with the standard C functions and with
+   the SIMD ones, the outputs should be identical */
+static int run_benchmark(int width, int height)
+{
+    const Uint32 yuv_formats[] = {
+        SDL_PIXELFORMAT_YV12,
+        SDL_PIXELFORMAT_IYUV,
+        SDL_PIXELFORMAT_NV12,
+        SDL_PIXELFORMAT_NV21,
+        SDL_PIXELFORMAT_YUY2,
+        SDL_PIXELFORMAT_UYVY,
+        SDL_PIXELFORMAT_YVYU
+    };
+    const Uint32 rgb_formats[] = {
+        SDL_PIXELFORMAT_RGB565,
+        SDL_PIXELFORMAT_RGB24,
+        SDL_PIXELFORMAT_ARGB8888,
+        SDL_PIXELFORMAT_ABGR8888,
+        SDL_PIXELFORMAT_RGBA8888,
+        SDL_PIXELFORMAT_BGRA8888
+    };
+    SDL_Surface *pattern = SDL_CreateRGBSurfaceWithFormat(0, width, height, 0, SDL_PIXELFORMAT_RGB24);
+    Uint8 *yuv = (Uint8 *)SDL_malloc(MAX_YUV_SURFACE_SIZE(width, height, 0));
+    Uint8 *expected = (Uint8 *)SDL_malloc(width * height * 4);
+    Uint8 *actual = (Uint8 *)SDL_malloc(width * height * 4);
+    int i, j, k, x, y, result = -1;
+
+    if (!pattern || !yuv || !expected || !actual) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't allocate benchmark surfaces");
+        goto done;
+    }
+
+    for (y = 0; y < pattern->h; ++y) {
+        Uint8 *p = (Uint8 *)pattern->pixels + y * pattern->pitch;
+        for (x = 0; x < pattern->w * 3; ++x) {
+            p[x] = (Uint8)rand();
+        }
+    }
+
+    result = 0;
+    for (i = 0; i < SDL_arraysize(yuv_formats); ++i) {
+        const int yuv_pitch = CalculateYUVPitch(yuv_formats[i], width);
+
+        ConvertRGBtoYUV(yuv_formats[i], pattern->pixels, pattern->pitch, yuv, width, height,
+            SDL_GetYUVConversionModeForResolution(width, height), 0, 100);
+
+        for (j = 0; j < SDL_arraysize(rgb_formats); ++j) {
+            const int rgb_pitch = width * SDL_BYTESPERPIXEL(rgb_formats[j]);
+            double elapsed[2];
+            SDL_bool same;
+
+            for (k = 0; k < 2; ++k) {
+                Uint8 *rgb = k ? actual : expected;
+                Uint64 start, now;
+                int runs = 0;
+
+                SDL_SetHint("SDL_YUV_INTRINSICS", k ? "1" : "0");
+                start = SDL_GetPerformanceCounter();
+                do {
+                    SDL_ConvertPixels(width, height, yuv_formats[i], yuv, yuv_pitch, rgb_formats[j], rgb, rgb_pitch);
+                    ++runs;
+                    now = SDL_GetPerformanceCounter();
+                } while ((now - start) < SDL_GetPerformanceFrequency() / 4);
+                elapsed[k] = (double)(now - start) * 1000.0 / SDL_GetPerformanceFrequency() / runs;
+            }
+            SDL_SetHint("SDL_YUV_INTRINSICS", NULL);
+            same = (SDL_memcmp(expected, actual, rgb_pitch * height) == 0);
+
+            SDL_Log("%-22s -> %-24s C %6.2f ms, SIMD %6.2f ms, %4.2fx%s\n",
+                    SDL_GetPixelFormatName(yuv_formats[i]), SDL_GetPixelFormatName(rgb_formats[j]),
+                    elapsed[0], elapsed[1], elapsed[0] / elapsed[1],
+                    same ? "" : " (output differs!)");
+            if (!same) {
+                result = -1;
+            }
+        }
+    }
+
+done:
+    SDL_free(actual);
+    SDL_free(expected);
+    SDL_free(yuv);
+    SDL_FreeSurface(pattern);
+    return result;
+}
+
 int
 main(int argc, char **argv)
 {
@@ -268,6 +354,7 @@ main(int argc, char **argv)
     Uint8 *raw_yuv;
     Uint32 then, now, i, iterations = 100;
     SDL_bool should_run_automated_tests = SDL_FALSE;
+    SDL_bool should_run_benchmark = SDL_FALSE;
 
     while (argv[arg] && *argv[arg] == '-') {
         if (SDL_strcmp(argv[arg], "--jpeg") == 0) {
@@ -308,8 +395,10 @@ main(int argc, char **argv)
             rgb_format = SDL_PIXELFORMAT_BGRA8888;
         } else if (SDL_strcmp(argv[arg], "--automated") == 0) {
             should_run_automated_tests = SDL_TRUE;
+        } else if (SDL_strcmp(argv[arg], "--benchmark") == 0) {
+            should_run_benchmark = SDL_TRUE;
         } else {
-            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Usage: %s [--jpeg|--bt601|-bt709|--auto] [--yv12|--iyuv|--yuy2|--uyvy|--yvyu|--nv12|--nv21] [--rgb555|--rgb565|--rgb24|--argb|--abgr|--rgba|--bgra] [image_filename]\n", argv[0]);
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Usage: %s [--jpeg|--bt601|-bt709|--auto] [--yv12|--iyuv|--yuy2|--uyvy|--yvyu|--nv12|--nv21] [--rgb555|--rgb565|--rgb24|--argb|--abgr|--rgba|--bgra] [--automated|--benchmark] [image_filename]\n", argv[0]);
             return 1;
         }
         ++arg;
@@ -322,6 +411,7 @@ main(int argc, char **argv)
                 automated_test_params[i].pattern_size,
                 automated_test_params[i].extra_pitch,
                 automated_test_params[i].enable_intrinsics ? "enabled" : "disabled");
+            SDL_SetHint("SDL_YUV_INTRINSICS", automated_test_params[i].enable_intrinsics ? "1" : "0");
             if (run_automated_tests(automated_test_params[i].pattern_size, automated_test_params[i].extra_pitch) < 0) {
                 return 2;
             }
@@ -329,6 +419,14 @@ main(int argc, char **argv)
         return 0;
     }
 
+    /* Compare the standard C and SIMD conversions from YUV */
+    if (should_run_benchmark) {
+        if (run_benchmark(1920, 1080) < 0) {
+            return 2;
+        }
+        return 0;
+    }
+
     if (argv[arg]) {
         filename = argv[arg];
     } else {